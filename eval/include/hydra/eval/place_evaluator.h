@@ -33,7 +33,12 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <vector>
 
 #include "hydra/common/dsg_types.h"
 #include "hydra/eval/place_metrics.h"
@@ -52,6 +57,22 @@ class PlaceEvaluator {
 
   PlaceMetrics eval(const std::string& graph_filepath, uint8_t min_basis) const;
 
+  /**
+   * @brief Evaluate several graph files for several basis thresholds.
+   *
+   * Each graph is only loaded once and the GVD lookup for each threshold is shared
+   * between all graphs.
+   * @param graph_filepaths Graphs to evaluate
+   * @param min_basis Basis thresholds to evaluate each graph for
+   * @param num_threads Number of graphs to load and score concurrently
+   * @returns Metrics indexed by graph and then threshold (in the same order as the
+   * input)
+   */
+  std::vector<std::vector<PlaceMetrics>> eval(
+      const std::vector<std::string>& graph_filepaths,
+      const std::vector<uint8_t>& min_basis,
+      size_t num_threads) const;
+
  public:
   static PlaceEvaluator::Ptr fromFile(const std::string& config_filepath,
                                       const std::string& tsdf_filepath,
@@ -61,6 +82,11 @@ class PlaceEvaluator {
   places::GvdIntegratorConfig config_;
   TsdfLayer::Ptr tsdf_;
   places::GvdLayer::Ptr gvd_;
+
+  std::shared_ptr<const GvdDistanceFinder> getFinder(uint8_t min_basis) const;
+
+  mutable std::mutex finder_mutex_;
+  mutable std::map<uint8_t, std::shared_ptr<const GvdDistanceFinder>> finders_;
 };
 
 }  // namespace hydra::eval
@@ -34,6 +34,8 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 
+#include <memory>
+#include <ostream>
 #include <vector>
 
 #include "hydra/common/dsg_types.h"
@@ -51,8 +53,38 @@ struct PlaceMetrics {
   std::vector<NodeId> node_order;
 };
 
+/**
+ * @brief Nearest GVD voxel lookup for a specific basis threshold.
+ *
+ * Building the underlying KD-tree is the most expensive part of scoring places, so
+ * finders can be built once per threshold and shared between evaluations. Queries are
+ * safe to run concurrently.
+ */
+class GvdDistanceFinder {
+ public:
+  GvdDistanceFinder(const places::GvdLayer& gvd, size_t min_gvd_basis);
+
+  ~GvdDistanceFinder();
+
+  //! Distance to the closest GVD voxel (NaN if there are no GVD voxels)
+  double distance(const Eigen::Vector3d& pos) const;
+
+  //! Number of GVD voxels that meet the basis threshold
+  size_t size() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 PlaceMetrics scorePlaces(const SceneGraphLayer& places,
                          const places::GvdLayer& gvd,
                          size_t min_gvd_basis);
 
+PlaceMetrics scorePlaces(const SceneGraphLayer& places,
+                         const places::GvdLayer& gvd,
+                         const GvdDistanceFinder& finder);
+
+std::ostream& operator<<(std::ostream& out, const PlaceMetrics& metrics);
+
 }  // namespace hydra::eval
@@ -38,6 +38,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "hydra/eval/room_io.h"
 #include "hydra/eval/room_metrics.h"
@@ -68,6 +69,15 @@ class RoomEvaluator {
 
   RoomMetrics eval(const std::string& graph_filepath) const;
 
+  /**
+   * @brief Evaluate several graph files against the same ground truth.
+   * @param graph_filepaths Graphs to evaluate
+   * @param num_threads Number of graphs to load and score concurrently
+   * @returns Metrics for each graph (in the same order as the input)
+   */
+  std::vector<RoomMetrics> eval(const std::vector<std::string>& graph_filepaths,
+                                size_t num_threads) const;
+
   static GlobalIndices getSphereAroundPoint(const TsdfLayer& layer,
                                             const Point& center,
                                             float radius);
@@ -81,6 +91,7 @@ class RoomEvaluator {
   RoomGeometry rooms_;
   TsdfLayer::Ptr tsdf_;
   RoomIndices room_indices_;
+  std::unique_ptr<RoomVoxelIndex> room_index_;
 };
 
 }  // namespace hydra::eval
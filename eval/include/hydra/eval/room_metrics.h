@@ -34,15 +34,18 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 #include <array>
 #include <map>
 #include <ostream>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace hydra::eval {
 
-using RoomIndices = std::map<size_t, std::set<std::array<int64_t, 3>>>;
+using VoxelKey = std::array<int64_t, 3>;
+using RoomIndices = std::map<size_t, std::set<VoxelKey>>;
 
 struct RoomMetrics {
   double total_recall;
@@ -58,8 +61,45 @@ struct RoomMetrics {
   bool valid() const;
 };
 
+/**
+ * @brief Inverted index from voxel to the rooms that contain the voxel.
+ *
+ * Counting the overlap with another set of rooms only takes one lookup per voxel of
+ * the other rooms instead of a pass over every pair of rooms. The index only needs to
+ * be built once for the ground-truth rooms and can be shared between evaluations.
+ */
+class RoomVoxelIndex {
+ public:
+  explicit RoomVoxelIndex(const RoomIndices& rooms);
+
+  size_t numRooms() const { return sizes_.size(); }
+
+  //! Number of voxels in each indexed room (in order of room ID)
+  const std::vector<size_t>& sizes() const { return sizes_; }
+
+  bool contains(const VoxelKey& voxel) const { return voxel_rooms_.count(voxel); }
+
+  /**
+   * @brief Compute the sparse contingency matrix against another set of rooms.
+   * @param rooms Rooms to compare against
+   * @returns Number of shared voxels between the indexed rooms (rows) and the other
+   * rooms (columns), both in order of room ID
+   */
+  Eigen::SparseMatrix<double> computeOverlap(const RoomIndices& rooms) const;
+
+ private:
+  struct KeyHash {
+    size_t operator()(const VoxelKey& key) const;
+  };
+
+  std::vector<size_t> sizes_;
+  std::unordered_multimap<VoxelKey, size_t, KeyHash> voxel_rooms_;
+};
+
 RoomMetrics scoreRooms(const RoomIndices& lhs_rooms, const RoomIndices& rhs_rooms);
 
+RoomMetrics scoreRooms(const RoomVoxelIndex& gt_index, const RoomIndices& est_rooms);
+
 std::ostream& operator<<(std::ostream& out, const RoomMetrics& metrics);
 
 }  // namespace hydra::eval
@@ -38,9 +38,12 @@
 #include <config_utilities/printing.h>
 #include <glog/logging.h>
 
+#include <algorithm>
+
 #include "hydra/places/gvd_integrator.h"
 #include "hydra/reconstruction/volumetric_map.h"
 #include "hydra/utils/layer_io.h"
+#include "hydra/utils/parallel_utilities.h"
 
 namespace hydra::eval {
 
@@ -64,6 +67,9 @@ void PlaceEvaluator::computeGroundTruth(const GvdIntegratorConfig& config) {
   CHECK(map) << "Invalid map!";
   integrator.updateFromTsdf(0, map->getTsdfLayer(), false, true);
   integrator.updateGvd(0);
+
+  std::lock_guard<std::mutex> lock(finder_mutex_);
+  finders_.clear();
 }
 
 PlaceEvaluator::Ptr PlaceEvaluator::fromFile(const std::string& config_filepath,
@@ -93,7 +99,51 @@ PlaceMetrics PlaceEvaluator::eval(const std::string& graph_filepath,
 
   const auto& places = graph->getLayer(DsgLayers::PLACES);
   LOG(INFO) << "Place Nodes: " << places.nodes().size();
-  return scorePlaces(places, *gvd_, min_basis);
+  return scorePlaces(places, *gvd_, *getFinder(min_basis));
+}
+
+std::vector<std::vector<PlaceMetrics>> PlaceEvaluator::eval(
+    const std::vector<std::string>& graph_filepaths,
+    const std::vector<uint8_t>& min_basis,
+    size_t num_threads) const {
+  // build the lookups up front so that workers don't wait on each other
+  std::vector<std::shared_ptr<const GvdDistanceFinder>> finders(min_basis.size());
+  processInParallel(min_basis.size(), num_threads, [&](size_t i) {
+    finders[i] = getFinder(min_basis[i]);
+  });
+
+  std::vector<std::vector<PlaceMetrics>> results(graph_filepaths.size());
+  processInParallel(graph_filepaths.size(), num_threads, [&](size_t i) {
+    const auto graph = DynamicSceneGraph::load(graph_filepaths[i]);
+    if (!graph->hasLayer(DsgLayers::PLACES)) {
+      LOG(ERROR) << "Graph file: " << graph_filepaths[i] << " does not have places";
+      results[i].resize(min_basis.size());
+      return;
+    }
+
+    const auto& places = graph->getLayer(DsgLayers::PLACES);
+    for (const auto& finder : finders) {
+      results[i].push_back(scorePlaces(places, *gvd_, *finder));
+    }
+  });
+
+  return results;
+}
+
+std::shared_ptr<const GvdDistanceFinder> PlaceEvaluator::getFinder(
+    uint8_t min_basis) const {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(finder_mutex_);
+    auto iter = finders_.find(min_basis);
+    if (iter != finders_.end()) {
+      return iter->second;
+    }
+  }  // end critical section
+
+  // building the KD-tree is slow, so avoid holding the lock while building
+  auto finder = std::make_shared<const GvdDistanceFinder>(*gvd_, min_basis);
+  std::lock_guard<std::mutex> lock(finder_mutex_);
+  return finders_.emplace(min_basis, finder).first->second;
 }
 
 }  // namespace hydra::eval
@@ -36,7 +36,10 @@
 
 #include <glog/logging.h>
 
+#include <cmath>
+#include <limits>
 #include <nanoflann.hpp>
+#include <sstream>
 
 namespace hydra::eval {
 
@@ -45,11 +48,19 @@ using nanoflann::L2_Simple_Adaptor;
 using places::GvdLayer;
 using places::GvdVoxel;
 
+namespace {
+
 void fillGvdPositions(const GvdLayer& layer,
                       size_t min_gvd_basis,
                       std::vector<Eigen::Vector3d>& result) {
   result.clear();
 
+  size_t num_voxels = 0;
+  for (const auto& block : layer) {
+    num_voxels += block.numVoxels();
+  }
+
+  result.reserve(num_voxels);
   for (const auto& block : layer) {
     for (size_t i = 0; i < block.numVoxels(); ++i) {
       const auto& voxel = block.getVoxel(i);
@@ -60,12 +71,11 @@ void fillGvdPositions(const GvdLayer& layer,
       result.push_back(block.getVoxelPosition(i).cast<double>());
     }
   }
+
+  result.shrink_to_fit();
 }
 
 struct VoxelKdTreeAdaptor {
-  VoxelKdTreeAdaptor(const std::vector<Eigen::Vector3d>& positions)
-      : positions(positions) {}
-
   inline size_t kdtree_get_point_count() const { return positions.size(); }
 
   inline double kdtree_get_pt(const size_t idx, const size_t dim) const {
@@ -80,36 +90,65 @@ struct VoxelKdTreeAdaptor {
   std::vector<Eigen::Vector3d> positions;
 };
 
-struct DistanceFinder {
+template <typename T>
+std::string showVector(const std::vector<T>& vec) {
+  std::stringstream ss;
+  ss << "[";
+  auto iter = vec.begin();
+  while (iter != vec.end()) {
+    ss << *iter;
+    ++iter;
+    if (iter != vec.end()) {
+      ss << ", ";
+    }
+  }
+  ss << "]";
+  return ss.str();
+}
+
+}  // namespace
+
+struct GvdDistanceFinder::Impl {
   using Dist = L2_Simple_Adaptor<double, VoxelKdTreeAdaptor>;
   using KDTree = KDTreeSingleIndexAdaptor<Dist, VoxelKdTreeAdaptor, 3, size_t>;
 
-  DistanceFinder(std::vector<Eigen::Vector3d>& positions) : adaptor(positions) {
+  Impl(const GvdLayer& gvd, size_t min_gvd_basis) {
+    fillGvdPositions(gvd, min_gvd_basis, adaptor.positions);
     kdtree.reset(new KDTree(3, adaptor));
     kdtree->buildIndex();
   }
 
-  double distance(const Eigen::Vector3d& pos) const {
-    size_t idx;
-    double dist;
-    size_t num_found = kdtree->knnSearch(pos.data(), 1, &idx, &dist);
-    return num_found ? std::sqrt(dist) : std::numeric_limits<double>::quiet_NaN();
-  }
-
   VoxelKdTreeAdaptor adaptor;
   std::unique_ptr<KDTree> kdtree;
 };
 
+GvdDistanceFinder::GvdDistanceFinder(const GvdLayer& gvd, size_t min_gvd_basis)
+    : impl_(std::make_unique<Impl>(gvd, min_gvd_basis)) {}
+
+GvdDistanceFinder::~GvdDistanceFinder() = default;
+
+double GvdDistanceFinder::distance(const Eigen::Vector3d& pos) const {
+  size_t idx;
+  double dist;
+  size_t num_found = impl_->kdtree->knnSearch(pos.data(), 1, &idx, &dist);
+  return num_found ? std::sqrt(dist) : std::numeric_limits<double>::quiet_NaN();
+}
+
+size_t GvdDistanceFinder::size() const { return impl_->adaptor.positions.size(); }
+
 PlaceMetrics scorePlaces(const SceneGraphLayer& places,
                          const GvdLayer& gvd,
                          size_t min_gvd_basis) {
+  const GvdDistanceFinder finder(gvd, min_gvd_basis);
+  return scorePlaces(places, gvd, finder);
+}
+
+PlaceMetrics scorePlaces(const SceneGraphLayer& places,
+                         const GvdLayer& gvd,
+                         const GvdDistanceFinder& finder) {
   PlaceMetrics metrics;
   metrics.is_valid = true;
 
-  std::vector<Eigen::Vector3d> gvd_positions;
-  fillGvdPositions(gvd, min_gvd_basis, gvd_positions);
-  const DistanceFinder finder(gvd_positions);
-
   for (auto&& [node_id, node] : places.nodes()) {
     const auto& attrs = node->attributes<PlaceNodeAttributes>();
     metrics.node_order.push_back(node_id);
@@ -136,6 +175,18 @@ PlaceMetrics scorePlaces(const SceneGraphLayer& places,
   return metrics;
 }
 
+std::ostream& operator<<(std::ostream& out, const PlaceMetrics& metrics) {
+  out << "{";
+  out << "\n  \"total\": " << metrics.node_order.size();
+  out << ",\n  \"valid\": " << metrics.num_valid;
+  out << ",\n  \"missing\": " << metrics.num_missing;
+  out << ",\n  \"unobserved\": " << metrics.num_unobserved;
+  out << ",\n  \"dist_errors\": " << showVector(metrics.gvd_distance_errors);
+  out << ",\n  \"closest_dists\": " << showVector(metrics.node_gvd_distances);
+  out << "\n}";
+  return out;
+}
+
 /*
 nlohmann::json json_results = {
     {"missing", missing},
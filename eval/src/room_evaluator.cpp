@@ -36,8 +36,11 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 #include "hydra/reconstruction/voxel_types.h"
 #include "hydra/utils/layer_io.h"
+#include "hydra/utils/parallel_utilities.h"
 
 namespace hydra::eval {
 
@@ -71,6 +74,8 @@ void RoomEvaluator::computeRoomIndices() {
           {global_index.x(), global_index.y(), global_index.z()});
     }
   }
+
+  room_index_ = std::make_unique<RoomVoxelIndex>(room_indices_);
 }
 
 const RoomIndices& RoomEvaluator::getRoomIndices() const { return room_indices_; }
@@ -103,14 +108,13 @@ void RoomEvaluator::computeDsgIndices(const DynamicSceneGraph& graph,
           continue;
         }
 
-        if (config.only_labeled) {
-          const auto pos = tsdf_->getVoxelPosition(global_index);
-          const auto room_id = rooms_.findRoomIndex(pos);
-          if (!room_id) {
-            continue;
-          }
+        const VoxelKey key{global_index.x(), global_index.y(), global_index.z()};
+        // labeled voxels that pass the thresholds are exactly the ground-truth voxels
+        if (config.only_labeled && !room_index_->contains(key)) {
+          continue;
         }
-        indices[room].insert({global_index.x(), global_index.y(), global_index.z()});
+
+        indices[room].insert(key);
       }
     }
   }
@@ -125,7 +129,16 @@ RoomMetrics RoomEvaluator::eval(const std::string& graph_filepath) const {
 
   RoomIndices est_indices;
   computeDsgIndices(*graph, est_indices);
-  return scoreRooms(room_indices_, est_indices);
+  return scoreRooms(*room_index_, est_indices);
+}
+
+std::vector<RoomMetrics> RoomEvaluator::eval(
+    const std::vector<std::string>& graph_filepaths, size_t num_threads) const {
+  std::vector<RoomMetrics> results(graph_filepaths.size());
+  processInParallel(graph_filepaths.size(), num_threads, [&](size_t i) {
+    results[i] = eval(graph_filepaths[i]);
+  });
+  return results;
 }
 
 GlobalIndices RoomEvaluator::getSphereAroundPoint(const TsdfLayer& layer,
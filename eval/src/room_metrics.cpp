@@ -36,32 +36,64 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <numeric>
 
 namespace hydra::eval {
 
 bool RoomMetrics::valid() const { return !gt_sizes.empty() || !est_sizes.empty(); }
 
-Eigen::MatrixXd computeOverlap(const RoomIndices& gt_rooms,
-                               const RoomIndices& est_rooms) {
-  Eigen::MatrixXd overlaps = Eigen::MatrixXd::Zero(gt_rooms.size(), est_rooms.size());
-
-  size_t gt_idx = 0;
-  for (const auto& gt_room_pair : gt_rooms) {
-    size_t est_idx = 0;
-    for (const auto& est_room_pair : est_rooms) {
-      for (const auto& index : est_room_pair.second) {
-        if (gt_room_pair.second.count(index)) {
-          overlaps(gt_idx, est_idx) += 1.0;
+size_t RoomVoxelIndex::KeyHash::operator()(const VoxelKey& key) const {
+  return static_cast<size_t>(key[0] * 73856093 ^ key[1] * 19349663 ^ key[2] * 83492791);
+}
+
+RoomVoxelIndex::RoomVoxelIndex(const RoomIndices& rooms) {
+  size_t num_voxels = 0;
+  for (const auto& [room_id, voxels] : rooms) {
+    num_voxels += voxels.size();
+  }
+
+  voxel_rooms_.reserve(num_voxels);
+  for (const auto& [room_id, voxels] : rooms) {
+    const auto row = sizes_.size();
+    sizes_.push_back(voxels.size());
+    for (const auto& voxel : voxels) {
+      voxel_rooms_.emplace(voxel, row);
+    }
+  }
+}
+
+Eigen::SparseMatrix<double> RoomVoxelIndex::computeOverlap(
+    const RoomIndices& rooms) const {
+  std::vector<Eigen::Triplet<double>> entries;
+  // per-column counts only touch the rows that overlap the current column
+  std::vector<double> counts(sizes_.size(), 0.0);
+  std::vector<size_t> touched;
+
+  size_t col = 0;
+  for (const auto& [room_id, voxels] : rooms) {
+    for (const auto& voxel : voxels) {
+      const auto range = voxel_rooms_.equal_range(voxel);
+      for (auto iter = range.first; iter != range.second; ++iter) {
+        if (counts[iter->second] == 0.0) {
+          touched.push_back(iter->second);
         }
+
+        counts[iter->second] += 1.0;
       }
+    }
 
-      ++est_idx;
+    for (const auto row : touched) {
+      entries.emplace_back(row, col, counts[row]);
+      counts[row] = 0.0;
     }
 
-    ++gt_idx;
+    touched.clear();
+    ++col;
   }
 
+  Eigen::SparseMatrix<double> overlaps(sizes_.size(), rooms.size());
+  overlaps.setFromTriplets(entries.begin(), entries.end());
   return overlaps;
 }
 
@@ -74,39 +106,49 @@ std::vector<size_t> getSizes(const RoomIndices& rooms) {
 }
 
 RoomMetrics scoreRooms(const RoomIndices& gt_rooms, const RoomIndices& est_rooms) {
+  return scoreRooms(RoomVoxelIndex(gt_rooms), est_rooms);
+}
+
+RoomMetrics scoreRooms(const RoomVoxelIndex& gt_index, const RoomIndices& est_rooms) {
   RoomMetrics results;
-  results.gt_sizes = getSizes(gt_rooms);
+  results.gt_sizes = gt_index.sizes();
   results.est_sizes = getSizes(est_rooms);
-  results.overlaps = computeOverlap(gt_rooms, est_rooms);
 
-  // recalls
-  const auto max_gt_overlaps = results.overlaps.rowwise().maxCoeff();
-  CHECK_EQ(max_gt_overlaps.rows(), static_cast<int>(results.gt_sizes.size()));
+  const auto overlaps = gt_index.computeOverlap(est_rooms);
+  results.overlaps = Eigen::MatrixXd(overlaps);
 
+  // rooms without any overlap have a maximum overlap of zero
+  Eigen::VectorXd max_gt_overlaps = Eigen::VectorXd::Zero(overlaps.rows());
+  Eigen::VectorXd max_est_overlaps = Eigen::VectorXd::Zero(overlaps.cols());
+  for (Eigen::Index k = 0; k < overlaps.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(overlaps, k); it; ++it) {
+      max_gt_overlaps(it.row()) = std::max(max_gt_overlaps(it.row()), it.value());
+      max_est_overlaps(it.col()) = std::max(max_est_overlaps(it.col()), it.value());
+    }
+  }
+
+  // recalls
   for (size_t i = 0; i < results.gt_sizes.size(); ++i) {
     const auto curr_size = results.gt_sizes.at(i);
     results.recalls.push_back(curr_size ? max_gt_overlaps(i) / curr_size : 0.0);
   }
 
   const auto total_gt_size =
-      std::accumulate(results.gt_sizes.begin(), results.gt_sizes.end(), 0);
+      std::accumulate(results.gt_sizes.begin(), results.gt_sizes.end(), size_t(0));
   results.total_recall = total_gt_size ? max_gt_overlaps.sum() / total_gt_size : 0.0;
 
   // precisions
-  const auto max_est_overlaps = results.overlaps.colwise().maxCoeff();
-  CHECK_EQ(max_est_overlaps.cols(), static_cast<int>(results.est_sizes.size()));
-
   for (size_t i = 0; i < results.est_sizes.size(); ++i) {
     const auto curr_size = results.est_sizes.at(i);
     results.precisions.push_back(curr_size ? max_est_overlaps(i) / curr_size : 0.0);
   }
 
   Eigen::IOFormat fmt(6, Eigen::DontAlignCols, ", ", "; ", "", "", "[", "]");
-  VLOG(10) << "GT: " << max_gt_overlaps.format(fmt);
-  VLOG(10) << "EST: " << max_est_overlaps.format(fmt);
+  VLOG(10) << "GT: " << max_gt_overlaps.transpose().format(fmt);
+  VLOG(10) << "EST: " << max_est_overlaps.transpose().format(fmt);
 
   const auto total_est_size =
-      std::accumulate(results.est_sizes.begin(), results.est_sizes.end(), 0);
+      std::accumulate(results.est_sizes.begin(), results.est_sizes.end(), size_t(0));
   results.total_precision =
       total_est_size ? max_est_overlaps.sum() / total_est_size : 0.0;
   return results;
@@ -0,0 +1,401 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <config_utilities/config.h>
+#include <config_utilities/parsing/yaml.h>
+#include <config_utilities/validation.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <hydra/active_window/reconstruction_module.h>
+#include <hydra/backend/backend_module.h>
+#include <hydra/common/hydra_pipeline.h>
+#include <hydra/common/pipeline_queues.h>
+#include <hydra/frontend/graph_builder.h>
+#include <hydra/input/camera.h>
+#include <hydra/input/input_recording.h>
+#include <hydra/input/replay_receiver.h>
+#include <hydra/input/sensor_extrinsics.h>
+#include <hydra/utils/timing_utilities.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+DEFINE_string(config, "", "pipeline config (defaults are used if empty)");
+DEFINE_string(recording, "", "recording to replay (synthetic scene if empty)");
+DEFINE_string(synthetic_recording,
+              "/tmp/hydra_benchmark_input.bin",
+              "output path for the generated synthetic scene");
+DEFINE_string(sensor_name, "benchmark_camera", "sensor name for the synthetic scene");
+DEFINE_int32(num_frames, 300, "number of synthetic frames");
+DEFINE_int32(width, 320, "synthetic camera width");
+DEFINE_int32(height, 240, "synthetic camera height");
+DEFINE_double(frame_rate_hz, 10.0, "synthetic frame rate");
+DEFINE_bool(use_recorded_rate, false, "replay at the recorded rate");
+DEFINE_int32(sample_period_ms, 5, "queue depth sampling period");
+DEFINE_int32(idle_samples, 20, "number of idle samples before the run is finished");
+
+namespace hydra {
+
+using timing::ElapsedTimeRecorder;
+
+struct BenchmarkConfig : PipelineConfig {
+  config::VirtualConfig<ActiveWindowModule> active_window{
+      ReconstructionModule::Config()};
+  config::VirtualConfig<GraphBuilder> frontend{GraphBuilder::Config()};
+  config::VirtualConfig<BackendModule> backend{BackendModule::Config()};
+  //! Replay inputs (generated from the synthetic camera if empty)
+  std::map<std::string, InputModule::Config::InputPair> inputs;
+};
+
+void declare_config(BenchmarkConfig& config) {
+  using namespace config;
+  name("BenchmarkConfig");
+  base<PipelineConfig>(config);
+  field(config.active_window, "active_window");
+  field(config.frontend, "frontend");
+  field(config.backend, "backend");
+  field(config.inputs, "inputs");
+}
+
+class BenchmarkPipeline : public HydraPipeline {
+ public:
+  explicit BenchmarkPipeline(const BenchmarkConfig& config)
+      : HydraPipeline(config, 0, 1) {
+    frontend_ = config.frontend.create(frontend_dsg_, shared_state_);
+    CHECK(frontend_) << "Invalid frontend config!";
+    modules_["frontend"] = frontend_;
+    backend_ = config.backend.create(backend_dsg_, shared_state_);
+    modules_["backend"] = backend_;
+    active_window_ = config.active_window.create(frontend_->queue());
+    modules_["reconstruction"] = active_window_;
+
+    InputModule::Config input_config;
+    input_config.inputs = config.inputs;
+    input_ = std::make_shared<ReplayInputModule>(input_config, active_window_->queue());
+    input_module_ = input_;
+  }
+
+  struct QueueDepths {
+    size_t reconstruction;
+    size_t frontend;
+    size_t backend;
+  };
+
+  QueueDepths queueDepths() const {
+    return {active_window_->queue()->size(),
+            frontend_->queue()->size(),
+            PipelineQueues::instance().backend_queue.size()};
+  }
+
+  bool finished() const { return input_->finished(); }
+
+ private:
+  std::shared_ptr<ReplayInputModule> input_;
+  std::shared_ptr<ActiveWindowModule> active_window_;
+  std::shared_ptr<GraphBuilder> frontend_;
+  std::shared_ptr<BackendModule> backend_;
+};
+
+struct SyntheticBox {
+  Eigen::Vector3d min;
+  Eigen::Vector3d max;
+  int32_t label;
+  Eigen::Vector3i color;
+};
+
+//! Distance along the ray to the box (entering it from outside, or leaving it from
+//! inside). Returns infinity if the ray misses
+double intersect(const SyntheticBox& box,
+                 const Eigen::Vector3d& p,
+                 const Eigen::Vector3d& d,
+                 bool inside,
+                 int& face) {
+  double t_near = -std::numeric_limits<double>::infinity();
+  double t_far = std::numeric_limits<double>::infinity();
+  int near_face = -1;
+  int far_face = -1;
+  for (int i = 0; i < 3; ++i) {
+    if (std::abs(d(i)) < 1.0e-12) {
+      if (p(i) < box.min(i) || p(i) > box.max(i)) {
+        return std::numeric_limits<double>::infinity();
+      }
+      continue;
+    }
+
+    double t0 = (box.min(i) - p(i)) / d(i);
+    double t1 = (box.max(i) - p(i)) / d(i);
+    int f0 = 2 * i;
+    int f1 = 2 * i + 1;
+    if (t0 > t1) {
+      std::swap(t0, t1);
+      std::swap(f0, f1);
+    }
+
+    if (t0 > t_near) {
+      t_near = t0;
+      near_face = f0;
+    }
+
+    if (t1 < t_far) {
+      t_far = t1;
+      far_face = f1;
+    }
+  }
+
+  if (t_near > t_far) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  face = inside ? far_face : near_face;
+  const double t = inside ? t_far : t_near;
+  return t > 0.0 ? t : std::numeric_limits<double>::infinity();
+}
+
+Camera::Config syntheticCamera() {
+  Camera::Config camera;
+  camera.min_range = 0.1;
+  camera.max_range = 10.0;
+  camera.extrinsics =
+      config::VirtualConfig<SensorExtrinsics>(IdentitySensorExtrinsics::Config());
+  camera.width = FLAGS_width;
+  camera.height = FLAGS_height;
+  camera.cx = FLAGS_width / 2.0f;
+  camera.cy = FLAGS_height / 2.0f;
+  // 90 degree horizontal field of view
+  camera.fx = FLAGS_width / 2.0f;
+  camera.fy = camera.fx;
+  return camera;
+}
+
+/**
+ * @brief Render a camera moving in a loop through a box-shaped room with a few
+ * objects and write the result to a recording.
+ */
+size_t writeSyntheticScene(const std::string& filepath,
+                           const std::string& sensor_name,
+                           const Camera::Config& camera) {
+  const SyntheticBox room{{-5.0, -4.0, 0.0}, {5.0, 4.0, 3.0}, 1, {200, 200, 200}};
+  const std::vector<SyntheticBox> objects{
+      {{3.5, -3.5, 0.0}, {4.5, -2.0, 1.0}, 4, {180, 40, 40}},
+      {{-4.5, 2.0, 0.0}, {-3.0, 3.5, 0.8}, 5, {40, 180, 40}},
+      {{-0.5, -0.5, 0.0}, {0.5, 0.5, 2.0}, 6, {40, 40, 180}},
+      {{1.0, 3.0, 0.0}, {2.5, 3.8, 1.8}, 7, {180, 180, 40}}};
+  // floor and ceiling get separate labels
+  const std::array<int32_t, 6> room_labels{1, 1, 1, 1, 2, 3};
+  const std::array<Eigen::Vector3i, 6> room_colors{Eigen::Vector3i(200, 200, 200),
+                                                   Eigen::Vector3i(200, 200, 200),
+                                                   Eigen::Vector3i(190, 190, 210),
+                                                   Eigen::Vector3i(190, 190, 210),
+                                                   Eigen::Vector3i(120, 90, 60),
+                                                   Eigen::Vector3i(240, 240, 240)};
+
+  InputPacketWriter writer(filepath);
+  const auto period_ns = static_cast<uint64_t>(1.0e9 / FLAGS_frame_rate_hz);
+  for (int frame = 0; frame < FLAGS_num_frames; ++frame) {
+    // two loops around the center of the room facing along the direction of travel
+    const double theta = 4.0 * M_PI * frame / FLAGS_num_frames;
+    const Eigen::Vector3d pos(2.5 * std::cos(theta), 2.0 * std::sin(theta), 1.5);
+    const Eigen::Vector3d forward(-std::sin(theta), std::cos(theta), 0.0);
+    const Eigen::Vector3d down(0.0, 0.0, -1.0);
+    Eigen::Matrix3d world_R_camera;
+    world_R_camera.col(0) = forward.cross(Eigen::Vector3d::UnitZ());
+    world_R_camera.col(1) = down;
+    world_R_camera.col(2) = forward;
+
+    const uint64_t stamp = (frame + 1) * period_ns;
+    auto image = std::make_shared<ImageInputPacket>(stamp, sensor_name);
+    image->depth = cv::Mat(camera.height, camera.width, CV_32FC1);
+    image->labels = cv::Mat(camera.height, camera.width, CV_32SC1);
+    image->color = cv::Mat(camera.height, camera.width, CV_8UC3);
+    for (int v = 0; v < camera.height; ++v) {
+      for (int u = 0; u < camera.width; ++u) {
+        const Eigen::Vector3d ray_C((u - camera.cx) / camera.fx,
+                                    (v - camera.cy) / camera.fy,
+                                    1.0);
+        const Eigen::Vector3d ray_W = world_R_camera * ray_C;
+
+        int face = -1;
+        double depth = intersect(room, pos, ray_W, true, face);
+        int32_t label = face >= 0 ? room_labels[face] : 0;
+        Eigen::Vector3i color = face >= 0 ? room_colors[face] : Eigen::Vector3i::Zero();
+        for (const auto& object : objects) {
+          int object_face;
+          const double t = intersect(object, pos, ray_W, false, object_face);
+          if (t < depth) {
+            depth = t;
+            label = object.label;
+            color = object.color;
+          }
+        }
+
+        // ray_C has unit z, so the ray parameter is the depth
+        image->depth.at<float>(v, u) = std::isfinite(depth) ? depth : 0.0f;
+        image->labels.at<int32_t>(v, u) = label;
+        image->color.at<cv::Vec3b>(v, u) = cv::Vec3b(color.x(), color.y(), color.z());
+      }
+    }
+
+    InputPacket packet;
+    packet.timestamp_ns = stamp;
+    packet.sensor_input = image;
+    packet.world_t_body = pos;
+    packet.world_R_body = Eigen::Quaterniond(world_R_camera);
+    if (!writer.write(packet)) {
+      break;
+    }
+  }
+
+  return writer.numWritten();
+}
+
+struct DepthStats {
+  size_t max = 0;
+  double total = 0.0;
+
+  void add(size_t depth) {
+    max = std::max(max, depth);
+    total += depth;
+  }
+};
+
+void showTimer(const std::string& module, const std::string& timer, double elapsed_s) {
+  const auto snapshot = ElapsedTimeRecorder::instance().snapshot(timer);
+  std::cout << std::left << std::setw(16) << module << std::right;
+  if (!snapshot) {
+    std::cout << "  (no measurements for " << timer << ")" << std::endl;
+    return;
+  }
+
+  const auto& stats = snapshot->stats;
+  std::cout << std::fixed << std::setprecision(2) << std::setw(8)
+            << stats.num_measurements << std::setw(10) << stats.mean_s * 1.0e3
+            << std::setw(10) << snapshot->p50_s * 1.0e3 << std::setw(10)
+            << snapshot->p90_s * 1.0e3 << std::setw(10) << snapshot->p99_s * 1.0e3
+            << std::setw(10) << stats.max_s * 1.0e3 << std::setw(10)
+            << stats.num_measurements / elapsed_s << std::endl;
+}
+
+}  // namespace hydra
+
+int main(int argc, char* argv[]) {
+  FLAGS_minloglevel = 1;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::SetUsageMessage("end-to-end pipeline throughput benchmark");
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  using namespace hydra;
+  auto pipeline_config = FLAGS_config.empty()
+                             ? BenchmarkConfig()
+                             : config::fromYamlFile<BenchmarkConfig>(FLAGS_config);
+  pipeline_config.timing_disabled = false;
+
+  std::string recording = FLAGS_recording;
+  const auto camera = syntheticCamera();
+  if (recording.empty()) {
+    recording = FLAGS_synthetic_recording;
+    const auto num_written = writeSyntheticScene(recording, FLAGS_sensor_name, camera);
+    std::cout << "Wrote " << num_written << " synthetic frame(s) to " << recording
+              << std::endl;
+  }
+
+  if (pipeline_config.inputs.empty()) {
+    ReplayReceiver::Config receiver;
+    receiver.recording = recording;
+    receiver.use_recorded_rate = FLAGS_use_recorded_rate;
+    auto& input = pipeline_config.inputs[FLAGS_sensor_name];
+    input.receiver = config::VirtualConfig<DataReceiver>(receiver);
+    input.sensor = config::VirtualConfig<Sensor>(camera);
+  }
+
+  BenchmarkPipeline pipeline(pipeline_config);
+  ElapsedTimeRecorder::instance().reset();
+
+  hydra::DepthStats reconstruction_depth, frontend_depth, backend_depth;
+  size_t num_samples = 0;
+  int num_idle = 0;
+  const auto start = std::chrono::steady_clock::now();
+  pipeline.start();
+  while (num_idle < FLAGS_idle_samples) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_sample_period_ms));
+    const auto depths = pipeline.queueDepths();
+    reconstruction_depth.add(depths.reconstruction);
+    frontend_depth.add(depths.frontend);
+    backend_depth.add(depths.backend);
+    ++num_samples;
+
+    const bool idle = pipeline.finished() && !depths.reconstruction &&
+                      !depths.frontend && !depths.backend;
+    num_idle = idle ? num_idle + 1 : 0;
+  }
+
+  // don't count the idle samples used to detect the end of the run
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start -
+      std::chrono::milliseconds(FLAGS_sample_period_ms * FLAGS_idle_samples);
+  pipeline.stop();
+
+  const double elapsed_s = std::max(elapsed.count(), 1.0e-9);
+  std::cout << std::endl
+            << std::left << std::setw(16) << "module" << std::right << std::setw(8)
+            << "count" << std::setw(10) << "mean[ms]" << std::setw(10) << "p50[ms]"
+            << std::setw(10) << "p90[ms]" << std::setw(10) << "p99[ms]"
+            << std::setw(10) << "max[ms]" << std::setw(10) << "rate[Hz]" << std::endl;
+  showTimer("reconstruction", "reconstruction/spin", elapsed_s);
+  showTimer("frontend", "frontend/spin", elapsed_s);
+  showTimer("backend", "backend/update", elapsed_s);
+
+  std::cout << std::endl << "queue depths (mean / max):" << std::endl;
+  const auto show_depth = [&](const std::string& name, const hydra::DepthStats& stats) {
+    std::cout << "  " << std::left << std::setw(16) << name << std::right
+              << std::setprecision(2) << stats.total / std::max<size_t>(num_samples, 1)
+              << " / " << stats.max << std::endl;
+  };
+  show_depth("reconstruction", reconstruction_depth);
+  show_depth("frontend", frontend_depth);
+  show_depth("backend", backend_depth);
+
+  const auto frames = ElapsedTimeRecorder::instance().snapshot("reconstruction/spin");
+  const size_t num_frames = frames ? frames->stats.num_measurements : 0;
+  std::cout << std::endl
+            << "processed " << num_frames << " frame(s) in " << std::setprecision(3)
+            << elapsed_s << " [s]: " << num_frames / elapsed_s << " [fps]" << std::endl;
+  return 0;
+}
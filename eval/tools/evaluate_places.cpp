@@ -35,13 +35,22 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "hydra/eval/place_evaluator.h"
 
 DEFINE_double(max_distance_m, 4.5, "max distance");
 DEFINE_string(tsdf_file, "", "tsdf file to read");
-DEFINE_string(dsg_file, "", "dsg file to read");
+DEFINE_string(dsg_file, "", "dsg file to read (more files can be passed as arguments)");
 DEFINE_string(gvd_config, "", "gvd integrator config");
-DEFINE_int32(min_basis, 1, "minimum extra basis points to be considered a place");
+DEFINE_string(min_basis,
+              "1",
+              "minimum extra basis points to be considered a place (comma-separated "
+              "list to evaluate several thresholds)");
+DEFINE_int32(num_threads, 1, "number of graphs to evaluate concurrently");
 
 int main(int argc, char* argv[]) {
   FLAGS_minloglevel = 3;
@@ -60,20 +69,55 @@ int main(int argc, char* argv[]) {
     LOG(FATAL) << "GVD config is required!";
   }
 
-  if (FLAGS_dsg_file == "") {
+  std::vector<std::string> dsg_paths;
+  if (!FLAGS_dsg_file.empty()) {
+    dsg_paths.push_back(FLAGS_dsg_file);
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    dsg_paths.push_back(argv[i]);
+  }
+
+  if (dsg_paths.empty()) {
     LOG(FATAL) << "DSG file is required!";
   }
 
+  std::vector<uint8_t> min_basis;
+  std::stringstream ss(FLAGS_min_basis);
+  std::string threshold;
+  while (std::getline(ss, threshold, ',')) {
+    min_basis.push_back(static_cast<uint8_t>(std::stoi(threshold)));
+  }
+
+  if (min_basis.empty()) {
+    LOG(FATAL) << "At least one basis threshold is required!";
+  }
+
   auto evaluator =
       hydra::eval::PlaceEvaluator::fromFile(FLAGS_gvd_config, FLAGS_tsdf_file);
   if (!evaluator) {
     LOG(FATAL) << "Unable to construct place evaluator.";
   }
 
-  const auto metrics = evaluator->eval(FLAGS_dsg_file, FLAGS_min_basis);
-  if (!metrics.is_valid) {
-    LOG(FATAL) << "Unable to evaluate invalid graph!";
+  const auto results = evaluator->eval(dsg_paths, min_basis, FLAGS_num_threads);
+
+  // results are reported as a map from file to threshold to metrics
+  std::cout << "{";
+  for (size_t i = 0; i < dsg_paths.size(); ++i) {
+    std::cout << (i ? ",\n" : "\n") << "\"" << dsg_paths[i] << "\": {";
+    for (size_t j = 0; j < min_basis.size(); ++j) {
+      const auto& metrics = results[i][j];
+      if (!metrics.is_valid) {
+        LOG(FATAL) << "Unable to evaluate invalid graph '" << dsg_paths[i] << "'!";
+      }
+
+      std::cout << (j ? ",\n" : "\n") << "\"" << static_cast<int>(min_basis[j])
+                << "\": " << metrics;
+    }
+
+    std::cout << "\n}";
   }
 
+  std::cout << "\n}" << std::endl;
   return 0;
 }
@@ -37,14 +37,17 @@
 
 #include <filesystem>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "hydra/eval/room_evaluator.h"
 
 DEFINE_string(tsdf_file, "", "tsdf file to read");
 DEFINE_string(bbox_file, "", "bounding box config file");
-DEFINE_string(dsg_file, "", "dsg file to read");
+DEFINE_string(dsg_file, "", "dsg file to read (more files can be passed as arguments)");
 DEFINE_int32(min_room_nodes, 0, "minimum number of room nodes for evaluation");
 DEFINE_bool(only_labeled, true, "only compute metrics for labeled voxels");
+DEFINE_int32(num_threads, 1, "number of graphs to evaluate concurrently");
 
 using namespace spark_dsg;
 
@@ -69,12 +72,27 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  std::filesystem::path dsg_path(FLAGS_dsg_file);
-  if (!std::filesystem::exists(dsg_path)) {
+  std::vector<std::string> dsg_paths;
+  if (!FLAGS_dsg_file.empty()) {
+    dsg_paths.push_back(FLAGS_dsg_file);
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    dsg_paths.push_back(argv[i]);
+  }
+
+  if (dsg_paths.empty()) {
     LOG(ERROR) << "DSG file is required!";
     return 1;
   }
 
+  for (const auto& dsg_path : dsg_paths) {
+    if (!std::filesystem::exists(dsg_path)) {
+      LOG(ERROR) << "DSG file '" << dsg_path << "' does not exist!";
+      return 1;
+    }
+  }
+
   hydra::eval::RoomEvaluator::Config config;
   config.only_labeled = FLAGS_only_labeled;
   config.min_room_nodes = FLAGS_min_room_nodes;
@@ -84,12 +102,30 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  const auto metrics = evaluator->eval(dsg_path);
-  if (!metrics.valid()) {
-    LOG(ERROR) << "Unable to evaluate invalid graph!";
-    return 1;
+  const auto results = evaluator->eval(dsg_paths, FLAGS_num_threads);
+  if (dsg_paths.size() == 1) {
+    if (!results.front().valid()) {
+      LOG(ERROR) << "Unable to evaluate invalid graph!";
+      return 1;
+    }
+
+    std::cout << results.front() << std::endl;
+    return 0;
+  }
+
+  // multiple graphs are reported as a map from file to metrics
+  bool first = true;
+  std::cout << "{";
+  for (size_t i = 0; i < dsg_paths.size(); ++i) {
+    if (!results[i].valid()) {
+      LOG(ERROR) << "Unable to evaluate invalid graph '" << dsg_paths[i] << "'";
+      continue;
+    }
+
+    std::cout << (first ? "\n" : ",\n") << "\"" << dsg_paths[i] << "\": " << results[i];
+    first = false;
   }
 
-  std::cout << metrics << std::endl;
+  std::cout << "\n}" << std::endl;
   return 0;
 }
@@ -33,36 +33,61 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include <set>
 
 #include "hydra/backend/merge_proposer.h"
 #include "hydra/utils/nearest_neighbor_utilities.h"
 
 namespace hydra::association {
 
+/**
+ * @brief Considers every archived node in the layer as a merge candidate
+ */
 struct Pairwise : AssociationStrategy {
   struct Config {};
 
-  Pairwise(const Config, const SceneGraphLayer&) {}
+  Pairwise(const Config, const SceneGraphLayer& layer);
   virtual ~Pairwise() = default;
 
-  LayerView candidates(const SceneGraphLayer& layer,
-                       const SceneGraphNode& node) const override;
+  bool update(const SceneGraphLayer& layer,
+              const std::vector<NodeId>& changed) override;
+
+  NodeSubsetView candidates(const SceneGraphLayer& layer,
+                            const SceneGraphNode& node) const override;
+
+  //! Archived nodes in the layer
+  std::set<NodeId> archived;
 };
 
 void declare_config(Pairwise::Config& config);
 
+/**
+ * @brief Considers every archived node with the same semantic label as a merge
+ * candidate
+ */
 struct SemanticPairwise : AssociationStrategy {
   struct Config {};
 
-  SemanticPairwise(const Config, const SceneGraphLayer&) {}
+  SemanticPairwise(const Config, const SceneGraphLayer& layer);
   virtual ~SemanticPairwise() = default;
 
-  LayerView candidates(const SceneGraphLayer& layer,
-                       const SceneGraphNode& node) const override;
+  bool update(const SceneGraphLayer& layer,
+              const std::vector<NodeId>& changed) override;
+
+  NodeSubsetView candidates(const SceneGraphLayer& layer,
+                            const SceneGraphNode& node) const override;
+
+  //! Archived nodes in the layer by semantic label
+  std::map<SemanticNodeAttributes::Label, std::set<NodeId>> archived;
+  //! Semantic label of every archived node
+  std::unordered_map<NodeId, SemanticNodeAttributes::Label> labels;
 };
 
 void declare_config(SemanticPairwise::Config& config);
 
+/**
+ * @brief Considers the closest archived nodes as merge candidates
+ */
 struct NearestNode : AssociationStrategy {
   struct Config {
     //! Number of merge candidates to find for every node
@@ -73,14 +98,21 @@ struct NearestNode : AssociationStrategy {
 
   virtual ~NearestNode();
 
-  LayerView candidates(const SceneGraphLayer& layer,
-                       const SceneGraphNode& node) const override;
+  bool update(const SceneGraphLayer& layer,
+              const std::vector<NodeId>& changed) override;
+
+  NodeSubsetView candidates(const SceneGraphLayer& layer,
+                            const SceneGraphNode& node) const override;
 
-  NearestNodeFinder::Ptr node_finder;
+  DynamicNodeFinder node_finder;
 };
 
 void declare_config(NearestNode::Config& config);
 
+/**
+ * @brief Considers the closest archived nodes with the same semantic label as merge
+ * candidates
+ */
 struct SemanticNearestNode : AssociationStrategy {
   struct Config {
     //! Number of merge candidates to find for every node
@@ -91,10 +123,15 @@ struct SemanticNearestNode : AssociationStrategy {
 
   virtual ~SemanticNearestNode();
 
-  LayerView candidates(const SceneGraphLayer& layer,
-                       const SceneGraphNode& node) const override;
+  bool update(const SceneGraphLayer& layer,
+              const std::vector<NodeId>& changed) override;
+
+  NodeSubsetView candidates(const SceneGraphLayer& layer,
+                            const SceneGraphNode& node) const override;
 
-  SemanticNodeFinders node_finders;
+  std::map<SemanticNodeAttributes::Label, DynamicNodeFinder> node_finders;
+  //! Semantic label of every archived node
+  std::unordered_map<NodeId, SemanticNodeAttributes::Label> labels;
 };
 
 void declare_config(SemanticNearestNode::Config& config);
@@ -46,6 +46,7 @@
 #include "hydra/backend/backend_input.h"
 #include "hydra/backend/dsg_updater.h"
 #include "hydra/backend/external_loop_closure_receiver.h"
+#include "hydra/backend/mst_factors.h"
 #include "hydra/backend/pgmo_configs.h"
 #include "hydra/common/module.h"
 #include "hydra/common/output_sink.h"
@@ -162,9 +163,11 @@ class BackendModule : public kimera_pgmo::KimeraPgmoInterface, public Module {
 
   SharedDsgInfo::Ptr private_dsg_;
   DynamicSceneGraph::Ptr unmerged_graph_;
+  GraphChangeLog graph_changes_;
   SharedModuleState::Ptr state_;
 
   DsgUpdater::Ptr dsg_updater_;
+  PlaceMstFactors place_factors_;
 
   kimera_pgmo::Path trajectory_;
   std::vector<size_t> timestamps_;
@@ -67,7 +67,7 @@ class DeformationInterpolator {
   void interpolateNodePositions(const DynamicSceneGraph& unmerged,
                                 DynamicSceneGraph& dsg,
                                 const UpdateInfo::ConstPtr& info,
-                                const LayerView& view) const;
+                                const NodeSubsetView& view) const;
 
  private:
   mutable std::unordered_map<NodeId, Eigen::Vector3d> cached_pos_;
@@ -38,10 +38,15 @@
 #include <pose_graph_tools/pose_graph.h>
 #include <spark_dsg/dynamic_scene_graph.h>
 
-#include <list>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <optional>
+#include <queue>
+#include <vector>
 
 #include "hydra/common/message_queue.h"
+#include "hydra/utils/graph_change_log.h"
 
 namespace hydra {
 
@@ -68,16 +73,60 @@ class ExternalLoopClosureReceiver {
     double max_time_difference = 1.0;
   } const config;
 
-  ExternalLoopClosureReceiver(const Config& config, Queue* const queue);
+  /**
+   * @brief Construct the receiver
+   * @param config Receiver configuration
+   * @param queue Queue of external loop closures (disabled if not provided)
+   * @param changes Optional change log of the graph passed to update, used to skip
+   * re-indexing agent layers that didn't change
+   */
+  ExternalLoopClosureReceiver(const Config& config,
+                              Queue* const queue,
+                              const GraphChangeLog* changes = nullptr);
   void update(const spark_dsg::DynamicSceneGraph& graph, const Callback& callback);
   LookupResult findClosest(const spark_dsg::DynamicSceneGraph& graph,
                            uint64_t timestamp_ns,
                            int robot_id,
                            double max_diff_s = 0.0) const;
+  //! Number of loop closures waiting for the trajectory to catch up
+  size_t numPending() const;
 
  protected:
+  using Stamp = std::chrono::nanoseconds;
+
+  //! Agent nodes of a single robot sorted by timestamp
+  struct AgentIndex {
+    const spark_dsg::SceneGraphLayer* layer = nullptr;
+    //! Largest node ID indexed so far (agent node IDs increase as nodes are added)
+    spark_dsg::NodeId last_id = 0;
+    //! Change log sequence the index was last synced at
+    std::optional<uint64_t> sequence;
+    std::vector<std::pair<Stamp, spark_dsg::NodeId>> stamps;
+    void clear();
+  };
+
+  //! Loop closure waiting on a robot's trajectory to reach the required stamp
+  struct PendingClosure {
+    Stamp stamp;
+    size_t order;
+    pose_graph_tools::PoseGraphEdge edge;
+    bool operator>(const PendingClosure& other) const;
+  };
+
+  using PendingQueue = std::priority_queue<PendingClosure,
+                                           std::vector<PendingClosure>,
+                                           std::greater<PendingClosure>>;
+
+  const AgentIndex* getIndex(const spark_dsg::DynamicSceneGraph& graph,
+                             int robot_id) const;
+  void syncIndex(const spark_dsg::SceneGraphLayer& layer, AgentIndex& index) const;
+
   Queue* const input_queue_;
-  std::list<pose_graph_tools::PoseGraphEdge> loop_closures_;
+  const GraphChangeLog* const changes_;
+  size_t num_received_ = 0;
+  //! Pending loop closures per robot, keyed by the stamp that robot has to reach
+  std::map<int, PendingQueue> pending_;
+  mutable std::map<int, AgentIndex> agent_indices_;
 };
 
 void declare_config(ExternalLoopClosureReceiver::Config& config);
@@ -0,0 +1,153 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "hydra/common/dsg_types.h"
+
+namespace hydra {
+
+//! Compression applied to the payload of an encoded graph delta
+enum class DeltaCompression : uint8_t { NONE = 0, LZ4 = 1, ZSTD = 2 };
+
+//! Whether the requested compression was compiled into this build
+bool compressionAvailable(DeltaCompression compression);
+
+/**
+ * @brief Incremental update to a scene graph.
+ *
+ * Keyframes contain the entire graph and reset the receiver. Deltas contain every node
+ * and edge that was added or changed since the previous message (stored as a small
+ * scene graph) as well as the nodes and edges that were removed. Deltas only carry
+ * the part of the mesh that changed (see MeshUpdate).
+ */
+struct GraphDelta {
+  using EdgeKey = std::pair<NodeId, NodeId>;
+
+  //! Describes how the mesh stored in a delta graph patches the receiver's mesh
+  struct MeshUpdate {
+    //! Size of the mesh after applying the update
+    uint64_t num_vertices = 0;
+    uint64_t num_faces = 0;
+    //! Index of the first vertex and face stored in the delta mesh
+    uint64_t vertex_offset = 0;
+    uint64_t face_offset = 0;
+  };
+
+  uint64_t sequence = 0;
+  uint64_t timestamp_ns = 0;
+  bool keyframe = false;
+  //! Added or changed nodes and edges (or the whole graph for a keyframe)
+  DynamicSceneGraph::Ptr graph;
+  std::vector<NodeId> removed_nodes;
+  std::vector<EdgeKey> removed_edges;
+  //! Mesh changes for deltas (unset if the mesh did not change)
+  std::optional<MeshUpdate> mesh_update;
+
+  /**
+   * @brief Serialize the delta to a byte buffer
+   * @param include_mesh Serialize the mesh of the delta graph
+   * @param compression Requested compression (falls back to NONE if unavailable)
+   */
+  std::vector<uint8_t> encode(
+      bool include_mesh, DeltaCompression compression = DeltaCompression::NONE) const;
+
+  //! Parse a buffer produced by encode. Returns std::nullopt for malformed buffers
+  static std::optional<GraphDelta> decode(const uint8_t* buffer, size_t length);
+};
+
+/**
+ * @brief Computes deltas between successive versions of a scene graph.
+ *
+ * Keeps a copy of the attributes of every node and edge (and of the mesh) that was
+ * last sent and compares against them to find changes.
+ */
+class GraphDeltaTracker {
+ public:
+  //! @param keyframe_interval Number of deltas between keyframes (0 only sends first)
+  explicit GraphDeltaTracker(size_t keyframe_interval = 0);
+
+  //! Compute the delta from the last call and record the current graph state
+  GraphDelta update(uint64_t timestamp_ns, const DynamicSceneGraph& graph);
+
+  //! Force the next update to be a keyframe
+  void reset();
+
+  uint64_t sequence() const { return next_sequence_; }
+
+ private:
+  struct NodeState {
+    LayerKey layer;
+    NodeAttributes::Ptr attrs;
+  };
+
+  const size_t keyframe_interval_;
+  uint64_t next_sequence_ = 0;
+  size_t since_keyframe_ = 0;
+  bool force_keyframe_ = true;
+  std::unordered_map<NodeId, NodeState> nodes_;
+  std::map<GraphDelta::EdgeKey, EdgeAttributes::Ptr> edges_;
+  Mesh::Ptr mesh_;
+};
+
+/**
+ * @brief Reconstructs a scene graph from a stream of keyframes and deltas.
+ *
+ * Deltas that do not directly follow the last applied message are dropped until the
+ * next keyframe arrives.
+ */
+class GraphDeltaApplier {
+ public:
+  //! Apply the delta. Returns false if the delta was dropped
+  bool apply(const GraphDelta& delta);
+
+  //! Reconstructed graph (null until the first keyframe is applied)
+  DynamicSceneGraph::Ptr graph() const { return graph_; }
+
+  //! Sequence number of the last applied message
+  std::optional<uint64_t> sequence() const { return last_sequence_; }
+
+ private:
+  DynamicSceneGraph::Ptr graph_;
+  std::optional<uint64_t> last_sequence_;
+};
+
+}  // namespace hydra
@@ -35,9 +35,14 @@
 #pragma once
 
 #include <config_utilities/virtual_config.h>
-#include <spark_dsg/layer_view.h>
+
+#include <map>
+#include <optional>
 
 #include "hydra/common/dsg_types.h"
+#include "hydra/common/global_info.h"
+#include "hydra/utils/graph_change_log.h"
+#include "hydra/utils/node_subset_view.h"
 
 namespace hydra {
 
@@ -57,8 +62,20 @@ using MergeList = std::list<Merge>;
 
 struct AssociationStrategy {
   virtual ~AssociationStrategy() = default;
-  virtual spark_dsg::LayerView candidates(const SceneGraphLayer& layer,
-                                          const SceneGraphNode& node) const = 0;
+
+  /**
+   * @brief Update any state the strategy keeps for the layer
+   * @param layer Layer the strategy was constructed with
+   * @param changed Nodes that were added, archived, moved or removed since the last
+   * update (or construction)
+   * @returns False if the strategy has to be reconstructed instead
+   */
+  virtual bool update(const SceneGraphLayer& layer,
+                      const std::vector<NodeId>& changed);
+
+  //! Get potential merge targets for a node (must be safe to call concurrently)
+  virtual NodeSubsetView candidates(const SceneGraphLayer& layer,
+                                    const SceneGraphNode& node) const = 0;
 };
 
 struct MergeProposer {
@@ -66,14 +83,48 @@ struct MergeProposer {
 
   struct Config {
     config::VirtualConfig<AssociationStrategy> strategy;
+    //! Number of threads to use when looking up merge candidates
+    int num_threads = GlobalInfo::instance().getConfig().default_num_threads;
   } const config;
 
   explicit MergeProposer(const Config& config) : config(config) {}
 
+  /**
+   * @brief Propose merges between the nodes in the view and their candidates
+   *
+   * Each pair of nodes is only checked once (i.e., if both nodes of a pair are in the
+   * view, only the first of the two symmetric proposals is checked and kept), so
+   * should_merge is expected to be symmetric.
+   * @param layer Layer to find merges in
+   * @param view Nodes to find merges for
+   * @param should_merge Check for whether a pair of nodes should be merged
+   * @param nodes_to_merge Accepted merges
+   * @param changes Change log for the graph. Allows the associator for the layer to
+   * be kept between calls instead of being reconstructed
+   * @param moved Whether node positions changed since the last call (e.g., after a
+   * loop closure), which always reconstructs the associator
+   */
   void findMerges(const SceneGraphLayer& layer,
-                  const spark_dsg::LayerView& view,
+                  const NodeSubsetView& view,
                   const MergeCheck& should_merge,
-                  MergeList& nodes_to_merge) const;
+                  MergeList& nodes_to_merge,
+                  const GraphChangeLog* changes = nullptr,
+                  bool moved = false) const;
+
+ private:
+  struct LayerAssociator {
+    std::unique_ptr<AssociationStrategy> associator;
+    //! Last change log sequence the associator was updated with
+    std::optional<uint64_t> sequence;
+    //! Nodes involved in merges proposed since the last update
+    std::vector<NodeId> merged;
+  };
+
+  AssociationStrategy* getAssociator(const SceneGraphLayer& layer,
+                                     const GraphChangeLog* changes,
+                                     bool moved) const;
+
+  mutable std::map<const SceneGraphLayer*, LayerAssociator> associators_;
 };
 
 void declare_config(MergeProposer::Config& config);
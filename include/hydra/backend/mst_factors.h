@@ -35,16 +35,74 @@
 
 #pragma once
 #include <kimera_pgmo/deformation_graph.h>
+#include <pose_graph_tools/pose_graph.h>
+
+#include <map>
+#include <optional>
+#include <set>
 
 #include "hydra/common/dsg_types.h"
+#include "hydra/utils/graph_change_log.h"
+#include "hydra/utils/minimum_spanning_tree.h"
 
 namespace hydra {
 
-void addPlacesToDeformationGraph(const DynamicSceneGraph& graph,
-                                 size_t timestamp_ns,
-                                 kimera_pgmo::DeformationGraph& deformation_graph,
-                                 double mst_edge_variance,
-                                 double mesh_edge_variance,
-                                 const std::function<char(NodeId)>& prefix_lookup);
+/**
+ * @brief Place factors for the deformation graph from a minimum spanning tree of the
+ * places layer.
+ *
+ * Every place with siblings gets a valence factor (with connections to the mesh for
+ * leaves of the tree) and every tree edge gets a between factor. The tree and the
+ * factors are cached and only the places that were added, removed or changed since the
+ * last update (plus the active window) are revisited.
+ */
+class PlaceMstFactors {
+ public:
+  using FactorMap = std::map<NodeId, kimera_pgmo::NodeValenceInfo>;
+  using BetweenMap =
+      std::map<DynamicMinimumSpanningTree::EdgeKey, pose_graph_tools::PoseGraphEdge>;
+
+  /**
+   * @brief Update the tree and factors and submit them to the deformation graph
+   *
+   * @param changes Optional change log of the graph used to find changed places
+   * @param full_update Revisit every place (e.g., after archived places moved)
+   */
+  void update(const DynamicSceneGraph& graph,
+              size_t timestamp_ns,
+              kimera_pgmo::DeformationGraph& deformation_graph,
+              double mst_edge_variance,
+              double mesh_edge_variance,
+              const std::function<char(NodeId)>& prefix_lookup,
+              const GraphChangeLog* changes = nullptr,
+              bool full_update = false);
+
+  const DynamicMinimumSpanningTree& mst() const { return mst_; }
+  const FactorMap& factors() const { return factors_; }
+  const BetweenMap& betweenFactors() const { return between_; }
+  size_t numFactors() const { return factors_.size(); }
+  size_t numBetweenFactors() const { return between_.size(); }
+
+ private:
+  std::vector<NodeId> getCandidates(const SceneGraphLayer& places,
+                                    const GraphChangeLog* changes,
+                                    bool scan) const;
+
+  //! Returns true if a previous factor was removed or changed
+  bool updateFactor(const SceneGraphLayer& places,
+                    NodeId node_id,
+                    const std::function<char(NodeId)>& prefix_lookup,
+                    kimera_pgmo::NodeValenceInfoList& new_factors,
+                    std::vector<NodeId>& moved);
+
+  DynamicMinimumSpanningTree mst_;
+  FactorMap factors_;
+  BetweenMap between_;
+  //! Places that were active (or just archived) at the last update
+  std::set<NodeId> active_;
+  std::set<NodeId> archived_;
+  //! Change log sequence of the last update
+  std::optional<uint64_t> last_sequence_;
+};
 
 }  // namespace hydra
@@ -58,6 +58,11 @@ void getNecessaryUpdates(
     std::vector<std::pair<NodeId, Place2d>>& nodes_to_update,
     std::vector<std::pair<NodeId, std::vector<Place2d>>>& nodes_to_add);
 
+/**
+ * @brief Compute weights of edges between all pairs of new (split) places
+ * @returns Weights keyed by (og_ix, split_ix, og_jx, split_jx) with og_jx <= og_ix for
+ * all pairs that should be connected
+ */
 std::map<std::tuple<size_t, size_t, size_t, size_t>, double> buildEdgeMap(
     const std::vector<std::pair<NodeId, std::vector<Place2d>>>& nodes_to_add,
     double place_overlap_threshold,
@@ -75,9 +80,9 @@ NodeSymbol insertNewNodes(
     std::map<std::tuple<size_t, size_t>, NodeId>& new_id_map);
 
 void addNewNodeEdges(
-    const std::vector<std::pair<NodeId, std::vector<Place2d>>> nodes_to_add,
-    const std::map<std::tuple<size_t, size_t, size_t, size_t>, double> edge_map,
-    const std::map<std::tuple<size_t, size_t>, NodeId> new_id_map,
+    const std::vector<std::pair<NodeId, std::vector<Place2d>>>& nodes_to_add,
+    const std::map<std::tuple<size_t, size_t, size_t, size_t>, double>& edge_map,
+    const std::map<std::tuple<size_t, size_t>, NodeId>& new_id_map,
     DynamicSceneGraph& graph);
 
 void reallocateMeshPoints(const std::vector<Place2d::PointT>& points,
@@ -39,6 +39,7 @@
 #include "hydra/backend/merge_proposer.h"
 #include "hydra/common/dsg_types.h"  // IWYU pragma: keep
 #include "hydra/common/shared_dsg_info.h"
+#include "hydra/utils/graph_change_log.h"
 
 namespace kimera_pgmo {
 class DeformationGraph;
@@ -63,6 +64,8 @@ struct UpdateInfo {
   const std::unordered_map<NodeId, size_t>* node_to_robot_id = nullptr;
   //! Archival information for mesh
   kimera_pgmo::MeshOffsetInfo mesh_offsets = {};
+  //! Changes to the unmerged graph (nodes added, archived or removed)
+  const GraphChangeLog* changes = nullptr;
 };
 
 using LayerCleanupFunc =
@@ -38,7 +38,9 @@
 #include "hydra/backend/association_strategies.h"
 #include "hydra/backend/merge_tracker.h"
 #include "hydra/backend/update_functions.h"
+#include "hydra/common/global_info.h"
 #include "hydra/utils/active_window_tracker.h"
+#include "hydra/utils/mesh_utilities.h"
 
 namespace hydra {
 
@@ -49,6 +51,8 @@ struct UpdateObjectsFunctor : public UpdateFunctor {
     //! Association strategy for finding matches to active nodes
     MergeProposer::Config merge_proposer = {config::VirtualConfig<AssociationStrategy>{
         association::SemanticNearestNode::Config{}}};
+    //! Number of threads to use when refitting object geometry
+    int num_threads = GlobalInfo::instance().getConfig().default_num_threads;
   } const config;
 
   explicit UpdateObjectsFunctor(const Config& config);
@@ -59,12 +63,24 @@ struct UpdateObjectsFunctor : public UpdateFunctor {
   MergeList findMerges(const DynamicSceneGraph& graph,
                        const UpdateInfo::ConstPtr& info) const;
 
-  void mergeAttributes(const DynamicSceneGraph& layer, NodeId from, NodeId to) const;
+  NodeAttributes::Ptr mergeAttributes(const DynamicSceneGraph& graph,
+                                      const std::vector<NodeId>& nodes) const;
 
   mutable ActiveWindowTracker active_tracker;
   const MergeProposer merge_proposer;
 
  private:
+  void pruneGeometryCaches(const DynamicSceneGraph& unmerged,
+                           const DynamicSceneGraph& merged,
+                           const GraphChangeLog* changes) const;
+
+  //! Last change log sequence used to prune the geometry caches
+  mutable uint64_t cache_sequence_ = 0;
+  //! Cached vertex positions and running statistics per object
+  mutable std::unordered_map<NodeId, ObjectGeometry> geometry_cache_;
+  //! Cached geometry of the union of all objects merged into a node
+  mutable std::unordered_map<NodeId, ObjectGeometry> merged_geometry_cache_;
+
   inline static const auto registration_ =
       config::RegistrationWithConfig<UpdateFunctor, UpdateObjectsFunctor, Config>(
           "UpdateObjectsFunctor");
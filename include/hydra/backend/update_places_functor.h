@@ -64,7 +64,7 @@ struct UpdatePlacesFunctor : public UpdateFunctor {
             SharedDsgInfo& dsg,
             const UpdateInfo::ConstPtr& info) const override;
 
-  size_t updateFromValues(const LayerView& view,
+  size_t updateFromValues(const NodeSubsetView& view,
                           SharedDsgInfo& dsg,
                           const UpdateInfo::ConstPtr& info) const;
 
@@ -0,0 +1,84 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <string>
+
+#include "hydra/backend/graph_delta.h"
+
+namespace hydra {
+
+/**
+ * @brief Publishes keyframes and deltas of a scene graph over zmq.
+ *
+ * Only built when libzmq is found. The tracker keeps a full copy of the last sent
+ * graph and mesh to compute deltas against.
+ */
+class ZmqGraphDeltaSender {
+ public:
+  ZmqGraphDeltaSender(const std::string& url,
+                      size_t keyframe_interval,
+                      DeltaCompression compression);
+  ~ZmqGraphDeltaSender();
+
+  //! Send the changes since the last call (or a keyframe)
+  void send(uint64_t timestamp_ns, const DynamicSceneGraph& graph, bool include_mesh);
+
+ private:
+  const DeltaCompression compression_;
+  void* socket_ = nullptr;
+  GraphDeltaTracker tracker_;
+};
+
+/**
+ * @brief Receives graph deltas sent by a ZmqSink with send_deltas enabled and
+ * reconstructs the scene graph
+ */
+class ZmqGraphDeltaReceiver {
+ public:
+  explicit ZmqGraphDeltaReceiver(const std::string& url);
+  ~ZmqGraphDeltaReceiver();
+
+  //! Wait for and apply the next message. Returns true if the graph was updated
+  bool recv(size_t timeout_ms);
+
+  //! Latest reconstructed graph (null until a keyframe is received)
+  DynamicSceneGraph::Ptr graph() const { return applier_.graph(); }
+
+ private:
+  void* socket_ = nullptr;
+  GraphDeltaApplier applier_;
+};
+
+}  // namespace hydra
@@ -39,6 +39,7 @@
 #include <thread>
 
 #include "hydra/backend/backend_module.h"
+#include "hydra/backend/graph_delta.h"
 
 namespace spark_dsg {
 class ZmqReceiver;
@@ -47,12 +48,22 @@ class ZmqSender;
 
 namespace hydra {
 
+class ZmqGraphDeltaSender;
+
 class ZmqSink : public BackendModule::Sink {
  public:
   struct Config {
     std::string url = "tcp://127.0.0.1:8001";
     bool send_mesh = true;
     size_t num_threads = 2;
+    //! Send keyframes and incremental deltas instead of the full graph every update.
+    //! Requires Hydra to be built with libzmq and keeps a copy of the last sent graph
+    //! and mesh, which roughly doubles the memory used for the backend graph
+    bool send_deltas = false;
+    //! Number of deltas between keyframes (0 only sends the first keyframe)
+    size_t keyframe_interval = 50;
+    //! Compression for delta messages (falls back to none if not compiled in)
+    DeltaCompression compression = DeltaCompression::NONE;
   } const config;
 
   explicit ZmqSink(const Config& config);
@@ -64,6 +75,8 @@ class ZmqSink : public BackendModule::Sink {
 
  private:
   std::unique_ptr<spark_dsg::ZmqSender> sender_;
+  //! Only allocated when sending deltas
+  std::shared_ptr<ZmqGraphDeltaSender> delta_sender_;
 };
 
 void declare_config(ZmqSink::Config& config);
@@ -35,6 +35,7 @@
 #pragma once
 #include <config_utilities/virtual_config.h>
 
+#include "hydra/common/batch_tiling.h"
 #include "hydra/common/global_info.h"
 #include "hydra/frontend/graph_builder.h"
 #include "hydra/reconstruction/volumetric_map.h"
@@ -48,10 +49,26 @@ class BatchPipeline {
 
   virtual ~BatchPipeline();
 
+  /**
+   * @brief Build a scene graph from a reconstructed map.
+   * @param graph_config Frontend to use to extract the scene graph
+   * @param map Map to build the scene graph from (mesh will be regenerated)
+   * @param room_config Optional room detection settings
+   * @param tiling Optional tiling settings. If enabled, the frontend is run on
+   * overlapping tiles of the map in parallel and the results are stitched together
+   * (not supported when loop closure detection is enabled)
+   */
   DynamicSceneGraph::Ptr construct(
       const config::VirtualConfig<GraphBuilder>& graph_config,
       VolumetricMap& map,
-      const RoomFinderConfig* room_config = nullptr) const;
+      const RoomFinderConfig* room_config = nullptr,
+      const BatchTilingConfig* tiling = nullptr) const;
+
+ protected:
+  bool constructTiled(const config::VirtualConfig<GraphBuilder>& graph_config,
+                      const VolumetricMap& map,
+                      const BatchTilingConfig& tiling,
+                      DynamicSceneGraph& graph) const;
 };
 
 }  // namespace hydra
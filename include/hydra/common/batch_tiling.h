@@ -0,0 +1,113 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <vector>
+
+#include "hydra/common/global_info.h"
+#include "hydra/reconstruction/volumetric_map.h"
+
+namespace hydra {
+
+struct BatchTilingConfig {
+  //! Side length of the square x-y tiles the map is split into (disabled if <= 0)
+  double tile_size_m = 0.0;
+  //! Margin of map around each tile that is also given to the tile's frontend
+  double overlap_m = 2.0;
+  //! Maximum distance between two copies of the same node from neighboring tiles
+  double stitch_distance_m = 0.2;
+  //! Resolution for matching mesh vertices shared by neighboring tiles
+  double vertex_tolerance_m = 1.0e-3;
+  //! Number of tiles to run the frontend on concurrently
+  int num_threads = GlobalInfo::instance().getConfig().default_num_threads;
+};
+
+void declare_config(BatchTilingConfig& config);
+
+struct MapTile {
+  //! Tile coordinates in the x-y plane (z is always 0)
+  BlockIndex index;
+  //! Blocks of the map owned by the tile
+  BlockIndices core;
+  //! Owned blocks and the blocks of neighboring tiles inside the overlap margin
+  BlockIndices blocks;
+};
+
+/**
+ * @brief Splits a map into overlapping x-y tiles and merges the scene graphs built for
+ * each tile back together.
+ *
+ * Every block (and therefore every point) of the map is owned by exactly one tile.
+ * When stitching, a tile contributes the nodes and mesh faces that lie inside its own
+ * region, while nodes from the overlap margin are matched to the copy kept by the
+ * owning tile so that edges crossing tile seams are preserved. Tiles are processed in
+ * order and node IDs are reassigned in that order, so the result does not depend on
+ * how the tile graphs were computed.
+ */
+class MapTiler {
+ public:
+  MapTiler(const BatchTilingConfig& config, float block_size);
+
+  /**
+   * @brief Partition the allocated blocks of a map into tiles.
+   * @param map Map to partition
+   * @returns Non-empty tiles sorted by tile index
+   */
+  std::vector<MapTile> partition(const VolumetricMap& map) const;
+
+  /**
+   * @brief Get the index of the tile that owns a point.
+   */
+  BlockIndex tileIndex(const Eigen::Vector3d& point) const;
+
+  /**
+   * @brief Merge the graphs built for each tile into a single graph.
+   * @param tiles Tiles produced by partition
+   * @param graphs Graph for each tile (null graphs are skipped)
+   * @param output Graph to add the stitched nodes, edges and mesh to. Mesh stitching
+   * only happens if the output graph has a mesh.
+   */
+  void stitch(const std::vector<MapTile>& tiles,
+              const std::vector<DynamicSceneGraph::Ptr>& graphs,
+              DynamicSceneGraph& output) const;
+
+  const BatchTilingConfig config;
+
+ private:
+  const float block_size_;
+  const int tile_blocks_;
+  const int overlap_blocks_;
+};
+
+}  // namespace hydra
@@ -89,6 +89,8 @@ struct PipelineConfig {
   bool timing_disabled = false;
   //! If true, don't show latest elapsed for timers
   bool disable_timer_output = true;
+  //! If true, keep every timer measurement (memory grows with runtime) for raw logs
+  bool keep_raw_timer_measurements = false;
   //! If true, forward pgmo custom logging to glog
   bool enable_pgmo_logging = true;
   //! If true, store additional details for the khronos spatio-temporal viualizer.
@@ -7,6 +7,7 @@
 #include "hydra/active_window/active_window_output.h"
 #include "hydra/active_window/volumetric_window.h"
 #include "hydra/common/dsg_types.h"
+#include "hydra/common/global_info.h"
 #include "hydra/utils/nearest_neighbor_utilities.h"
 
 namespace hydra {
@@ -56,6 +57,8 @@ class FrontierExtractor {
     double minimum_relative_z = -0.2;
     double maximum_relative_z = 1;
     bool compute_frontier_shape = false;
+    //! Number of threads used to search blocks for frontier voxels
+    int num_threads = GlobalInfo::instance().getConfig().default_num_threads;
   } const config;
 
   explicit FrontierExtractor(const Config& config);
@@ -75,6 +78,8 @@ class FrontierExtractor {
   std::vector<std::pair<NodeId, BlockIndex>> nodes_to_remove_;
 
   TsdfLayer::Ptr tsdf_;
+  //! Unobserved voxels of every block in tsdf_, refreshed when a block is updated
+  BlockIndexMap<std::vector<size_t>> unobserved_voxels_;
   std::vector<NodeId> archived_places_;
   spatial_hash::IndexSet just_archived_blocks_;
   spatial_hash::IndexSet recently_archived_blocks_;
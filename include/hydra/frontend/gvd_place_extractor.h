@@ -95,12 +95,16 @@ class GvdPlaceExtractor : public FreespacePlacesInterface {
 
   void filterGround(DynamicSceneGraph& graph);
 
+  //! Persistent downsampled TSDF (only available with the downsample interpolator)
+  const TsdfPyramid* tsdfPyramid() const { return tsdf_pyramid_.get(); }
+
  protected:
   mutable std::mutex gvd_mutex_;
   places::GvdLayer::Ptr gvd_;
   places::GraphExtractor graph_extractor_;
   std::unique_ptr<places::GvdIntegrator> gvd_integrator_;
   std::unique_ptr<TsdfInterpolator> tsdf_interpolator_;
+  std::unique_ptr<TsdfPyramid> tsdf_pyramid_;
   std::unique_ptr<VolumetricWindow> map_window_;
   NodeIdSet active_nodes_;
   Eigen::Vector3d latest_pos_;
@@ -1,4 +1,7 @@
 #pragma once
+#include <spatial_hash/hash.h>
+
+#include <Eigen/Dense>
 #include <cstdint>
 #include <map>
 #include <set>
@@ -35,4 +38,66 @@ Clusters findClusters(const ClusteringConfig& config,
                       const kimera_pgmo::MeshDelta& delta,
                       const std::vector<size_t>& indices);
 
+/**
+ * @brief Euclidean clustering that persists between updates
+ *
+ * Points are identified between updates by their quantized position (meshing
+ * produces the same vertex positions for unchanged surfaces even though vertex
+ * indices change). Points are stored in a voxel hash with cells the size of the
+ * cluster tolerance and connected with a union-find. Each update only links new
+ * points and points whose cluster lost a point, so the cost of neighbor search
+ * scales with the number of changed points instead of the total number of points.
+ * Clusters are the same as Euclidean cluster extraction: connected components of
+ * points within the cluster tolerance, filtered by min and max cluster size.
+ */
+class IncrementalClusters {
+ public:
+  explicit IncrementalClusters(const ClusteringConfig& config);
+
+  /**
+   * @brief Update the tracked points and get the current clusters
+   * @param points All current points
+   * @returns Clusters as (sorted) indices into points, largest clusters first
+   */
+  Clusters update(const std::vector<Eigen::Vector3f>& points);
+
+  /**
+   * @brief Update the tracked points from a subset of mesh vertices
+   * @returns Clusters as (sorted) mesh vertex indices, largest clusters first
+   */
+  Clusters update(const kimera_pgmo::MeshDelta& delta,
+                  const std::vector<size_t>& indices);
+
+  void reset();
+
+  //! Number of unique points currently tracked
+  size_t size() const { return key_to_node_.size(); }
+
+  //! Number of points linked against neighbors during the last update
+  size_t numLinked() const { return num_linked_; }
+
+ private:
+  struct Node {
+    Eigen::Vector3f pos;
+    spatial_hash::LongIndex key;
+    spatial_hash::LongIndex cell;
+    size_t parent;
+    std::vector<size_t> members;
+  };
+
+  size_t addNode(const Eigen::Vector3f& pos, const spatial_hash::LongIndex& key);
+  void removeNode(size_t node);
+  size_t findRoot(size_t node);
+  void link(size_t lhs, size_t rhs);
+  void linkNeighbors(size_t node);
+
+  const ClusteringConfig config_;
+  const double cell_scale_;
+  size_t num_linked_;
+  std::vector<Node> nodes_;
+  std::vector<size_t> free_nodes_;
+  spatial_hash::LongIndexHashMap<size_t> key_to_node_;
+  spatial_hash::LongIndexHashMap<std::vector<size_t>> cells_;
+};
+
 }  // namespace hydra::clustering
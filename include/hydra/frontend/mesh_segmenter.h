@@ -64,6 +64,8 @@ class MeshSegmenter {
     std::string layer_id = DsgLayers::OBJECTS;
     clustering::ClusteringConfig clustering;
     BoundingBox::Type bounding_box_type = BoundingBox::Type::AABB;
+    //! Cell size of the spatial hash used to find overlapping objects when merging
+    double merge_cell_size_m = 1.0;
     std::string timer_namespace = "frontend/objects";
     std::vector<Sink::Factory> sinks;
   } const config;
@@ -100,6 +102,7 @@ class MeshSegmenter {
  private:
   NodeSymbol next_node_id_;
   std::set<uint32_t> labels_;
+  std::map<uint32_t, clustering::IncrementalClusters> label_clusters_;
   std::map<uint32_t, std::set<NodeId>> active_nodes_;
   Sink::List sinks_;
 };
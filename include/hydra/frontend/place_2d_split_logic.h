@@ -3,6 +3,7 @@
 #include <pcl/point_types.h>
 #include <spark_dsg/edge_attributes.h>
 
+#include "hydra/utils/place_2d_grid_index.h"
 #include "spark_dsg/node_attributes.h"
 
 namespace kimera_pgmo {
@@ -72,6 +73,12 @@ bool shouldAddPlaceConnection(const Place2d& p1,
                               const double place_max_neighbor_z_diff,
                               double& weight);
 
+//! Bounds of the ellipse that shouldAddPlaceConnection tests for node attributes
+PlaceBounds2d getConnectionBounds(const Place2dNodeAttributes& attrs);
+
+//! Bounds of the ellipse that shouldAddPlaceConnection tests for split places
+PlaceBounds2d getConnectionBounds(const Place2d& place);
+
 void remapPlace2dMesh(Place2dNodeAttributes& attrs,
                       const kimera_pgmo::MeshOffsetInfo& offsets);
 
@@ -34,7 +34,15 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 
+#include <spark_dsg/node_attributes.h>
 #include <spark_dsg/scene_graph_layer.h>
+#include <spatial_hash/hash.h>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "hydra/common/global_info.h"
 
 namespace kimera_pgmo {
 class MeshDelta;
@@ -42,13 +50,79 @@ class MeshDelta;
 
 namespace hydra {
 
+/**
+ * @brief Assigns vertices of the latest mesh delta to the voxel connections of places
+ *
+ * Mesh vertices are bucketed into a voxel hash. Places whose voxel connections and
+ * surrounding mesh are unchanged since the last update reuse their previous matches
+ * instead of searching the hash again.
+ */
 class PlaceMeshConnector {
  public:
   using DeformationMapping = std::vector<size_t>;
 
-  static size_t addConnections(const kimera_pgmo::MeshDelta& delta,
-                               const spark_dsg::SceneGraphLayer& places,
-                               const DeformationMapping& mapping);
+  struct Config {
+    //! Side length of the hash cells used to bucket mesh vertices
+    double cell_size = 0.1;
+    //! Number of cells per side of the blocks used to detect mesh changes
+    int block_ratio = 8;
+    //! Number of cell rings searched around a voxel connection before falling back to
+    //! checking every cell of the hash
+    int max_search_rings = 2;
+    //! Number of threads used to search connections of changed places
+    int num_threads = GlobalInfo::instance().getConfig().default_num_threads;
+  } const config;
+
+  explicit PlaceMeshConnector(const Config& config);
+
+  size_t addConnections(const kimera_pgmo::MeshDelta& delta,
+                        const spark_dsg::SceneGraphLayer& places,
+                        const DeformationMapping& mapping);
+
+  //! Number of places that were searched (instead of reused) during the last update
+  size_t numSearched() const { return num_searched_; }
+
+ protected:
+  struct VertexMatch {
+    spatial_hash::Index cell;
+    //! Position of the vertex in the cell (stable while the cell is unchanged)
+    size_t slot;
+  };
+
+  struct ConnectionCache {
+    Eigen::Vector3d position;
+    //! Number of cell rings around the connection the match depends on (unset if the
+    //! whole mesh had to be searched)
+    std::optional<int> rings;
+    std::optional<VertexMatch> match;
+  };
+
+  using PlaceCache = std::vector<ConnectionCache>;
+
+  void updateCells(const kimera_pgmo::MeshDelta& delta);
+
+  bool isUnchanged(const spark_dsg::PlaceNodeAttributes& attrs,
+                   const PlaceCache& cache) const;
+
+  bool hasValidMatches(const PlaceCache& cache) const;
+
+  void searchConnections(const kimera_pgmo::MeshDelta& delta,
+                         const spark_dsg::PlaceNodeAttributes& attrs,
+                         PlaceCache& cache) const;
+
+  spatial_hash::Index toCell(const Eigen::Vector3d& position) const;
+
+  spatial_hash::Index toBlock(const spatial_hash::Index& cell) const;
+
+  //! Delta vertex indices per hash cell
+  spatial_hash::IndexHashMap<std::vector<size_t>> cells_;
+  //! Hash of the vertices contained in each block
+  spatial_hash::IndexHashMap<size_t> block_signatures_;
+  spatial_hash::IndexSet changed_blocks_;
+  std::unordered_map<spark_dsg::NodeId, PlaceCache> cache_;
+  size_t num_searched_ = 0;
 };
 
+void declare_config(PlaceMeshConnector::Config& config);
+
 }  // namespace hydra
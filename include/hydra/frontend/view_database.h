@@ -1,4 +1,6 @@
 #pragma once
+#include <spatial_hash/hash.h>
+
 #include "hydra/common/dsg_types.h"
 #include "hydra/frontend/view_selector.h"
 #include "hydra/utils/active_window_tracker.h"
@@ -19,6 +21,10 @@ class ViewDatabase {
     double inflation_distance = 0.0;
     //! @brief Layers to assign views for
     std::vector<std::string> layers{DsgLayers::PLACES, DsgLayers::MESH_PLACES};
+    //! @brief Cell size of the spatial hash used to look up candidate views
+    double index_cell_size = 2.0;
+    //! @brief Views whose range bounds span more cells are checked for every query
+    size_t max_cells_per_view = 4096;
     //! @brief Verbosity for database
     int verbosity = 0;
   } const config;
@@ -30,8 +36,32 @@ class ViewDatabase {
   void updateAssignments(const DynamicSceneGraph& graph,
                          const ArchivalCheck& should_archive) const;
 
+  /**
+   * @brief Get all views whose frustum bounds overlap the point (in insertion order)
+   */
+  ViewSelector::ViewList getCandidates(const Eigen::Vector3d& pos) const;
+
  protected:
+  struct IndexEntry {
+    size_t id;
+    const FeatureView* view;
+  };
+
+  using IndexEntries = std::vector<IndexEntry>;
+
+  void addView(FeatureView::Ptr&& view) const;
+  void removeView(const FeatureView& view) const;
+  /**
+   * @brief Get the index cells that may contain points visible from the view
+   * @returns False if the view is unbounded or spans more than max_cells_per_view
+   */
+  bool getViewCells(const FeatureView& view,
+                    std::vector<spatial_hash::LongIndex>& cells) const;
+
+  mutable size_t next_view_id_;
   mutable ViewSelector::FeatureList views_;
+  mutable spatial_hash::LongIndexHashMap<IndexEntries> view_index_;
+  mutable IndexEntries unbounded_views_;
   std::unique_ptr<ViewSelector> view_selector_;
   mutable std::map<std::string, ActiveWindowTracker> trackers_;
 };
@@ -23,14 +23,25 @@ struct FeatureView {
                    float inflation_distance,
                    Eigen::Vector3d* point_s = nullptr) const;
 
+  //! Position of the sensor in the world frame
+  const Eigen::Vector3d& position() const { return world_t_sensor_; }
+  //! Radius around the sensor that bounds the view frustum (may be infinite)
+  double range() const;
+
  private:
   const Sensor* const sensor_;
+  const Eigen::Vector3d world_t_sensor_;
 };
 
 struct ViewSelector {
   using FeatureList = std::list<FeatureView::Ptr>;
+  //! Candidate views in the order they were received
+  using ViewList = std::vector<const FeatureView*>;
   virtual ~ViewSelector() = default;
-  virtual void selectFeature(const FeatureList& views,
+  void selectFeature(const FeatureList& views,
+                     float inflation_distance,
+                     spark_dsg::SemanticNodeAttributes& attrs) const;
+  virtual void selectFeature(const ViewList& views,
                              float inflation_distance,
                              spark_dsg::SemanticNodeAttributes& attrs) const = 0;
 };
@@ -37,6 +37,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "hydra/gnn/tensor.h"
 
@@ -49,11 +50,28 @@ struct GnnInterfaceImpl;
 
 class GnnInterface {
  public:
-  // TODO(nathan) add actual config
+  enum class OptimizationLevel { DISABLE, BASIC, EXTENDED, ALL };
+
+  struct Config {
+    std::string model_path;
+    //! Number of threads used to parallelize execution within operators
+    size_t intra_op_threads = 1;
+    //! Number of threads used to parallelize execution between operators
+    size_t inter_op_threads = 1;
+    //! Graph optimizations applied by onnxruntime when loading the model
+    OptimizationLevel optimization_level = OptimizationLevel::ALL;
+    //! Inputs that are edge indices (shape 2 x E) to offset when batching graphs
+    std::vector<std::string> edge_fields{"edge_index"};
+    //! Name of the input (if any) that assigns nodes to graphs when batching
+    std::string batch_field = "batch";
+  } const config;
+
   explicit GnnInterface(const std::string& model_path);
 
   GnnInterface(const std::string& model_path, const DynamicIndexMap& output_map);
 
+  explicit GnnInterface(const Config& config, const DynamicIndexMap& output_map = {});
+
   ~GnnInterface();
 
   /**
@@ -86,15 +104,27 @@ class GnnInterface {
   TensorMap operator()(const TensorMap& input,
                        const std::vector<int64_t>& output_sizes) const;
 
+  /**
+   * \brief Run inference over several graphs with a single model invocation
+   *
+   * Graphs are packed into one disjoint union (see GraphBatch). For outputs with
+   * dynamic axes, output size 0 is the total number of nodes and output size 1 is the
+   * number of graphs. Outputs are split per graph by row count.
+   *
+   * \param[in] inputs Map between input name and Tensor value for each graph
+   * \returns Result for each graph in the same order as the inputs
+   */
+  std::vector<TensorMap> batch(const std::vector<TensorMap>& inputs) const;
+
  protected:
   std::unique_ptr<GnnInterfaceImpl> impl_;
 
-  std::string model_path_;
-
   /**
    * \brief Show information about the underlying model and deployment framework
    */
   friend std::ostream& operator<<(std::ostream& out, const GnnInterface& gnn);
 };
 
+void declare_config(GnnInterface::Config& config);
+
 }  // namespace hydra::gnn
@@ -0,0 +1,96 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hydra/gnn/tensor.h"
+
+namespace hydra::gnn {
+
+using TensorMap = std::map<std::string, Tensor>;
+
+/**
+ * \brief Packs several graphs into a single disjoint-union graph
+ *
+ * Node-level inputs are concatenated along the first axis, edge-level inputs
+ * (2 x E) are concatenated along the second axis with indices offset by the number
+ * of preceding nodes, and a batch vector mapping each node to its graph is added.
+ * Packed tensors are reused between calls when shapes do not change and the tensors
+ * are not referenced elsewhere.
+ */
+class GraphBatch {
+ public:
+  explicit GraphBatch(const std::vector<std::string>& edge_fields = {"edge_index"},
+                      const std::string& batch_field = "batch");
+
+  /**
+   * \brief Pack graphs into the batched input
+   * \param[in] graphs Input tensors for every graph (must share the same fields)
+   */
+  void pack(const std::vector<TensorMap>& graphs);
+
+  /**
+   * \brief Split batched outputs back into per-graph outputs
+   *
+   * Outputs with one row per node are split by node offsets, outputs with one row per
+   * graph are split by row, and any other output is returned unsplit for every graph.
+   */
+  std::vector<TensorMap> unpack(const TensorMap& outputs) const;
+
+  const TensorMap& input() const { return input_; }
+
+  size_t size() const { return node_offsets_.empty() ? 0 : node_offsets_.size() - 1; }
+
+  int64_t numNodes() const { return node_offsets_.empty() ? 0 : node_offsets_.back(); }
+
+  int64_t numEdges() const { return edge_offsets_.empty() ? 0 : edge_offsets_.back(); }
+
+  const std::vector<int64_t>& nodeOffsets() const { return node_offsets_; }
+
+ private:
+  Tensor& getBuffer(const std::string& name,
+                    const std::vector<int64_t>& dims,
+                    Tensor::Type type);
+
+  std::vector<std::string> edge_fields_;
+  std::string batch_field_;
+  std::vector<int64_t> node_offsets_;
+  std::vector<int64_t> edge_offsets_;
+  TensorMap input_;
+};
+
+}  // namespace hydra::gnn
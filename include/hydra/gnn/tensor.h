@@ -100,6 +100,9 @@ class Tensor {
 
   int64_t cols() const;
 
+  //! Whether the underlying memory is referenced by another tensor
+  bool shared() const;
+
   template <typename T>
   const T* data(bool validate = true) const {
     if (validate && !matchesType<T>(type_)) {
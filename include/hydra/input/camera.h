@@ -99,6 +99,12 @@ class Camera : public Sensor {
   bool pointIsInViewFrustum(const Eigen::Vector3f& point_C,
                             float inflation_distance = 0.0f) const override;
 
+  bool projectBoundsToImagePlane(const Eigen::Matrix3Xf& points_C,
+                                 float& u_min,
+                                 float& u_max,
+                                 float& v_min,
+                                 float& v_max) const override;
+
   cv::Mat computeVertexMap(const cv::Mat& depth_image,
                            const Eigen::Isometry3f* T_W_C = nullptr) const;
 
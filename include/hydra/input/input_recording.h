@@ -0,0 +1,94 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <filesystem>
+#include <fstream>
+
+#include "hydra/input/input_packet.h"
+
+namespace hydra {
+
+/**
+ * @brief Writer for a compact binary log of input packets.
+ *
+ * Every record stores the packet timestamp, the body pose, the sensor name and frame,
+ * the input and label features and the raw matrices of the image (color, depth and
+ * labels) or pointcloud (points, colors and labels) input. Values are written in
+ * native byte order, so recordings are only portable between machines with the same
+ * endianness.
+ */
+class InputPacketWriter {
+ public:
+  explicit InputPacketWriter(const std::filesystem::path& filepath);
+
+  /**
+   * @brief Append a packet to the recording
+   * @returns False if the packet type is unsupported or the write failed
+   */
+  bool write(const InputPacket& packet);
+
+  bool good() const { return static_cast<bool>(out_); }
+  size_t numWritten() const { return num_written_; }
+
+ private:
+  std::ofstream out_;
+  size_t num_written_ = 0;
+};
+
+/**
+ * @brief Reader for recordings produced by InputPacketWriter.
+ */
+class InputPacketReader {
+ public:
+  explicit InputPacketReader(const std::filesystem::path& filepath);
+
+  /**
+   * @brief Read the next packet
+   * @returns The packet or nullptr at the end of the recording (or on a read error)
+   */
+  InputPacket::Ptr next();
+
+  //! Go back to the first packet of the recording
+  void rewind();
+
+  bool good() const { return valid_; }
+
+ private:
+  std::ifstream in_;
+  std::streampos data_start_;
+  bool valid_ = false;
+};
+
+}  // namespace hydra
@@ -92,6 +92,12 @@ class Lidar : public Sensor {
   bool pointIsInViewFrustum(const Eigen::Vector3f& point_C,
                             float inflation_distance = 0.0f) const override;
 
+  bool projectBoundsToImagePlane(const Eigen::Matrix3Xf& points_C,
+                                 float& u_min,
+                                 float& u_max,
+                                 float& v_min,
+                                 float& v_max) const override;
+
   YAML::Node dump() const override;
 
  private:
@@ -0,0 +1,117 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <config_utilities/factory.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "hydra/input/data_receiver.h"
+#include "hydra/input/input_module.h"
+
+namespace hydra {
+
+/**
+ * @brief Data receiver that replays a recording written by InputPacketWriter.
+ *
+ * Only packets recorded for the sensor the receiver is created for are replayed. The
+ * recorded body poses are kept until they are looked up by the input module.
+ */
+class ReplayReceiver : public DataReceiver {
+ public:
+  struct Config : DataReceiver::Config {
+    //! Path to the recording
+    std::string recording;
+    //! Replay at the recorded rate instead of as fast as the pipeline consumes data
+    bool use_recorded_rate = false;
+    //! Speedup applied to the recorded rate
+    double rate_scale = 1.0;
+  } const config;
+
+  ReplayReceiver(const Config& config, const std::string& sensor_name);
+
+  virtual ~ReplayReceiver();
+
+  //! Recorded body pose for a replayed packet (removed after the lookup)
+  PoseStatus popBodyPose(uint64_t timestamp_ns);
+
+  //! Whether every packet in the recording has been queued
+  bool finished() const { return finished_; }
+
+  //! Number of packets queued so far
+  size_t numReplayed() const { return num_replayed_; }
+
+ protected:
+  bool initImpl() override;
+
+  void spin();
+
+  std::atomic<bool> should_shutdown_{false};
+  std::atomic<bool> finished_{false};
+  std::atomic<size_t> num_replayed_{0};
+  std::unique_ptr<std::thread> spin_thread_;
+
+  mutable std::mutex pose_mutex_;
+  std::map<uint64_t, PoseStatus> poses_;
+
+ private:
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<DataReceiver, ReplayReceiver, Config, std::string>(
+          "ReplayReceiver");
+};
+
+/**
+ * @brief Input module that pulls body poses from replay receivers.
+ */
+class ReplayInputModule : public InputModule {
+ public:
+  ReplayInputModule(const Config& config, const OutputQueue::Ptr& output_queue);
+
+  virtual ~ReplayInputModule() = default;
+
+  //! Whether every receiver finished replaying its recording
+  bool finished() const;
+
+ protected:
+  PoseStatus getBodyPose(uint64_t timestamp) override;
+
+  std::vector<ReplayReceiver*> replay_receivers_;
+};
+
+void declare_config(ReplayReceiver::Config& config);
+
+}  // namespace hydra
@@ -159,6 +159,22 @@ class Sensor {
   virtual bool pointIsInViewFrustum(const Eigen::Vector3f& point_C,
                                     float inflation_distance = 0.f) const = 0;
 
+  /**
+   * @brief Computes conservative image plane bounds for the convex hull of a set of
+   * points. Bounds are not clipped to the image.
+   * @param points_C Points in camera frame (as columns).
+   * @param u_min Output min x image plane coordinate in px.
+   * @param u_max Output max x image plane coordinate in px.
+   * @param v_min Output min y image plane coordinate in px.
+   * @param v_max Output max y image plane coordinate in px.
+   * @return True if bounds could be computed (not supported by default).
+   */
+  virtual bool projectBoundsToImagePlane(const Eigen::Matrix3Xf& points_C,
+                                         float& u_min,
+                                         float& u_max,
+                                         float& v_min,
+                                         float& v_max) const;
+
   //! @brief Name of current sensor
   const std::string name;
 
@@ -33,6 +33,7 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include "hydra/common/global_info.h"
 #include "hydra/loop_closure/descriptor_matching.h"
 #include "hydra/loop_closure/registration.h"
 #include "hydra/loop_closure/scene_graph_descriptors.h"
@@ -48,6 +49,11 @@ struct GnnLcdConfig {
   std::string places_model_path;
   bool places_pos_in_feature = false;
   bool objects_pos_in_feature = false;
+  //! Number of threads used to build descriptor inputs
+  int num_threads = GlobalInfo::instance().getConfig().default_num_threads;
+  //! Compute all new descriptors of a layer with one model invocation (requires
+  //! models that accept a batch input)
+  bool batch_inference = false;
 };
 
 struct LayerLcdConfig {
@@ -71,6 +77,8 @@ struct LcdDetectorConfig {
   HistogramConfig<double> place_histogram_config{0.5, 2.5, 30};
   bool use_gnn_descriptors = false;
   GnnLcdConfig gnn_lcd;
+  //! Number of candidate matches per layer to register concurrently
+  size_t num_registration_threads = 1;
 };
 
 class LcdDetector {
@@ -116,6 +124,9 @@ class LcdDetector {
   bool addNewDescriptors(const DynamicSceneGraph& graph,
                          const SceneGraphNode& agent_node);
 
+  void addLayerDescriptors(const DynamicSceneGraph& graph,
+                           const std::vector<const SceneGraphNode*>& agent_nodes);
+
   std::vector<RegistrationSolution> registerAndVerify(const DynamicSceneGraph& dsg,
                                                       const SearchResultMap& matches,
                                                       NodeId agent_node,
@@ -136,6 +147,7 @@ class LcdDetector {
 
   std::map<std::string, DescriptorCache> cache_map_;
   std::map<NodeId, DescriptorCache> leaf_cache_;
+  std::shared_ptr<SubgraphIndex> subgraph_index_;
   std::map<NodeId, std::set<NodeId>> root_leaf_map_;
 
   std::map<size_t, LayerSearchResults> matches_;
@@ -38,6 +38,17 @@
 
 namespace hydra::lcd {
 
+/**
+ * @brief Options shared by the GNN descriptor factories
+ */
+struct GnnDescriptorOptions {
+  //! Number of threads used to build input tensors (and run unbatched inference)
+  int num_threads = 1;
+  //! Run a single model invocation for all descriptors of a batch. Requires a model
+  //! that takes a "batch" input and returns one output row per graph
+  bool batch_inference = false;
+};
+
 struct ObjectGnnDescriptor : DescriptorFactory {
   using LabelEmbeddings = std::map<uint8_t, Eigen::VectorXf>;
 
@@ -45,16 +56,22 @@ struct ObjectGnnDescriptor : DescriptorFactory {
                       const SubgraphConfig& config,
                       double max_edge_distance_m,
                       const LabelEmbeddings& label_embeddings,
-                      bool use_pos_in_feature = true);
+                      bool use_pos_in_feature = true,
+                      const GnnDescriptorOptions& options = {});
 
   gnn::TensorMap makeInput(const DynamicSceneGraph& graph,
                            const std::set<NodeId>& nodes) const;
 
   Descriptor::Ptr construct(const DynamicSceneGraph& graph,
-                            const DynamicSceneGraphNode& agent_node) const override;
+                            const SceneGraphNode& agent_node) const override;
+
+  std::vector<Descriptor::Ptr> constructBatch(
+      const DynamicSceneGraph& graph,
+      const std::vector<const SceneGraphNode*>& agent_nodes) const override;
 
  protected:
   const SubgraphConfig config_;
+  const GnnDescriptorOptions options_;
   std::unique_ptr<gnn::GnnInterface> model_;
 
   double max_edge_distance_m_;
@@ -66,17 +83,23 @@ struct ObjectGnnDescriptor : DescriptorFactory {
 struct PlaceGnnDescriptor : DescriptorFactory {
   PlaceGnnDescriptor(const std::string& model_path,
                      const SubgraphConfig& config,
-                     bool use_pos_in_feature = true);
+                     bool use_pos_in_feature = true,
+                     const GnnDescriptorOptions& options = {});
 
   gnn::TensorMap makeInput(const DynamicSceneGraph& graph,
                            const std::set<NodeId>& nodes) const;
 
   Descriptor::Ptr construct(const DynamicSceneGraph& graph,
-                            const DynamicSceneGraphNode& agent_node) const override;
+                            const SceneGraphNode& agent_node) const override;
+
+  std::vector<Descriptor::Ptr> constructBatch(
+      const DynamicSceneGraph& graph,
+      const std::vector<const SceneGraphNode*>& agent_nodes) const override;
 
  protected:
   const SubgraphConfig config_;
   const bool use_pos_in_feature_;
+  const GnnDescriptorOptions options_;
   std::unique_ptr<gnn::GnnInterface> model_;
 };
 
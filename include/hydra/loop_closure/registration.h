@@ -38,7 +38,10 @@
 #include <spark_dsg/printing.h>
 #include <teaser/registration.h>
 
+#include <algorithm>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #include "hydra/loop_closure/descriptor_matching.h"
 #include "hydra/loop_closure/registration_solution.h"
@@ -55,6 +58,9 @@ struct LayerRegistrationConfig {
   std::string registration_output_path = "";
   bool recreate_subgraph = false;
   SubgraphConfig subgraph_extraction;
+  //! Maximum correspondences per source node, keeping the closest descriptors (0 to
+  //! keep all)
+  size_t max_correspondences_per_node = 0;
 };
 
 struct DsgRegistrationInput {
@@ -69,6 +75,8 @@ struct DsgRegistrationSolver {
 
   virtual ~DsgRegistrationSolver() = default;
 
+  //! Solve registration for a candidate match. Called concurrently for different
+  //! candidates when parallel registration is enabled
   virtual RegistrationSolution solve(const DynamicSceneGraph& dsg,
                                      const DsgRegistrationInput& match,
                                      NodeId query_agent_id) const = 0;
@@ -76,6 +84,46 @@ struct DsgRegistrationSolver {
 
 using TeaserParams = teaser::RobustRegistrationSolver::Params;
 
+/**
+ * @brief Pool of TEASER solvers so that concurrent registrations each get their own
+ * solver instance (solving mutates the solver).
+ */
+class TeaserSolverPool {
+ public:
+  using Solver = teaser::RobustRegistrationSolver;
+
+  //! Exclusive handle to a solver that returns it to the pool on destruction
+  class Lease {
+   public:
+    Lease(const TeaserSolverPool& pool, std::unique_ptr<Solver>&& solver)
+        : pool_(&pool), solver_(std::move(solver)) {}
+    Lease(Lease&& other) = default;
+    ~Lease();
+
+    Solver& operator*() const { return *solver_; }
+    Solver* operator->() const { return solver_.get(); }
+
+   private:
+    const TeaserSolverPool* pool_;
+    std::unique_ptr<Solver> solver_;
+  };
+
+  explicit TeaserSolverPool(const TeaserParams& params);
+
+  //! Get an idle solver (constructing a new one if none are available)
+  Lease acquire() const;
+
+  //! Number of solvers constructed so far
+  size_t size() const;
+
+  const TeaserParams params;
+
+ private:
+  mutable std::mutex mutex_;
+  mutable size_t num_solvers_;
+  mutable std::vector<std::unique_ptr<Solver>> idle_;
+};
+
 struct DsgTeaserSolver : DsgRegistrationSolver {
   DsgTeaserSolver(const std::string& layer,
                   const LayerRegistrationConfig& config,
@@ -91,13 +139,22 @@ struct DsgTeaserSolver : DsgRegistrationSolver {
   LayerRegistrationConfig config;
   std::string timer_prefix;
   std::string log_prefix;
-  // registration call mutates the solver
-  mutable teaser::RobustRegistrationSolver solver;
+  // registration call mutates the solver, so each concurrent call leases its own
+  TeaserSolverPool solvers;
 };
 
+using Correspondences = std::vector<std::pair<NodeId, NodeId>>;
+
 using CorrespondenceFunc =
     std::function<bool(const SceneGraphNode&, const SceneGraphNode&)>;
 
+//! Key that nodes must share to be considered as a correspondence (e.g., label)
+using CorrespondenceKeyFunc = std::function<uint64_t(const SceneGraphNode&)>;
+
+//! Distance between two candidate nodes (lower is better)
+using CorrespondenceScoreFunc =
+    std::function<double(const SceneGraphNode&, const SceneGraphNode&)>;
+
 template <typename NodeSet = std::list<NodeId>>
 struct LayerRegistrationProblem {
   mutable NodeSet src_nodes;
@@ -131,16 +188,106 @@ std::list<NodeId> pruneSet(const SceneGraphLayer& layer, NodeSet& nodes) {
   return pruned;
 }
 
+/**
+ * @brief Compute correspondences between all source and destination nodes with the
+ * same key.
+ *
+ * Destination nodes are bucketed by key, so only nodes sharing a key are compared.
+ * If max_per_node is non-zero, only the destination nodes with the lowest score are
+ * kept for each source node (ties preserve destination order). Correspondences are
+ * ordered by source node and then destination node order.
+ */
 template <typename NodeSet>
-LayerRegistrationSolution registerDsgLayer(
+Correspondences getKeyedCorrespondences(const SceneGraphLayer& src,
+                                        const SceneGraphLayer& dest,
+                                        const NodeSet& src_nodes,
+                                        const NodeSet& dest_nodes,
+                                        const CorrespondenceKeyFunc& key_func,
+                                        const CorrespondenceScoreFunc& score_func = {},
+                                        size_t max_per_node = 0) {
+  std::unordered_map<uint64_t, std::vector<const SceneGraphNode*>> buckets;
+  for (const auto& dest_id : dest_nodes) {
+    const auto dest_node = dest.findNode(dest_id);
+    CHECK(dest_node);
+    buckets[key_func(*dest_node)].push_back(dest_node);
+  }
+
+  Correspondences correspondences;
+  std::vector<std::pair<double, size_t>> scores;
+  for (const auto& src_id : src_nodes) {
+    const auto src_node = src.findNode(src_id);
+    CHECK(src_node);
+    const auto bucket = buckets.find(key_func(*src_node));
+    if (bucket == buckets.end()) {
+      continue;
+    }
+
+    const auto& candidates = bucket->second;
+    if (!max_per_node || candidates.size() <= max_per_node) {
+      for (const auto dest_node : candidates) {
+        correspondences.emplace_back(src_id, dest_node->id);
+      }
+
+      continue;
+    }
+
+    scores.clear();
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      const double score = score_func ? score_func(*src_node, *candidates[i]) : 0.0;
+      scores.emplace_back(score, i);
+    }
+
+    // pairs sort by score and then by index, keeping ties in destination order
+    std::partial_sort(scores.begin(), scores.begin() + max_per_node, scores.end());
+    std::sort(scores.begin(),
+              scores.begin() + max_per_node,
+              [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+    for (size_t i = 0; i < max_per_node; ++i) {
+      correspondences.emplace_back(src_id, candidates[scores[i].second]->id);
+    }
+  }
+
+  return correspondences;
+}
+
+//! Compute correspondences by testing every source and destination node pair
+template <typename NodeSet>
+Correspondences getAllCorrespondences(const SceneGraphLayer& src,
+                                      const SceneGraphLayer& dest,
+                                      const NodeSet& src_nodes,
+                                      const NodeSet& dest_nodes,
+                                      const CorrespondenceFunc& correspondence_func) {
+  Correspondences correspondences;
+  correspondences.reserve(src_nodes.size() * dest_nodes.size());
+  for (const auto& src_id : src_nodes) {
+    auto src_node_opt = src.findNode(src_id);
+    CHECK(src_node_opt);
+    const auto& src_node = *src_node_opt;
+
+    for (const auto& dest_id : dest_nodes) {
+      auto dest_node_opt = dest.findNode(dest_id);
+      CHECK(dest_node_opt);
+      const auto& dest_node = *dest_node_opt;
+
+      if (correspondence_func(src_node, dest_node)) {
+        correspondences.emplace_back(src_id, dest_id);
+      }
+    }
+  }
+
+  return correspondences;
+}
+
+using CorrespondenceBuilder =
+    std::function<Correspondences(const SceneGraphLayer&, const SceneGraphLayer&)>;
+
+template <typename NodeSet>
+LayerRegistrationSolution registerDsgLayerWithBuilder(
     const LayerRegistrationConfig& config,
     teaser::RobustRegistrationSolver& solver,
     const LayerRegistrationProblem<NodeSet>& problem,
     const SceneGraphLayer& src,
-    const CorrespondenceFunc& correspondence_func) {
-  std::vector<std::pair<NodeId, NodeId>> correspondences;
-  correspondences.reserve(problem.src_nodes.size() * problem.dest_nodes.size());
-
+    const CorrespondenceBuilder& builder) {
   if (problem.src_mutex) {
     problem.src_mutex->lock();
   }
@@ -163,21 +310,7 @@ LayerRegistrationSolution registerDsgLayer(
             << displayNodeSymbolContainer(dest_pruned);
   }
 
-  for (const auto& src_id : problem.src_nodes) {
-    auto src_node_opt = src.findNode(src_id);
-    CHECK(src_node_opt);
-    const auto& src_node = *src_node_opt;
-
-    for (const auto& dest_id : problem.dest_nodes) {
-      auto dest_node_opt = dest.findNode(dest_id);
-      CHECK(dest_node_opt);
-      const auto& dest_node = *dest_node_opt;
-
-      if (correspondence_func(src_node, dest_node)) {
-        correspondences.emplace_back(src_id, dest_id);
-      }
-    }
-  }
+  const auto correspondences = builder(src, dest);
 
   if (problem.src_mutex) {
     problem.src_mutex->unlock();
@@ -239,6 +372,51 @@ LayerRegistrationSolution registerDsgLayer(
           valid_correspondences};
 }
 
+template <typename NodeSet>
+LayerRegistrationSolution registerDsgLayer(
+    const LayerRegistrationConfig& config,
+    teaser::RobustRegistrationSolver& solver,
+    const LayerRegistrationProblem<NodeSet>& problem,
+    const SceneGraphLayer& src,
+    const CorrespondenceFunc& correspondence_func) {
+  return registerDsgLayerWithBuilder(
+      config,
+      solver,
+      problem,
+      src,
+      [&](const SceneGraphLayer& src_layer, const SceneGraphLayer& dest_layer) {
+        return getAllCorrespondences(src_layer,
+                                     dest_layer,
+                                     problem.src_nodes,
+                                     problem.dest_nodes,
+                                     correspondence_func);
+      });
+}
+
+template <typename NodeSet>
+LayerRegistrationSolution registerDsgLayerKeyed(
+    const LayerRegistrationConfig& config,
+    teaser::RobustRegistrationSolver& solver,
+    const LayerRegistrationProblem<NodeSet>& problem,
+    const SceneGraphLayer& src,
+    const CorrespondenceKeyFunc& key_func,
+    const CorrespondenceScoreFunc& score_func = {}) {
+  return registerDsgLayerWithBuilder(
+      config,
+      solver,
+      problem,
+      src,
+      [&](const SceneGraphLayer& src_layer, const SceneGraphLayer& dest_layer) {
+        return getKeyedCorrespondences(src_layer,
+                                       dest_layer,
+                                       problem.src_nodes,
+                                       problem.dest_nodes,
+                                       key_func,
+                                       score_func,
+                                       config.max_correspondences_per_node);
+      });
+}
+
 template <typename NodeSet>
 LayerRegistrationSolution registerDsgLayerPairwise(
     const LayerRegistrationConfig& config,
@@ -249,21 +427,25 @@ LayerRegistrationSolution registerDsgLayerPairwise(
       config, solver, problem, src, [](const auto&, const auto&) { return true; });
 }
 
+//! Distance between semantic features (0 if either node has no feature)
+double getSemanticFeatureDistance(const SceneGraphNode& src_node,
+                                  const SceneGraphNode& dest_node);
+
 template <typename NodeSet>
 LayerRegistrationSolution registerDsgLayerSemantic(
     const LayerRegistrationConfig& config,
     teaser::RobustRegistrationSolver& solver,
     const LayerRegistrationProblem<NodeSet>& problem,
     const SceneGraphLayer& src) {
-  return registerDsgLayer(
+  return registerDsgLayerKeyed(
       config,
       solver,
       problem,
       src,
-      [](const SceneGraphNode& src_node, const SceneGraphNode& dest_node) {
-        return src_node.attributes<SemanticNodeAttributes>().semantic_label ==
-               dest_node.attributes<SemanticNodeAttributes>().semantic_label;
-      });
+      [](const SceneGraphNode& node) -> uint64_t {
+        return node.attributes<SemanticNodeAttributes>().semantic_label;
+      },
+      getSemanticFeatureDistance);
 }
 
 }  // namespace hydra::lcd
@@ -57,6 +57,14 @@ struct DescriptorFactory {
 
   virtual Descriptor::Ptr construct(const DynamicSceneGraph& dsg,
                                     const SceneGraphNode& agent_node) const = 0;
+
+  //! Construct descriptors for several agent nodes (calls construct for each node)
+  virtual std::vector<Descriptor::Ptr> constructBatch(
+      const DynamicSceneGraph& dsg,
+      const std::vector<const SceneGraphNode*>& agent_nodes) const;
+
+  //! Optional index used to speed up subgraph extraction (set by the detector)
+  std::shared_ptr<const SubgraphIndex> subgraph_index;
 };
 
 struct AgentDescriptorFactory : DescriptorFactory {
@@ -33,6 +33,9 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include <map>
+#include <tuple>
+
 #include "hydra/common/dsg_types.h"
 
 namespace hydra {
@@ -48,9 +51,77 @@ struct SubgraphConfig {
   SubgraphConfig();
 };
 
+/**
+ * @brief Neighborhood index for subgraph extraction.
+ *
+ * Archived places no longer move or gain siblings in the frontend graph, so their
+ * positions and siblings are cached in flat records that are added as places are
+ * archived. Places that are not archived yet and the objects attached to any place
+ * are looked up in the graph once per batch (see startBatch) and shared by every root
+ * in the batch, as are the subgraphs already extracted for a root. Not thread-safe.
+ */
+class SubgraphIndex {
+ public:
+  struct PlaceRecord {
+    Eigen::Vector3d position;
+    std::vector<NodeId> siblings;
+  };
+
+  using ObjectList = std::vector<std::pair<NodeId, Eigen::Vector3d>>;
+
+  //! Add (or refresh) records for archived places
+  void update(const DynamicSceneGraph& graph, const std::unordered_set<NodeId>& places);
+
+  //! Drop cached records for places that are not archived, objects and subgraphs
+  void startBatch() const;
+
+  void clear();
+
+  size_t numPlaces() const { return places_.size(); }
+
+  bool hasPlace(NodeId place) const { return places_.count(place); }
+
+  //! Get the record for a place, looking it up in the graph if it is not archived
+  const PlaceRecord* getPlace(const DynamicSceneGraph& graph, NodeId place) const;
+
+  //! Get the objects attached to a place
+  const ObjectList& getObjects(const DynamicSceneGraph& graph, NodeId place) const;
+
+  const std::vector<NodeId>* getCachedSubgraph(NodeId root,
+                                               bool is_places,
+                                               double radius_m) const;
+
+  void cacheSubgraph(NodeId root,
+                     bool is_places,
+                     double radius_m,
+                     const std::vector<NodeId>& nodes) const;
+
+ private:
+  using SubgraphKey = std::tuple<NodeId, bool, double>;
+
+  std::unordered_map<NodeId, PlaceRecord> places_;
+  mutable std::unordered_map<NodeId, PlaceRecord> batch_places_;
+  mutable std::unordered_map<NodeId, ObjectList> batch_objects_;
+  mutable std::map<SubgraphKey, std::vector<NodeId>> batch_subgraphs_;
+};
+
+/**
+ * @brief Get the nodes of the subgraph around a root place as a sorted vector
+ *
+ * Places (or objects attached to places) are found by a breadth-first search over
+ * places within the max radius of the root. If an index is provided, archived
+ * neighborhoods are read from the index instead of the graph.
+ */
+std::vector<NodeId> getSubgraphNodeList(const SubgraphConfig& config,
+                                        const DynamicSceneGraph& graph,
+                                        NodeId root_node,
+                                        bool is_places,
+                                        const SubgraphIndex* index = nullptr);
+
 std::set<NodeId> getSubgraphNodes(const SubgraphConfig& config,
                                   const DynamicSceneGraph& graph,
                                   NodeId root_node,
-                                  bool is_places);
+                                  bool is_places,
+                                  const SubgraphIndex* index = nullptr);
 
 }  // namespace hydra
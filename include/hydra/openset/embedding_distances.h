@@ -19,6 +19,17 @@ struct EmbeddingDistance {
   virtual float dist(const FeatureVector& lhs, const FeatureVector& rhs) const = 0;
 
   virtual float score(const FeatureVector& lhs, const FeatureVector& rhs) const = 0;
+
+  /**
+   * @brief Score every query against every embedding in a group
+   *
+   * Equivalent to score(group.embeddings[n], queries.col(m)) for every entry. The
+   * default implementation scores every pair individually.
+   *
+   * @returns Scores between every query (rows) and embedding (columns) (M x N)
+   */
+  virtual Eigen::MatrixXf scoreGroup(const EmbeddingGroup& group,
+                                     const FeatureGroup& queries) const;
 };
 
 struct CosineDistance : EmbeddingDistance {
@@ -34,6 +45,10 @@ struct CosineDistance : EmbeddingDistance {
 
   float score(const FeatureVector& lhs, const FeatureVector& rhs) const override;
 
+  //! Scores all pairs with a single matrix product of the normalized embeddings
+  Eigen::MatrixXf scoreGroup(const EmbeddingGroup& group,
+                             const FeatureGroup& queries) const override;
+
   const Config config;
 
  private:
@@ -92,9 +107,17 @@ struct LerfScore : public EmbeddingDistance {
 
   float score(const FeatureVector& lhs, const FeatureVector& rhs) const override;
 
+  Eigen::MatrixXf scoreGroup(const EmbeddingGroup& group,
+                             const FeatureGroup& queries) const override;
+
   const Config config;
 
  private:
+  //! Max cosine similarity between each embedding (columns) and the canonical features
+  Eigen::VectorXf getCannonicalTerm(const FeatureGroup& normalized,
+                                    const Eigen::VectorXf& norms) const;
+
+  const CosineDistance dot_prod_;
   std::unique_ptr<EmbeddingGroup> cannonical_;
 
   inline static const auto registration_ =
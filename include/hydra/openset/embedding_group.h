@@ -1,6 +1,7 @@
 #pragma once
 #include <Eigen/Dense>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -32,8 +33,54 @@ struct EmbeddingGroup {
   ScoreResult getBestScore(const EmbeddingDistance& dist,
                            const FeatureVector& embedding) const;
 
+  /**
+   * @brief Score multiple queries against every embedding in the group
+   * @param dist Distance to use for scoring
+   * @param queries Query embeddings as columns (D x M)
+   * @returns Scores between every query (rows) and embedding (columns) (M x N)
+   */
+  Eigen::MatrixXf getScoreMatrix(const EmbeddingDistance& dist,
+                                 const FeatureGroup& queries) const;
+
+  /**
+   * @brief Get the best scoring embedding for every query (columns of queries)
+   */
+  std::vector<ScoreResult> getBestScores(const EmbeddingDistance& dist,
+                                         const FeatureGroup& queries) const;
+
+  /**
+   * @brief Embeddings as unit-norm columns (D x N)
+   *
+   * Zero embeddings are left as zero columns. The matrix is rebuilt the first time
+   * it is requested after the embeddings change (embeddings are public, so changes
+   * are detected by comparing against a copy of the embeddings the cache was built
+   * from).
+   */
+  const FeatureGroup& normalized() const;
+
+  //! Norms of the original embeddings (N)
+  const Eigen::VectorXf& norms() const;
+
   std::vector<FeatureVector> embeddings;
   std::vector<std::string> names;
+
+ private:
+  bool cacheValid() const;
+  void updateCache() const;
+
+  mutable std::mutex cache_mutex_;
+  //! Embeddings the cache was built from (D x N)
+  mutable FeatureGroup cached_;
+  mutable FeatureGroup normalized_;
+  mutable Eigen::VectorXf norms_;
 };
 
+//! Normalize columns in place and return the original column norms
+Eigen::VectorXf normalizeColumns(FeatureGroup& features);
+
+/**
+ * @brief Get best score and index for every row of a score matrix
+ */
+std::vector<EmbeddingGroup::ScoreResult> getRowwiseMax(const Eigen::MatrixXf& scores);
+
 }  // namespace hydra
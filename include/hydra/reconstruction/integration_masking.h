@@ -40,10 +40,26 @@
 
 namespace hydra {
 
+/**
+ * @brief Set the mask for every pixel with a label in the specified set
+ *
+ * Labels are looked up in a dense table spanning the range of labels to mask. Large
+ * images are split across threads.
+ * @param labels Label image (must be CV_32SC1)
+ * @param to_mask Labels to mask
+ * @param mask Mask to update (initialized if empty, converted to CV_32SC1 otherwise)
+ * @returns False if the label image or mask are invalid
+ */
 bool maskInvalidSemantics(const cv::Mat& labels,
-                          const std::set<int32_t> to_mask,
+                          const std::set<int32_t>& to_mask,
                           cv::Mat& mask);
 
-bool maskNonZero(const cv::Mat input, cv::Mat& mask);
+/**
+ * @brief Set the mask for every non-zero pixel of a single channel integer image
+ * @param input Image to mask (must have an integer depth)
+ * @param mask Mask to update (initialized if empty, converted to CV_32SC1 otherwise)
+ * @returns False if the input image or mask are invalid
+ */
+bool maskNonZero(const cv::Mat& input, cv::Mat& mask);
 
 }  // namespace hydra
@@ -46,6 +46,7 @@
 // Government is authorized to reproduce and distribute reprints for Government
 // purposes notwithstanding any copyright notation herein.
 #pragma once
+#include <atomic>
 #include <memory>
 #include <string>
 #include <thread>
@@ -106,6 +107,9 @@ class ProjectiveIntegrator {
         InterpolatorAdaptive::Config{}};
     //! Semantic integrator configuration (optional)
     config::VirtualConfig<SemanticIntegrator> semantic_integrator;
+    //! Skip blocks and groups of voxels that are out of range or lie entirely behind
+    //! the observed surface using a max-range pyramid of the range image
+    bool use_range_pyramid = true;
   } const config;
 
   struct VoxelMeasurement {
@@ -218,9 +222,24 @@ class ProjectiveIntegrator {
                             const cv::Mat& integration_mask,
                             VoxelMeasurement& measurement) const;
 
+  /**
+   * @brief Number of voxels projected into the sensor during the last call to
+   * updateBlocks.
+   */
+  size_t numProjectedVoxels() const { return num_projected_voxels_; }
+
  protected:
+  struct RangeCuller;
+
+  void updateBlockImpl(const BlockIndex& block_index,
+                       const InputData& data,
+                       const cv::Mat& integration_mask,
+                       VolumetricMap& map,
+                       const RangeCuller* culler) const;
+
   const std::unique_ptr<const ProjectionInterpolator> interpolator_;
   const SemanticIntegratorPtr semantic_integrator_;
+  mutable std::atomic<size_t> num_projected_voxels_{0};
 };
 
 void declare_config(ProjectiveIntegrator::Config& config);
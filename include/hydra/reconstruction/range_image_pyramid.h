@@ -0,0 +1,75 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <opencv2/core/mat.hpp>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Mip pyramid of the maximum range over a range image.
+ *
+ * Level 0 is the range image and every following level stores the maximum of the (up
+ * to) 2x2 pixels of the level below it, down to a single pixel. NaN ranges are ignored
+ * as they never produce valid measurements.
+ */
+class RangeImagePyramid {
+ public:
+  RangeImagePyramid() = default;
+
+  explicit RangeImagePyramid(const cv::Mat& range_image);
+
+  bool empty() const { return levels_.empty(); }
+
+  size_t numLevels() const { return levels_.size(); }
+
+  const cv::Mat& level(size_t index) const { return levels_.at(index); }
+
+  /**
+   * @brief Get an upper bound on the max range in a pixel rectangle
+   *
+   * Bounds are inclusive and clipped to the image. Reads at most 2x2 pixels from the
+   * coarsest level that covers the rectangle, so the returned value may include pixels
+   * next to the rectangle.
+   *
+   * @returns Max range or lowest float if the rectangle contains no valid pixels
+   */
+  float maxRange(int u_min, int u_max, int v_min, int v_max) const;
+
+ private:
+  std::vector<cv::Mat> levels_;
+};
+
+}  // namespace hydra
@@ -59,6 +59,11 @@ struct SemanticIntegrator {
  * @brief Full maximum-likelihood integrator
  *
  * Based roughly on Kimera-Semantics and https://arxiv.org/pdf/1609.05130
+ *
+ * Every observation adds the non-match likelihood to all labels and the match
+ * likelihood to the observed label. The non-match part is accumulated in the voxel's
+ * likelihood offset, so an update only touches the observed label and the current
+ * argmax. Use SemanticVoxel::likelihoods() to read the full log-likelihoods.
  */
 class MLESemanticIntegrator : public SemanticIntegrator {
  public:
@@ -77,6 +82,12 @@ class MLESemanticIntegrator : public SemanticIntegrator {
   size_t total_labels_;
 
   float init_likelihood_;
+  float match_likelihood_;
+  float nonmatch_likelihood_;
+  //! Difference between the match and non-match likelihoods
+  float match_increment_;
+  //! Whether the offset representation is usable (i.e., non-match likelihood finite)
+  bool use_offset_;
   Eigen::MatrixXf observation_likelihoods_;
 };
 
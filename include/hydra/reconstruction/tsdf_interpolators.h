@@ -37,6 +37,7 @@
 
 #include <memory>
 
+#include "hydra/common/global_info.h"
 #include "hydra/reconstruction/voxel_types.h"
 
 namespace hydra {
@@ -56,6 +57,10 @@ struct DownsampleTsdfInterpolator : public TsdfInterpolator {
   struct Config {
     size_t ratio = 2;
     float tolerance = 1.0e-10;
+    //! Number of threads to use when interpolating blocks
+    int num_threads = GlobalInfo::instance().getConfig().default_num_threads;
+    //! Number of levels to keep when used for a persistent TSDF pyramid
+    size_t num_levels = 1;
   } const config;
 
   explicit DownsampleTsdfInterpolator(const Config& config);
@@ -65,6 +70,21 @@ struct DownsampleTsdfInterpolator : public TsdfInterpolator {
   std::shared_ptr<TsdfLayer> interpolate(const TsdfLayer& input,
                                          const BlockIndices* blocks) const override;
 
+  /**
+   * @brief Interpolate blocks of the input into an existing downsampled layer
+   *
+   * Blocks are allocated in the output if necessary and overwritten otherwise.
+   *
+   * @param input Layer to downsample
+   * @param blocks Blocks to interpolate (must be allocated in the input)
+   * @param output Layer with the downsampled voxel size and voxels per side
+   */
+  void interpolateBlocks(const TsdfLayer& input,
+                         const BlockIndices& blocks,
+                         TsdfLayer& output) const;
+
+  void interpolateBlock(const TsdfBlock& input, TsdfBlock& output) const;
+
   inline static const auto registration_ =
       config::RegistrationWithConfig<TsdfInterpolator,
                                      DownsampleTsdfInterpolator,
@@ -73,4 +93,44 @@ struct DownsampleTsdfInterpolator : public TsdfInterpolator {
 
 void declare_config(DownsampleTsdfInterpolator::Config& config);
 
+/**
+ * @brief Persistent downsampled copies of a TSDF layer.
+ *
+ * Level 0 is downsampled by the configured ratio and every further level by another
+ * factor of two from the previous level. Every level has the same block size, so a
+ * block has the same index at every level. Only the blocks passed to update are
+ * re-interpolated, and they are flagged as updated so that consumers can process
+ * changed blocks only.
+ */
+class TsdfPyramid {
+ public:
+  using Config = DownsampleTsdfInterpolator::Config;
+
+  explicit TsdfPyramid(const Config& config);
+
+  /**
+   * @brief Re-interpolate blocks of the input layer at every level
+   * @param input Full resolution layer
+   * @param blocks Blocks to update (every allocated input block if not provided)
+   * @returns False if the input can't be downsampled by the configured ratio
+   */
+  bool update(const TsdfLayer& input, const BlockIndices* blocks = nullptr);
+
+  //! Remove blocks from every level
+  void removeBlocks(const BlockIndices& blocks);
+
+  size_t numLevels() const { return levels_.size(); }
+
+  //! Downsampled layer for a level (nullptr before the first update)
+  const TsdfLayer* level(size_t index) const;
+
+  //! Mutable access to a level (e.g., to clear updated flags)
+  TsdfLayer* level(size_t index);
+
+ private:
+  const DownsampleTsdfInterpolator base_interpolator_;
+  const DownsampleTsdfInterpolator level_interpolator_;
+  std::vector<std::shared_ptr<TsdfLayer>> levels_;
+};
+
 }  // namespace hydra
@@ -159,6 +159,14 @@ class VolumetricMap {
 
   virtual std::unique_ptr<VolumetricMap> cloneUpdated() const;
 
+  /**
+   * @brief Copy a subset of the blocks of the map into a new map.
+   * @param blocks Indices of the blocks to copy. Indices without an allocated block are
+   * ignored.
+   * @return New map with the same configuration containing only the requested blocks.
+   */
+  virtual std::unique_ptr<VolumetricMap> cloneBlocks(const BlockIndices& blocks) const;
+
   virtual void updateFrom(const VolumetricMap& other);
 
  protected:
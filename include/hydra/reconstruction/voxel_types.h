@@ -89,8 +89,15 @@ struct SemanticVoxel {
   Eigen::VectorXf semantic_likelihoods;
   //! Labels assigned to each likelihood slot
   Eigen::Matrix<uint32_t, Eigen::Dynamic, 1> semantic_labels;
+  //! Log-likelihood shared by every label (not yet applied to semantic_likelihoods)
+  float likelihood_offset = 0.0f;
   //! Whether or not the voxel has been initialized
   bool empty = true;
+
+  //! Log-likelihoods of each label with the shared offset applied
+  Eigen::VectorXf likelihoods() const {
+    return semantic_likelihoods.array() + likelihood_offset;
+  }
 };
 
 // Voxel to track which parts of space are free with high confidence.
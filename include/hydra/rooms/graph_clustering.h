@@ -54,16 +54,26 @@ struct ClusterResults {
   void fillFromInitialClusters(const InitialClusters& initial_clusters);
 };
 
+/**
+ * @brief Assign unlabeled nodes to the initial clusters by label propagation
+ *
+ * Nodes are visited in ID order and moved to the neighboring community with the
+ * largest positive modularity gain. With more than one thread, nodes are grouped by a
+ * greedy coloring and every color is evaluated in parallel; this uses slightly stale
+ * community degrees, so results can differ from the sequential sweep.
+ */
 ClusterResults clusterGraphByModularity(const SceneGraphLayer& layer,
                                         const InitialClusters& initial_clusters,
                                         size_t max_iters = 5,
-                                        double gamma = 1.0);
+                                        double gamma = 1.0,
+                                        size_t num_threads = 1);
 
 ClusterResults clusterGraphByModularity(const SceneGraphLayer& layer,
                                         const InitialClusters& initial_clusters,
                                         const EdgeWeightFunc& edge_weight_func,
                                         size_t max_iters = 5,
-                                        double gamma = 1.0);
+                                        double gamma = 1.0,
+                                        size_t num_threads = 1);
 
 ClusterResults clusterGraphByNeighbors(const SceneGraphLayer& layer,
                                        const InitialClusters& initial_clusters);
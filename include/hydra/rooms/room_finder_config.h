@@ -60,6 +60,8 @@ struct RoomFinderConfig {
   RoomClusterMode clustering_mode = RoomClusterMode::NEIGHBORS;
   double max_modularity_iters = 5;
   double modularity_gamma = 1.0;
+  //! Threads for modularity clustering (more than one changes the visiting order)
+  size_t num_modularity_threads = 1;
   double dilation_diff_threshold_m = 1.0e-4;
   bool log_filtrations = false;
   bool log_place_graphs = false;
@@ -33,7 +33,11 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
-#include <spark_dsg/layer_view.h>
+#include <optional>
+#include <set>
+
+#include "hydra/utils/graph_change_log.h"
+#include "hydra/utils/node_subset_view.h"
 
 namespace hydra {
 
@@ -46,9 +50,17 @@ struct ActiveWindowTracker {
 
   /**
    * @brief Get iterator over active window (active nodes plus just-archived nodes)
+   *
+   * Without a change log every node of the layer is checked. With a change log only
+   * the previous window and the nodes that changed since the last (unfrozen) view are
+   * checked, unless the log no longer covers the last view.
+   * @param layer Layer to get the active window of
+   * @param freeze Don't update the window (i.e., the view is read-only)
+   * @param changes Optional change log of the graph the layer belongs to
    */
-  spark_dsg::LayerView view(const spark_dsg::SceneGraphLayer& layer,
-                            bool freeze = false) const;
+  NodeSubsetView view(const spark_dsg::SceneGraphLayer& layer,
+                      bool freeze = false,
+                      const GraphChangeLog* changes = nullptr) const;
   /**
    * @brief Remove all archived nodes from iteration
    */
@@ -60,8 +72,11 @@ struct ActiveWindowTracker {
 
  private:
   bool isActive(const spark_dsg::SceneGraphNode& node, bool freeze = false) const;
+  NodeSubsetView scanLayer(const spark_dsg::SceneGraphLayer& layer, bool freeze) const;
   mutable std::set<spark_dsg::NodeId> to_clear_;
   mutable std::set<spark_dsg::NodeId> prev_active_;
+  //! Last change log sequence the window was updated with
+  mutable std::optional<uint64_t> last_sequence_;
 };
 
 }  // namespace hydra
@@ -48,8 +48,12 @@ struct DisjointSet {
 
   bool hasSet(NodeId node) const;
 
+  //! Find the root of the node's set without modifying the set
   NodeId findSet(NodeId node) const;
 
+  //! Find the root of the node's set, shortening the path to the root
+  NodeId findSet(NodeId node);
+
   bool addSet(NodeId node);
 
   std::optional<NodeId> doUnion(NodeId lhs, NodeId rhs, bool rhs_better = false);
@@ -0,0 +1,126 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spark_dsg/dynamic_scene_graph.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Sequence-numbered log of node changes in a scene graph
+ *
+ * The log is fed once per graph update (via observe) and then shared by every
+ * consumer of the graph: each consumer remembers the last sequence number it saw and
+ * asks for the nodes that changed since then, instead of re-scanning whole layers.
+ */
+class GraphChangeLog {
+ public:
+  using Ptr = std::shared_ptr<GraphChangeLog>;
+
+  enum class Change : uint8_t { ADDED, DEACTIVATED, REMOVED };
+
+  struct Entry {
+    uint64_t sequence;
+    spark_dsg::NodeId node;
+    //! Layer of the node (unknown for removed nodes that were never active)
+    std::optional<spark_dsg::LayerId> layer;
+    Change change;
+  };
+
+  /**
+   * @brief Start a new sequence and record every node added or removed from the graph
+   * and every tracked active node that was archived since the last call
+   *
+   * Consumes the new and removed node flags of the graph. Nodes are only assumed to go
+   * from active to archived (and not back), which is how the frontend manages them.
+   * @returns Sequence number of the new entries
+   */
+  uint64_t observe(spark_dsg::DynamicSceneGraph& graph);
+
+  /**
+   * @brief Record a single change as part of the next sequence
+   */
+  void record(spark_dsg::NodeId node,
+              std::optional<spark_dsg::LayerId> layer,
+              Change change);
+
+  //! Sequence number of the latest observed update
+  uint64_t sequence() const;
+
+  /**
+   * @brief Check whether all changes after the specified sequence are still available
+   */
+  bool covers(uint64_t sequence) const;
+
+  /**
+   * @brief Get all changes recorded after the specified sequence number (in order)
+   */
+  std::vector<Entry> changesSince(uint64_t sequence) const;
+
+  /**
+   * @brief Get the sorted and unique IDs of all nodes changed after the specified
+   * sequence number, optionally restricted to a single layer (removed nodes with an
+   * unknown layer are always included)
+   */
+  std::vector<spark_dsg::NodeId> dirtySince(uint64_t sequence) const;
+  std::vector<spark_dsg::NodeId> dirtySince(uint64_t sequence,
+                                            spark_dsg::LayerId layer) const;
+
+  /**
+   * @brief Drop all changes recorded at or before the specified sequence number
+   */
+  void trim(uint64_t sequence);
+
+  void reset();
+
+ private:
+  template <typename Filter>
+  std::vector<spark_dsg::NodeId> collect(uint64_t sequence, const Filter& filter) const;
+
+  mutable std::mutex mutex_;
+  uint64_t sequence_ = 0;
+  uint64_t trimmed_ = 0;
+  std::deque<Entry> entries_;
+  //! Nodes that were active the last time the graph was observed
+  std::unordered_map<spark_dsg::NodeId, spark_dsg::LayerId> active_;
+};
+
+}  // namespace hydra
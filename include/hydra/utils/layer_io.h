@@ -115,7 +115,9 @@ inline bool deserializeVoxel(BinaryDeserializer& deserializer, TsdfVoxel& voxel)
 template <>
 inline bool serializeVoxel(BinarySerializer& serializer, const SemanticVoxel& voxel) {
   serializer.write(voxel.semantic_label);
-  serializer.write(voxel.semantic_likelihoods);
+  // write the full likelihoods to keep the format independent of the offset
+  const Eigen::VectorXf likelihoods = voxel.likelihoods();
+  serializer.write(likelihoods);
   serializer.write(voxel.empty);
   return true;
 }
@@ -124,6 +126,7 @@ template <>
 inline bool deserializeVoxel(BinaryDeserializer& deserializer, SemanticVoxel& voxel) {
   deserializer.read(voxel.semantic_label);
   deserializer.read(voxel.semantic_likelihoods);
+  voxel.likelihood_offset = 0.0f;
   deserializer.read(voxel.empty);
   return true;
 }
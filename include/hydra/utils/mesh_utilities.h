@@ -36,6 +36,7 @@
 #include <spark_dsg/bounding_box.h>
 #include <spark_dsg/node_attributes.h>
 
+#include <limits>
 #include <optional>
 #include <vector>
 
@@ -54,6 +55,48 @@ bool updateObjectGeometry(const spark_dsg::Mesh& mesh,
                           const std::vector<size_t>* indices = nullptr,
                           std::optional<BoundingBox::Type> type = std::nullopt);
 
+/**
+ * @brief Running centroid and extents of the mesh vertices belonging to an object.
+ *
+ * Caches the last seen position of every connected vertex so that an update only has
+ * to apply the change of vertices that moved, were added or were removed. The extents
+ * are only recomputed from the cache when a vertex on the boundary moves inwards or is
+ * removed.
+ */
+class ObjectGeometry {
+ public:
+  /**
+   * @brief Synchronize with the current connections and mesh vertex positions
+   * @param mesh Mesh containing the (possibly deformed) vertices
+   * @param connections Mesh vertex indices that belong to the object
+   * @returns Number of cached vertices that changed
+   */
+  size_t update(const spark_dsg::Mesh& mesh, const std::vector<size_t>& connections);
+
+  /**
+   * @brief Write the centroid and bounding box of the cached vertices to the attributes
+   * @returns False if no cached vertex has a valid position
+   */
+  bool apply(const spark_dsg::Mesh& mesh, spark_dsg::ObjectNodeAttributes& attrs) const;
+
+  size_t numValid() const { return num_valid_; }
+  const std::vector<size_t>& indices() const { return indices_; }
+
+ private:
+  void add(const Eigen::Vector3f& pos);
+  void remove(const Eigen::Vector3f& pos);
+  void recompute();
+
+  std::vector<size_t> indices_;
+  std::vector<Eigen::Vector3f> positions_;
+  size_t num_valid_ = 0;
+  Eigen::Vector3d sum_ = Eigen::Vector3d::Zero();
+  Eigen::Vector3f min_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f max_ =
+      Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  bool needs_recompute_ = false;
+};
+
 MeshLayer::Ptr getActiveMesh(const MeshLayer& mesh_layer,
                              const BlockIndices& archived_blocks);
 
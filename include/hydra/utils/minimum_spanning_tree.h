@@ -33,6 +33,11 @@
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
 #pragma once
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "hydra/common/dsg_types.h"
 
 namespace hydra {
@@ -65,4 +70,83 @@ MinimumSpanningTreeInfo getMinimumSpanningEdges(const SceneGraphLayer& layer);
 MinimumSpanningTreeInfo getMinimumSpanningEdges(const SceneGraphLayer& layer,
                                                 const EdgeFilter& func);
 
+struct DynamicMstImpl;
+
+/**
+ * @brief Minimum spanning forest that is updated as nodes and edges are added and
+ * removed.
+ *
+ * The forest is stored in a link-cut tree, so inserting an edge only needs a path
+ * maximum query (O(log n) amortized) to decide whether the new edge replaces a tree
+ * edge. Removing a tree edge searches the smaller of the two resulting subtrees for the
+ * cheapest replacement edge. Edge distances can be changed after an edge is added:
+ * cheaper edges are handled like insertions and more expensive tree edges like
+ * removals.
+ */
+class DynamicMinimumSpanningTree {
+ public:
+  using EdgeKey = std::pair<NodeId, NodeId>;
+
+  //! Tree edges that were added or removed since the changes were last cleared
+  struct Changes {
+    std::vector<EdgeKey> added;
+    std::vector<EdgeKey> removed;
+    //! Nodes whose number of tree edges changed
+    std::unordered_set<NodeId> nodes;
+  };
+
+  DynamicMinimumSpanningTree();
+  ~DynamicMinimumSpanningTree();
+
+  bool addNode(NodeId node);
+  //! Remove a node and all edges connected to it
+  bool removeNode(NodeId node);
+  bool addEdge(NodeId source, NodeId target, double distance);
+  bool removeEdge(NodeId source, NodeId target);
+  //! Change the distance of an existing edge, updating the tree if required
+  bool setEdgeDistance(NodeId source, NodeId target, double distance);
+
+  //! Add, remove and re-weight nodes and edges to match the layer
+  void update(const SceneGraphLayer& layer, const EdgeFilter& filter = {});
+
+  /**
+   * @brief Add, remove and re-weight only the given nodes and their edges to match the
+   * layer
+   *
+   * Nodes missing from the layer are removed. Edge distances are recomputed from the
+   * current node positions, so nodes that moved must be included.
+   * @param layer Layer to match
+   * @param nodes Nodes that were added, removed or changed in the layer
+   * @param filter Optional filter for layer edges to include
+   */
+  void update(const SceneGraphLayer& layer,
+              const std::vector<NodeId>& nodes,
+              const EdgeFilter& filter = {});
+
+  bool hasNode(NodeId node) const;
+  bool hasEdge(NodeId source, NodeId target) const;
+  bool isTreeEdge(NodeId source, NodeId target) const;
+  std::optional<double> edgeDistance(NodeId source, NodeId target) const;
+  size_t numNodes() const;
+  size_t numEdges() const;
+  size_t numTreeEdges() const;
+  //! Number of tree edges connected to the node
+  size_t degree(NodeId node) const;
+  //! Nodes connected to the node by tree edges
+  std::vector<NodeId> treeNeighbors(NodeId node) const;
+  bool isLeaf(NodeId node) const { return degree(node) == 1; }
+
+  //! Sum of distances of all tree edges
+  double totalDistance() const;
+
+  //! Current forest in the same format as getMinimumSpanningEdges
+  MinimumSpanningTreeInfo info() const;
+
+  //! Get and clear tree changes since the last call
+  Changes takeChanges();
+
+ private:
+  std::unique_ptr<DynamicMstImpl> impl_;
+};
+
 }  // namespace hydra
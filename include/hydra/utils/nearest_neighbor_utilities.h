@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -73,6 +74,51 @@ class NearestNodeFinder {
   std::unique_ptr<Detail> internals_;
 };
 
+/**
+ * @brief Nearest neighbor search over a set of nodes that can change over time.
+ *
+ * Unlike NearestNodeFinder, nodes can be added, moved and removed without rebuilding
+ * the whole index. Node positions are copied on insertion, so the finder doesn't
+ * reference the layer and has to be told when a node moves.
+ */
+class DynamicNodeFinder {
+ public:
+  using Callback = NearestNodeFinder::Callback;
+  using Ptr = std::unique_ptr<DynamicNodeFinder>;
+
+  DynamicNodeFinder();
+
+  virtual ~DynamicNodeFinder();
+
+  /**
+   * @brief Add a node to the index (or update its position if already present)
+   */
+  void insert(NodeId node, const Eigen::Vector3d& position);
+
+  /**
+   * @brief Remove a node from the index
+   * @returns True if the node was present
+   */
+  bool erase(NodeId node);
+
+  bool contains(NodeId node) const;
+
+  size_t size() const;
+
+  /**
+   * @brief Find the closest nodes to a position (in order of increasing distance)
+   *
+   * The callback gets the node, the rank of the node and the squared distance.
+   */
+  void find(const Eigen::Vector3d& position,
+            size_t num_to_find,
+            const Callback& callback) const;
+
+ private:
+  struct Detail;
+  std::unique_ptr<Detail> internals_;
+};
+
 using SemanticNodeFinders =
     std::map<SemanticNodeAttributes::Label, std::unique_ptr<NearestNodeFinder>>;
 
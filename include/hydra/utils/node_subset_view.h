@@ -0,0 +1,118 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spark_dsg/layer_view.h>
+#include <spark_dsg/scene_graph_layer.h>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Iterable subset of the nodes of a single layer.
+ *
+ * Unlike spark_dsg::LayerView (which walks every node of the layer and applies a
+ * filter), the subset is resolved once on construction, so iterating over a handful
+ * of candidate nodes doesn't touch the rest of the layer. The view holds pointers to
+ * the nodes and is invalidated by adding or removing nodes from the layer.
+ */
+class NodeSubsetView {
+ public:
+  using Nodes = std::vector<const spark_dsg::SceneGraphNode*>;
+
+  struct Iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = spark_dsg::SceneGraphNode;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const spark_dsg::SceneGraphNode*;
+    using reference = const spark_dsg::SceneGraphNode&;
+
+    explicit Iterator(Nodes::const_iterator iter) : iter_(iter) {}
+    reference operator*() const { return **iter_; }
+    pointer operator->() const { return *iter_; }
+    Iterator& operator++() {
+      ++iter_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator prev = *this;
+      ++iter_;
+      return prev;
+    }
+    bool operator==(const Iterator& other) const { return iter_ == other.iter_; }
+    bool operator!=(const Iterator& other) const { return iter_ != other.iter_; }
+
+   private:
+    Nodes::const_iterator iter_;
+  };
+
+  NodeSubsetView() = default;
+
+  /**
+   * @brief Construct a view over every node in the layer
+   */
+  explicit NodeSubsetView(const spark_dsg::SceneGraphLayer& layer);
+
+  /**
+   * @brief Construct a view over the nodes that pass the filter of a layer view
+   */
+  explicit NodeSubsetView(const spark_dsg::LayerView& view);
+
+  /**
+   * @brief Construct a view over the specified nodes
+   *
+   * Nodes that don't exist in the layer are skipped and nodes are visited in the
+   * order they are specified.
+   */
+  NodeSubsetView(const spark_dsg::SceneGraphLayer& layer,
+                 const std::vector<spark_dsg::NodeId>& nodes);
+
+  /**
+   * @brief Construct a view over already resolved nodes
+   */
+  explicit NodeSubsetView(Nodes&& nodes) : nodes_(std::move(nodes)) {}
+
+  Iterator begin() const { return Iterator(nodes_.begin()); }
+  Iterator end() const { return Iterator(nodes_.end()); }
+  size_t size() const { return nodes_.size(); }
+  bool empty() const { return nodes_.empty(); }
+
+ private:
+  Nodes nodes_;
+};
+
+}  // namespace hydra
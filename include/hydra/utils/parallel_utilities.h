@@ -0,0 +1,83 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <type_traits>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Call func for every index in [0, num_items) with a pool of workers
+ *
+ * Workers pull the next index from a shared counter, so indices are started in
+ * increasing order but may finish in any order. The calling thread is used as one of
+ * the workers and at most num_items workers are started. If func accepts two
+ * arguments, it is called as func(worker_index, item_index) with worker_index in
+ * [0, num_workers) so callers can keep per-worker scratch space.
+ *
+ * @param num_items Number of items to process
+ * @param num_threads Maximum number of workers (values below 1 run serially)
+ * @param func Function to call for each item
+ */
+template <typename Func>
+void processInParallel(size_t num_items, int num_threads, const Func& func) {
+  std::atomic<size_t> next_index(0);
+  const auto worker = [&](size_t worker_index) {
+    size_t i;
+    while ((i = next_index++) < num_items) {
+      if constexpr (std::is_invocable_v<const Func&, size_t, size_t>) {
+        func(worker_index, i);
+      } else {
+        func(i);
+      }
+    }
+  };
+
+  const size_t num_workers = std::min<size_t>(std::max(num_threads, 1), num_items);
+  std::vector<std::future<void>> threads;
+  for (size_t i = 1; i < num_workers; ++i) {
+    threads.emplace_back(std::async(std::launch::async, worker, i));
+  }
+
+  worker(0);
+  for (auto& thread : threads) {
+    thread.get();
+  }
+}
+
+}  // namespace hydra
@@ -0,0 +1,95 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spatial_hash/hash.h>
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Axis-aligned bounds of a 2D place in the xy-plane.
+ */
+struct PlaceBounds2d {
+  Eigen::Vector2d min = Eigen::Vector2d::Zero();
+  Eigen::Vector2d max = Eigen::Vector2d::Zero();
+  //! Unbounded places are considered to overlap every other place
+  bool bounded = false;
+
+  bool overlaps(const PlaceBounds2d& other) const;
+
+  /**
+   * @brief Get the bounds of the region {x | (x - c)^T A (x - c) < 1}
+   *
+   * This is the region tested by the ellipse overlap math, so places whose bounds don't
+   * overlap have zero overlap distance. If the symmetric part of A is not positive
+   * definite the region is unbounded.
+   */
+  static PlaceBounds2d fromEllipse(const Eigen::Matrix2d& A, const Eigen::Vector2d& c);
+};
+
+/**
+ * @brief Uniform grid over the bounds of a set of 2D places.
+ *
+ * Used to find the places that can overlap instead of checking every pair of places.
+ * The cell size is picked from the average extent of the places.
+ */
+class Place2dGridIndex {
+ public:
+  explicit Place2dGridIndex(const std::vector<PlaceBounds2d>& bounds);
+
+  size_t size() const { return bounds_.size(); }
+
+  double cellSize() const { return cell_size_; }
+
+  /**
+   * @brief Get all places whose bounds overlap the bounds of the specified place
+   * @param index Place to get candidates for
+   * @returns Indices of overlapping places in increasing order (includes the place)
+   */
+  std::vector<size_t> getCandidates(size_t index) const;
+
+ private:
+  spatial_hash::IndexHashMap<std::vector<size_t>> cells_;
+  //! Unbounded places or places that cover too many cells
+  std::vector<size_t> large_;
+  std::vector<PlaceBounds2d> bounds_;
+  double cell_size_;
+
+  inline static constexpr size_t kMaxCellsPerPlace = 64;
+};
+
+}  // namespace hydra
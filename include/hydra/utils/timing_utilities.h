@@ -40,7 +40,9 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace hydra::timing {
@@ -56,32 +58,89 @@ struct ElapsedStatistics {
 
 std::ostream& operator<<(std::ostream& out, const ElapsedStatistics& stats);
 
+/**
+ * @brief Fixed-size log-linear histogram of durations.
+ *
+ * Durations are bucketed by power of two with 16 linear sub-buckets per power, giving
+ * a relative error of at most ~3% for any percentile over [1 ns, ~70 min].
+ */
+class ElapsedHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 4;
+  static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr size_t kMaxExponent = 41;
+  static constexpr size_t kNumBuckets = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+  void add(std::chrono::nanoseconds elapsed);
+  void merge(const ElapsedHistogram& other);
+  size_t count() const { return count_; }
+
+  //! Approximate quantile (q in [0, 1]) in seconds. Returns 0 if empty
+  double quantile(double q) const;
+
+  static size_t bucketIndex(uint64_t elapsed_ns);
+  static uint64_t bucketLowerBound(size_t index);
+
+ private:
+  size_t count_ = 0;
+  std::vector<uint64_t> counts_;
+};
+
 class ElapsedTimeRecorder {
  public:
+  using TimerId = uint32_t;
+
   struct Entry {
     uint64_t timestamp;
     std::chrono::nanoseconds elapsed;
     double elapsed_seconds() const;
   };
 
+  //! Statistics and histogram of a timer at a point in time
+  struct Snapshot {
+    std::string name;
+    ElapsedStatistics stats;
+    ElapsedHistogram histogram;
+    double p50_s = 0.0;
+    double p90_s = 0.0;
+    double p99_s = 0.0;
+  };
+
   static ElapsedTimeRecorder& instance();
 
   void reset();
 
+  //! Get the interned ID for a timer (registering it if necessary)
+  TimerId getTimerId(const std::string& timer_name);
+
   void start(const std::string& timer_name, const uint64_t timestamp);
 
+  void start(TimerId timer, const uint64_t timestamp);
+
   void stop(const std::string& timer_name);
 
+  void stop(TimerId timer);
+
   void record(const std::string& timer_name,
               const uint64_t timestamp,
               const std::chrono::nanoseconds elapsed);
 
+  void record(TimerId timer,
+              const uint64_t timestamp,
+              const std::chrono::nanoseconds elapsed);
+
   std::vector<std::string> timerNames() const;
 
   std::optional<double> getLastElapsed(const std::string& timer_name) const;
 
   ElapsedStatistics getStats(const std::string& timer_name) const;
 
+  //! Current statistics and percentiles for every timer with measurements
+  std::vector<Snapshot> snapshot() const;
+
+  //! Current statistics and percentiles for a single timer
+  std::optional<Snapshot> snapshot(const std::string& timer_name) const;
+
   std::string printAllStats() const;
 
   void logTimers(const std::filesystem::path& output,
@@ -96,23 +155,45 @@ class ElapsedTimeRecorder {
   //! Whether or not timers log to console
   bool disable_output;
 
- private:
-  struct TimePoint {
-    uint64_t timestamp;
-    std::chrono::time_point<std::chrono::high_resolution_clock> now;
-  };
+  //! Whether or not to keep every measurement for logTimers (histograms are always kept)
+  bool keep_raw_measurements;
+
+  struct ThreadState;
+  struct TimerState;
 
+ private:
   ElapsedTimeRecorder();
 
-  void add(const std::string& name,
+  ThreadState& localState();
+
+  void add(ThreadState& state,
+           TimerId timer,
            const uint64_t timestamp,
-           const std::chrono::nanoseconds elapsed);
+           const std::chrono::nanoseconds elapsed,
+           int64_t order);
+
+  //! Merge the state of every thread for the requested timers
+  std::map<TimerId, TimerState> collect(std::optional<TimerId> timer = std::nullopt,
+                                        bool with_measurements = false) const;
+
+  std::optional<TimerId> findTimerId(const std::string& timer_name) const;
+
+  std::string getTimerName(TimerId timer) const;
 
-  mutable std::mutex mutex_;
   static std::unique_ptr<ElapsedTimeRecorder> instance_;
 
-  std::map<std::string, TimePoint> starts_;
-  std::map<std::string, std::vector<Entry>> elapsed_;
+  //! Unique ID to invalidate thread-local state when the recorder is reset
+  const uint64_t generation_;
+
+  // timer name interning
+  mutable std::shared_mutex names_mutex_;
+  std::unordered_map<std::string, TimerId> ids_;
+  std::vector<std::string> names_;
+
+  // per-thread measurements; state for exited threads is merged into retired_
+  mutable std::mutex threads_mutex_;
+  mutable std::vector<std::shared_ptr<ThreadState>> threads_;
+  mutable std::shared_ptr<ThreadState> retired_;
 };
 
 class ScopedTimer {
@@ -135,6 +216,7 @@ class ScopedTimer {
 
  private:
   std::string name_;
+  std::optional<ElapsedTimeRecorder::TimerId> id_;
   uint64_t timestamp_;
   bool verbose_;
   int verbosity_;
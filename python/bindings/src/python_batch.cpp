@@ -44,6 +44,8 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl/filesystem.h>
 
+#include <optional>
+
 #include "hydra/bindings/glog_utilities.h"
 
 namespace hydra::python {
@@ -53,11 +55,16 @@ class PythonBatchPipeline : public BatchPipeline {
   struct Config : PipelineConfig {
     config::VirtualConfig<GraphBuilder> frontend;
     RoomFinderConfig room_finder;
+    BatchTilingConfig tiling;
   } const config;
 
   PythonBatchPipeline(const Config& config, int robot_id = 0);
   virtual ~PythonBatchPipeline() = default;
   DynamicSceneGraph::Ptr construct(const VolumetricMap& map) const;
+  DynamicSceneGraph::Ptr constructTiled(const VolumetricMap& map,
+                                        double tile_size_m,
+                                        std::optional<double> overlap_m,
+                                        std::optional<int> num_threads) const;
 };
 
 void declare_config(PythonBatchPipeline::Config& config) {
@@ -66,6 +73,7 @@ void declare_config(PythonBatchPipeline::Config& config) {
   base<PipelineConfig>(config);
   field(config.frontend, "frontend");
   field(config.room_finder, "backend/room_finder");
+  field(config.tiling, "tiling");
 }
 
 PythonBatchPipeline::PythonBatchPipeline(const Config& config, int robot_id)
@@ -76,7 +84,23 @@ PythonBatchPipeline::PythonBatchPipeline(const Config& config, int robot_id)
 
 DynamicSceneGraph::Ptr PythonBatchPipeline::construct(const VolumetricMap& map) const {
   const auto new_map = map.clone();
-  return BatchPipeline::construct(config.frontend, *new_map, &config.room_finder);
+  return BatchPipeline::construct(
+      config.frontend, *new_map, &config.room_finder, &config.tiling);
+}
+
+DynamicSceneGraph::Ptr PythonBatchPipeline::constructTiled(
+    const VolumetricMap& map,
+    double tile_size_m,
+    std::optional<double> overlap_m,
+    std::optional<int> num_threads) const {
+  auto tiling = config.tiling;
+  tiling.tile_size_m = tile_size_m;
+  tiling.overlap_m = overlap_m.value_or(tiling.overlap_m);
+  tiling.num_threads = num_threads.value_or(tiling.num_threads);
+
+  const auto new_map = map.clone();
+  return BatchPipeline::construct(
+      config.frontend, *new_map, &config.room_finder, &tiling);
 }
 
 namespace python_batch {
@@ -112,7 +136,13 @@ void addBindings(pybind11::module_& m) {
           },
           "config"_a,
           "robot_id"_a = 0)
-      .def("construct", &PythonBatchPipeline::construct);
+      .def("construct", &PythonBatchPipeline::construct)
+      .def("construct_tiled",
+           &PythonBatchPipeline::constructTiled,
+           "map"_a,
+           "tile_size_m"_a,
+           "overlap_m"_a = std::nullopt,
+           "num_threads"_a = std::nullopt);
 }
 
 }  // namespace python_batch
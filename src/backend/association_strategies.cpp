@@ -39,6 +39,9 @@
 #include <config_utilities/factory.h>
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <optional>
+
 namespace hydra::association {
 namespace {
 
@@ -69,44 +72,115 @@ static const auto semantic_nearest_node_reg =
                                    SemanticNearestNode::Config,
                                    const SceneGraphLayer&>("SemanticNearestNode");
 
+// NOTE(nathan) only archived nodes are merge targets (active nodes are merge sources)
+inline const SceneGraphNode* findArchived(const SceneGraphLayer& layer,
+                                          NodeId node_id) {
+  const auto node = layer.findNode(node_id);
+  return node && !node->attributes().is_active ? node : nullptr;
+}
+
+template <typename Container>
+NodeSubsetView resolveArchived(const SceneGraphLayer& layer,
+                               const Container& candidates,
+                               NodeId query) {
+  NodeSubsetView::Nodes nodes;
+  for (const auto node_id : candidates) {
+    if (node_id == query) {
+      continue;
+    }
+
+    // the cached indices can be slightly out of date
+    const auto node = findArchived(layer, node_id);
+    if (node) {
+      nodes.push_back(node);
+    }
+  }
+
+  return NodeSubsetView(std::move(nodes));
+}
+
+inline std::optional<SemanticNodeAttributes::Label> getLabel(
+    const SceneGraphNode& node) {
+  const auto attrs = node.tryAttributes<SemanticNodeAttributes>();
+  return attrs ? std::optional(attrs->semantic_label) : std::nullopt;
+}
+
 }  // namespace
 
 void declare_config(Pairwise::Config&) { config::name("Pairwise::Config"); }
 
-LayerView Pairwise::candidates(const SceneGraphLayer& layer,
-                               const SceneGraphNode& node) const {
-  return LayerView(layer, [&node](const auto& other) {
-    if (other.id == node.id) {
-      return false;
+Pairwise::Pairwise(const Config, const SceneGraphLayer& layer) {
+  for (const auto& [node_id, node] : layer.nodes()) {
+    if (!node->attributes().is_active) {
+      archived.insert(node_id);
     }
+  }
+}
+
+bool Pairwise::update(const SceneGraphLayer& layer,
+                      const std::vector<NodeId>& changed) {
+  for (const auto node_id : changed) {
+    if (findArchived(layer, node_id)) {
+      archived.insert(node_id);
+    } else {
+      archived.erase(node_id);
+    }
+  }
 
-    // NOTE(nathan) this results in some of the nodes on the boundary of the active
-    // window being considered as merge targets and sources, but it should be fine
-    return !other.attributes().is_active;
-  });
+  return true;
+}
+
+NodeSubsetView Pairwise::candidates(const SceneGraphLayer& layer,
+                                    const SceneGraphNode& node) const {
+  // NOTE(nathan) this results in some of the nodes on the boundary of the active
+  // window being considered as merge targets and sources, but it should be fine
+  return resolveArchived(layer, archived, node.id);
 }
 
 void declare_config(SemanticPairwise::Config&) {
   config::name("SemanticPairwise::Config");
 }
 
-LayerView SemanticPairwise::candidates(const SceneGraphLayer& layer,
-                                       const SceneGraphNode& node) const {
-  return LayerView(layer, [&node](const SceneGraphNode& other) {
-    if (node.id == other.id) {
-      return false;
+SemanticPairwise::SemanticPairwise(const Config, const SceneGraphLayer& layer) {
+  std::vector<NodeId> nodes;
+  for (const auto& [node_id, node] : layer.nodes()) {
+    nodes.push_back(node_id);
+  }
+
+  update(layer, nodes);
+}
+
+bool SemanticPairwise::update(const SceneGraphLayer& layer,
+                              const std::vector<NodeId>& changed) {
+  for (const auto node_id : changed) {
+    const auto node = findArchived(layer, node_id);
+    const auto label = node ? getLabel(*node) : std::nullopt;
+    const auto prev = labels.find(node_id);
+    if (prev != labels.end() && (!label || prev->second != *label)) {
+      archived[prev->second].erase(node_id);
+      labels.erase(prev);
     }
 
-    const auto& lhs_attrs = node.attributes<SemanticNodeAttributes>();
-    const auto& rhs_attrs = other.attributes<SemanticNodeAttributes>();
-    if (rhs_attrs.is_active) {
-      // NOTE(nathan) we don't catch all "active window" nodes with this, but it should
-      // be fine
-      return false;
+    if (label) {
+      archived[*label].insert(node_id);
+      labels[node_id] = *label;
     }
+  }
+
+  return true;
+}
+
+NodeSubsetView SemanticPairwise::candidates(const SceneGraphLayer& layer,
+                                            const SceneGraphNode& node) const {
+  // NOTE(nathan) we don't catch all "active window" nodes with this, but it should
+  // be fine
+  const auto label = getLabel(node);
+  const auto iter = label ? archived.find(*label) : archived.end();
+  if (iter == archived.end()) {
+    return {};
+  }
 
-    return lhs_attrs.semantic_label == rhs_attrs.semantic_label;
-  });
+  return resolveArchived(layer, iter->second, node.id);
 }
 
 void declare_config(NearestNode::Config& config) {
@@ -119,30 +193,45 @@ NearestNode::NearestNode(const Config& config, const SceneGraphLayer& layer)
     : config(config) {
   // TODO(nathan) this used to filter by real_place, but there's no way to do that.
   // (it should be fine generally, but might cause weirdness with the frontiers)
-  node_finder = NearestNodeFinder::fromLayer(
-      layer, [](const SceneGraphNode& node) { return !node.attributes().is_active; });
+  for (const auto& [node_id, node] : layer.nodes()) {
+    if (!node->attributes().is_active) {
+      node_finder.insert(node_id, node->attributes().position);
+    }
+  }
 }
 
 NearestNode::~NearestNode() = default;
 
-LayerView NearestNode::candidates(const SceneGraphLayer& layer,
-                                  const SceneGraphNode& node) const {
-  if (!node_finder) {
-    return {};
+bool NearestNode::update(const SceneGraphLayer& layer,
+                         const std::vector<NodeId>& changed) {
+  for (const auto node_id : changed) {
+    const auto node = findArchived(layer, node_id);
+    if (node) {
+      node_finder.insert(node_id, node->attributes().position);
+    } else {
+      node_finder.erase(node_id);
+    }
   }
 
-  const auto& from_attrs = node.attributes();
+  return true;
+}
 
-  std::set<NodeId> candidates;
-  node_finder->find(
-      from_attrs.position,
-      config.num_merges_to_consider,
-      !from_attrs.is_active,
-      [&candidates](NodeId place_id, size_t, double) { candidates.insert(place_id); });
+NodeSubsetView NearestNode::candidates(const SceneGraphLayer& layer,
+                                       const SceneGraphNode& node) const {
+  // ask for one more candidate if the node is its own nearest neighbor
+  const auto self = node_finder.contains(node.id) ? 1 : 0;
+  std::vector<NodeId> candidates;
+  node_finder.find(node.attributes().position,
+                   config.num_merges_to_consider + self,
+                   [&](NodeId other, size_t, double) {
+                     if (other != node.id &&
+                         candidates.size() < config.num_merges_to_consider) {
+                       candidates.push_back(other);
+                     }
+                   });
 
-  // NOTE(nathan) bind by copy required (otherwise reference goes out of scope...)
-  return LayerView(
-      layer, [candidates](const auto& node) { return candidates.count(node.id); });
+  std::sort(candidates.begin(), candidates.end());
+  return resolveArchived(layer, candidates, node.id);
 }
 
 void declare_config(SemanticNearestNode::Config& config) {
@@ -154,30 +243,58 @@ void declare_config(SemanticNearestNode::Config& config) {
 SemanticNearestNode::SemanticNearestNode(const Config& config,
                                          const SceneGraphLayer& layer)
     : config(config) {
-  makeSemanticNodeFinders(layer, node_finders);
+  std::vector<NodeId> nodes;
+  for (const auto& [node_id, node] : layer.nodes()) {
+    nodes.push_back(node_id);
+  }
+
+  update(layer, nodes);
 }
 
 SemanticNearestNode::~SemanticNearestNode() = default;
 
-LayerView SemanticNearestNode::candidates(const SceneGraphLayer& layer,
-                                          const SceneGraphNode& node) const {
-  const auto& from_attrs = node.attributes<SemanticNodeAttributes>();
-  const auto iter = node_finders.find(from_attrs.semantic_label);
+bool SemanticNearestNode::update(const SceneGraphLayer& layer,
+                                 const std::vector<NodeId>& changed) {
+  for (const auto node_id : changed) {
+    const auto node = findArchived(layer, node_id);
+    const auto label = node ? getLabel(*node) : std::nullopt;
+    const auto prev = labels.find(node_id);
+    if (prev != labels.end() && (!label || prev->second != *label)) {
+      node_finders[prev->second].erase(node_id);
+      labels.erase(prev);
+    }
+
+    if (label) {
+      node_finders[*label].insert(node_id, node->attributes().position);
+      labels[node_id] = *label;
+    }
+  }
+
+  return true;
+}
+
+NodeSubsetView SemanticNearestNode::candidates(const SceneGraphLayer& layer,
+                                               const SceneGraphNode& node) const {
+  const auto label = getLabel(node);
+  const auto iter = label ? node_finders.find(*label) : node_finders.end();
   if (iter == node_finders.end()) {
     return {};
   }
 
-  std::set<NodeId> candidates;
-  (*iter).second->find(from_attrs.position,
-                       config.num_merges_to_consider,
-                       !from_attrs.is_active,
-                       [&candidates](NodeId object_id, size_t, double) {
-                         candidates.insert(object_id);
-                       });
-
-  // NOTE(nathan) bind by copy required (otherwise reference goes out of scope...)
-  return LayerView(
-      layer, [candidates](const auto& node) { return candidates.count(node.id); });
+  const auto& finder = iter->second;
+  const auto self = finder.contains(node.id) ? 1 : 0;
+  std::vector<NodeId> candidates;
+  finder.find(node.attributes().position,
+              config.num_merges_to_consider + self,
+              [&](NodeId other, size_t, double) {
+                if (other != node.id &&
+                    candidates.size() < config.num_merges_to_consider) {
+                  candidates.push_back(other);
+                }
+              });
+
+  std::sort(candidates.begin(), candidates.end());
+  return resolveArchived(layer, candidates, node.id);
 }
 
 }  // namespace hydra::association
@@ -58,6 +58,9 @@ using pose_graph_tools::PoseGraph;
 
 namespace {
 
+//! Number of graph updates that changes are kept around for
+constexpr uint64_t kChangeHistory = 10;
+
 static const auto registration =
     config::RegistrationWithConfig<BackendModule,
                                    BackendModule,
@@ -117,7 +120,8 @@ BackendModule::BackendModule(const Config& config,
       private_dsg_(dsg),
       state_(state),
       external_lc_receiver_(config.external_loop_closures,
-                            &PipelineQueues::instance().external_loop_closure_queue) {
+                            &PipelineQueues::instance().external_loop_closure_queue,
+                            &graph_changes_) {
   // set up frontend graph copy
   unmerged_graph_ = private_dsg_->graph->clone();
   private_dsg_->graph->setMesh(GlobalInfo::instance().createMesh());
@@ -262,7 +266,8 @@ bool BackendModule::spinOnce(bool force_update) {
     optimize(timestamp_ns);
   } else {
     updateDsgMesh(timestamp_ns);
-    UpdateInfo::ConstPtr info(new UpdateInfo{timestamp_ns});
+    UpdateInfo::Ptr info(new UpdateInfo{timestamp_ns});
+    info->changes = &graph_changes_;
     dsg_updater_->callUpdateFunctions(timestamp_ns, info);
   }
 
@@ -446,6 +451,12 @@ bool BackendModule::updatePrivateDsg(size_t timestamp_ns, bool force_update) {
     unmerged_graph_->mergeGraph(*shared_dsg.graph);
   }  // end joint critical section
 
+  // keep a few updates worth of changes for functors that skip an update
+  const auto sequence = graph_changes_.observe(*unmerged_graph_);
+  if (sequence > kChangeHistory) {
+    graph_changes_.trim(sequence - kChangeHistory);
+  }
+
   backend_graph_logger_.logGraph(*private_dsg_->graph);
   return true;
 }
@@ -508,12 +519,14 @@ void BackendModule::updateAgentNodeMeasurements(const PoseGraph& meas) {
 void BackendModule::optimize(size_t timestamp_ns, bool force_find_merge) {
   if (config.add_places_to_deformation_graph) {
     const auto vertex_key = GlobalInfo::instance().getRobotPrefix().vertex_key;
-    addPlacesToDeformationGraph(*unmerged_graph_,
-                                timestamp_ns,
-                                *deformation_graph_,
-                                config.pgmo.place_edge_variance,
-                                config.pgmo.place_mesh_variance,
-                                [vertex_key](auto) { return vertex_key; });
+    place_factors_.update(*unmerged_graph_,
+                          timestamp_ns,
+                          *deformation_graph_,
+                          config.pgmo.place_edge_variance,
+                          config.pgmo.place_mesh_variance,
+                          [vertex_key](auto) { return vertex_key; },
+                          &graph_changes_,
+                          have_new_loopclosures_);
   }
 
   {  // timer scope
@@ -532,7 +545,8 @@ void BackendModule::optimize(size_t timestamp_ns, bool force_find_merge) {
                                            {},
                                            deformation_graph_.get(),
                                            nullptr,
-                                           mesh_offsets_});
+                                           mesh_offsets_,
+                                           &graph_changes_});
   dsg_updater_->callUpdateFunctions(timestamp_ns, info);
   have_new_loopclosures_ = false;
 }
@@ -108,7 +108,7 @@ void DeformationInterpolator::interpolateNodePositions(
     const DynamicSceneGraph& unmerged,
     DynamicSceneGraph& dsg,
     const UpdateInfo::ConstPtr& info,
-    const LayerView& view) const {
+    const NodeSubsetView& view) const {
   if (!info->deformation_graph) {
     return;
   }
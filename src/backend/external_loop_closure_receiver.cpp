@@ -40,6 +40,8 @@
 #include <spark_dsg/node_attributes.h>
 #include <spark_dsg/node_symbol.h>
 
+#include <algorithm>
+
 namespace hydra {
 
 using LookupResult = ExternalLoopClosureReceiver::LookupResult;
@@ -59,15 +61,6 @@ inline double convertToSeconds(std::chrono::nanoseconds time_ns) {
   return std::chrono::duration_cast<std::chrono::duration<double>>(time_ns).count();
 }
 
-inline std::chrono::nanoseconds getLastStamp(const SceneGraphLayer& layer) {
-  auto last = std::max_element(
-      layer.nodes().begin(), layer.nodes().end(), [](const auto& lhs, const auto& rhs) {
-        return getAgentTimestamp(*lhs.second) < getAgentTimestamp(*rhs.second);
-      });
-  return last == layer.nodes().end() ? std::chrono::nanoseconds(0)
-                                     : getAgentTimestamp(*last->second);
-}
-
 }  // namespace
 
 void declare_config(ExternalLoopClosureReceiver::Config& config) {
@@ -79,46 +72,138 @@ void declare_config(ExternalLoopClosureReceiver::Config& config) {
 }
 
 ExternalLoopClosureReceiver::ExternalLoopClosureReceiver(const Config& config,
-                                                         Queue* const queue)
-    : config(config), input_queue_(queue) {
+                                                         Queue* const queue,
+                                                         const GraphChangeLog* changes)
+    : config(config), input_queue_(queue), changes_(changes) {
   LOG_IF(WARNING, !input_queue_) << "External loop closures disabled!";
 }
 
-LookupResult ExternalLoopClosureReceiver::findClosest(const DynamicSceneGraph& graph,
-                                                      uint64_t stamp_ns,
-                                                      int robot_id,
-                                                      double max_diff_s) const {
+void ExternalLoopClosureReceiver::AgentIndex::clear() {
+  layer = nullptr;
+  last_id = 0;
+  sequence.reset();
+  stamps.clear();
+}
+
+bool ExternalLoopClosureReceiver::PendingClosure::operator>(
+    const PendingClosure& other) const {
+  return stamp == other.stamp ? order > other.order : stamp > other.stamp;
+}
+
+size_t ExternalLoopClosureReceiver::numPending() const {
+  size_t total = 0;
+  for (const auto& [robot_id, queue] : pending_) {
+    total += queue.size();
+  }
+
+  return total;
+}
+
+void ExternalLoopClosureReceiver::syncIndex(const SceneGraphLayer& layer,
+                                            AgentIndex& index) const {
+  if (index.layer != &layer || layer.numNodes() < index.stamps.size()) {
+    index.clear();
+    index.layer = &layer;
+  }
+
+  bool removed = false;
+  if (changes_) {
+    const auto sequence = changes_->sequence();
+    if (index.sequence && changes_->covers(*index.sequence)) {
+      // the change log tells us whether any node of the layer was added or removed
+      bool changed = false;
+      for (const auto& entry : changes_->changesSince(*index.sequence)) {
+        if (entry.layer && *entry.layer != layer.id) {
+          continue;
+        }
+
+        changed |= entry.change != GraphChangeLog::Change::DEACTIVATED;
+        removed |= entry.change == GraphChangeLog::Change::REMOVED;
+      }
+
+      if (!changed) {
+        index.sequence = sequence;
+        return;
+      }
+    }
+
+    index.sequence = sequence;
+  }
+
+  // agent nodes are keyed by increasing IDs, so only nodes after the last indexed ID
+  // should be new
+  const auto& nodes = layer.nodes();
+  auto iter = index.stamps.empty() ? nodes.begin() : nodes.upper_bound(index.last_id);
+  const auto num_new = static_cast<size_t>(std::distance(iter, nodes.end()));
+  if (removed || index.stamps.size() + num_new != layer.numNodes()) {
+    // nodes were inserted out of order or removed: reindex everything
+    index.stamps.clear();
+    index.last_id = 0;
+    iter = nodes.begin();
+  }
+
+  const auto num_sorted = index.stamps.size();
+  for (; iter != nodes.end(); ++iter) {
+    index.stamps.emplace_back(getAgentTimestamp(*iter->second), iter->first);
+    index.last_id = std::max(index.last_id, iter->first);
+  }
+
+  const auto middle = index.stamps.begin() + num_sorted;
+  std::sort(middle, index.stamps.end());
+  std::inplace_merge(index.stamps.begin(), middle, index.stamps.end());
+}
+
+const ExternalLoopClosureReceiver::AgentIndex* ExternalLoopClosureReceiver::getIndex(
+    const DynamicSceneGraph& graph, int robot_id) const {
   const auto prefix = kimera_pgmo::GetRobotPrefix(robot_id);
   const auto layer_id = graph.getLayerKey(config.layer)->layer;
   const auto layer = graph.findLayer(layer_id, prefix);
   if (!layer) {
-    LOG(WARNING) << "Missing robot " << robot_id << " for external loop closure";
-    return {};
+    return nullptr;
   }
 
-  const auto stamp = std::chrono::nanoseconds(stamp_ns);
-  const auto last_stamp = getLastStamp(*layer);
-  if (stamp > last_stamp) {
-    // avoid clearing loop closure before best candidate node can be determined
+  auto& index = agent_indices_[robot_id];
+  syncIndex(*layer, index);
+  return &index;
+}
+
+LookupResult ExternalLoopClosureReceiver::findClosest(const DynamicSceneGraph& graph,
+                                                      uint64_t stamp_ns,
+                                                      int robot_id,
+                                                      double max_diff_s) const {
+  const auto index = getIndex(graph, robot_id);
+  if (!index) {
+    LOG(WARNING) << "Missing robot " << robot_id << " for external loop closure";
     return {};
   }
 
-  auto closest =
-      std::min_element(layer->nodes().begin(),
-                       layer->nodes().end(),
-                       [stamp](const auto& lhs, const auto& rhs) {
-                         const auto diff_lhs = getAgentTimestamp(*lhs.second) - stamp;
-                         const auto diff_rhs = getAgentTimestamp(*rhs.second) - stamp;
-                         return std::abs(diff_lhs.count()) < std::abs(diff_rhs.count());
-                       });
-  if (closest == layer->nodes().end()) {
+  const auto& stamps = index->stamps;
+  if (stamps.empty()) {
     VLOG(1) << "No nodes exist for robot " << robot_id << "' when looking up timestamp "
             << stamp_ns << " [ns]";
     return {};
   }
 
-  const NodeSymbol best_id(closest->second->id);
-  const auto best_stamp = getAgentTimestamp(*closest->second);
+  const auto stamp = Stamp(stamp_ns);
+  if (stamp > stamps.back().first) {
+    // avoid clearing loop closure before best candidate node can be determined
+    return {};
+  }
+
+  // first node at or after the stamp; the node before it may be closer
+  auto closest = std::lower_bound(
+      stamps.begin(), stamps.end(), stamp, [](const auto& entry, const Stamp& value) {
+        return entry.first < value;
+      });
+  if (closest != stamps.begin()) {
+    const auto prev = std::prev(closest);
+    if (stamp - prev->first <= closest->first - stamp) {
+      closest = prev;
+    }
+  }
+
+  const NodeSymbol best_id(closest->second);
+  const auto best_stamp = closest->first;
   const auto diff_s = convertToSeconds(best_stamp - stamp);
   VLOG(5) << "Found node " << best_id.str() << " with difference of " << diff_s
           << " [s] for timestamp " << stamp_ns << " [ns]";
@@ -140,18 +225,36 @@ void ExternalLoopClosureReceiver::update(const DynamicSceneGraph& graph,
     return;
   }
 
+  std::vector<PendingClosure> ready;
   while (!input_queue_->empty()) {
     const auto pose_graph = input_queue_->pop();
     for (const auto& edge : pose_graph.edges) {
-      loop_closures_.push_back(edge);
+      ready.push_back({Stamp(0), num_received_++, edge});
+    }
+  }
+
+  // only retry closures that the trajectory of the robot they wait on has reached
+  for (auto& [robot_id, queue] : pending_) {
+    const auto index = getIndex(graph, robot_id);
+    if (!index || index->stamps.empty()) {
+      continue;
+    }
+
+    const auto last_stamp = index->stamps.back().first;
+    while (!queue.empty() && queue.top().stamp <= last_stamp) {
+      ready.push_back(queue.top());
+      queue.pop();
     }
   }
 
-  auto iter = loop_closures_.begin();
-  while (iter != loop_closures_.end()) {
-    const auto& edge = *iter;
-    const auto max_diff_s = config.max_time_difference;
+  // process closures in the order they were received
+  std::sort(ready.begin(), ready.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.order < rhs.order;
+  });
 
+  const auto max_diff_s = config.max_time_difference;
+  for (auto& closure : ready) {
+    const auto& edge = closure.edge;
     // NOTE(hlim) the pose graph edge IDs contain the loop closure timestamps, not the
     // keyframe IDs
     const auto from_node =
@@ -160,20 +263,24 @@ void ExternalLoopClosureReceiver::update(const DynamicSceneGraph& graph,
     if (from_node.status == LookupResult::Status::INVALID ||
         to_node.status == LookupResult::Status::INVALID) {
       LOG(WARNING) << "Dropped external loop closure: " << edge;
-      iter = loop_closures_.erase(iter);
       continue;
     }
 
     // delay adding loop closure until best nodes can be determined
-    if (from_node.status == LookupResult::Status::UNKNOWN ||
-        to_node.status == LookupResult::Status::UNKNOWN) {
-      ++iter;
+    if (from_node.status == LookupResult::Status::UNKNOWN) {
+      closure.stamp = Stamp(edge.key_from);
+      pending_[edge.robot_from].push(closure);
+      continue;
+    }
+
+    if (to_node.status == LookupResult::Status::UNKNOWN) {
+      closure.stamp = Stamp(edge.key_to);
+      pending_[edge.robot_to].push(closure);
       continue;
     }
 
     // to_id, from_id, to_T_from
     callback(to_node.id, from_node.id, gtsam::Pose3(edge.pose.matrix()));
-    iter = loop_closures_.erase(iter);
   }
 }
 
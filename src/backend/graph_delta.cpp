@@ -0,0 +1,678 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/backend/graph_delta.h"
+
+#include <glog/logging.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+#include "hydra_build_config.h"
+
+#if defined(HYDRA_USE_LZ4) && HYDRA_USE_LZ4
+#include <lz4.h>
+#endif
+
+#if defined(HYDRA_USE_ZSTD) && HYDRA_USE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace hydra {
+
+namespace {
+
+using EdgeKey = GraphDelta::EdgeKey;
+
+inline constexpr uint8_t kMagic[4] = {'H', 'D', 'L', 'T'};
+inline constexpr uint8_t kVersion = 1;
+inline constexpr size_t kHeaderSize = 4 + 4 + 3 * sizeof(uint64_t);
+// upper bound on the decoded payload to reject corrupt size fields before allocating
+inline constexpr uint64_t kMaxPayloadSize = uint64_t(1) << 32;
+// LZ4 cannot expand a block by more than this factor
+inline constexpr uint64_t kMaxLz4Ratio = 255;
+
+template <typename Func>
+void forEachLayer(const DynamicSceneGraph& graph, const Func& func) {
+  for (const auto& [layer_id, layer] : graph.layers()) {
+    func(*layer);
+  }
+
+  for (const auto& [layer_id, partitions] : graph.layer_partitions()) {
+    for (const auto& [partition_id, layer] : partitions) {
+      func(*layer);
+    }
+  }
+}
+
+template <typename Func>
+void forEachEdge(const DynamicSceneGraph& graph, const Func& func) {
+  forEachLayer(graph, [&func](const SceneGraphLayer& layer) {
+    for (const auto& [key, edge] : layer.edges()) {
+      func(edge);
+    }
+  });
+
+  for (const auto& [key, edge] : graph.interlayer_edges()) {
+    func(edge);
+  }
+}
+
+template <typename T>
+void writeValue(std::vector<uint8_t>& buffer, const T& value) {
+  const auto offset = buffer.size();
+  buffer.resize(offset + sizeof(T));
+  std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+bool readValue(const uint8_t*& pos, const uint8_t* end, T& value) {
+  if (static_cast<size_t>(end - pos) < sizeof(T)) {
+    return false;
+  }
+
+  std::memcpy(&value, pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+DeltaCompression resolveCompression(DeltaCompression requested) {
+  if (compressionAvailable(requested)) {
+    return requested;
+  }
+
+  LOG_FIRST_N(WARNING, 1) << "Requested graph delta compression "
+                          << static_cast<int>(requested)
+                          << " not available in this build; sending uncompressed";
+  return DeltaCompression::NONE;
+}
+
+bool compress(DeltaCompression compression,
+              const std::vector<uint8_t>& input,
+              std::vector<uint8_t>& output) {
+  switch (compression) {
+#if defined(HYDRA_USE_LZ4) && HYDRA_USE_LZ4
+    case DeltaCompression::LZ4: {
+      const auto offset = output.size();
+      output.resize(offset + LZ4_compressBound(input.size()));
+      const int size =
+          LZ4_compress_default(reinterpret_cast<const char*>(input.data()),
+                               reinterpret_cast<char*>(output.data() + offset),
+                               input.size(),
+                               output.size() - offset);
+      output.resize(offset + std::max(size, 0));
+      return size > 0;
+    }
+#endif
+#if defined(HYDRA_USE_ZSTD) && HYDRA_USE_ZSTD
+    case DeltaCompression::ZSTD: {
+      const auto offset = output.size();
+      output.resize(offset + ZSTD_compressBound(input.size()));
+      const size_t size = ZSTD_compress(output.data() + offset,
+                                        output.size() - offset,
+                                        input.data(),
+                                        input.size(),
+                                        1);
+      if (ZSTD_isError(size)) {
+        output.resize(offset);
+        return false;
+      }
+
+      output.resize(offset + size);
+      return true;
+    }
+#endif
+    case DeltaCompression::NONE:
+      output.insert(output.end(), input.begin(), input.end());
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool decompress(DeltaCompression compression,
+                const uint8_t* input,
+                size_t input_size,
+                std::vector<uint8_t>& output) {
+  switch (compression) {
+#if defined(HYDRA_USE_LZ4) && HYDRA_USE_LZ4
+    case DeltaCompression::LZ4: {
+      const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(input),
+                                           reinterpret_cast<char*>(output.data()),
+                                           input_size,
+                                           output.size());
+      return size >= 0 && static_cast<size_t>(size) == output.size();
+    }
+#endif
+#if defined(HYDRA_USE_ZSTD) && HYDRA_USE_ZSTD
+    case DeltaCompression::ZSTD: {
+      const size_t size =
+          ZSTD_decompress(output.data(), output.size(), input, input_size);
+      return !ZSTD_isError(size) && size == output.size();
+    }
+#endif
+    case DeltaCompression::NONE:
+      if (input_size != output.size()) {
+        return false;
+      }
+
+      std::memcpy(output.data(), input, input_size);
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool payloadSizeValid(DeltaCompression compression,
+                      uint64_t payload_size,
+                      const uint8_t* input,
+                      size_t input_size) {
+  if (payload_size > kMaxPayloadSize) {
+    return false;
+  }
+
+  switch (compression) {
+    case DeltaCompression::NONE:
+      return payload_size == input_size;
+    case DeltaCompression::LZ4:
+      return payload_size <= kMaxLz4Ratio * input_size;
+#if defined(HYDRA_USE_ZSTD) && HYDRA_USE_ZSTD
+    case DeltaCompression::ZSTD:
+      // encode always writes the content size into the frame header
+      return ZSTD_getFrameContentSize(input, input_size) == payload_size;
+#endif
+    default:
+      return false;
+  }
+}
+
+void copyVertex(const Mesh& src, size_t i, Mesh& dst, size_t j) {
+  dst.setPos(j, src.pos(i));
+  if (src.has_colors && dst.has_colors) {
+    dst.setColor(j, src.color(i));
+  }
+
+  if (src.has_timestamps && dst.has_timestamps) {
+    dst.setTimestamp(j, src.timestamp(i));
+  }
+
+  if (src.has_labels && dst.has_labels) {
+    dst.setLabel(j, src.label(i));
+  }
+
+  if (src.has_first_seen_stamps && dst.has_first_seen_stamps) {
+    dst.setFirstSeenTimestamp(j, src.firstSeenTimestamp(i));
+  }
+}
+
+bool vertexEqual(const Mesh& lhs, size_t i, const Mesh& rhs, size_t j) {
+  return lhs.pos(i) == rhs.pos(j) &&
+         (!lhs.has_colors || lhs.color(i) == rhs.color(j)) &&
+         (!lhs.has_timestamps || lhs.timestamp(i) == rhs.timestamp(j)) &&
+         (!lhs.has_labels || lhs.label(i) == rhs.label(j)) &&
+         (!lhs.has_first_seen_stamps ||
+          lhs.firstSeenTimestamp(i) == rhs.firstSeenTimestamp(j));
+}
+
+Mesh::Ptr makeMesh(const Mesh& like) {
+  return std::make_shared<Mesh>(like.has_colors,
+                                like.has_timestamps,
+                                like.has_labels,
+                                like.has_first_seen_stamps);
+}
+
+// copies all vertices and faces of src after the source offsets into dst starting at
+// the destination offsets, resizing dst to fit exactly
+void copyMeshRange(const Mesh& src,
+                   size_t src_vertex,
+                   size_t src_face,
+                   Mesh& dst,
+                   size_t dst_vertex,
+                   size_t dst_face) {
+  dst.resizeVertices(dst_vertex + src.numVertices() - src_vertex);
+  for (size_t i = src_vertex; i < src.numVertices(); ++i) {
+    copyVertex(src, i, dst, dst_vertex + i - src_vertex);
+  }
+
+  dst.resizeFaces(dst_face + src.numFaces() - src_face);
+  for (size_t i = src_face; i < src.numFaces(); ++i) {
+    dst.face(dst_face + i - src_face) = src.face(i);
+  }
+}
+
+bool sameLayout(const Mesh& lhs, const Mesh& rhs) {
+  return lhs.has_colors == rhs.has_colors && lhs.has_timestamps == rhs.has_timestamps &&
+         lhs.has_labels == rhs.has_labels &&
+         lhs.has_first_seen_stamps == rhs.has_first_seen_stamps;
+}
+
+Mesh::Ptr copyMesh(const Mesh& mesh) {
+  auto copy = makeMesh(mesh);
+  copyMeshRange(mesh, 0, 0, *copy, 0, 0);
+  return copy;
+}
+
+// finds the first vertex and face that differ from the previously sent mesh
+std::optional<GraphDelta::MeshUpdate> diffMesh(const Mesh& mesh, const Mesh* prev) {
+  GraphDelta::MeshUpdate update;
+  update.num_vertices = mesh.numVertices();
+  update.num_faces = mesh.numFaces();
+  if (!prev || !sameLayout(mesh, *prev)) {
+    return update;
+  }
+
+  const auto num_vertices = std::min(mesh.numVertices(), prev->numVertices());
+  while (update.vertex_offset < num_vertices &&
+         vertexEqual(mesh, update.vertex_offset, *prev, update.vertex_offset)) {
+    ++update.vertex_offset;
+  }
+
+  const auto num_faces = std::min(mesh.numFaces(), prev->numFaces());
+  while (update.face_offset < num_faces &&
+         mesh.face(update.face_offset) == prev->face(update.face_offset)) {
+    ++update.face_offset;
+  }
+
+  const bool unchanged = update.vertex_offset == prev->numVertices() &&
+                         update.vertex_offset == update.num_vertices &&
+                         update.face_offset == prev->numFaces() &&
+                         update.face_offset == update.num_faces;
+  return unchanged ? std::nullopt : std::make_optional(update);
+}
+
+}  // namespace
+
+bool compressionAvailable(DeltaCompression compression) {
+  switch (compression) {
+    case DeltaCompression::NONE:
+      return true;
+    case DeltaCompression::LZ4:
+      return HYDRA_USE_LZ4;
+    case DeltaCompression::ZSTD:
+      return HYDRA_USE_ZSTD;
+    default:
+      return false;
+  }
+}
+
+std::vector<uint8_t> GraphDelta::encode(bool include_mesh,
+                                        DeltaCompression compression) const {
+  std::vector<uint8_t> payload;
+  writeValue<uint64_t>(payload, removed_nodes.size());
+  for (const auto node_id : removed_nodes) {
+    writeValue(payload, node_id);
+  }
+
+  writeValue<uint64_t>(payload, removed_edges.size());
+  for (const auto& [source, target] : removed_edges) {
+    writeValue(payload, source);
+    writeValue(payload, target);
+  }
+
+  const bool send_mesh_update = include_mesh && mesh_update;
+  writeValue<uint8_t>(payload, send_mesh_update ? 1 : 0);
+  if (send_mesh_update) {
+    writeValue(payload, mesh_update->num_vertices);
+    writeValue(payload, mesh_update->num_faces);
+    writeValue(payload, mesh_update->vertex_offset);
+    writeValue(payload, mesh_update->face_offset);
+  }
+
+  if (graph) {
+    std::vector<uint8_t> graph_buffer;
+    spark_dsg::io::binary::writeGraph(*graph, graph_buffer, include_mesh);
+    payload.insert(payload.end(), graph_buffer.begin(), graph_buffer.end());
+  }
+
+  compression = resolveCompression(compression);
+
+  std::vector<uint8_t> buffer;
+  buffer.reserve(kHeaderSize + payload.size());
+  buffer.insert(buffer.end(), std::begin(kMagic), std::end(kMagic));
+  buffer.push_back(kVersion);
+  buffer.push_back(keyframe ? 1 : 0);
+  buffer.push_back(static_cast<uint8_t>(compression));
+  buffer.push_back(graph ? 1 : 0);
+  writeValue(buffer, sequence);
+  writeValue(buffer, timestamp_ns);
+  writeValue<uint64_t>(buffer, payload.size());
+
+  if (!compress(compression, payload, buffer)) {
+    LOG(WARNING) << "Failed to compress graph delta; sending uncompressed";
+    buffer.resize(kHeaderSize);
+    buffer[6] = static_cast<uint8_t>(DeltaCompression::NONE);
+    buffer.insert(buffer.end(), payload.begin(), payload.end());
+  }
+
+  return buffer;
+}
+
+std::optional<GraphDelta> GraphDelta::decode(const uint8_t* buffer, size_t length) {
+  if (!buffer || length < kHeaderSize || std::memcmp(buffer, kMagic, 4) != 0) {
+    LOG(ERROR) << "Invalid graph delta header";
+    return std::nullopt;
+  }
+
+  if (buffer[4] != kVersion) {
+    LOG(ERROR) << "Unsupported graph delta version " << static_cast<int>(buffer[4]);
+    return std::nullopt;
+  }
+
+  GraphDelta delta;
+  delta.keyframe = buffer[5] != 0;
+  const auto compression = static_cast<DeltaCompression>(buffer[6]);
+  const bool has_graph = buffer[7] != 0;
+  if (!compressionAvailable(compression)) {
+    LOG(ERROR) << "Graph delta uses unavailable compression "
+               << static_cast<int>(compression);
+    return std::nullopt;
+  }
+
+  const uint8_t* pos = buffer + 8;
+  const uint8_t* end = buffer + length;
+  uint64_t payload_size = 0;
+  readValue(pos, end, delta.sequence);
+  readValue(pos, end, delta.timestamp_ns);
+  readValue(pos, end, payload_size);
+  if (!payloadSizeValid(compression, payload_size, pos, end - pos)) {
+    LOG(ERROR) << "Invalid payload size " << payload_size << " for graph delta "
+               << delta.sequence;
+    return std::nullopt;
+  }
+
+  std::vector<uint8_t> payload(payload_size);
+  if (!decompress(compression, pos, end - pos, payload)) {
+    LOG(ERROR) << "Failed to decompress graph delta " << delta.sequence;
+    return std::nullopt;
+  }
+
+  pos = payload.data();
+  end = payload.data() + payload.size();
+  uint64_t num_removed = 0;
+  if (!readValue(pos, end, num_removed) ||
+      num_removed > static_cast<size_t>(end - pos) / sizeof(NodeId)) {
+    return std::nullopt;
+  }
+
+  delta.removed_nodes.resize(num_removed);
+  for (auto& node_id : delta.removed_nodes) {
+    readValue(pos, end, node_id);
+  }
+
+  if (!readValue(pos, end, num_removed) ||
+      num_removed > static_cast<size_t>(end - pos) / (2 * sizeof(NodeId))) {
+    return std::nullopt;
+  }
+
+  delta.removed_edges.resize(num_removed);
+  for (auto& [source, target] : delta.removed_edges) {
+    readValue(pos, end, source);
+    readValue(pos, end, target);
+  }
+
+  uint8_t has_mesh_update = 0;
+  if (!readValue(pos, end, has_mesh_update)) {
+    return std::nullopt;
+  }
+
+  if (has_mesh_update) {
+    GraphDelta::MeshUpdate update;
+    if (!readValue(pos, end, update.num_vertices) ||
+        !readValue(pos, end, update.num_faces) ||
+        !readValue(pos, end, update.vertex_offset) ||
+        !readValue(pos, end, update.face_offset) ||
+        update.vertex_offset > update.num_vertices ||
+        update.face_offset > update.num_faces) {
+      return std::nullopt;
+    }
+
+    delta.mesh_update = update;
+  }
+
+  if (has_graph) {
+    try {
+      delta.graph = spark_dsg::io::binary::readGraph(pos, end - pos);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Failed to parse graph delta " << delta.sequence << ": "
+                 << e.what();
+      return std::nullopt;
+    }
+
+    if (!delta.graph) {
+      return std::nullopt;
+    }
+  }
+
+  return delta;
+}
+
+GraphDeltaTracker::GraphDeltaTracker(size_t keyframe_interval)
+    : keyframe_interval_(keyframe_interval) {}
+
+void GraphDeltaTracker::reset() { force_keyframe_ = true; }
+
+GraphDelta GraphDeltaTracker::update(uint64_t timestamp_ns,
+                                     const DynamicSceneGraph& graph) {
+  GraphDelta delta;
+  delta.sequence = next_sequence_++;
+  delta.timestamp_ns = timestamp_ns;
+  delta.keyframe = force_keyframe_ ||
+                   (keyframe_interval_ > 0 && since_keyframe_ >= keyframe_interval_);
+  force_keyframe_ = false;
+  since_keyframe_ = delta.keyframe ? 0 : since_keyframe_ + 1;
+
+  const auto mesh = graph.mesh();
+  if (delta.keyframe) {
+    delta.graph = graph.clone();
+  } else {
+    delta.graph = DynamicSceneGraph::fromNames(graph.layer_names());
+    // only the vertices and faces after the first change are sent
+    delta.mesh_update = mesh ? diffMesh(*mesh, mesh_.get()) : std::nullopt;
+    if (delta.mesh_update) {
+      auto mesh_tail = makeMesh(*mesh);
+      copyMeshRange(*mesh,
+                    delta.mesh_update->vertex_offset,
+                    delta.mesh_update->face_offset,
+                    *mesh_tail,
+                    0,
+                    0);
+      delta.graph->setMesh(mesh_tail);
+    }
+  }
+
+  if (!mesh) {
+    mesh_.reset();
+  } else if (delta.keyframe || !mesh_ || !sameLayout(*mesh, *mesh_)) {
+    mesh_ = copyMesh(*mesh);
+  } else if (delta.mesh_update) {
+    const auto& update = *delta.mesh_update;
+    copyMeshRange(*mesh,
+                  update.vertex_offset,
+                  update.face_offset,
+                  *mesh_,
+                  update.vertex_offset,
+                  update.face_offset);
+  }
+
+  const auto add_node = [&](const SceneGraphNode& node) {
+    if (!delta.keyframe && !delta.graph->hasNode(node.id)) {
+      delta.graph->addOrUpdateNode(
+          node.layer.layer, node.id, node.attributes().clone(), node.layer.partition);
+    }
+  };
+
+  std::unordered_map<NodeId, NodeState> next_nodes;
+  next_nodes.reserve(nodes_.size());
+  forEachLayer(graph, [&](const SceneGraphLayer& layer) {
+    for (const auto& [node_id, node] : layer.nodes()) {
+      auto prev = nodes_.find(node_id);
+      const bool changed = prev == nodes_.end() ||
+                           !(prev->second.layer == node->layer) ||
+                           !(*prev->second.attrs == node->attributes());
+      if (!changed) {
+        next_nodes.emplace(node_id, std::move(prev->second));
+        continue;
+      }
+
+      add_node(*node);
+      next_nodes.emplace(node_id, NodeState{node->layer, node->attributes().clone()});
+    }
+  });
+
+  for (const auto& [node_id, state] : nodes_) {
+    if (!next_nodes.count(node_id)) {
+      delta.removed_nodes.push_back(node_id);
+    }
+  }
+
+  decltype(edges_) next_edges;
+  forEachEdge(graph, [&](const SceneGraphEdge& edge) {
+    const EdgeKey key{edge.source, edge.target};
+    auto prev = edges_.find(key);
+    if (prev != edges_.end() && *prev->second == *edge.info) {
+      next_edges.emplace(key, std::move(prev->second));
+      return;
+    }
+
+    // edges can only be added between nodes present in the delta graph
+    add_node(graph.getNode(edge.source));
+    add_node(graph.getNode(edge.target));
+    if (!delta.keyframe) {
+      delta.graph->insertEdge(edge.source, edge.target, edge.info->clone());
+    }
+
+    next_edges.emplace(key, edge.info->clone());
+  });
+
+  for (const auto& [key, attrs] : edges_) {
+    if (!next_edges.count(key)) {
+      delta.removed_edges.push_back(key);
+    }
+  }
+
+  nodes_ = std::move(next_nodes);
+  edges_ = std::move(next_edges);
+  if (delta.keyframe) {
+    delta.removed_nodes.clear();
+    delta.removed_edges.clear();
+  }
+
+  return delta;
+}
+
+bool GraphDeltaApplier::apply(const GraphDelta& delta) {
+  if (!delta.graph) {
+    LOG(WARNING) << "Dropping graph delta " << delta.sequence << " without graph";
+    return false;
+  }
+
+  if (delta.keyframe) {
+    graph_ = delta.graph->clone();
+    // later deltas patch the mesh in place, so never share it with the message
+    const auto mesh = delta.graph->mesh();
+    graph_->setMesh(mesh ? copyMesh(*mesh) : nullptr);
+    last_sequence_ = delta.sequence;
+    return true;
+  }
+
+  if (!graph_ || !last_sequence_ || delta.sequence != *last_sequence_ + 1) {
+    VLOG(2) << "Dropping graph delta " << delta.sequence
+            << " while waiting for keyframe";
+    return false;
+  }
+
+  const auto mesh_tail = delta.graph->mesh();
+  if (delta.mesh_update) {
+    const auto& update = *delta.mesh_update;
+    const auto mesh = graph_->mesh();
+    const size_t num_vertices = mesh ? mesh->numVertices() : 0;
+    const size_t num_faces = mesh ? mesh->numFaces() : 0;
+    const bool valid = mesh_tail && update.vertex_offset <= num_vertices &&
+                       update.face_offset <= num_faces &&
+                       update.vertex_offset + mesh_tail->numVertices() ==
+                           update.num_vertices &&
+                       update.face_offset + mesh_tail->numFaces() == update.num_faces;
+    if (!valid) {
+      LOG(WARNING) << "Dropping graph delta " << delta.sequence
+                   << " with inconsistent mesh update";
+      return false;
+    }
+  }
+
+  for (const auto& [source, target] : delta.removed_edges) {
+    graph_->removeEdge(source, target);
+  }
+
+  for (const auto node_id : delta.removed_nodes) {
+    graph_->removeNode(node_id);
+  }
+
+  forEachLayer(*delta.graph, [this](const SceneGraphLayer& layer) {
+    for (const auto& [node_id, node] : layer.nodes()) {
+      const auto prev = graph_->findNode(node_id);
+      if (prev && !(prev->layer == node->layer)) {
+        graph_->removeNode(node_id);
+      }
+
+      graph_->addOrUpdateNode(node->layer.layer,
+                              node_id,
+                              node->attributes().clone(),
+                              node->layer.partition);
+    }
+  });
+
+  forEachEdge(*delta.graph, [this](const SceneGraphEdge& edge) {
+    graph_->removeEdge(edge.source, edge.target);
+    graph_->insertEdge(edge.source, edge.target, edge.info->clone());
+  });
+
+  if (delta.mesh_update) {
+    const auto& update = *delta.mesh_update;
+    auto mesh = graph_->mesh();
+    if (!mesh || !sameLayout(*mesh, *mesh_tail)) {
+      // layout changes are always sent as a full mesh (offsets of zero)
+      mesh = makeMesh(*mesh_tail);
+      graph_->setMesh(mesh);
+    }
+
+    copyMeshRange(*mesh_tail, 0, 0, *mesh, update.vertex_offset, update.face_offset);
+  }
+
+  last_sequence_ = delta.sequence;
+  return true;
+}
+
+}  // namespace hydra
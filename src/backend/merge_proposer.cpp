@@ -36,8 +36,14 @@
 #include "hydra/backend/merge_proposer.h"
 
 #include <config_utilities/config.h>
+#include <config_utilities/types/conversions.h>
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <set>
+
+#include "hydra/utils/parallel_utilities.h"
+
 namespace hydra {
 
 namespace {
@@ -58,39 +64,101 @@ std::ostream& operator<<(std::ostream& out, const Merge& merge) {
   return out;
 }
 
+bool AssociationStrategy::update(const SceneGraphLayer&, const std::vector<NodeId>&) {
+  return false;
+}
+
 void declare_config(MergeProposer::Config& config) {
   using namespace config;
   name("MergeProposer::Config");
   config.strategy.setOptional();
   field(config.strategy, "strategy");
+  field<ThreadNumConversion>(config.num_threads, "num_threads");
+  check(config.num_threads, GT, 0, "num_threads");
+}
+
+AssociationStrategy* MergeProposer::getAssociator(const SceneGraphLayer& layer,
+                                                  const GraphChangeLog* changes,
+                                                  bool moved) const {
+  auto& entry = associators_[&layer];
+  const auto sequence =
+      changes ? std::optional<uint64_t>(changes->sequence()) : std::nullopt;
+
+  bool valid = entry.associator && entry.sequence && changes && !moved &&
+               changes->covers(*entry.sequence);
+  if (valid) {
+    auto changed = changes->dirtySince(*entry.sequence, layer.id);
+    changed.insert(changed.end(), entry.merged.begin(), entry.merged.end());
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    valid = entry.associator->update(layer, changed);
+  }
+
+  if (!valid) {
+    entry.associator = config.strategy.create<const SceneGraphLayer&>(layer);
+  }
+
+  entry.sequence = sequence;
+  entry.merged.clear();
+  return entry.associator.get();
 }
 
 void MergeProposer::findMerges(const SceneGraphLayer& layer,
-                               const LayerView& view,
+                               const NodeSubsetView& view,
                                const MergeCheck& should_merge,
-                               MergeList& nodes_to_merge) const {
-  const auto associator = config.strategy.create<const SceneGraphLayer&>(layer);
+                               MergeList& nodes_to_merge,
+                               const GraphChangeLog* changes,
+                               bool moved) const {
+  const auto associator = getAssociator(layer, changes, moved);
   if (!associator) {
     LOG(WARNING) << "Merges enabled, but factory not specified!";
     return;
   }
 
-  for (const auto& node : view) {
-    const auto candidates = associator->candidates(layer, node);
-    if (!candidates) {
-      continue;
+  // look up candidates for every node in parallel
+  const std::vector<const SceneGraphNode*> nodes = [&view]() {
+    std::vector<const SceneGraphNode*> nodes;
+    nodes.reserve(view.size());
+    for (const auto& node : view) {
+      nodes.push_back(&node);
     }
+    return nodes;
+  }();
 
-    for (const auto& other : candidates) {
+  std::vector<std::vector<const SceneGraphNode*>> node_candidates(nodes.size());
+  processInParallel(nodes.size(), config.num_threads, [&](size_t i) {
+    const auto& node = *nodes[i];
+    for (const auto& other : associator->candidates(layer, node)) {
       if (layer.hasEdge(node.id, other.id)) {
         continue;  // avoid merging siblings
       }
 
-      if (should_merge(node, other)) {
-        nodes_to_merge.push_back({node.id, other.id});
+      node_candidates[i].push_back(&other);
+    }
+  });
+
+  // only check each pair once (in order of the view)
+  std::set<std::pair<NodeId, NodeId>> checked;
+  std::vector<NodeId> merged;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const auto& node = *nodes[i];
+    for (const auto other : node_candidates[i]) {
+      if (!checked.insert(std::minmax(node.id, other->id)).second) {
+        continue;
+      }
+
+      if (should_merge(node, *other)) {
+        nodes_to_merge.push_back({node.id, other->id});
+        merged.push_back(node.id);
+        merged.push_back(other->id);
       }
     }
   }
+
+  // merging changes (or removes) nodes, so associators need to look at them again
+  for (auto& [key, entry] : associators_) {
+    entry.merged.insert(entry.merged.end(), merged.begin(), merged.end());
+  }
 }
 
 }  // namespace hydra
@@ -35,22 +35,134 @@
 #include "hydra/backend/mst_factors.h"
 
 #include <glog/logging.h>
-#include <pose_graph_tools/pose_graph.h>
+
+#include <algorithm>
+#include <iterator>
 
 #include "hydra/common/global_info.h"
-#include "hydra/utils/minimum_spanning_tree.h"
 #include "hydra/utils/timing_utilities.h"
 
 namespace hydra {
 
 using timing::ScopedTimer;
 
-void addPlacesToDeformationGraph(const DynamicSceneGraph& graph,
-                                 size_t timestamp_ns,
-                                 kimera_pgmo::DeformationGraph& deformation_graph,
-                                 double mst_edge_variance,
-                                 double mesh_edge_variance,
-                                 const std::function<char(NodeId)>& prefix_lookup) {
+namespace {
+
+inline pose_graph_tools::PoseGraphEdge makeBetweenEdge(const SceneGraphLayer& places,
+                                                      NodeId source_id,
+                                                      NodeId target_id,
+                                                      int robot_id) {
+  gtsam::Pose3 source(gtsam::Rot3(), getNodePosition(places, source_id));
+  gtsam::Pose3 target(gtsam::Rot3(), getNodePosition(places, target_id));
+  pose_graph_tools::PoseGraphEdge mst_e;
+  mst_e.key_from = source_id;
+  mst_e.key_to = target_id;
+  mst_e.robot_from = robot_id;
+  mst_e.robot_to = robot_id;
+  // TODO(nathan) this should technically be something else
+  mst_e.type = pose_graph_tools::PoseGraphEdge::Type::MESH;
+  mst_e.stamp_ns = 0;
+  mst_e.pose = source.between(target).matrix();
+  mst_e.covariance.setIdentity();
+  return mst_e;
+}
+
+inline bool sameFactor(const kimera_pgmo::NodeValenceInfo& lhs,
+                       const kimera_pgmo::NodeValenceInfo& rhs) {
+  return lhs.key == rhs.key && lhs.valence_prefix == rhs.valence_prefix &&
+         lhs.valence == rhs.valence && lhs.pose.equals(rhs.pose, 0.0);
+}
+
+}  // namespace
+
+std::vector<NodeId> PlaceMstFactors::getCandidates(const SceneGraphLayer& places,
+                                                   const GraphChangeLog* changes,
+                                                   bool scan) const {
+  std::vector<NodeId> candidates;
+  if (scan) {
+    candidates.reserve(places.numNodes());
+    for (const auto& id_node_pair : places.nodes()) {
+      candidates.push_back(id_node_pair.first);
+    }
+
+    for (const auto& id_factor_pair : factors_) {
+      if (!places.hasNode(id_factor_pair.first)) {
+        candidates.push_back(id_factor_pair.first);
+      }
+    }
+
+    return candidates;
+  }
+
+  // only the active window moves or changes edges without showing up in the log
+  std::set<NodeId> window(active_.begin(), active_.end());
+  window.insert(archived_.begin(), archived_.end());
+  const auto dirty = changes->dirtySince(*last_sequence_, places.id);
+  candidates.reserve(window.size() + dirty.size());
+  std::set_union(window.begin(),
+                 window.end(),
+                 dirty.begin(),
+                 dirty.end(),
+                 std::back_inserter(candidates));
+  return candidates;
+}
+
+bool PlaceMstFactors::updateFactor(const SceneGraphLayer& places,
+                                   NodeId node_id,
+                                   const std::function<char(NodeId)>& prefix_lookup,
+                                   kimera_pgmo::NodeValenceInfoList& new_factors,
+                                   std::vector<NodeId>& moved) {
+  auto iter = factors_.find(node_id);
+  const auto node = places.findNode(node_id);
+  if (!node || !node->hasSiblings()) {
+    if (iter == factors_.end()) {
+      return false;
+    }
+
+    factors_.erase(iter);
+    return true;
+  }
+
+  const auto& attrs = node->attributes<PlaceNodeAttributes>();
+  kimera_pgmo::NodeValenceInfo factor;
+  factor.valence_prefix = prefix_lookup(node_id);
+  factor.key = node_id;
+  factor.pose = gtsam::Pose3(gtsam::Rot3(), attrs.position);
+  if (mst_.isLeaf(node_id)) {
+    for (const auto& idx : attrs.deformation_connections) {
+      if (idx == std::numeric_limits<size_t>::max()) {
+        continue;
+      }
+      factor.valence.push_back(idx);
+    }
+  }
+
+  if (iter == factors_.end()) {
+    new_factors.push_back(factor);
+    factors_.emplace(node_id, std::move(factor));
+    return false;
+  }
+
+  if (sameFactor(iter->second, factor)) {
+    return false;
+  }
+
+  if (iter->second.pose.translation() != factor.pose.translation()) {
+    moved.push_back(node_id);
+  }
+
+  iter->second = std::move(factor);
+  return true;
+}
+
+void PlaceMstFactors::update(const DynamicSceneGraph& graph,
+                             size_t timestamp_ns,
+                             kimera_pgmo::DeformationGraph& deformation_graph,
+                             double mst_edge_variance,
+                             double mesh_edge_variance,
+                             const std::function<char(NodeId)>& prefix_lookup,
+                             const GraphChangeLog* changes,
+                             bool full_update) {
   const auto& places = graph.getLayer(DsgLayers::PLACES);
   if (places.nodes().empty()) {
     LOG(WARNING) << "Attempting to add places to deformation graph without places";
@@ -58,64 +170,112 @@ void addPlacesToDeformationGraph(const DynamicSceneGraph& graph,
   }
 
   ScopedTimer timer("dsg_updater/add_places", timestamp_ns);
-  deformation_graph.clearTemporaryStructures();
+  // grab the sequence before reading the graph so that nothing gets missed
+  const auto sequence =
+      changes ? std::optional<uint64_t>(changes->sequence()) : std::nullopt;
+  const bool scan =
+      full_update || !changes || !last_sequence_ || !changes->covers(*last_sequence_);
+  const auto candidates = getCandidates(places, changes, scan);
 
-  MinimumSpanningTreeInfo mst_info;
+  DynamicMinimumSpanningTree::Changes tree_changes;
   {  // start timing scope
     ScopedTimer mst_timer("dsg_updater/places_mst", timestamp_ns);
-    mst_info = getMinimumSpanningEdges(places);
-  }  // end timing scope
+    if (scan) {
+      mst_.update(places);
+    } else {
+      mst_.update(places, candidates);
+    }
 
-  {  // start timing scope
-    ScopedTimer add_timer("dsg_updater/add_places_nodes", timestamp_ns);
+    tree_changes = mst_.takeChanges();
+  }  // end timing scope
 
-    kimera_pgmo::NodeValenceInfoList factors;
-    for (const auto& [node_id, node] : places.nodes()) {
-      const auto& attrs = node->attributes<PlaceNodeAttributes>();
-      if (!node->hasSiblings()) {
-        continue;
-      }
+  std::set<NodeId> active;
+  std::set<NodeId> archived;
+  for (const auto node_id : candidates) {
+    const auto node = places.findNode(node_id);
+    if (!node) {
+      continue;
+    }
 
-      auto& factor = factors.emplace_back();
-      factor.valence_prefix = prefix_lookup(node_id);
-      factor.key = node_id;
-      factor.pose = gtsam::Pose3(gtsam::Rot3(), attrs.position);
-
-      if (mst_info.leaves.count(node_id)) {
-        for (const auto& idx : attrs.deformation_connections) {
-          if (idx == std::numeric_limits<size_t>::max()) {
-            continue;
-          }
-          factor.valence.push_back(idx);
-        }
-      }
+    if (node->attributes().is_active) {
+      active.insert(node_id);
+    } else if (active_.count(node_id)) {
+      // keep just-archived places for one more update in case they still change
+      archived.insert(node_id);
     }
+  }
+
+  active_ = std::move(active);
+  archived_ = std::move(archived);
+  last_sequence_ = sequence;
 
-    deformation_graph.processNewTempNodesValences(factors, false, mesh_edge_variance);
+  // kimera_pgmo can only clear all temporary factors at once, so factors are only
+  // resubmitted if a previous factor changed or was removed
+  bool resubmit = false;
+  kimera_pgmo::NodeValenceInfoList new_factors;
+  std::vector<NodeId> moved;
+  {  // start timing scope
+    ScopedTimer add_timer("dsg_updater/add_places_nodes", timestamp_ns);
+    std::set<NodeId> to_update(candidates.begin(), candidates.end());
+    to_update.insert(tree_changes.nodes.begin(), tree_changes.nodes.end());
+    for (const auto node_id : to_update) {
+      resubmit |= updateFactor(places, node_id, prefix_lookup, new_factors, moved);
+    }
   }  // end timing scope
 
+  pose_graph_tools::PoseGraph new_edges;
   {  // start timing scope
     ScopedTimer between_timer("dsg_updater/add_places_between", timestamp_ns);
+    for (const auto& key : tree_changes.removed) {
+      resubmit |= between_.erase(key) > 0;
+    }
+
     const auto robot_id = GlobalInfo::instance().getRobotPrefix().id;
-    pose_graph_tools::PoseGraph mst_edges;
-    for (const auto& edge : mst_info.edges) {
-      gtsam::Pose3 source(gtsam::Rot3(), getNodePosition(places, edge.source));
-      gtsam::Pose3 target(gtsam::Rot3(), getNodePosition(places, edge.target));
-      pose_graph_tools::PoseGraphEdge mst_e;
-      mst_e.key_from = edge.source;
-      mst_e.key_to = edge.target;
-      mst_e.robot_from = robot_id;
-      mst_e.robot_to = robot_id;
-      // TODO(nathan) this should technically be something else
-      mst_e.type = pose_graph_tools::PoseGraphEdge::Type::MESH;
-      mst_e.stamp_ns = 0;
-      mst_e.pose = source.between(target).matrix();
-      mst_e.covariance.setIdentity();
-      mst_edges.edges.push_back(mst_e);
+    for (const auto& key : tree_changes.added) {
+      const auto edge = makeBetweenEdge(places, key.first, key.second, robot_id);
+      between_[key] = edge;
+      new_edges.edges.push_back(edge);
     }
 
-    deformation_graph.processNewTempEdges(mst_edges, mst_edge_variance);
+    for (const auto node_id : moved) {
+      for (const auto other : mst_.treeNeighbors(node_id)) {
+        const auto key = node_id < other ? std::make_pair(node_id, other)
+                                         : std::make_pair(other, node_id);
+        between_[key] = makeBetweenEdge(places, key.first, key.second, robot_id);
+        resubmit = true;
+      }
+    }
   }  // end timing scope
+
+  ScopedTimer submit_timer("dsg_updater/add_places_submit", timestamp_ns);
+  if (!resubmit) {
+    if (!new_factors.empty()) {
+      deformation_graph.processNewTempNodesValences(
+          new_factors, false, mesh_edge_variance);
+    }
+
+    if (!new_edges.edges.empty()) {
+      deformation_graph.processNewTempEdges(new_edges, mst_edge_variance);
+    }
+
+    return;
+  }
+
+  kimera_pgmo::NodeValenceInfoList factors;
+  factors.reserve(factors_.size());
+  for (const auto& id_factor_pair : factors_) {
+    factors.push_back(id_factor_pair.second);
+  }
+
+  pose_graph_tools::PoseGraph mst_edges;
+  mst_edges.edges.reserve(between_.size());
+  for (const auto& key_edge_pair : between_) {
+    mst_edges.edges.push_back(key_edge_pair.second);
+  }
+
+  deformation_graph.clearTemporaryStructures();
+  deformation_graph.processNewTempNodesValences(factors, false, mesh_edge_variance);
+  deformation_graph.processNewTempEdges(mst_edges, mst_edge_variance);
 }
 
 }  // namespace hydra
@@ -117,26 +117,40 @@ std::map<std::tuple<size_t, size_t, size_t, size_t>, double> buildEdgeMap(
     const std::vector<std::pair<NodeId, std::vector<Place2d>>>& nodes_to_add,
     double place_overlap_threshold,
     double place_neighbor_z_diff) {
-  std::map<std::tuple<size_t, size_t, size_t, size_t>, double> edge_map;
-  // compute which pairs of new nodes will need to have an edge added
-  // Currently checks all split merged nodes. Maybe just check neighbors-of-neighbors?
+  // flatten split places so that only places with overlapping ellipses get checked
+  std::vector<std::pair<size_t, size_t>> keys;
+  std::vector<PlaceBounds2d> bounds;
   for (size_t og_ix = 0; og_ix < nodes_to_add.size(); ++og_ix) {
-    for (size_t split_ix = 0; split_ix < nodes_to_add.at(og_ix).second.size();
-         ++split_ix) {
-      Place2d p1 = nodes_to_add.at(og_ix).second.at(split_ix);
-      for (size_t og_jx = 0; og_jx <= og_ix; ++og_jx) {
-        for (size_t split_jx = 0; split_jx < nodes_to_add.at(og_jx).second.size();
-             ++split_jx) {
-          Place2d p2 = nodes_to_add.at(og_jx).second.at(split_jx);
-          double weight;
-          bool connected = shouldAddPlaceConnection(
-              p1, p2, place_overlap_threshold, place_neighbor_z_diff, weight);
-          edge_map.insert({std::make_tuple(og_ix, split_ix, og_jx, split_jx),
-                           connected ? weight : 0});
-        }
+    const auto& split_places = nodes_to_add.at(og_ix).second;
+    for (size_t split_ix = 0; split_ix < split_places.size(); ++split_ix) {
+      keys.emplace_back(og_ix, split_ix);
+      bounds.push_back(getConnectionBounds(split_places.at(split_ix)));
+    }
+  }
+
+  // compute which pairs of new nodes will need to have an edge added. Non-overlapping
+  // places have zero weight and never get an edge, so they are not stored
+  std::map<std::tuple<size_t, size_t, size_t, size_t>, double> edge_map;
+  const Place2dGridIndex index(bounds);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const auto [og_ix, split_ix] = keys[i];
+    const auto& p1 = nodes_to_add.at(og_ix).second.at(split_ix);
+    for (const auto j : index.getCandidates(i)) {
+      const auto [og_jx, split_jx] = keys[j];
+      if (og_jx > og_ix) {
+        break;  // candidates are sorted, so all remaining places are later
+      }
+
+      const auto& p2 = nodes_to_add.at(og_jx).second.at(split_jx);
+      double weight;
+      const bool connected = shouldAddPlaceConnection(
+          p1, p2, place_overlap_threshold, place_neighbor_z_diff, weight);
+      if (connected && weight > 0) {
+        edge_map.insert({std::make_tuple(og_ix, split_ix, og_jx, split_jx), weight});
       }
     }
   }
+
   return edge_map;
 }
 
@@ -250,32 +264,25 @@ NodeSymbol insertNewNodes(
 }
 
 void addNewNodeEdges(
-    const std::vector<std::pair<NodeId, std::vector<Place2d>>> nodes_to_add,
-    const std::map<std::tuple<size_t, size_t, size_t, size_t>, double> edge_map,
-    const std::map<std::tuple<size_t, size_t>, NodeId> new_id_map,
+    const std::vector<std::pair<NodeId, std::vector<Place2d>>>& /* nodes_to_add */,
+    const std::map<std::tuple<size_t, size_t, size_t, size_t>, double>& edge_map,
+    const std::map<std::tuple<size_t, size_t>, NodeId>& new_id_map,
     DynamicSceneGraph& graph) {
-  // It looks like this loop would take a long time, but all of these sizes should be
-  // extremely small (e.g. 2ish)
-  for (size_t og_ix = 0; og_ix < nodes_to_add.size(); ++og_ix) {
-    for (size_t split_ix = 0; split_ix < nodes_to_add.at(og_ix).second.size();
-         ++split_ix) {
-      Place2d p1 = nodes_to_add.at(og_ix).second.at(split_ix);
-      for (size_t og_jx = 0; og_jx <= og_ix; ++og_jx) {
-        for (size_t split_jx = 0; split_jx < nodes_to_add.at(og_jx).second.size();
-             ++split_jx) {
-          double weight =
-              edge_map.at(std::make_tuple(og_ix, split_ix, og_jx, split_jx));
-          if (weight > 0) {
-            NodeId n1 = new_id_map.at(std::make_tuple(og_ix, split_ix));
-            NodeId n2 = new_id_map.at(std::make_tuple(og_jx, split_jx));
-            EdgeAttributes ea;
-            ea.weight = weight;
-            ea.weighted = true;
-            graph.insertEdge(n1, n2, ea.clone());
-          }
-        }
-      }
+  // edge map only contains connected pairs (in the same order as iterating over all
+  // pairs of split places)
+  for (const auto& [key, weight] : edge_map) {
+    if (weight <= 0) {
+      continue;
     }
+
+    const auto& [og_ix, split_ix, og_jx, split_jx] = key;
+
+    NodeId n1 = new_id_map.at(std::make_tuple(og_ix, split_ix));
+    NodeId n2 = new_id_map.at(std::make_tuple(og_jx, split_jx));
+    EdgeAttributes ea;
+    ea.weight = weight;
+    ea.weighted = true;
+    graph.insertEdge(n1, n2, ea.clone());
   }
 }
 
@@ -35,12 +35,14 @@
 #include "hydra/backend/update_objects_functor.h"
 
 #include <config_utilities/config.h>
+#include <config_utilities/types/conversions.h>
 #include <config_utilities/validation.h>
 #include <glog/logging.h>
 #include <spark_dsg/printing.h>
 
 #include "hydra/backend/backend_utilities.h"
 #include "hydra/utils/mesh_utilities.h"
+#include "hydra/utils/parallel_utilities.h"
 #include "hydra/utils/timing_utilities.h"
 
 namespace hydra {
@@ -49,41 +51,13 @@ using timing::ScopedTimer;
 using SemanticLabel = SemanticNodeAttributes::Label;
 using MergeId = std::optional<NodeId>;
 
-NodeAttributes::Ptr mergeObjectAttributes(const DynamicSceneGraph& graph,
-                                          const std::vector<NodeId>& nodes) {
-  if (nodes.empty()) {
-    return nullptr;
-  }
-
-  auto iter = nodes.begin();
-  auto attrs_ptr = graph.getNode(*iter).attributes().clone();
-  auto& new_attrs =
-      *CHECK_NOTNULL(dynamic_cast<ObjectNodeAttributes*>(attrs_ptr.get()));
-  ++iter;
-  while (iter != nodes.end()) {
-    const auto& from_attrs = graph.getNode(*iter).attributes<ObjectNodeAttributes>();
-    utils::mergeIndices(from_attrs.mesh_connections, new_attrs.mesh_connections);
-    ++iter;
-  }
-
-  if (new_attrs.mesh_connections.empty()) {
-    VLOG(2) << "Merge is empty: " << displayNodeSymbolContainer(nodes);
-    return attrs_ptr;
-  }
-
-  auto mesh = graph.mesh();
-  if (!updateObjectGeometry(*mesh, new_attrs)) {
-    VLOG(2) << "Merge geometry invalid: " << displayNodeSymbolContainer(nodes);
-  }
-
-  return attrs_ptr;
-}
-
 void declare_config(UpdateObjectsFunctor::Config& config) {
   using namespace config;
   name("UpdateObjectsFunctor::Config");
   field(config.allow_connection_merging, "allow_connection_merging");
   field(config.merge_proposer, "merge_proposer");
+  field<ThreadNumConversion>(config.num_threads, "num_threads");
+  check(config.num_threads, GT, 0, "num_threads");
 }
 
 UpdateObjectsFunctor::UpdateObjectsFunctor(const Config& config)
@@ -96,7 +70,10 @@ UpdateFunctor::Hooks UpdateObjectsFunctor::hooks() const {
   };
 
   if (config.allow_connection_merging) {
-    my_hooks.merge = &mergeObjectAttributes;
+    my_hooks.merge = [this](const DynamicSceneGraph& graph,
+                            const std::vector<NodeId>& nodes) {
+      return mergeAttributes(graph, nodes);
+    };
   }
 
   return my_hooks;
@@ -116,12 +93,26 @@ void UpdateObjectsFunctor::call(const DynamicSceneGraph& unmerged,
   // we want to iterate over the unmerged graph
   const auto new_loopclosure = info->loop_closure_detected;
   active_tracker.clear();  // reset from previous pass
-  LayerView view = new_loopclosure ? LayerView(objects) : active_tracker.view(objects);
+  const auto view = new_loopclosure
+                        ? NodeSubsetView(objects)
+                        : active_tracker.view(objects, false, info->changes);
+
+  if (new_loopclosure) {
+    // most vertices moved, so refit everything instead of diffing cached positions
+    // (this also drops entries for objects that no longer exist)
+    geometry_cache_.clear();
+    merged_geometry_cache_.clear();
+  } else {
+    pruneGeometryCaches(unmerged, *dsg.graph, info->changes);
+  }
+
+  if (info->changes) {
+    cache_sequence_ = info->changes->sequence();
+  }
 
   // apply updates to every attribute that may have changed since the last call
   size_t num_changed = 0;
-  // we want to use the optimized mesh (unmerged doesn't have a mesh)
-  const auto mesh = dsg.graph->mesh();
+  std::vector<std::pair<NodeId, ObjectNodeAttributes*>> to_update;
   for (const auto& node : view) {
     ++num_changed;
     auto attrs = node.tryAttributes<ObjectNodeAttributes>();
@@ -137,17 +128,107 @@ void UpdateObjectsFunctor::call(const DynamicSceneGraph& unmerged,
       continue;
     }
 
-    if (!updateObjectGeometry(*mesh, *attrs)) {
-      VLOG(2) << "Invalid centroid for object " << NodeSymbol(node.id).str();
+    to_update.emplace_back(node.id, attrs);
+  }
+
+  // allocate cache entries up front so that workers never modify the map
+  std::vector<ObjectGeometry*> geometries;
+  geometries.reserve(to_update.size());
+  for (const auto& [node_id, attrs] : to_update) {
+    geometries.push_back(&geometry_cache_[node_id]);
+  }
+
+  // we want to use the optimized mesh (unmerged doesn't have a mesh)
+  const auto mesh = dsg.graph->mesh();
+  std::vector<uint8_t> valid(to_update.size(), 0);
+  processInParallel(to_update.size(), config.num_threads, [&](size_t i) {
+    auto& attrs = *to_update[i].second;
+    auto& geometry = *geometries[i];
+    geometry.update(*mesh, attrs.mesh_connections);
+    valid[i] = geometry.apply(*mesh, attrs);
+    if (!valid[i]) {
+      // keep the bounding box behavior for objects without valid vertices
+      updateObjectGeometry(*mesh, attrs);
+    }
+  });
+
+  for (size_t i = 0; i < to_update.size(); ++i) {
+    const auto& [node_id, attrs] = to_update[i];
+    if (!valid[i]) {
+      VLOG(2) << "Invalid centroid for object " << NodeSymbol(node_id).str();
     }
 
     // TODO(nathan) this is sloppy and needs to be cleaned up
-    dsg.graph->setNodeAttributes(node.id, attrs->clone());
+    dsg.graph->setNodeAttributes(node_id, attrs->clone());
   }
 
   VLOG(2) << "[Hydra Backend] Object update: " << num_changed << " node(s)";
 }
 
+void UpdateObjectsFunctor::pruneGeometryCaches(const DynamicSceneGraph& unmerged,
+                                               const DynamicSceneGraph& merged,
+                                               const GraphChangeLog* changes) const {
+  if (changes && changes->covers(cache_sequence_)) {
+    for (const auto& entry : changes->changesSince(cache_sequence_)) {
+      if (entry.change == GraphChangeLog::Change::REMOVED) {
+        geometry_cache_.erase(entry.node);
+        merged_geometry_cache_.erase(entry.node);
+      }
+    }
+
+    return;
+  }
+
+  // without a complete change history, drop entries for nodes that no longer exist
+  const auto prune = [](auto& cache, const DynamicSceneGraph& graph) {
+    auto iter = cache.begin();
+    while (iter != cache.end()) {
+      iter = graph.hasNode(iter->first) ? std::next(iter) : cache.erase(iter);
+    }
+  };
+
+  prune(geometry_cache_, unmerged);
+  prune(merged_geometry_cache_, merged);
+}
+
+NodeAttributes::Ptr UpdateObjectsFunctor::mergeAttributes(
+    const DynamicSceneGraph& graph, const std::vector<NodeId>& nodes) const {
+  if (nodes.empty()) {
+    return nullptr;
+  }
+
+  auto iter = nodes.begin();
+  auto attrs_ptr = graph.getNode(*iter).attributes().clone();
+  auto& new_attrs =
+      *CHECK_NOTNULL(dynamic_cast<ObjectNodeAttributes*>(attrs_ptr.get()));
+  ++iter;
+  while (iter != nodes.end()) {
+    const auto& from_attrs = graph.getNode(*iter).attributes<ObjectNodeAttributes>();
+    utils::mergeIndices(from_attrs.mesh_connections, new_attrs.mesh_connections);
+    // nodes merged into the target are removed and no longer need their own geometry
+    merged_geometry_cache_.erase(*iter);
+    ++iter;
+  }
+
+  if (new_attrs.mesh_connections.empty()) {
+    VLOG(2) << "Merge is empty: " << displayNodeSymbolContainer(nodes);
+    merged_geometry_cache_.erase(nodes.front());
+    return attrs_ptr;
+  }
+
+  // the merge target is reused across passes, so only new connections and moved
+  // vertices need to be applied to its cached geometry
+  auto mesh = graph.mesh();
+  auto& geometry = merged_geometry_cache_[nodes.front()];
+  geometry.update(*mesh, new_attrs.mesh_connections);
+  if (!geometry.apply(*mesh, new_attrs)) {
+    updateObjectGeometry(*mesh, new_attrs);
+    VLOG(2) << "Merge geometry invalid: " << displayNodeSymbolContainer(nodes);
+  }
+
+  return attrs_ptr;
+}
+
 MergeList UpdateObjectsFunctor::findMerges(const DynamicSceneGraph& graph,
                                            const UpdateInfo::ConstPtr& info) const {
   if (!graph.hasLayer(DsgLayers::OBJECTS)) {
@@ -157,7 +238,8 @@ MergeList UpdateObjectsFunctor::findMerges(const DynamicSceneGraph& graph,
   const auto new_lcd = info->loop_closure_detected;
   const auto& objects = graph.getLayer(DsgLayers::OBJECTS);
   // freeze layer view to avoid messing with tracker
-  LayerView view = new_lcd ? LayerView(objects) : active_tracker.view(objects, true);
+  const auto view = new_lcd ? NodeSubsetView(objects)
+                            : active_tracker.view(objects, true, info->changes);
 
   MergeList proposals;
   merge_proposer.findMerges(
@@ -173,7 +255,9 @@ MergeList UpdateObjectsFunctor::findMerges(const DynamicSceneGraph& graph,
         return lhs_attrs->bounding_box.contains(rhs_attrs->position) ||
                rhs_attrs->bounding_box.contains(lhs_attrs->position);
       },
-      proposals);
+      proposals,
+      info->changes,
+      new_lcd);
   return proposals;
 }
 
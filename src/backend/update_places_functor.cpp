@@ -96,7 +96,7 @@ void UpdatePlacesFunctor::filterMissing(DynamicSceneGraph& graph,
   }
 }
 
-size_t UpdatePlacesFunctor::updateFromValues(const LayerView& view,
+size_t UpdatePlacesFunctor::updateFromValues(const NodeSubsetView& view,
                                              SharedDsgInfo& dsg,
                                              const UpdateInfo::ConstPtr& info) const {
   if (!info->places_values) {
@@ -137,7 +137,8 @@ void UpdatePlacesFunctor::call(const DynamicSceneGraph& unmerged,
   const auto new_loopclosure = info->loop_closure_detected;
   const auto& places = unmerged.getLayer(config.layer);
   active_tracker.clear();  // reset from previous pass
-  const auto view = new_loopclosure ? LayerView(places) : active_tracker.view(places);
+  const auto view = new_loopclosure ? NodeSubsetView(places)
+                                    : active_tracker.view(places, false, info->changes);
 
   size_t num_changed = 0;
   if (!info->places_values || info->places_values->size() == 0) {
@@ -154,7 +155,8 @@ MergeList UpdatePlacesFunctor::findMerges(const DynamicSceneGraph& graph,
   const auto new_lcd = info->loop_closure_detected;
   const auto& places = graph.getLayer(config.layer);
   // freeze layer view to avoid messing with tracker
-  const auto view = new_lcd ? LayerView(places) : active_tracker.view(places, true);
+  const auto view = new_lcd ? NodeSubsetView(places)
+                            : active_tracker.view(places, true, info->changes);
 
   MergeList proposals;
   merge_proposer.findMerges(
@@ -182,7 +184,9 @@ MergeList UpdatePlacesFunctor::findMerges(const DynamicSceneGraph& graph,
             std::abs(lhs_attrs->distance - rhs_attrs->distance);
         return radii_deviation <= config.distance_tolerance_m;
       },
-      proposals);
+      proposals,
+      info->changes,
+      new_lcd);
   return proposals;
 }
 
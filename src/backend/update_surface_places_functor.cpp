@@ -40,6 +40,8 @@
 #include <pcl/common/centroid.h>
 #include <pcl/point_types.h>
 
+#include <algorithm>
+
 #include "hydra/backend/backend_utilities.h"
 #include "hydra/backend/surface_place_utilities.h"
 #include "hydra/frontend/place_2d_split_logic.h"
@@ -128,7 +130,8 @@ void Update2dPlacesFunctor::call(const DynamicSceneGraph& unmerged,
   const auto new_loopclosure = info->loop_closure_detected;
 
   active_tracker.clear();  // reset from previous pass
-  const auto view = new_loopclosure ? LayerView(*layer) : active_tracker.view(*layer);
+  const auto view = new_loopclosure ? NodeSubsetView(*layer)
+                                    : active_tracker.view(*layer, false, info->changes);
 
   size_t num_changed = 0;
   const auto mesh = unmerged.mesh();
@@ -156,7 +159,8 @@ MergeList Update2dPlacesFunctor::findMerges(const DynamicSceneGraph& graph,
 
   const auto new_lcd = info->loop_closure_detected;
   // freeze layer view to avoid messing with tracker
-  const auto view = new_lcd ? LayerView(*layer) : active_tracker.view(*layer, true);
+  const auto view = new_lcd ? NodeSubsetView(*layer)
+                            : active_tracker.view(*layer, true, info->changes);
 
   MergeList nodes_to_merge;
   merge_proposer.findMerges(
@@ -173,7 +177,9 @@ MergeList Update2dPlacesFunctor::findMerges(const DynamicSceneGraph& graph,
 
         return shouldMerge(*lhs_attrs, *rhs_attrs);
       },
-      nodes_to_merge);
+      nodes_to_merge,
+      info->changes,
+      new_lcd);
   return nodes_to_merge;
 }
 
@@ -345,12 +351,35 @@ void Update2dPlacesFunctor::cleanup(SharedDsgInfo& dsg) const {
     addBoundaryInfo(mesh->points, attrs);
   }
 
-  std::vector<std::pair<NodeId, NodeId>> edges_to_remove;
-  std::map<NodeId, NodeId> extra_edges_to_check;
+  // Only nodes with overlapping ellipses can be connected (unless any overlap passes
+  // the threshold), so the remaining pairs only need existing edges removed
+  std::vector<NodeId> checked_ids;
+  std::vector<PlaceBounds2d> bounds;
+  std::unordered_map<NodeId, size_t> checked_index;
+  for (const auto& [node_id, finalize] : checked_nodes) {
+    checked_index[node_id] = checked_ids.size();
+    checked_ids.push_back(node_id);
+    bounds.push_back(config.connection_overlap_threshold < 0.0
+                         ? PlaceBounds2d()
+                         : getConnectionBounds(
+                               graph.getNode(node_id).attributes<Place2dNodeAttributes>()));
+  }
+
+  const Place2dGridIndex index(bounds);
   for (const auto& [node_id, finalize] : checked_nodes) {
     auto& attrs1 = graph.getNode(node_id).attributes<Place2dNodeAttributes>();
+    const auto candidates = index.getCandidates(checked_index.at(node_id));
+    const std::set<NodeId> siblings = graph.getNode(node_id).siblings();
+    for (const auto nid : siblings) {
+      const auto iter = checked_index.find(nid);
+      if (iter != checked_index.end() &&
+          !std::binary_search(candidates.begin(), candidates.end(), iter->second)) {
+        graph.removeEdge(node_id, nid);
+      }
+    }
 
-    for (const auto& [neighbor_id, neighbor_finalize] : checked_nodes) {
+    for (const auto j : candidates) {
+      const auto neighbor_id = checked_ids[j];
       const auto& neighbor_node = graph.getNode(neighbor_id);
       auto& attrs2 = neighbor_node.attributes<Place2dNodeAttributes>();
       EdgeAttributes ea;
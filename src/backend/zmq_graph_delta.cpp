@@ -0,0 +1,120 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/backend/zmq_graph_delta.h"
+
+#include <glog/logging.h>
+#include <zmq.h>
+
+#include <memory>
+
+namespace hydra {
+namespace {
+
+// inproc endpoints only connect sockets within the same context, so all delta
+// sockets share a single context per process
+void* getDeltaContext() {
+  static std::unique_ptr<void, int (*)(void*)> context(zmq_ctx_new(), &zmq_ctx_term);
+  return context.get();
+}
+
+void* makeDeltaSocket(int type) {
+  void* socket = zmq_socket(getDeltaContext(), type);
+  CHECK(socket) << "Failed to create zmq socket: " << zmq_strerror(zmq_errno());
+  const int linger = 0;
+  zmq_setsockopt(socket, ZMQ_LINGER, &linger, sizeof(linger));
+  return socket;
+}
+
+}  // namespace
+
+ZmqGraphDeltaSender::ZmqGraphDeltaSender(const std::string& url,
+                                         size_t keyframe_interval,
+                                         DeltaCompression compression)
+    : compression_(compression),
+      socket_(makeDeltaSocket(ZMQ_PUB)),
+      tracker_(keyframe_interval) {
+  if (!compressionAvailable(compression)) {
+    LOG(WARNING) << "Requested compression not available, sending uncompressed deltas";
+  }
+
+  if (zmq_bind(socket_, url.c_str()) != 0) {
+    LOG(ERROR) << "Failed to bind to '" << url << "': " << zmq_strerror(zmq_errno());
+  }
+}
+
+ZmqGraphDeltaSender::~ZmqGraphDeltaSender() { zmq_close(socket_); }
+
+void ZmqGraphDeltaSender::send(uint64_t timestamp_ns,
+                               const DynamicSceneGraph& graph,
+                               bool include_mesh) {
+  const auto delta = tracker_.update(timestamp_ns, graph);
+  const auto buffer = delta.encode(include_mesh, compression_);
+  VLOG(5) << "Sending " << (delta.keyframe ? "keyframe " : "delta ") << delta.sequence
+          << " (" << buffer.size() << " bytes)";
+  if (zmq_send(socket_, buffer.data(), buffer.size(), 0) < 0) {
+    LOG(WARNING) << "Failed to send graph delta: " << zmq_strerror(zmq_errno());
+  }
+}
+
+ZmqGraphDeltaReceiver::ZmqGraphDeltaReceiver(const std::string& url)
+    : socket_(makeDeltaSocket(ZMQ_SUB)) {
+  zmq_setsockopt(socket_, ZMQ_SUBSCRIBE, "", 0);
+  if (zmq_connect(socket_, url.c_str()) != 0) {
+    LOG(ERROR) << "Failed to connect to '" << url << "': " << zmq_strerror(zmq_errno());
+  }
+}
+
+ZmqGraphDeltaReceiver::~ZmqGraphDeltaReceiver() { zmq_close(socket_); }
+
+bool ZmqGraphDeltaReceiver::recv(size_t timeout_ms) {
+  zmq_pollitem_t item{socket_, 0, ZMQ_POLLIN, 0};
+  if (zmq_poll(&item, 1, timeout_ms) <= 0 || !(item.revents & ZMQ_POLLIN)) {
+    return false;
+  }
+
+  zmq_msg_t msg;
+  zmq_msg_init(&msg);
+  if (zmq_msg_recv(&msg, socket_, 0) < 0) {
+    zmq_msg_close(&msg);
+    return false;
+  }
+
+  const auto delta = GraphDelta::decode(static_cast<const uint8_t*>(zmq_msg_data(&msg)),
+                                        zmq_msg_size(&msg));
+  zmq_msg_close(&msg);
+  return delta && applier_.apply(*delta);
+}
+
+}  // namespace hydra
@@ -41,6 +41,12 @@
 #include <glog/logging.h>
 #include <spark_dsg/zmq_interface.h>
 
+#include "hydra_build_config.h"
+
+#if HYDRA_USE_ZMQ_DELTAS
+#include "hydra/backend/zmq_graph_delta.h"
+#endif
+
 namespace hydra {
 namespace {
 
@@ -61,9 +67,27 @@ void declare_config(ZmqSink::Config& config) {
   field(config.url, "url");
   field(config.num_threads, "num_threads");
   field(config.send_mesh, "send_mesh");
+  field(config.send_deltas, "send_deltas");
+  field(config.keyframe_interval, "keyframe_interval");
+  enum_field(config.compression,
+             "compression",
+             {{DeltaCompression::NONE, "NONE"},
+              {DeltaCompression::LZ4, "LZ4"},
+              {DeltaCompression::ZSTD, "ZSTD"}});
 }
 
 ZmqSink::ZmqSink(const Config& config) : config(config::checkValid(config)) {
+  if (config.send_deltas) {
+#if HYDRA_USE_ZMQ_DELTAS
+    delta_sender_ = std::make_shared<ZmqGraphDeltaSender>(
+        config.url, config.keyframe_interval, config.compression);
+    return;
+#else
+    LOG(ERROR) << "Graph deltas require Hydra to be built with libzmq, sending full "
+                  "graphs instead";
+#endif
+  }
+
   sender_ = std::make_unique<spark_dsg::ZmqSender>(config.url, config.num_threads);
 }
 
@@ -74,6 +98,13 @@ void ZmqSink::call(uint64_t timestamp_ns,
                    const kimera_pgmo::DeformationGraph& /*dgraph*/) const {
   VLOG(5) << "Sending graph via zmq to '" << config.url << "' @ " << timestamp_ns
           << " [ns]";
+#if HYDRA_USE_ZMQ_DELTAS
+  if (delta_sender_) {
+    delta_sender_->send(timestamp_ns, graph, config.send_mesh);
+    return;
+  }
+#endif
+
   CHECK_NOTNULL(sender_)->send(graph, config.send_mesh);
 }
 
@@ -37,11 +37,15 @@
 #include <glog/logging.h>
 #include <glog/stl_logging.h>
 
+#include <algorithm>
+
 #include "hydra/backend/update_buildings_functor.h"
 #include "hydra/backend/update_functions.h"
 #include "hydra/backend/update_rooms_functor.h"
+#include "hydra/common/pipeline_queues.h"
 #include "hydra/common/shared_module_state.h"
 #include "hydra/reconstruction/mesh_integrator.h"
+#include "hydra/utils/parallel_utilities.h"
 
 namespace hydra {
 
@@ -56,7 +60,8 @@ BatchPipeline::~BatchPipeline() {}
 
 DynamicSceneGraph::Ptr BatchPipeline::construct(const VFConfig& frontend_config,
                                                 VolumetricMap& map,
-                                                const RFConfig* room_config) const {
+                                                const RFConfig* room_config,
+                                                const BatchTilingConfig* tiling) const {
   if (!map.hasSemantics()) {
     return nullptr;
   }
@@ -67,16 +72,22 @@ DynamicSceneGraph::Ptr BatchPipeline::construct(const VFConfig& frontend_config,
 
   auto dsg = GlobalInfo::instance().createSharedDsg();
   auto graph = dsg->graph->clone();
-  auto state = std::make_shared<SharedModuleState>();
-  auto frontend = frontend_config.create(dsg, state);
+  if (tiling && tiling->tile_size_m > 0.0) {
+    if (!constructTiled(frontend_config, map, *tiling, *dsg->graph)) {
+      return nullptr;
+    }
+  } else {
+    auto state = std::make_shared<SharedModuleState>();
+    auto frontend = frontend_config.create(dsg, state);
 
-  // TODO(nathan) this is a little sketchy given the lack of pose info
-  auto msg = std::make_shared<ActiveWindowOutput>();
-  msg->setMap(map);
-  frontend->queue()->push(msg);
+    // TODO(nathan) this is a little sketchy given the lack of pose info
+    auto msg = std::make_shared<ActiveWindowOutput>();
+    msg->setMap(map);
+    frontend->queue()->push(msg);
 
-  if (!frontend->spinOnce()) {
-    return nullptr;
+    if (!frontend->spinOnce()) {
+      return nullptr;
+    }
   }
 
   if (room_config) {
@@ -92,4 +103,58 @@ DynamicSceneGraph::Ptr BatchPipeline::construct(const VFConfig& frontend_config,
   return dsg->graph;
 }
 
+bool BatchPipeline::constructTiled(const VFConfig& frontend_config,
+                                   const VolumetricMap& map,
+                                   const BatchTilingConfig& tiling,
+                                   DynamicSceneGraph& graph) const {
+  const MapTiler tiler(tiling, map.blockSize());
+  const auto tiles = tiler.partition(map);
+  LOG(INFO) << "[Batch Pipeline] Building scene graph from " << tiles.size()
+            << " tile(s)";
+
+  auto& queues = PipelineQueues::instance();
+  if (queues.lcd_queue) {
+    // every tile would push its own updates to the single loop closure module
+    LOG(ERROR) << "[Batch Pipeline] Tiled construction does not support loop closures";
+    return false;
+  }
+
+  // frontends reset global queues on construction (e.g., the BoW queue), so they are
+  // created serially before any tile starts reading from them
+  std::vector<SharedDsgInfo::Ptr> tile_dsgs(tiles.size());
+  std::vector<std::unique_ptr<GraphBuilder>> frontends(tiles.size());
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    tile_dsgs[i] = GlobalInfo::instance().createSharedDsg();
+    auto state = std::make_shared<SharedModuleState>();
+    frontends[i] = frontend_config.create(tile_dsgs[i], state);
+  }
+
+  std::vector<DynamicSceneGraph::Ptr> tile_graphs(tiles.size());
+  processInParallel(tiles.size(), tiling.num_threads, [&](size_t i) {
+    auto msg = std::make_shared<ActiveWindowOutput>();
+    msg->setMap(std::shared_ptr<VolumetricMap>(map.cloneBlocks(tiles[i].blocks)));
+    frontends[i]->queue()->push(msg);
+    if (frontends[i]->spinOnce()) {
+      tile_graphs[i] = tile_dsgs[i]->graph;
+    } else {
+      LOG(WARNING) << "[Batch Pipeline] Failed to build tile "
+                   << tiles[i].index.transpose();
+    }
+
+    frontends[i].reset();
+  });
+
+  // there is no backend to consume the updates each tile sent
+  queues.backend_queue.clear();
+
+  const auto has_graph = [](const auto& tile_graph) { return tile_graph != nullptr; };
+  if (std::none_of(tile_graphs.begin(), tile_graphs.end(), has_graph)) {
+    return false;
+  }
+
+  graph.setMesh(GlobalInfo::instance().createMesh());
+  tiler.stitch(tiles, tile_graphs, graph);
+  return true;
+}
+
 }  // namespace hydra
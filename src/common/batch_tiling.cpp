@@ -0,0 +1,569 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/common/batch_tiling.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/types/conversions.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <unordered_set>
+
+#include "hydra/utils/mesh_utilities.h"
+
+namespace hydra {
+
+using spark_dsg::Mesh;
+using spark_dsg::NodeAttributes;
+using spark_dsg::NodeSymbol;
+using spark_dsg::ObjectNodeAttributes;
+using spark_dsg::PartitionId;
+using spark_dsg::Place2dNodeAttributes;
+using spark_dsg::PlaceNodeAttributes;
+using spark_dsg::SceneGraphEdge;
+using spark_dsg::SceneGraphLayer;
+using spark_dsg::SceneGraphNode;
+
+void declare_config(BatchTilingConfig& config) {
+  using namespace config;
+  name("BatchTilingConfig");
+  field(config.tile_size_m, "tile_size_m", "m");
+  field(config.overlap_m, "overlap_m", "m");
+  field(config.stitch_distance_m, "stitch_distance_m", "m");
+  field(config.vertex_tolerance_m, "vertex_tolerance_m", "m");
+  field<ThreadNumConversion>(config.num_threads, "num_threads");
+  check(config.overlap_m, GE, 0.0, "overlap_m");
+  check(config.stitch_distance_m, GT, 0.0, "stitch_distance_m");
+  check(config.vertex_tolerance_m, GT, 0.0, "vertex_tolerance_m");
+}
+
+namespace {
+
+using LayerIndex = std::pair<LayerId, PartitionId>;
+using VertexMap = std::vector<int64_t>;
+using Face = std::array<size_t, 3>;
+
+inline int64_t floorDiv(int64_t value, int64_t divisor) {
+  const auto quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+inline bool indexLess(const BlockIndex& lhs, const BlockIndex& rhs) {
+  return std::lexicographical_compare(
+      lhs.data(), lhs.data() + 3, rhs.data(), rhs.data() + 3);
+}
+
+template <typename Func>
+void forEachLayer(const DynamicSceneGraph& graph, const Func& func) {
+  for (const auto& [layer_id, layer] : graph.layers()) {
+    func(*layer);
+  }
+
+  for (const auto& [layer_id, partitions] : graph.layer_partitions()) {
+    for (const auto& [partition_id, layer] : partitions) {
+      func(*layer);
+    }
+  }
+}
+
+template <typename Func>
+void forEachEdge(const DynamicSceneGraph& graph, const Func& func) {
+  forEachLayer(graph, [&func](const SceneGraphLayer& layer) {
+    for (const auto& [key, edge] : layer.edges()) {
+      func(edge);
+    }
+  });
+
+  for (const auto& [key, edge] : graph.interlayer_edges()) {
+    func(edge);
+  }
+}
+
+std::vector<const SceneGraphNode*> sortedNodes(const DynamicSceneGraph& graph) {
+  std::vector<const SceneGraphNode*> nodes;
+  forEachLayer(graph, [&nodes](const SceneGraphLayer& layer) {
+    for (const auto& [node_id, node] : layer.nodes()) {
+      nodes.push_back(&(*node));
+    }
+  });
+
+  std::sort(nodes.begin(), nodes.end(), [](const auto* lhs, const auto* rhs) {
+    return lhs->id < rhs->id;
+  });
+  return nodes;
+}
+
+// Spatial hash of the nodes kept by a tile, used to find the kept copy of a node that
+// another tile saw in its overlap margin
+struct NodeLookup {
+  struct Entry {
+    NodeId id;
+    Eigen::Vector3d pos;
+  };
+
+  explicit NodeLookup(double cell_size) : scale(1.0 / cell_size) {}
+
+  void insert(const LayerIndex& layer, NodeId id, const Eigen::Vector3d& pos) {
+    cells[layer][toCell(pos)].push_back({id, pos});
+  }
+
+  std::optional<NodeId> find(const LayerIndex& layer,
+                             const Eigen::Vector3d& pos,
+                             double max_distance) const {
+    auto layer_iter = cells.find(layer);
+    if (layer_iter == cells.end()) {
+      return std::nullopt;
+    }
+
+    // cells are at least max_distance wide, so neighboring cells cover the radius
+    std::optional<NodeId> best;
+    double best_distance = max_distance;
+    const auto cell = toCell(pos);
+    for (int64_t x = -1; x <= 1; ++x) {
+      for (int64_t y = -1; y <= 1; ++y) {
+        for (int64_t z = -1; z <= 1; ++z) {
+          const auto iter =
+              layer_iter->second.find(cell + spatial_hash::LongIndex(x, y, z));
+          if (iter == layer_iter->second.end()) {
+            continue;
+          }
+
+          for (const auto& entry : iter->second) {
+            const auto distance = (entry.pos - pos).norm();
+            if (best ? distance < best_distance : distance <= best_distance) {
+              best = entry.id;
+              best_distance = distance;
+            }
+          }
+        }
+      }
+    }
+
+    return best;
+  }
+
+  spatial_hash::LongIndex toCell(const Eigen::Vector3d& pos) const {
+    return spatial_hash::LongIndex((pos * scale).array().floor().cast<int64_t>());
+  }
+
+  const double scale;
+  std::map<LayerIndex, spatial_hash::LongIndexHashMap<std::vector<Entry>>> cells;
+};
+
+void copyVertex(const Mesh& src, size_t i, Mesh& dst, size_t j) {
+  dst.setPos(j, src.pos(i));
+  if (src.has_colors && dst.has_colors) {
+    dst.setColor(j, src.color(i));
+  }
+
+  if (src.has_timestamps && dst.has_timestamps) {
+    dst.setTimestamp(j, src.timestamp(i));
+  }
+
+  if (src.has_labels && dst.has_labels) {
+    dst.setLabel(j, src.label(i));
+  }
+
+  if (src.has_first_seen_stamps && dst.has_first_seen_stamps) {
+    dst.setFirstSeenTimestamp(j, src.firstSeenTimestamp(i));
+  }
+}
+
+template <typename Func>
+std::vector<VertexMap> stitchMesh(const std::vector<DynamicSceneGraph::Ptr>& graphs,
+                                  const Func& owns_point,
+                                  double tolerance,
+                                  Mesh& output) {
+  const double scale = 1.0 / tolerance;
+  const auto vertex_key = [scale](const Mesh::Pos& pos) -> spatial_hash::LongIndex {
+    return spatial_hash::LongIndex(
+        (pos.cast<double>() * scale).array().round().cast<int64_t>());
+  };
+
+  std::vector<VertexMap> vertex_maps(graphs.size());
+  spatial_hash::LongIndexHashMap<size_t> vertex_lookup;
+  std::vector<Face> faces;
+  for (size_t t = 0; t < graphs.size(); ++t) {
+    const auto mesh = graphs[t] ? graphs[t]->mesh() : nullptr;
+    if (!mesh) {
+      continue;
+    }
+
+    auto& vertex_map = vertex_maps[t];
+    vertex_map.assign(mesh->numVertices(), -1);
+    for (size_t f = 0; f < mesh->numFaces(); ++f) {
+      const auto& face = mesh->face(f);
+      const Eigen::Vector3f centroid =
+          (mesh->pos(face[0]) + mesh->pos(face[1]) + mesh->pos(face[2])) / 3.0f;
+      if (!owns_point(t, centroid.cast<double>())) {
+        continue;
+      }
+
+      Face new_face;
+      for (size_t k = 0; k < 3; ++k) {
+        const auto v = face[k];
+        if (vertex_map[v] < 0) {
+          const auto result =
+              vertex_lookup.emplace(vertex_key(mesh->pos(v)), output.numVertices());
+          const auto new_index = result.first->second;
+          if (result.second) {
+            output.resizeVertices(new_index + 1);
+            copyVertex(*mesh, v, output, new_index);
+          }
+
+          vertex_map[v] = new_index;
+        }
+
+        new_face[k] = vertex_map[v];
+      }
+
+      faces.push_back(new_face);
+    }
+  }
+
+  // vertices that only belong to faces owned by other tiles map to those tiles' copy
+  for (size_t t = 0; t < graphs.size(); ++t) {
+    auto& vertex_map = vertex_maps[t];
+    for (size_t v = 0; v < vertex_map.size(); ++v) {
+      if (vertex_map[v] >= 0) {
+        continue;
+      }
+
+      const auto iter = vertex_lookup.find(vertex_key(graphs[t]->mesh()->pos(v)));
+      if (iter != vertex_lookup.end()) {
+        vertex_map[v] = iter->second;
+      }
+    }
+  }
+
+  const auto offset = output.numFaces();
+  output.resizeFaces(offset + faces.size());
+  for (size_t i = 0; i < faces.size(); ++i) {
+    output.face(offset + i) = faces[i];
+  }
+
+  return vertex_maps;
+}
+
+template <typename List>
+void remapList(List& indices, const VertexMap& vertex_map) {
+  List remapped;
+  std::unordered_set<size_t> seen;
+  for (const auto idx : indices) {
+    if (idx >= vertex_map.size() || vertex_map[idx] < 0) {
+      continue;
+    }
+
+    const size_t new_idx = vertex_map[idx];
+    if (seen.insert(new_idx).second) {
+      remapped.push_back(new_idx);
+    }
+  }
+
+  indices = std::move(remapped);
+}
+
+void remapMeshConnections(NodeAttributes& attrs, const VertexMap& vertex_map) {
+  if (auto objects = dynamic_cast<ObjectNodeAttributes*>(&attrs)) {
+    remapList(objects->mesh_connections, vertex_map);
+  }
+
+  if (auto places = dynamic_cast<PlaceNodeAttributes*>(&attrs)) {
+    remapList(places->pcl_mesh_connections, vertex_map);
+  }
+
+  if (auto places = dynamic_cast<Place2dNodeAttributes*>(&attrs)) {
+    remapList(places->pcl_mesh_connections, vertex_map);
+  }
+}
+
+}  // namespace
+
+MapTiler::MapTiler(const BatchTilingConfig& config, float block_size)
+    : config(config::checkValid(config)),
+      block_size_(block_size),
+      tile_blocks_(std::max(1, static_cast<int>(std::round(config.tile_size_m /
+                                                           block_size)))),
+      overlap_blocks_(static_cast<int>(std::ceil(config.overlap_m / block_size))) {}
+
+BlockIndex MapTiler::tileIndex(const Eigen::Vector3d& point) const {
+  const auto x = static_cast<int64_t>(std::floor(point.x() / block_size_));
+  const auto y = static_cast<int64_t>(std::floor(point.y() / block_size_));
+  return BlockIndex(floorDiv(x, tile_blocks_), floorDiv(y, tile_blocks_), 0);
+}
+
+std::vector<MapTile> MapTiler::partition(const VolumetricMap& map) const {
+  auto blocks = map.getTsdfLayer().allocatedBlockIndices();
+  std::sort(blocks.begin(), blocks.end(), indexLess);
+
+  std::vector<MapTile> tiles;
+  spatial_hash::IndexHashMap<size_t> tile_lookup;
+  for (const auto& block : blocks) {
+    const BlockIndex index(
+        floorDiv(block.x(), tile_blocks_), floorDiv(block.y(), tile_blocks_), 0);
+    auto iter = tile_lookup.find(index);
+    if (iter == tile_lookup.end()) {
+      iter = tile_lookup.emplace(index, tiles.size()).first;
+      tiles.push_back({index, {}, {}});
+    }
+
+    tiles[iter->second].core.push_back(block);
+  }
+
+  // tiles without any blocks of their own are not needed to cover the map
+  for (const auto& block : blocks) {
+    const auto x_min = floorDiv(block.x() - overlap_blocks_, tile_blocks_);
+    const auto x_max = floorDiv(block.x() + overlap_blocks_, tile_blocks_);
+    const auto y_min = floorDiv(block.y() - overlap_blocks_, tile_blocks_);
+    const auto y_max = floorDiv(block.y() + overlap_blocks_, tile_blocks_);
+    for (auto x = x_min; x <= x_max; ++x) {
+      for (auto y = y_min; y <= y_max; ++y) {
+        const auto iter = tile_lookup.find(BlockIndex(x, y, 0));
+        if (iter != tile_lookup.end()) {
+          tiles[iter->second].blocks.push_back(block);
+        }
+      }
+    }
+  }
+
+  std::sort(tiles.begin(), tiles.end(), [](const auto& lhs, const auto& rhs) {
+    return indexLess(lhs.index, rhs.index);
+  });
+  return tiles;
+}
+
+void MapTiler::stitch(const std::vector<MapTile>& tiles,
+                      const std::vector<DynamicSceneGraph::Ptr>& graphs,
+                      DynamicSceneGraph& output) const {
+  CHECK_EQ(tiles.size(), graphs.size());
+
+  // points outside of every tile are assigned to an extra "orphan" slot
+  const size_t orphan = tiles.size();
+  spatial_hash::IndexHashMap<size_t> tile_lookup;
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    tile_lookup[tiles[i].index] = i;
+  }
+
+  const auto owner = [&](const Eigen::Vector3d& point) {
+    const auto iter = tile_lookup.find(tileIndex(point));
+    return iter == tile_lookup.end() ? orphan : iter->second;
+  };
+
+  std::vector<VertexMap> vertex_maps;
+  const auto mesh = output.mesh();
+  if (mesh) {
+    vertex_maps = stitchMesh(
+        graphs,
+        [&](size_t t, const Eigen::Vector3d& point) { return owner(point) == t; },
+        config.vertex_tolerance_m,
+        *mesh);
+  }
+
+  // first pass: every tile adds the nodes inside its own region, with IDs assigned in
+  // tile order
+  std::map<char, size_t> next_index;
+  std::vector<std::unordered_map<NodeId, NodeId>> node_maps(tiles.size());
+  std::vector<NodeLookup> lookups(tiles.size() + 1,
+                                  NodeLookup(config.stitch_distance_m));
+  std::unordered_map<NodeId, size_t> node_tiles;
+  for (size_t t = 0; t < tiles.size(); ++t) {
+    if (!graphs[t]) {
+      continue;
+    }
+
+    for (const auto* node : sortedNodes(*graphs[t])) {
+      const LayerIndex layer(node->layer.layer, node->layer.partition);
+      const auto& pos = node->attributes().position;
+      const auto slot = owner(pos);
+      if (slot != t && slot != orphan) {
+        continue;
+      }
+
+      if (slot == orphan) {
+        const auto match = lookups[orphan].find(layer, pos, config.stitch_distance_m);
+        if (match) {
+          node_maps[t][node->id] = *match;
+          continue;
+        }
+      }
+
+      const auto category = NodeSymbol(node->id).category();
+      const NodeId new_id = NodeSymbol(category, next_index[category]++);
+      auto attrs = node->attributes().clone();
+      if (mesh) {
+        remapMeshConnections(*attrs, vertex_maps[t]);
+      }
+
+      output.addOrUpdateNode(layer.first, new_id, std::move(attrs), layer.second);
+      lookups[slot].insert(layer, new_id, pos);
+      node_maps[t][node->id] = new_id;
+      node_tiles[new_id] = t;
+    }
+  }
+
+  // second pass: nodes from the overlap margins map to the copy of the owning tile
+  for (size_t t = 0; t < tiles.size(); ++t) {
+    if (!graphs[t]) {
+      continue;
+    }
+
+    for (const auto* node : sortedNodes(*graphs[t])) {
+      if (node_maps[t].count(node->id)) {
+        continue;
+      }
+
+      const LayerIndex layer(node->layer.layer, node->layer.partition);
+      const auto& pos = node->attributes().position;
+      const auto match = lookups[owner(pos)].find(layer, pos, config.stitch_distance_m);
+      if (match) {
+        node_maps[t][node->id] = *match;
+      }
+    }
+  }
+
+  // objects cut by a tile seam are detected in (part) by both tiles
+  std::vector<NodeId> seam_objects;
+  for (const auto& [node_id, tile] : node_tiles) {
+    const auto attrs = output.getNode(node_id).tryAttributes<ObjectNodeAttributes>();
+    if (!attrs) {
+      continue;
+    }
+
+    const auto corners = attrs->bounding_box.corners();
+    const auto first = tileIndex(corners.front().cast<double>());
+    for (const auto& corner : corners) {
+      if (tileIndex(corner.cast<double>()) != first) {
+        seam_objects.push_back(node_id);
+        break;
+      }
+    }
+  }
+
+  std::sort(seam_objects.begin(), seam_objects.end());
+  std::unordered_map<NodeId, NodeId> merged;
+  for (size_t i = 0; i < seam_objects.size(); ++i) {
+    const auto node_id = seam_objects[i];
+    if (merged.count(node_id)) {
+      continue;
+    }
+
+    const auto& node = output.getNode(node_id);
+    auto& attrs = node.attributes<ObjectNodeAttributes>();
+    for (size_t j = i + 1; j < seam_objects.size(); ++j) {
+      const auto other_id = seam_objects[j];
+      if (merged.count(other_id) || node_tiles.at(other_id) == node_tiles.at(node_id)) {
+        continue;
+      }
+
+      const auto& other_attrs =
+          output.getNode(other_id).attributes<ObjectNodeAttributes>();
+      if (other_attrs.semantic_label != attrs.semantic_label) {
+        continue;
+      }
+
+      if (!attrs.bounding_box.contains(other_attrs.position) &&
+          !other_attrs.bounding_box.contains(attrs.position)) {
+        continue;
+      }
+
+      std::unordered_set<size_t> seen(attrs.mesh_connections.begin(),
+                                      attrs.mesh_connections.end());
+      for (const auto idx : other_attrs.mesh_connections) {
+        if (seen.insert(idx).second) {
+          attrs.mesh_connections.push_back(idx);
+        }
+      }
+
+      if (mesh) {
+        updateObjectGeometry(*mesh, attrs);
+      }
+
+      output.removeNode(other_id);
+      merged[other_id] = node_id;
+    }
+  }
+
+  const auto resolve = [&](size_t t, NodeId node_id) -> std::optional<NodeId> {
+    const auto iter = node_maps[t].find(node_id);
+    if (iter == node_maps[t].end()) {
+      return std::nullopt;
+    }
+
+    auto new_id = iter->second;
+    auto merged_iter = merged.find(new_id);
+    while (merged_iter != merged.end()) {
+      new_id = merged_iter->second;
+      merged_iter = merged.find(new_id);
+    }
+
+    return new_id;
+  };
+
+  for (size_t t = 0; t < tiles.size(); ++t) {
+    if (!graphs[t]) {
+      continue;
+    }
+
+    // edges are sorted so that the first tile to see an edge provides its attributes
+    std::vector<const SceneGraphEdge*> edges;
+    forEachEdge(*graphs[t], [&edges](const SceneGraphEdge& edge) {
+      edges.push_back(&edge);
+    });
+
+    std::sort(edges.begin(), edges.end(), [](const auto* lhs, const auto* rhs) {
+      return std::make_pair(lhs->source, lhs->target) <
+             std::make_pair(rhs->source, rhs->target);
+    });
+
+    for (const auto* edge : edges) {
+      const auto source = resolve(t, edge->source);
+      const auto target = resolve(t, edge->target);
+      if (!source || !target || *source == *target) {
+        continue;
+      }
+
+      if (!output.hasEdge(*source, *target)) {
+        output.insertEdge(*source, *target, edge->info->clone());
+      }
+    }
+  }
+}
+
+}  // namespace hydra
@@ -111,6 +111,7 @@ void declare_config(PipelineConfig& config) {
   field(config.enable_lcd, "enable_lcd");
   field(config.timing_disabled, "timing_disabled");
   field(config.disable_timer_output, "disable_timer_output");
+  field(config.keep_raw_timer_measurements, "keep_raw_timer_measurements");
   field(config.enable_pgmo_logging, "enable_pgmo_logging");
   field(config.default_verbosity, "default_verbosity");
   field(config.default_num_threads, "default_num_threads");
@@ -133,6 +134,7 @@ void GlobalInfo::configureTimers() {
   ElapsedTimeRecorder& timer = ElapsedTimeRecorder::instance();
   timer.timing_disabled = config_.timing_disabled;
   timer.disable_output = config_.disable_timer_output;
+  timer.keep_raw_measurements = config_.keep_raw_timer_measurements;
 }
 
 void GlobalInfo::initFromConfig(const PipelineConfig& config, int robot_id) {
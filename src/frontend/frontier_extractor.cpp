@@ -1,4 +1,5 @@
 #include <config_utilities/config_utilities.h>
+#include <config_utilities/types/conversions.h>
 #include <spark_dsg/dynamic_scene_graph.h>
 #include <spark_dsg/node_attributes.h>
 #include <spark_dsg/scene_graph_types.h>
@@ -22,13 +23,13 @@
 #include <pcl/segmentation/sac_segmentation.h>
 #undef PCL_NO_PRECOMPILE
 
-#include <queue>
 
 #include "hydra/common/config_utilities.h"
 #include "hydra/common/global_info.h"
 #include "hydra/frontend/frontier_extractor.h"
 #include "hydra/reconstruction/voxel_types.h"
 #include "hydra/utils/nearest_neighbor_utilities.h"
+#include "hydra/utils/parallel_utilities.h"
 
 namespace hydra {
 
@@ -185,138 +186,147 @@ std::vector<std::pair<Eigen::Vector3d, double>> getPlacesForBlock(
   return center_dists;
 }
 
-void computeVoxelsInPlace(
-    const Eigen::Vector3f block_origin,
+// Per-frame state shared by all blocks that are processed
+struct FrontierFrame {
+  const TsdfLayer& tsdf;
+  const DynamicSceneGraph& graph;
+  NearestNodeFinder& finder;
+  std::vector<std::pair<Eigen::Vector3d, double>> archived_center_dists;
+  double max_place_radius;
+  double min_frontier_z;
+  double max_frontier_z;
+};
+
+// Frontier voxels and unallocated neighboring blocks found for a single block
+struct BlockFrontiers {
+  std::vector<pcl::PointXYZ> points;
+  std::vector<pcl::PointXYZ> archived_points;
+  BlockIndices extra_blocks;
+};
+
+enum class VoxelPlaceStatus : uint8_t { UNKNOWN, OUTSIDE, PLACE, ARCHIVED_PLACE };
+
+VoxelPlaceStatus computeVoxelInPlace(
+    const Eigen::Vector3f& block_origin,
     const std::vector<std::pair<Eigen::Vector3d, double>>& center_dists,
     const std::vector<std::pair<Eigen::Vector3d, double>>& archived_center_dists,
-    const size_t voxels_per_block,
+    const size_t voxel_linear_index,
     const size_t voxels_per_side,
-    const double voxel_size,
-    std::vector<bool>& inside_place,
-    std::vector<bool>& inside_archived_place) {
-  for (size_t v = 0; v < voxels_per_block; ++v) {
-    VoxelIndex ind = spatial_hash::voxelIndexFromLinearIndex(v, voxels_per_side);
-    const Point center =
-        block_origin + spatial_hash::centerPointFromIndex(ind, voxel_size);
-    inside_place[v] = false;
-    for (const auto& cd : center_dists) {
-      if ((center - cd.first.cast<float>()).norm() <= cd.second) {
-        inside_place[v] = true;
-        break;
-      }
+    const double voxel_size) {
+  VoxelIndex ind =
+      spatial_hash::voxelIndexFromLinearIndex(voxel_linear_index, voxels_per_side);
+  const Point center = block_origin + spatial_hash::centerPointFromIndex(ind, voxel_size);
+  for (const auto& cd : center_dists) {
+    if ((center - cd.first.cast<float>()).norm() <= cd.second) {
+      return VoxelPlaceStatus::PLACE;
     }
-    inside_archived_place[v] = false;
-    if (inside_place[v]) {
-      continue;
-    }
-    for (const auto& cd : archived_center_dists) {
-      if ((center - cd.first.cast<float>()).norm() <= cd.second) {
-        inside_archived_place[v] = true;
-        break;
-      }
+  }
+
+  for (const auto& cd : archived_center_dists) {
+    if ((center - cd.first.cast<float>()).norm() <= cd.second) {
+      return VoxelPlaceStatus::ARCHIVED_PLACE;
     }
   }
+
+  return VoxelPlaceStatus::OUTSIDE;
 }
 
-void checkFreeNeighbors(const std::vector<bool>& inside_place,
-                        const std::vector<bool>& inside_archived_place,
-                        const int vps,
-                        const VoxelIndex& index,
-                        bool& neighbor_free,
-                        bool& neighbor_archived_free) {
-  const spatial_hash::NeighborSearch search(26);
-  for (const auto& neighbor : search.neighborIndices(index)) {
-    if (neighbor.array().minCoeff() < 0 || neighbor.array().maxCoeff() >= vps) {
-      continue;
-    }
-    const size_t vn = spatial_hash::linearIndexFromVoxelIndex(neighbor, vps);
-    neighbor_free = inside_place[vn];
-    neighbor_archived_free |= inside_archived_place[vn];
-    if (neighbor_free) {
-      return;
+std::vector<size_t> getUnobservedVoxels(const TsdfBlock& block) {
+  std::vector<size_t> unobserved;
+  for (size_t v = 0; v < block.numVoxels(); ++v) {
+    if (block.getVoxel(v).weight < 1e-6) {
+      unobserved.push_back(v);
     }
   }
+
+  return unobserved;
 }
 
-void processBlock(NearestNodeFinder& finder,
-                  const TsdfLayer& tsdf,
+// Unobserved voxels are passed explicitly (in increasing order); if not provided,
+// the block is not allocated and every voxel is considered unobserved
+void processBlock(const FrontierFrame& frame,
                   const BlockIndex& block_index,
+                  const std::vector<size_t>* unobserved_voxels,
                   const bool block_is_archived,
-                  const DynamicSceneGraph& graph,
-                  const std::vector<NodeId>& archived_places,
-                  const double max_place_radius,
-                  const double min_frontier_z,
-                  const double max_frontier_z,
                   const bool skip_adding_frontiers,
-                  IndexSet& skip_add_blocks,
-                  std::queue<BlockIndex>& extra_blocks,
-                  SpatialCloud::Ptr cloud,
-                  SpatialCloud::Ptr archived_cloud) {
-  // Get all active places near block
-  const Eigen::Vector3f block_center =
-      spatial_hash::centerPointFromIndex(block_index, tsdf.blockSize());
+                  BlockFrontiers& result) {
+  const auto& tsdf = frame.tsdf;
+  const auto block_size = tsdf.blockSize();
+  const auto vps = tsdf.voxels_per_side;
+  const size_t voxels_per_block = std::pow(vps, 3);
+  if (unobserved_voxels && unobserved_voxels->empty()) {
+    return;
+  }
+
+  // Skip blocks that are entirely outside the z band of voxels that we care about
   const Eigen::Vector3f block_origin =
-      spatial_hash::originPointFromIndex(block_index, tsdf.blockSize());
-  auto center_dists = getPlacesForBlock(
-      graph, block_center, finder, tsdf.blockSize(), max_place_radius);
+      spatial_hash::originPointFromIndex(block_index, block_size);
+  if (block_origin.z() + block_size < frame.min_frontier_z ||
+      block_origin.z() > frame.max_frontier_z) {
+    return;
+  }
 
-  // TODO(aaron): We should probably check to see if the whole block is outside of the
-  // z band of voxels we are about. Can greatly reduce amount of work.
+  // Get all active places near block
+  const Eigen::Vector3f block_center =
+      spatial_hash::centerPointFromIndex(block_index, block_size);
+  const auto center_dists = getPlacesForBlock(
+      frame.graph, block_center, frame.finder, block_size, frame.max_place_radius);
 
-  // Get all recently-archived places near block
+  // Get all recently-archived places that can contain a voxel of the block (the block
+  // size bounds the distance from the block center to any voxel center)
   std::vector<std::pair<Eigen::Vector3d, double>> archived_center_dists;
-  for (auto pid : archived_places) {
-    const auto node = graph.findNode(pid);
-    if (!node) {
-      continue;
+  for (const auto& cd : frame.archived_center_dists) {
+    const auto dist = (block_center - cd.first.cast<float>()).norm();
+    if (dist <= cd.second + block_size) {
+      archived_center_dists.push_back(cd);
     }
+  }
 
-    const auto& pattr = node->attributes<PlaceNodeAttributes>();
-    archived_center_dists.push_back({pattr.position, pattr.distance});
+  if (center_dists.empty() && archived_center_dists.empty()) {
+    // no voxel can be inside a place, so the block has no frontiers
+    return;
   }
 
-  // find all voxels that are inside a place
-  const size_t voxels_per_block = std::pow(tsdf.voxels_per_side, 3);
-  std::vector<bool> inside_place(voxels_per_block);
-  std::vector<bool> inside_archived_place(voxels_per_block);
+  // place membership is only computed for unobserved voxels and their neighbors
+  std::vector<VoxelPlaceStatus> status(voxels_per_block, VoxelPlaceStatus::UNKNOWN);
+  const auto get_status = [&](size_t v) {
+    if (status[v] == VoxelPlaceStatus::UNKNOWN) {
+      status[v] = computeVoxelInPlace(block_origin,
+                                      center_dists,
+                                      archived_center_dists,
+                                      v,
+                                      vps,
+                                      tsdf.voxel_size);
+    }
+    return status[v];
+  };
 
-  computeVoxelsInPlace(block_origin,
-                       center_dists,
-                       archived_center_dists,
-                       voxels_per_block,
-                       tsdf.voxels_per_side,
-                       tsdf.voxel_size,
-                       inside_place,
-                       inside_archived_place);
+  const spatial_hash::VoxelNeighborSearch block_search(tsdf, 6);
+  const spatial_hash::NeighborSearch voxel_search(26);
+  IndexSet seen_extra_blocks;
+  const size_t num_candidates =
+      unobserved_voxels ? unobserved_voxels->size() : voxels_per_block;
 
   // find voxels that are on boundary of unobserved space and space inside a place
-  for (size_t v = 0; v < voxels_per_block; ++v) {
-    // Check the voxel is not observed in the TSDF
-    const auto tsdf_block = tsdf.getBlockPtr(block_index);
-    if (tsdf_block && tsdf_block->getVoxel(v).weight >= 1e-6) {
-      continue;
-    }
-
-    const VoxelIndex voxel_index =
-        spatial_hash::voxelIndexFromLinearIndex(v, tsdf.voxels_per_side);
+  for (size_t i = 0; i < num_candidates; ++i) {
+    const size_t v = unobserved_voxels ? unobserved_voxels->at(i) : i;
+    const VoxelIndex voxel_index = spatial_hash::voxelIndexFromLinearIndex(v, vps);
 
     // Skip voxels outside of the window that we care about
     VoxelKey key(block_index, voxel_index);
     auto center = tsdf.getVoxelPosition(key);
-    if (center.z() < min_frontier_z or center.z() > max_frontier_z) {
+    if (center.z() < frame.min_frontier_z or center.z() > frame.max_frontier_z) {
       continue;
     }
 
     // If voxel is on the "border" of the block, and it is inside a place, and the
     // neighboring block is not allocated, need to add neighbor to queue of "extra"
     // blocks
-    if (inside_place[v] || inside_archived_place[v]) {
-      const spatial_hash::VoxelNeighborSearch search(tsdf, 6);
-      for (const auto& neighbor_key : search.neighborKeys({block_index, voxel_index})) {
+    if (get_status(v) != VoxelPlaceStatus::OUTSIDE) {
+      for (const auto& neighbor_key : block_search.neighborKeys(key)) {
         if (!tsdf.hasBlock(neighbor_key.first) &&
-            !skip_add_blocks.count(neighbor_key.first)) {
-          extra_blocks.push(neighbor_key.first);
-          skip_add_blocks.insert(neighbor_key.first);
+            seen_extra_blocks.insert(neighbor_key.first).second) {
+          result.extra_blocks.push_back(neighbor_key.first);
         }
       }
       continue;
@@ -325,14 +335,23 @@ void processBlock(NearestNodeFinder& finder,
     if (skip_adding_frontiers) {
       return;
     }
+
     bool neighbor_free = false;
     bool neighbor_archived_free = false;
-    checkFreeNeighbors(inside_place,
-                       inside_archived_place,
-                       tsdf.voxels_per_side,
-                       voxel_index,
-                       neighbor_free,
-                       neighbor_archived_free);
+    for (const auto& neighbor : voxel_search.neighborIndices(voxel_index)) {
+      if (neighbor.array().minCoeff() < 0 ||
+          neighbor.array().maxCoeff() >= static_cast<int>(vps)) {
+        continue;
+      }
+
+      const auto neighbor_status =
+          get_status(spatial_hash::linearIndexFromVoxelIndex(neighbor, vps));
+      neighbor_archived_free |= neighbor_status == VoxelPlaceStatus::ARCHIVED_PLACE;
+      if (neighbor_status == VoxelPlaceStatus::PLACE) {
+        neighbor_free = true;
+        break;
+      }
+    }
 
     if (!neighbor_free && !neighbor_archived_free) {
       continue;
@@ -342,9 +361,40 @@ void processBlock(NearestNodeFinder& finder,
     // that's inside a place is in an archived place
     bool archived = block_is_archived || (!neighbor_free && neighbor_archived_free);
     if (archived) {
-      archived_cloud->points.push_back({center.x(), center.y(), center.z()});
+      result.archived_points.push_back({center.x(), center.y(), center.z()});
     } else {
-      cloud->points.push_back({center.x(), center.y(), center.z()});
+      result.points.push_back({center.x(), center.y(), center.z()});
+    }
+  }
+}
+
+// Process blocks with a pool of workers. Results are stored per block so that
+// merging them afterwards is independent of the number of threads
+template <typename Func>
+void processBlocks(size_t num_blocks,
+                   int num_threads,
+                   std::vector<BlockFrontiers>& results,
+                   const Func& func) {
+  results.clear();
+  results.resize(num_blocks);
+  processInParallel(num_blocks, num_threads, [&](size_t i) { func(i, results[i]); });
+}
+
+// Merge per-block results in block order. Extra blocks are only queued once
+void mergeBlockFrontiers(const std::vector<BlockFrontiers>& results,
+                         SpatialCloud& cloud,
+                         SpatialCloud& archived_cloud,
+                         IndexSet& processed_extra_blocks,
+                         BlockIndices& extra_blocks) {
+  for (const auto& result : results) {
+    cloud.points.insert(cloud.points.end(), result.points.begin(), result.points.end());
+    archived_cloud.points.insert(archived_cloud.points.end(),
+                                 result.archived_points.begin(),
+                                 result.archived_points.end());
+    for (const auto& index : result.extra_blocks) {
+      if (processed_extra_blocks.insert(index).second) {
+        extra_blocks.push_back(index);
+      }
     }
   }
 }
@@ -417,7 +467,7 @@ void FrontierExtractor::computeSparseFrontiers(const SpatialCloud::Ptr cloud,
 }
 
 void FrontierExtractor::updateTsdf(const ActiveWindowOutput& msg) {
-  // allocate and copy tsdf
+  // allocate and copy tsdf (the active window output only contains updated blocks)
   const auto& tsdf_update = msg.map().getTsdfLayer();
   if (!tsdf_) {
     tsdf_.reset(new TsdfLayer(tsdf_update.voxel_size, tsdf_update.voxels_per_side));
@@ -425,6 +475,7 @@ void FrontierExtractor::updateTsdf(const ActiveWindowOutput& msg) {
 
   for (const auto& block : tsdf_update) {
     tsdf_->allocateBlock(block.index) = block;
+    unobserved_voxels_[block.index] = getUnobservedVoxels(block);
   }
 }
 
@@ -449,44 +500,57 @@ void FrontierExtractor::detectFrontiers(const ActiveWindowOutput& input,
   }
 
   if (place_finder_) {
-    std::queue<BlockIndex> extra_blocks;
+    FrontierFrame frame{*tsdf_,
+                        graph,
+                        *place_finder_,
+                        {},
+                        config.max_place_radius,
+                        min_frontier_z,
+                        max_frontier_z};
+
+    // Get all recently-archived places
+    for (auto pid : archived_places_) {
+      const auto node = graph.findNode(pid);
+      if (!node) {
+        continue;
+      }
+
+      const auto& pattr = node->attributes<PlaceNodeAttributes>();
+      frame.archived_center_dists.push_back({pattr.position, pattr.distance});
+    }
+
+    std::vector<BlockFrontiers> results;
     IndexSet processed_extra_blocks;
-    for (const auto& idx : tsdf_->allocatedBlockIndices()) {
-      processBlock(*place_finder_,
-                   *tsdf_,
+    BlockIndices extra_blocks;
+    const auto blocks = tsdf_->allocatedBlockIndices();
+    processBlocks(blocks.size(), config.num_threads, results, [&](size_t i, auto& res) {
+      const auto& idx = blocks[i];
+      processBlock(frame,
                    idx,
+                   &unobserved_voxels_.at(idx),
                    just_archived_blocks_.count(idx),
-                   graph,
-                   archived_places_,
-                   config.max_place_radius,
-                   min_frontier_z,
-                   max_frontier_z,
                    false,
-                   processed_extra_blocks,
-                   extra_blocks,
-                   cloud,
-                   archived_cloud);
-    }
+                   res);
+    });
+    mergeBlockFrontiers(
+        results, *cloud, *archived_cloud, processed_extra_blocks, extra_blocks);
 
+    // extra blocks are processed in the order they were discovered
     while (!extra_blocks.empty()) {
-      BlockIndex bix = extra_blocks.front();
-      extra_blocks.pop();
-      bool skip_adding_frontiers = recently_archived_blocks_.count(bix);
-
-      processBlock(*place_finder_,
-                   *tsdf_,
-                   bix,
-                   just_archived_blocks_.count(bix),
-                   graph,
-                   archived_places_,
-                   config.max_place_radius,
-                   min_frontier_z,
-                   max_frontier_z,
-                   skip_adding_frontiers,
-                   processed_extra_blocks,
-                   extra_blocks,
-                   cloud,
-                   archived_cloud);
+      BlockIndices next_blocks;
+      processBlocks(
+          extra_blocks.size(), config.num_threads, results, [&](size_t i, auto& res) {
+            const auto& bix = extra_blocks[i];
+            processBlock(frame,
+                         bix,
+                         nullptr,
+                         just_archived_blocks_.count(bix),
+                         recently_archived_blocks_.count(bix),
+                         res);
+          });
+      mergeBlockFrontiers(
+          results, *cloud, *archived_cloud, processed_extra_blocks, next_blocks);
+      extra_blocks = std::move(next_blocks);
     }
   }
 
@@ -567,6 +631,7 @@ void FrontierExtractor::updateRecentBlocks(const Eigen::Vector3d& current_pos,
 
     for (const auto& index : just_archived_blocks_) {
       tsdf_->removeBlock(index);
+      unobserved_voxels_.erase(index);
     }
   }
 
@@ -603,6 +668,8 @@ void declare_config(FrontierExtractor::Config& config) {
   field(config.minimum_relative_z, "minimum_relative_z");
   field(config.maximum_relative_z, "maximum_relative_z");
   field(config.compute_frontier_shape, "compute_frontier_shape");
+  field<ThreadNumConversion>(config.num_threads, "num_threads");
+  check(config.num_threads, GT, 0, "num_threads");
 }
 
 }  // namespace hydra
@@ -84,6 +84,13 @@ GvdPlaceExtractor::GvdPlaceExtractor(const Config& c)
     LOG(INFO) << "Downsampling TSDF when creating places!";
   }
 
+  const auto downsampler =
+      dynamic_cast<const DownsampleTsdfInterpolator*>(tsdf_interpolator_.get());
+  if (downsampler) {
+    // keep downsampled blocks between updates instead of rebuilding the layer
+    tsdf_pyramid_ = std::make_unique<TsdfPyramid>(downsampler->config);
+  }
+
   VLOG(1) << "\n" << Sink::printSinks(sinks_);
 }
 
@@ -126,12 +133,23 @@ void GvdPlaceExtractor::detect(const ActiveWindowOutput& msg) {
   }
 
   TsdfLayer::Ptr downsampled_tsdf;
-  if (tsdf_interpolator_) {
+  const TsdfLayer* downsampled = nullptr;
+  if (tsdf_pyramid_) {
+    ScopedTimer dtimer("frontend/downsample_tsdf", msg.timestamp_ns, true, 2, false);
+    // drop blocks that reconstruction removed from the TSDF layer
+    tsdf_pyramid_->removeBlocks(msg.archived_mesh_indices);
+    if (tsdf_pyramid_->update(map.getTsdfLayer())) {
+      downsampled = tsdf_pyramid_->level(0);
+    }
+  } else if (tsdf_interpolator_) {
     ScopedTimer dtimer("frontend/downsample_tsdf", msg.timestamp_ns, true, 2, false);
     downsampled_tsdf = tsdf_interpolator_->interpolate(map.getTsdfLayer());
+    downsampled = downsampled_tsdf.get();
   }
 
-  const auto& tsdf = downsampled_tsdf ? *downsampled_tsdf : map.getTsdfLayer();
+  const auto& tsdf = downsampled ? *downsampled : map.getTsdfLayer();
+  // the pyramid keeps every block in the window and flags the re-interpolated ones
+  const bool only_updated = downsampled && tsdf_pyramid_;
   const Eigen::Isometry3d world_T_body = msg.world_T_body();
   latest_pos_ = world_T_body.translation();
 
@@ -143,8 +161,10 @@ void GvdPlaceExtractor::detect(const ActiveWindowOutput& msg) {
   {  // start critical section
     std::unique_lock<std::mutex> lock(gvd_mutex_);
     ScopedTimer timer("places/gvd", msg.timestamp_ns);
-    // reconstruction now only sends updated blocks so we integrate everything
-    gvd_integrator_->updateFromTsdf(msg.timestamp_ns, tsdf, false, true);
+    // reconstruction now only sends updated blocks so we integrate everything (unless
+    // the pyramid is used, which flags the blocks that changed)
+    gvd_integrator_->updateFromTsdf(
+        msg.timestamp_ns, tsdf, only_updated, !only_updated);
     gvd_integrator_->updateGvd(msg.timestamp_ns, &graph_extractor_);
 
     if (map_window_) {
@@ -156,6 +176,9 @@ void GvdPlaceExtractor::detect(const ActiveWindowOutput& msg) {
       }
 
       gvd_integrator_->archiveBlocks(to_archive, &graph_extractor_);
+      if (tsdf_pyramid_) {
+        tsdf_pyramid_->removeBlocks(to_archive);
+      }
     }
   }  // end critical section
 
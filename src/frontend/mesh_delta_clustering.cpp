@@ -3,14 +3,25 @@
 #include <config_utilities/config.h>
 #include <glog/logging.h>
 #include <kimera_pgmo/mesh_delta.h>
-#include <pcl/point_cloud.h>
-#define PCL_NO_PRECOMPILE
-#include <pcl/search/kdtree.h>
-#include <pcl/segmentation/extract_clusters.h>
-#undef PCL_NO_PRECOMPILE
+
+#include <algorithm>
+#include <numeric>
 
 namespace hydra::clustering {
 
+using spatial_hash::LongIndex;
+
+namespace {
+
+// points closer than this (in meters) are treated as the same point between updates
+inline constexpr double kKeyScale = 1.0e4;
+
+inline LongIndex quantize(const Eigen::Vector3f& pos, double scale) {
+  return (pos.cast<double>() * scale).array().floor().cast<int64_t>();
+}
+
+}  // namespace
+
 void declare_config(ClusteringConfig& config) {
   using namespace config;
   name("ClusteringConfig");
@@ -74,38 +85,202 @@ LabelIndices getLabelIndices(const std::set<uint32_t>& desired_labels,
 Clusters findClusters(const ClusteringConfig& config,
                       const kimera_pgmo::MeshDelta& delta,
                       const std::vector<size_t>& indices) {
-  using pcl::PointXYZ;
-  pcl::PointCloud<PointXYZ>::Ptr cloud(new pcl::PointCloud<PointXYZ>());
-  cloud->resize(indices.size());
-  for (size_t i = 0; i < indices.size(); ++i) {
-    const auto& pos = delta.getVertex(indices.at(i)).pos;
-    auto& p = cloud->at(i);
-    p.x = pos.x();
-    p.y = pos.y();
-    p.z = pos.z();
-  }
-
-  pcl::search::KdTree<PointXYZ>::Ptr tree(new pcl::search::KdTree<PointXYZ>());
-  tree->setInputCloud(cloud);
-
-  pcl::EuclideanClusterExtraction<PointXYZ> estimator;
-  estimator.setClusterTolerance(config.cluster_tolerance);
-  estimator.setMinClusterSize(config.min_cluster_size);
-  estimator.setMaxClusterSize(config.max_cluster_size);
-  estimator.setSearchMethod(tree);
-  estimator.setInputCloud(cloud);
-
-  std::vector<pcl::PointIndices> result;
-  estimator.extract(result);
+  IncrementalClusters clusters(config);
+  return clusters.update(delta, indices);
+}
+
+IncrementalClusters::IncrementalClusters(const ClusteringConfig& config)
+    : config_(config), cell_scale_(1.0 / config.cluster_tolerance), num_linked_(0) {}
+
+void IncrementalClusters::reset() {
+  nodes_.clear();
+  free_nodes_.clear();
+  key_to_node_.clear();
+  cells_.clear();
+  num_linked_ = 0;
+}
+
+size_t IncrementalClusters::addNode(const Eigen::Vector3f& pos, const LongIndex& key) {
+  size_t node;
+  if (free_nodes_.empty()) {
+    node = nodes_.size();
+    nodes_.emplace_back();
+  } else {
+    node = free_nodes_.back();
+    free_nodes_.pop_back();
+  }
+
+  auto& info = nodes_[node];
+  info.pos = pos;
+  info.key = key;
+  info.cell = quantize(pos, cell_scale_);
+  info.parent = node;
+  info.members = {node};
+  key_to_node_[key] = node;
+  cells_[info.cell].push_back(node);
+  return node;
+}
+
+void IncrementalClusters::removeNode(size_t node) {
+  auto& info = nodes_[node];
+  auto cell_iter = cells_.find(info.cell);
+  if (cell_iter != cells_.end()) {
+    auto& cell = cell_iter->second;
+    cell.erase(std::remove(cell.begin(), cell.end(), node), cell.end());
+    if (cell.empty()) {
+      cells_.erase(cell_iter);
+    }
+  }
+
+  key_to_node_.erase(info.key);
+  info.members.clear();
+  free_nodes_.push_back(node);
+}
+
+size_t IncrementalClusters::findRoot(size_t node) {
+  while (nodes_[node].parent != node) {
+    // path halving
+    auto& parent = nodes_[node].parent;
+    parent = nodes_[parent].parent;
+    node = parent;
+  }
+
+  return node;
+}
+
+void IncrementalClusters::link(size_t lhs, size_t rhs) {
+  lhs = findRoot(lhs);
+  rhs = findRoot(rhs);
+  if (lhs == rhs) {
+    return;
+  }
+
+  if (nodes_[lhs].members.size() < nodes_[rhs].members.size()) {
+    std::swap(lhs, rhs);
+  }
+
+  auto& members = nodes_[lhs].members;
+  auto& other_members = nodes_[rhs].members;
+  members.insert(members.end(), other_members.begin(), other_members.end());
+  other_members.clear();
+  nodes_[rhs].parent = lhs;
+}
+
+void IncrementalClusters::linkNeighbors(size_t node) {
+  ++num_linked_;
+  const auto tolerance_sq = config_.cluster_tolerance * config_.cluster_tolerance;
+  const auto center = nodes_[node].cell;
+  for (int64_t x = -1; x <= 1; ++x) {
+    for (int64_t y = -1; y <= 1; ++y) {
+      for (int64_t z = -1; z <= 1; ++z) {
+        const auto iter = cells_.find(center + LongIndex(x, y, z));
+        if (iter == cells_.end()) {
+          continue;
+        }
+
+        for (const auto other : iter->second) {
+          if (other == node) {
+            continue;
+          }
+
+          const auto dist_sq = (nodes_[node].pos - nodes_[other].pos).squaredNorm();
+          if (dist_sq <= tolerance_sq) {
+            link(node, other);
+          }
+        }
+      }
+    }
+  }
+}
+
+Clusters IncrementalClusters::update(const std::vector<Eigen::Vector3f>& points) {
+  num_linked_ = 0;
+
+  spatial_hash::LongIndexHashMap<std::vector<size_t>> current;
+  for (size_t i = 0; i < points.size(); ++i) {
+    current[quantize(points[i], kKeyScale)].push_back(i);
+  }
+
+  // clusters that lose a point may split, so all remaining points in the cluster
+  // have to be relinked
+  std::vector<size_t> removed;
+  for (const auto& [key, node] : key_to_node_) {
+    if (!current.count(key)) {
+      removed.push_back(node);
+    }
+  }
+
+  std::unordered_set<size_t> invalid_roots;
+  for (const auto node : removed) {
+    invalid_roots.insert(findRoot(node));
+  }
+
+  std::vector<size_t> to_link;
+  for (const auto root : invalid_roots) {
+    const auto members = nodes_[root].members;
+    for (const auto member : members) {
+      nodes_[member].parent = member;
+      nodes_[member].members = {member};
+      to_link.push_back(member);
+    }
+  }
+
+  std::unordered_set<size_t> removed_set(removed.begin(), removed.end());
+  for (const auto node : removed) {
+    removeNode(node);
+  }
+
+  to_link.erase(std::remove_if(to_link.begin(),
+                               to_link.end(),
+                               [&](size_t node) { return removed_set.count(node); }),
+                to_link.end());
+
+  for (const auto& [key, point_indices] : current) {
+    if (!key_to_node_.count(key)) {
+      to_link.push_back(addNode(points[point_indices.front()], key));
+    }
+  }
+
+  for (const auto node : to_link) {
+    linkNeighbors(node);
+  }
+
+  std::unordered_map<size_t, std::vector<size_t>> root_to_points;
+  for (const auto& [key, point_indices] : current) {
+    auto& cluster = root_to_points[findRoot(key_to_node_.at(key))];
+    cluster.insert(cluster.end(), point_indices.begin(), point_indices.end());
+  }
 
   Clusters clusters;
-  clusters.resize(result.size());
-  for (size_t k = 0; k < clusters.size(); ++k) {
-    auto& cluster = clusters.at(k);
-    const auto& pcl_indices = result.at(k).indices;
-    cluster.resize(pcl_indices.size());
-    for (size_t i = 0; i < pcl_indices.size(); ++i) {
-      cluster[i] = indices[pcl_indices[i]];
+  for (auto& [root, cluster] : root_to_points) {
+    if (cluster.size() < config_.min_cluster_size ||
+        cluster.size() > config_.max_cluster_size) {
+      continue;
+    }
+
+    std::sort(cluster.begin(), cluster.end());
+    clusters.push_back(std::move(cluster));
+  }
+
+  std::sort(clusters.begin(), clusters.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.size() == rhs.size() ? lhs.front() < rhs.front()
+                                    : lhs.size() > rhs.size();
+  });
+  return clusters;
+}
+
+Clusters IncrementalClusters::update(const kimera_pgmo::MeshDelta& delta,
+                                     const std::vector<size_t>& indices) {
+  std::vector<Eigen::Vector3f> points;
+  points.reserve(indices.size());
+  for (const auto idx : indices) {
+    points.push_back(delta.getVertex(idx).pos);
+  }
+
+  auto clusters = update(points);
+  for (auto& cluster : clusters) {
+    for (auto& idx : cluster) {
+      idx = indices[idx];
     }
   }
 
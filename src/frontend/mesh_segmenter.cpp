@@ -45,6 +45,8 @@
 #include <spark_dsg/bounding_box_extraction.h>
 #include <spark_dsg/printing.h>
 
+#include <limits>
+
 #include "hydra/utils/mesh_utilities.h"
 #include "hydra/utils/timing_utilities.h"
 
@@ -65,8 +67,10 @@ void declare_config(MeshSegmenter::Config& config) {
               {spark_dsg::BoundingBox::Type::AABB, "AABB"},
               {spark_dsg::BoundingBox::Type::OBB, "OBB"},
               {spark_dsg::BoundingBox::Type::RAABB, "RAABB"}});
+  field(config.merge_cell_size_m, "merge_cell_size_m");
   field(config.timer_namespace, "timer_namespace");
   field(config.sinks, "sinks");
+  check(config.merge_cell_size_m, GT, 0.0, "merge_cell_size_m");
 }
 
 template <typename LList, typename RList>
@@ -92,6 +96,69 @@ inline bool nodesMatch(const Cluster& cluster, const SceneGraphNode& node) {
       cluster.centroid);
 }
 
+// Spatial hash over object bounding boxes. If one object's bounding box contains the
+// position of another, the two bounding boxes overlap at that position, so the
+// objects share at least one cell and all matches are found among cell neighbors
+struct BoundingBoxIndex {
+  explicit BoundingBoxIndex(double cell_size) : scale(1.0 / cell_size) {}
+
+  void insert(NodeId node_id, const BoundingBox& bbox) {
+    Eigen::Vector3f lower = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+    Eigen::Vector3f upper = -lower;
+    for (const auto& corner : bbox.corners()) {
+      lower = lower.cwiseMin(corner);
+      upper = upper.cwiseMax(corner);
+    }
+
+    const auto min_cell = toCell(lower);
+    const auto max_cell = toCell(upper);
+    for (int64_t x = min_cell.x(); x <= max_cell.x(); ++x) {
+      for (int64_t y = min_cell.y(); y <= max_cell.y(); ++y) {
+        for (int64_t z = min_cell.z(); z <= max_cell.z(); ++z) {
+          auto& cell = cells[spatial_hash::LongIndex(x, y, z)];
+          if (cell.empty() || cell.back() != node_id) {
+            cell.push_back(node_id);
+          }
+        }
+      }
+    }
+
+    node_cells[node_id] = {min_cell, max_cell};
+  }
+
+  std::set<NodeId> candidates(NodeId node_id) const {
+    std::set<NodeId> result;
+    const auto iter = node_cells.find(node_id);
+    if (iter == node_cells.end()) {
+      return result;
+    }
+
+    const auto& [min_cell, max_cell] = iter->second;
+    for (int64_t x = min_cell.x(); x <= max_cell.x(); ++x) {
+      for (int64_t y = min_cell.y(); y <= max_cell.y(); ++y) {
+        for (int64_t z = min_cell.z(); z <= max_cell.z(); ++z) {
+          const auto cell = cells.find(spatial_hash::LongIndex(x, y, z));
+          if (cell != cells.end()) {
+            result.insert(cell->second.begin(), cell->second.end());
+          }
+        }
+      }
+    }
+
+    result.erase(node_id);
+    return result;
+  }
+
+  spatial_hash::LongIndex toCell(const Eigen::Vector3f& pos) const {
+    return (pos.cast<double>() * scale).array().floor().cast<int64_t>();
+  }
+
+  const double scale;
+  spatial_hash::LongIndexHashMap<std::vector<NodeId>> cells;
+  std::map<NodeId, std::pair<spatial_hash::LongIndex, spatial_hash::LongIndex>>
+      node_cells;
+};
+
 // TODO(nathan) move node ID to not be here
 MeshSegmenter::MeshSegmenter(const Config& config, const std::set<uint32_t>& labels)
     : config(config::checkValid(config)),
@@ -101,6 +168,7 @@ MeshSegmenter::MeshSegmenter(const Config& config, const std::set<uint32_t>& lab
   VLOG(2) << "[Mesh Segmenter] using labels: " << clustering::printLabels(labels_);
   for (const auto& label : labels_) {
     active_nodes_[label] = std::set<NodeId>();
+    label_clusters_.emplace(label, clustering::IncrementalClusters(config.clustering));
   }
 }
 
@@ -122,12 +190,18 @@ LabelClusters MeshSegmenter::detect(uint64_t stamp_ns,
     return label_clusters;
   }
 
-  for (const auto& [label, indices] : label_indices) {
-    if (indices.size() < config.clustering.min_cluster_size) {
+  for (auto& [label, clusterer] : label_clusters_) {
+    const auto iter = label_indices.find(label);
+    if (iter == label_indices.end() ||
+        iter->second.size() < config.clustering.min_cluster_size) {
+      clusterer.reset();
       continue;
     }
 
-    const auto result = clustering::findClusters(config.clustering, delta, indices);
+    const auto& indices = iter->second;
+    const auto result = clusterer.update(delta, indices);
+    VLOG(5) << "[Mesh Segmenter] Linked " << clusterer.numLinked() << " / "
+            << clusterer.size() << " point(s) for label " << label;
 
     auto iter = label_clusters.insert({label, {}}).first;
     auto& clusters = iter->second;
@@ -234,6 +308,12 @@ void MeshSegmenter::mergeActiveNodes(DynamicSceneGraph& graph, uint32_t label) {
   std::set<NodeId> merged_nodes;
 
   auto& curr_active = active_nodes_.at(label);
+  BoundingBoxIndex index(config.merge_cell_size_m);
+  for (const auto& node_id : curr_active) {
+    const auto& attrs = graph.getNode(node_id).attributes<SemanticNodeAttributes>();
+    index.insert(node_id, attrs.bounding_box);
+  }
+
   for (const auto& node_id : curr_active) {
     if (merged_nodes.count(node_id)) {
       continue;
@@ -241,11 +321,7 @@ void MeshSegmenter::mergeActiveNodes(DynamicSceneGraph& graph, uint32_t label) {
     const auto& node = graph.getNode(node_id);
 
     std::list<NodeId> to_merge;
-    for (const auto& other_id : curr_active) {
-      if (node_id == other_id) {
-        continue;
-      }
-
+    for (const auto& other_id : index.candidates(node_id)) {
       if (merged_nodes.count(other_id)) {
         continue;
       }
@@ -267,6 +343,8 @@ void MeshSegmenter::mergeActiveNodes(DynamicSceneGraph& graph, uint32_t label) {
 
     if (!to_merge.empty()) {
       updateObjectGeometry(*graph.mesh(), attrs);
+      // the merged object can now overlap objects it did not overlap before
+      index.insert(node_id, attrs.bounding_box);
     }
   }
 
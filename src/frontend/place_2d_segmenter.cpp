@@ -241,12 +241,26 @@ void Place2dSegmenter::updateGraph(uint64_t timestamp_ns,
     new_semiactive_places[label] = std::set<NodeId>();
   }
 
-  for (const auto& [label, ns1] : full_nodes) {
+  // Only places with overlapping ellipses can be connected (unless any overlap passes
+  // the threshold)
+  std::vector<std::pair<uint32_t, NodeId>> nodes(full_nodes.begin(), full_nodes.end());
+  std::vector<PlaceBounds2d> bounds;
+  for (const auto& [label, nid] : nodes) {
+    bounds.push_back(config.place_overlap_threshold < 0.0
+                         ? PlaceBounds2d()
+                         : getConnectionBounds(
+                               graph.getNode(nid).attributes<Place2dNodeAttributes>()));
+  }
+
+  const Place2dGridIndex index(bounds);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const auto& [label, ns1] = nodes[i];
     auto& attrs1 = graph.getNode(ns1).attributes<Place2dNodeAttributes>();
     attrs1.has_active_mesh_indices = attrs1.pcl_max_index >= offsets.archived_vertices;
 
     bool fixed_neighbors = true;
-    for (const auto& [neighbor_label, ns2] : full_nodes) {
+    for (const auto j : index.getCandidates(i)) {
+      const auto ns2 = nodes[j].second;
       if (ns1 == ns2) {
         continue;
       }
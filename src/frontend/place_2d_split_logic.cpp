@@ -274,6 +274,15 @@ bool shouldAddPlaceConnection(const Place2d& p1,
   }
 }
 
+PlaceBounds2d getConnectionBounds(const Place2dNodeAttributes& attrs) {
+  return PlaceBounds2d::fromEllipse(attrs.ellipse_matrix_compress,
+                                    attrs.ellipse_centroid.head(2));
+}
+
+PlaceBounds2d getConnectionBounds(const Place2d& place) {
+  return PlaceBounds2d::fromEllipse(place.ellipse_matrix_expand, place.ellipse_centroid);
+}
+
 void remapPlace2dMesh(Place2dNodeAttributes& attrs,
                       const kimera_pgmo::MeshOffsetInfo& offsets) {
   remapPlace2dConnections(attrs, offsets);
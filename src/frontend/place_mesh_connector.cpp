@@ -34,71 +34,238 @@
  * -------------------------------------------------------------------------- */
 #include "hydra/frontend/place_mesh_connector.h"
 
+#include <config_utilities/config.h>
+#include <config_utilities/types/conversions.h>
+#include <config_utilities/validation.h>
 #include <glog/logging.h>
-#include <glog/stl_logging.h>
 #include <kimera_pgmo/mesh_delta.h>
-#include <spark_dsg/node_attributes.h>
 
-#include <nanoflann.hpp>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include "hydra/utils/parallel_utilities.h"
 
 namespace hydra {
 
-using nanoflann::KDTreeSingleIndexAdaptor;
-using nanoflann::L2_Simple_Adaptor;
+using spark_dsg::NodeId;
 using spark_dsg::PlaceNodeAttributes;
 using spark_dsg::SceneGraphLayer;
+using spatial_hash::Index;
+
+namespace {
+
+inline void hashCombine(size_t& seed, size_t value) {
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+inline size_t hashVertex(const Eigen::Vector3f& pos,
+                         uint32_t label,
+                         const Index& cell,
+                         size_t slot) {
+  size_t seed = slot;
+  hashCombine(seed, spatial_hash::IndexHash()(cell));
+  for (int i = 0; i < 3; ++i) {
+    hashCombine(seed, std::hash<float>()(pos(i)));
+  }
+
+  hashCombine(seed, label);
+  return seed;
+}
+
+inline int floorDiv(int value, int divisor) {
+  return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+}  // namespace
 
-struct MeshDeltaAdaptor {
-  MeshDeltaAdaptor(const kimera_pgmo::MeshDelta& delta) : delta(delta) {}
+void declare_config(PlaceMeshConnector::Config& config) {
+  using namespace config;
+  name("PlaceMeshConnector::Config");
+  field(config.cell_size, "cell_size", "m");
+  field(config.block_ratio, "block_ratio");
+  field(config.max_search_rings, "max_search_rings");
+  field<ThreadNumConversion>(config.num_threads, "num_threads");
+  check(config.cell_size, GT, 0.0, "cell_size");
+  check(config.block_ratio, GT, 0, "block_ratio");
+  check(config.max_search_rings, GE, 0, "max_search_rings");
+  check(config.num_threads, GT, 0, "num_threads");
+}
 
-  inline size_t kdtree_get_point_count() const { return delta.getNumVertices(); }
+PlaceMeshConnector::PlaceMeshConnector(const Config& config)
+    : config(config::checkValid(config)) {}
+
+Index PlaceMeshConnector::toCell(const Eigen::Vector3d& position) const {
+  return (position / config.cell_size).array().floor().cast<int>();
+}
 
-  inline double kdtree_get_pt(const size_t idx, const size_t dim) const {
-    const auto& p = delta.getVertex(idx);
-    return dim == 0 ? p.pos.x() : (dim == 1 ? p.pos.y() : p.pos.z());
+Index PlaceMeshConnector::toBlock(const Index& cell) const {
+  return Index(floorDiv(cell.x(), config.block_ratio),
+               floorDiv(cell.y(), config.block_ratio),
+               floorDiv(cell.z(), config.block_ratio));
+}
+
+void PlaceMeshConnector::updateCells(const kimera_pgmo::MeshDelta& delta) {
+  // delta indices are only valid for the current delta, so the hash is rebuilt
+  cells_.clear();
+  for (size_t i = 0; i < delta.getNumVertices(); ++i) {
+    const auto& pos = delta.getVertex(i).pos;
+    cells_[toCell(pos.cast<double>())].push_back(i);
   }
 
-  template <class T>
-  bool kdtree_get_bbox(T&) const {
+  spatial_hash::IndexHashMap<size_t> signatures;
+  for (const auto& [cell, indices] : cells_) {
+    // sum of per-vertex hashes is independent of the cell iteration order
+    auto& signature = signatures[toBlock(cell)];
+    for (size_t slot = 0; slot < indices.size(); ++slot) {
+      const auto& v = delta.getVertex(indices[slot]);
+      signature += hashVertex(v.pos, v.traits.label, cell, slot);
+    }
+  }
+
+  changed_blocks_.clear();
+  for (const auto& [block, signature] : signatures) {
+    const auto iter = block_signatures_.find(block);
+    if (iter == block_signatures_.end() || iter->second != signature) {
+      changed_blocks_.insert(block);
+    }
+  }
+
+  for (const auto& [block, signature] : block_signatures_) {
+    if (!signatures.count(block)) {
+      changed_blocks_.insert(block);
+    }
+  }
+
+  block_signatures_ = std::move(signatures);
+}
+
+bool PlaceMeshConnector::isUnchanged(const PlaceNodeAttributes& attrs,
+                                     const PlaceCache& cache) const {
+  const auto& connections = attrs.voxblox_mesh_connections;
+  if (connections.size() != cache.size()) {
     return false;
   }
 
-  const kimera_pgmo::MeshDelta& delta;
-};
+  for (size_t i = 0; i < connections.size(); ++i) {
+    const auto& entry = cache[i];
+    const Eigen::Vector3d pos =
+        Eigen::Map<const Eigen::Vector3d>(connections[i].voxel_pos);
+    if (pos != entry.position) {
+      return false;
+    }
+
+    if (!entry.rings) {
+      // the match depends on every vertex of the mesh
+      if (!changed_blocks_.empty()) {
+        return false;
+      }
 
-struct MeshVertexLookup {
-  using Dist = L2_Simple_Adaptor<double, MeshDeltaAdaptor>;
-  using KDTree = KDTreeSingleIndexAdaptor<Dist, MeshDeltaAdaptor, 3, size_t>;
+      continue;
+    }
 
-  MeshVertexLookup(const kimera_pgmo::MeshDelta& delta) : adaptor(delta) {
-    kdtree.reset(new KDTree(3, adaptor));
-    kdtree->buildIndex();
+    // check every block overlapping the searched cells
+    const auto cell = toCell(pos);
+    const Index min_block = toBlock(Index(cell.array() - *entry.rings));
+    const Index max_block = toBlock(Index(cell.array() + *entry.rings));
+    for (int x = min_block.x(); x <= max_block.x(); ++x) {
+      for (int y = min_block.y(); y <= max_block.y(); ++y) {
+        for (int z = min_block.z(); z <= max_block.z(); ++z) {
+          if (changed_blocks_.count(Index(x, y, z))) {
+            return false;
+          }
+        }
+      }
+    }
   }
 
-  ~MeshVertexLookup() = default;
+  return true;
+}
 
-  std::optional<size_t> find(const Eigen::Vector3d& position) const {
-    size_t index;
-    double distance;
-    size_t num_found = kdtree->knnSearch(position.data(), 1, &index, &distance);
-    if (!num_found) {
-      return std::nullopt;
+bool PlaceMeshConnector::hasValidMatches(const PlaceCache& cache) const {
+  for (const auto& entry : cache) {
+    if (!entry.match) {
+      continue;
     }
 
-    // TODO(nathan) think about global indices
-    return index;
+    const auto iter = cells_.find(entry.match->cell);
+    if (iter == cells_.end() || entry.match->slot >= iter->second.size()) {
+      return false;
+    }
   }
 
-  MeshDeltaAdaptor adaptor;
-  std::unique_ptr<KDTree> kdtree;
-};
+  return true;
+}
+
+void PlaceMeshConnector::searchConnections(const kimera_pgmo::MeshDelta& delta,
+                                           const PlaceNodeAttributes& attrs,
+                                           PlaceCache& cache) const {
+  cache.clear();
+  for (const auto& connection : attrs.voxblox_mesh_connections) {
+    auto& entry = cache.emplace_back();
+    entry.position = Eigen::Map<const Eigen::Vector3d>(connection.voxel_pos);
+    const auto center = toCell(entry.position);
+
+    double best_distance = std::numeric_limits<double>::infinity();
+    const auto check_cell = [&](const Index& cell, const std::vector<size_t>& indices) {
+      for (size_t slot = 0; slot < indices.size(); ++slot) {
+        const auto& pos = delta.getVertex(indices[slot]).pos;
+        const auto distance = (pos.cast<double>() - entry.position).norm();
+        if (distance < best_distance) {
+          best_distance = distance;
+          entry.match = VertexMatch{cell, slot};
+        }
+      }
+    };
+
+    for (int r = 0; r <= config.max_search_rings; ++r) {
+      // only visit the shell of cells at Chebyshev distance r
+      for (int x = -r; x <= r; ++x) {
+        for (int y = -r; y <= r; ++y) {
+          for (int z = -r; z <= r; ++z) {
+            if (std::max({std::abs(x), std::abs(y), std::abs(z)}) != r) {
+              continue;
+            }
+
+            const Index cell = center + Index(x, y, z);
+            const auto iter = cells_.find(cell);
+            if (iter != cells_.end()) {
+              check_cell(cell, iter->second);
+            }
+          }
+        }
+      }
+
+      // vertices outside the searched rings are at least r cells away
+      if (best_distance <= r * config.cell_size) {
+        entry.rings = r;
+        break;
+      }
+    }
+
+    if (entry.rings) {
+      continue;
+    }
+
+    // the nearest vertex may be outside the searched rings, so check the rest
+    for (const auto& [cell, indices] : cells_) {
+      if ((cell - center).cwiseAbs().maxCoeff() > config.max_search_rings) {
+        check_cell(cell, indices);
+      }
+    }
+  }
+}
 
 size_t PlaceMeshConnector::addConnections(const kimera_pgmo::MeshDelta& delta,
                                           const SceneGraphLayer& places,
                                           const DeformationMapping& mapping) {
-  const MeshVertexLookup lookup(delta);
+  updateCells(delta);
 
   size_t num_missing = 0;
+  std::vector<std::pair<PlaceNodeAttributes*, PlaceCache*>> to_update;
+  std::unordered_map<NodeId, PlaceCache> prev_cache;
+  std::swap(prev_cache, cache_);
   for (const auto& [node_id, node] : places.nodes()) {
     auto& attrs = node->attributes<PlaceNodeAttributes>();
     // TODO(nathan) archive logic should live here if we actually track mesh vertices
@@ -106,36 +273,62 @@ size_t PlaceMeshConnector::addConnections(const kimera_pgmo::MeshDelta& delta,
       continue;
     }
 
-    attrs.deformation_connections.clear();
-    attrs.pcl_mesh_connections.clear();
-    attrs.mesh_vertex_labels.clear();
-
     if (attrs.voxblox_mesh_connections.empty()) {
+      attrs.deformation_connections.clear();
+      attrs.pcl_mesh_connections.clear();
+      attrs.mesh_vertex_labels.clear();
       ++num_missing;
       continue;
     }
 
-    for (auto& vertex : attrs.voxblox_mesh_connections) {
-      const Eigen::Vector3d pos = Eigen::Map<const Eigen::Vector3d>(vertex.voxel_pos);
-      const auto nearest = lookup.find(pos);
-      if (!nearest) {
+    // only active places are kept in the cache
+    auto iter = prev_cache.find(node_id);
+    auto& cache = cache_[node_id];
+    if (iter != prev_cache.end()) {
+      cache = std::move(iter->second);
+    }
+
+    to_update.emplace_back(&attrs, &cache);
+  }
+
+  std::atomic<size_t> num_searched(0);
+  processInParallel(to_update.size(), config.num_threads, [&](size_t i) {
+    auto& attrs = *to_update[i].first;
+    auto& cache = *to_update[i].second;
+    if (!isUnchanged(attrs, cache) || !hasValidMatches(cache)) {
+      searchConnections(delta, attrs, cache);
+      ++num_searched;
+    }
+
+    attrs.deformation_connections.clear();
+    attrs.pcl_mesh_connections.clear();
+    attrs.mesh_vertex_labels.clear();
+    for (size_t j = 0; j < cache.size(); ++j) {
+      const auto& match = cache[j].match;
+      if (!match) {
         continue;
       }
 
       // assign mesh vertex to relevant fields
-      const auto& v = delta.getVertex(*nearest);
-      vertex.vertex = *nearest;
-      attrs.pcl_mesh_connections.push_back(*nearest);
+      // TODO(nathan) think about global indices
+      const auto index = cells_.find(match->cell)->second[match->slot];
+      const auto& v = delta.getVertex(index);
+      auto& vertex = attrs.voxblox_mesh_connections[j];
+      vertex.vertex = index;
+      attrs.pcl_mesh_connections.push_back(index);
 
       // assign (potentially valid) deformation connection
-      attrs.deformation_connections.push_back(mapping.at(*nearest));
+      attrs.deformation_connections.push_back(index < mapping.size()
+                                                  ? mapping[index]
+                                                  : std::numeric_limits<size_t>::max());
       if (v.traits.properties.has_label) {
         attrs.mesh_vertex_labels.push_back(v.traits.label);
         vertex.label = v.traits.label;
       }
     }
-  }
+  });
 
+  num_searched_ = num_searched;
   return num_missing;
 }
 
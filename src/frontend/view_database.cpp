@@ -2,9 +2,14 @@
 
 #include <config_utilities/config.h>
 #include <config_utilities/factory.h>
+#include <config_utilities/validation.h>
 #include <glog/logging.h>
 #include <spark_dsg/printing.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 #include "hydra/common/pipeline_queues.h"
 #include "hydra/input/input_data.h"
 
@@ -16,13 +21,18 @@ void declare_config(ViewDatabase::Config& config) {
   field(config.view_selection_method, "view_selection_method");
   field(config.inflation_distance, "inflation_distance");
   field(config.layers, "layers");
+  field(config.index_cell_size, "index_cell_size");
+  field(config.max_cells_per_view, "max_cells_per_view");
   field(config.verbosity, "verbosity");
+  check(config.index_cell_size, GT, 0.0, "index_cell_size");
+  check(config.max_cells_per_view, GT, 0, "max_cells_per_view");
 }
 
 using NodeSet = std::unordered_set<NodeId>;
 
 ViewDatabase::ViewDatabase(const Config& config)
-    : config(config),
+    : config(config::checkValid(config)),
+      next_view_id_(0),
       view_selector_(config::create<ViewSelector>(config.view_selection_method)) {
   CHECK(view_selector_);
   for (const auto& layer : config.layers) {
@@ -32,29 +42,136 @@ ViewDatabase::ViewDatabase(const Config& config)
 
 ViewDatabase::~ViewDatabase() {}
 
+bool ViewDatabase::getViewCells(const FeatureView& view,
+                                std::vector<spatial_hash::LongIndex>& cells) const {
+  cells.clear();
+  if (!std::isfinite(view.range())) {
+    return false;
+  }
+
+  // views are bounded by a sphere of radius max range (plus inflation) around the
+  // sensor, so only cells overlapping the sphere's AABB can contain visible points
+  const auto radius = view.range() + config.inflation_distance;
+  const auto scale = 1.0 / config.index_cell_size;
+  const Eigen::Vector3d lower = ((view.position().array() - radius) * scale).floor();
+  const Eigen::Vector3d upper = ((view.position().array() + radius) * scale).floor();
+  const Eigen::Vector3d dims = upper - lower + Eigen::Vector3d::Ones();
+  if (dims.prod() > static_cast<double>(config.max_cells_per_view)) {
+    // long-range sensors would touch too many cells, so check them for every query
+    return false;
+  }
+
+  const spatial_hash::LongIndex min_cell = lower.cast<int64_t>();
+  const spatial_hash::LongIndex max_cell = upper.cast<int64_t>();
+
+  // a cell can only contain visible points if the ball around the cell center
+  // that covers the cell intersects the (inflated) frustum
+  const double half_diagonal = 0.5 * std::sqrt(3.0) * config.index_cell_size;
+  const float cell_inflation = config.inflation_distance + half_diagonal;
+  for (int64_t x = min_cell.x(); x <= max_cell.x(); ++x) {
+    for (int64_t y = min_cell.y(); y <= max_cell.y(); ++y) {
+      for (int64_t z = min_cell.z(); z <= max_cell.z(); ++z) {
+        const Eigen::Vector3d center =
+            (Eigen::Vector3d(x, y, z).array() + 0.5) * config.index_cell_size;
+        if (view.pointInView(center, cell_inflation)) {
+          cells.emplace_back(x, y, z);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+void ViewDatabase::addView(FeatureView::Ptr&& view) const {
+  if (!view) {
+    LOG_IF(INFO, config.verbosity >= 2) << "Dropped empty view!";
+    return;
+  }
+
+  const IndexEntry entry{next_view_id_++, view.get()};
+  std::vector<spatial_hash::LongIndex> cells;
+  if (!getViewCells(*view, cells)) {
+    unbounded_views_.push_back(entry);
+  } else {
+    for (const auto& cell : cells) {
+      view_index_[cell].push_back(entry);
+    }
+  }
+
+  views_.push_back(std::move(view));
+}
+
+void ViewDatabase::removeView(const FeatureView& view) const {
+  const auto matches = [&view](const IndexEntry& entry) { return entry.view == &view; };
+  std::vector<spatial_hash::LongIndex> cells;
+  if (!getViewCells(view, cells)) {
+    unbounded_views_.erase(
+        std::remove_if(unbounded_views_.begin(), unbounded_views_.end(), matches),
+        unbounded_views_.end());
+    return;
+  }
+
+  for (const auto& cell : cells) {
+    auto cell_iter = view_index_.find(cell);
+    if (cell_iter == view_index_.end()) {
+      continue;
+    }
+
+    auto& entries = cell_iter->second;
+    entries.erase(std::remove_if(entries.begin(), entries.end(), matches),
+                  entries.end());
+    if (entries.empty()) {
+      view_index_.erase(cell_iter);
+    }
+  }
+}
+
+ViewSelector::ViewList ViewDatabase::getCandidates(const Eigen::Vector3d& pos) const {
+  const Eigen::Vector3d scaled = (pos / config.index_cell_size).array().floor();
+  const spatial_hash::LongIndex cell = scaled.cast<int64_t>();
+
+  IndexEntries merged;
+  const auto iter = view_index_.find(cell);
+  if (iter == view_index_.end()) {
+    merged = unbounded_views_;
+  } else {
+    // both lists are sorted by id, so merging preserves the order views arrived in
+    merged.reserve(iter->second.size() + unbounded_views_.size());
+    std::merge(iter->second.begin(),
+               iter->second.end(),
+               unbounded_views_.begin(),
+               unbounded_views_.end(),
+               std::back_inserter(merged),
+               [](const auto& lhs, const auto& rhs) { return lhs.id < rhs.id; });
+  }
+
+  ViewSelector::ViewList candidates;
+  candidates.reserve(merged.size());
+  for (const auto& entry : merged) {
+    candidates.push_back(entry.view);
+  }
+
+  return candidates;
+}
+
 void ViewDatabase::updateAssignments(const DynamicSceneGraph& graph,
                                      const ArchivalCheck& should_archive) const {
   auto& queue = PipelineQueues::instance().input_features_queue;
   size_t new_views = 0;
   while (!queue.empty()) {
     ++new_views;
-    views_.push_back(queue.pop());
+    addView(queue.pop());
   }
 
   // clean up views
   auto iter = views_.begin();
   while (iter != views_.end()) {
     const auto& view = *iter;
-    if (!view) {
-      iter = views_.erase(iter);
-      LOG_IF(INFO, config.verbosity >= 2) << "Removed empty view!";
-      continue;
-    }
-
-    const Eigen::Vector3d view_pos = view->sensor_T_world.inverse().translation();
-    if (should_archive(view_pos, view->timestamp_ns)) {
+    if (should_archive(view->position(), view->timestamp_ns)) {
       LOG_IF(INFO, config.verbosity >= 2)
           << "Archived view @ " << view->timestamp_ns << " [ns]";
+      removeView(*view);
       iter = views_.erase(iter);
       continue;
     }
@@ -88,8 +205,13 @@ void ViewDatabase::updateAssignments(const DynamicSceneGraph& graph,
         continue;
       }
 
+      const auto candidates = getCandidates(attrs->position);
+      if (candidates.empty()) {
+        continue;
+      }
+
       ++num_assigned;
-      view_selector_->selectFeature(views_, config.inflation_distance, *attrs);
+      view_selector_->selectFeature(candidates, config.inflation_distance, *attrs);
     }
 
     LOG_IF(INFO, config.verbosity >= 1) << "Assigned features for " << num_assigned
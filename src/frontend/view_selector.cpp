@@ -18,12 +18,15 @@ FeatureView::FeatureView(uint64_t timestamp_ns,
     : timestamp_ns(timestamp_ns),
       sensor_T_world(sensor_T_world),
       feature(feature),
-      sensor_(sensor) {
+      sensor_(sensor),
+      world_t_sensor_(sensor_T_world.inverse().translation()) {
   CHECK(sensor_);
 }
 
 const Sensor& FeatureView::sensor() const { return *sensor_; }
 
+double FeatureView::range() const { return sensor_->max_range(); }
+
 bool FeatureView::pointInView(const Eigen::Vector3d& point_w,
                               float inflation_distance,
                               Eigen::Vector3d* point_s) const {
@@ -35,8 +38,20 @@ bool FeatureView::pointInView(const Eigen::Vector3d& point_w,
   return sensor_->pointIsInViewFrustum(p_s.cast<float>(), inflation_distance);
 }
 
+void ViewSelector::selectFeature(const FeatureList& views,
+                                 float inflation_distance,
+                                 SemanticNodeAttributes& attrs) const {
+  ViewList view_ptrs;
+  view_ptrs.reserve(views.size());
+  for (const auto& view : views) {
+    view_ptrs.push_back(view.get());
+  }
+
+  selectFeature(view_ptrs, inflation_distance, attrs);
+}
+
 struct BoundaryViewSelector : ViewSelector {
-  void selectFeature(const FeatureList& views,
+  void selectFeature(const ViewList& views,
                      float inflation_distance,
                      SemanticNodeAttributes& attrs) const override {
     double min_dist = std::numeric_limits<double>::max();
@@ -58,7 +73,7 @@ struct BoundaryViewSelector : ViewSelector {
       const auto dist = std::abs(radius - p_s.norm());
       if (dist < min_dist) {
         attrs.semantic_feature = view->feature;
-        best_view = view.get();
+        best_view = view;
         min_dist = dist;
       }
     }
@@ -73,7 +88,7 @@ struct BoundaryViewSelector : ViewSelector {
 };
 
 struct ClosestViewSelector : ViewSelector {
-  void selectFeature(const FeatureList& views,
+  void selectFeature(const ViewList& views,
                      float inflation_distance,
                      SemanticNodeAttributes& attrs) const override {
     const FeatureView* best_view = nullptr;
@@ -91,7 +106,7 @@ struct ClosestViewSelector : ViewSelector {
       // norm of position in sensor frame is distance in world frame
       const auto dist = p_s.norm();
       if (dist < min_dist) {
-        best_view = view.get();
+        best_view = view;
         min_dist = dist;
       }
     }
@@ -106,7 +121,7 @@ struct ClosestViewSelector : ViewSelector {
 };
 
 struct FusionViewSelector : ViewSelector {
-  void selectFeature(const FeatureList& views,
+  void selectFeature(const ViewList& views,
                      float inflation_distance,
                      SemanticNodeAttributes& attrs) const override {
     size_t num_visible = 0;
@@ -34,28 +34,72 @@
  * -------------------------------------------------------------------------- */
 #include "hydra/gnn/gnn_interface.h"
 
+#include <config_utilities/config.h>
+#include <config_utilities/types/enum.h>
+#include <config_utilities/validation.h>
 #include <glog/logging.h>
 
+#include <mutex>
+
+#include "hydra/gnn/graph_batch.h"
 #include "hydra/gnn/ort_utilities.h"
 
 namespace hydra::gnn {
 
-struct GnnInterfaceImpl {
-  explicit GnnInterfaceImpl(const std::string& model_path)
-      : GnnInterfaceImpl(model_path, {}) {}
+using OptimizationLevel = GnnInterface::OptimizationLevel;
+
+void declare_config(GnnInterface::Config& config) {
+  using namespace config;
+  name("GnnInterface::Config");
+  field(config.model_path, "model_path");
+  field(config.intra_op_threads, "intra_op_threads");
+  field(config.inter_op_threads, "inter_op_threads");
+  enum_field(config.optimization_level,
+             "optimization_level",
+             {{OptimizationLevel::DISABLE, "DISABLE"},
+              {OptimizationLevel::BASIC, "BASIC"},
+              {OptimizationLevel::EXTENDED, "EXTENDED"},
+              {OptimizationLevel::ALL, "ALL"}});
+  field(config.edge_fields, "edge_fields");
+  field(config.batch_field, "batch_field");
+  check(config.intra_op_threads, GT, 0, "intra_op_threads");
+  check(config.inter_op_threads, GT, 0, "inter_op_threads");
+}
+
+GraphOptimizationLevel toOrtLevel(OptimizationLevel level) {
+  switch (level) {
+    case OptimizationLevel::DISABLE:
+      return GraphOptimizationLevel::ORT_DISABLE_ALL;
+    case OptimizationLevel::BASIC:
+      return GraphOptimizationLevel::ORT_ENABLE_BASIC;
+    case OptimizationLevel::EXTENDED:
+      return GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+    case OptimizationLevel::ALL:
+    default:
+      return GraphOptimizationLevel::ORT_ENABLE_ALL;
+  }
+}
 
-  GnnInterfaceImpl(const std::string& model_path, const DynamicIndexMap& output_map)
-      : model_path(model_path),
+struct GnnInterfaceImpl {
+  struct OutputBuffer {
+    Tensor tensor;
+    Ort::Value value{nullptr};
+  };
+
+  GnnInterfaceImpl(const GnnInterface::Config& config,
+                   const DynamicIndexMap& output_map)
+      : model_path(config.model_path),
         output_map(output_map),
+        batch(config.edge_fields, config.batch_field),
         mem_info(Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator,
                                             OrtMemType::OrtMemTypeDefault)) {
     env.reset(new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "hydra_gnn_interface"));
     Ort::SessionOptions options;
-    options.SetIntraOpNumThreads(1).SetInterOpNumThreads(1);
+    options.SetIntraOpNumThreads(config.intra_op_threads)
+        .SetInterOpNumThreads(config.inter_op_threads)
+        .SetGraphOptimizationLevel(toOrtLevel(config.optimization_level));
     session.reset(new Ort::Session(*env, model_path.c_str(), options));
     allocator.reset(new Ort::AllocatorWithDefaultOptions());
-    mem_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator,
-                                          OrtMemType::OrtMemTypeDefault);
 
     inputs = getSessionInputs(session.get(), *allocator);
     for (const auto& input : inputs) {
@@ -82,20 +126,37 @@ struct GnnInterfaceImpl {
       input_values.push_back(input.makeOrtValue(mem_info, iter->second));
     }
 
+    // take ownership of cached output buffers so concurrent calls never share one
+    std::vector<OutputBuffer> buffers;
+    {
+      std::lock_guard<std::mutex> lock(buffer_mutex);
+      buffers = std::move(output_buffers);
+      output_buffers.clear();
+    }
+    buffers.resize(outputs.size());
+
     TensorMap tensor_outputs;
     std::vector<Ort::Value> output_values;
-    for (const auto& output : outputs) {
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      const auto& output = outputs[i];
       const auto iter = output_map.find(output.name);
-
-      Tensor tensor;
-      if (iter == output_map.end()) {
-        tensor = output.getTensor();
-      } else {
-        tensor = output.getDynamicTensor(iter->second, output_dimensions);
+      const auto is_dynamic = iter != output_map.end();
+      const auto dims = is_dynamic
+                            ? output.getDynamicDims(iter->second, output_dimensions)
+                            : output.dims;
+
+      // reuse the previous output buffer if nobody else is holding on to it
+      auto& buffer = buffers[i];
+      if (!buffer.value || buffer.tensor.shared() || buffer.tensor.dims() != dims) {
+        buffer.tensor = is_dynamic
+                            ? output.getDynamicTensor(iter->second, output_dimensions)
+                            : output.getTensor();
+        buffer.value = output.makeOrtValue(mem_info, buffer.tensor);
       }
 
-      tensor_outputs[output.name] = tensor;
-      output_values.push_back(output.makeOrtValue(mem_info, tensor));
+      tensor_outputs[output.name] = buffer.tensor;
+      output_values.push_back(std::move(buffer.value));
+      buffer.value = Ort::Value(nullptr);
     }
 
     session->Run(Ort::RunOptions(nullptr),
@@ -106,9 +167,30 @@ struct GnnInterfaceImpl {
                  output_values.data(),
                  output_names.size());
 
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      buffers[i].value = std::move(output_values[i]);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(buffer_mutex);
+      output_buffers = std::move(buffers);
+    }
+
     return tensor_outputs;
   }
 
+  std::vector<TensorMap> runBatch(const std::vector<TensorMap>& graphs) const {
+    if (graphs.empty()) {
+      return {};
+    }
+
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    batch.pack(graphs);
+    const auto output = (*this)(batch.input(),
+                                {batch.numNodes(), static_cast<int64_t>(batch.size())});
+    return batch.unpack(output);
+  }
+
   std::string model_path;
 
   std::vector<FieldInfo> inputs;
@@ -118,6 +200,11 @@ struct GnnInterfaceImpl {
 
   DynamicIndexMap output_map;
 
+  mutable std::mutex buffer_mutex;
+  mutable std::vector<OutputBuffer> output_buffers;
+  mutable std::mutex batch_mutex;
+  mutable GraphBatch batch;
+
   std::unique_ptr<Ort::Env> env;
   std::unique_ptr<Ort::AllocatorWithDefaultOptions> allocator;
   std::unique_ptr<Ort::Session> session;
@@ -159,8 +246,11 @@ GnnInterface::GnnInterface(const std::string& model_path)
 
 GnnInterface::GnnInterface(const std::string& model_path,
                            const DynamicIndexMap& output_map)
-    : model_path_(model_path) {
-  impl_.reset(new GnnInterfaceImpl(model_path, output_map));
+    : GnnInterface(Config{model_path}, output_map) {}
+
+GnnInterface::GnnInterface(const Config& config, const DynamicIndexMap& output_map)
+    : config(config::checkValid(config)) {
+  impl_.reset(new GnnInterfaceImpl(this->config, output_map));
 }
 
 GnnInterface::~GnnInterface() {}
@@ -179,6 +269,10 @@ TensorMap GnnInterface::operator()(const TensorMap& input,
   return (*impl_)(input, output_sizes);
 }
 
+std::vector<TensorMap> GnnInterface::batch(const std::vector<TensorMap>& inputs) const {
+  return impl_->runBatch(inputs);
+}
+
 std::ostream& operator<<(std::ostream& out, const GnnInterface& gnn) {
   out << "providers: ";
   const auto providers = Ort::GetAvailableProviders();
@@ -0,0 +1,236 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/gnn/graph_batch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace hydra::gnn {
+
+namespace {
+
+inline size_t rowBytes(const Tensor& tensor) {
+  return tensor.rows() ? tensor.num_bytes() / tensor.rows() : 0;
+}
+
+inline Tensor sliceRows(const Tensor& tensor, int64_t start, int64_t num_rows) {
+  auto dims = tensor.dims();
+  dims[0] = num_rows;
+  Tensor result(dims, tensor.type());
+  const auto stride = rowBytes(tensor);
+  std::memcpy(result.data<char>(false),
+              tensor.data<char>(false) + start * stride,
+              num_rows * stride);
+  return result;
+}
+
+template <typename T>
+void copyEdges(const Tensor& edges, int64_t node_offset, int64_t col, Tensor& packed) {
+  const auto num_edges = edges.cols();
+  const auto total_edges = packed.cols();
+  const T* src = edges.data<T>();
+  T* dest = packed.data<T>();
+  for (int64_t r = 0; r < 2; ++r) {
+    const T* src_row = src + r * num_edges;
+    T* dest_row = dest + r * total_edges + col;
+    for (int64_t i = 0; i < num_edges; ++i) {
+      dest_row[i] = src_row[i] + static_cast<T>(node_offset);
+    }
+  }
+}
+
+}  // namespace
+
+GraphBatch::GraphBatch(const std::vector<std::string>& edge_fields,
+                       const std::string& batch_field)
+    : edge_fields_(edge_fields), batch_field_(batch_field) {}
+
+Tensor& GraphBatch::getBuffer(const std::string& name,
+                              const std::vector<int64_t>& dims,
+                              Tensor::Type type) {
+  auto iter = input_.find(name);
+  if (iter == input_.end()) {
+    return input_.emplace(name, Tensor(dims, type)).first->second;
+  }
+
+  auto& tensor = iter->second;
+  if (tensor.shared() || tensor.type() != type || tensor.dims() != dims) {
+    tensor = Tensor(dims, type);
+  }
+
+  return tensor;
+}
+
+void GraphBatch::pack(const std::vector<TensorMap>& graphs) {
+  node_offsets_.assign(1, 0);
+  edge_offsets_.assign(1, 0);
+  if (graphs.empty()) {
+    input_.clear();
+    return;
+  }
+
+  for (auto iter = input_.begin(); iter != input_.end();) {
+    if (iter->first == batch_field_ || graphs.front().count(iter->first)) {
+      ++iter;
+    } else {
+      iter = input_.erase(iter);
+    }
+  }
+
+  const auto& edge_name = edge_fields_.empty() ? std::string() : edge_fields_.front();
+  for (const auto& graph : graphs) {
+    if (graph.size() != graphs.front().size()) {
+      throw std::invalid_argument("all graphs in batch must have the same inputs");
+    }
+
+    int64_t num_nodes = -1;
+    for (const auto& [name, tensor] : graph) {
+      const auto is_edge = std::count(edge_fields_.begin(), edge_fields_.end(), name);
+      if (is_edge || tensor.num_dims() == 0) {
+        continue;
+      }
+
+      if (num_nodes >= 0 && tensor.rows() != num_nodes) {
+        std::stringstream ss;
+        ss << "node input '" << name << "' has " << tensor.rows()
+           << " rows (expected " << num_nodes << ")";
+        throw std::invalid_argument(ss.str());
+      }
+
+      num_nodes = tensor.rows();
+    }
+
+    const auto edge_iter = graph.find(edge_name);
+    const auto num_edges = edge_iter == graph.end() ? 0 : edge_iter->second.cols();
+    node_offsets_.push_back(node_offsets_.back() + std::max<int64_t>(num_nodes, 0));
+    edge_offsets_.push_back(edge_offsets_.back() + num_edges);
+  }
+
+  for (const auto& [name, first] : graphs.front()) {
+    const bool is_edge =
+        std::count(edge_fields_.begin(), edge_fields_.end(), name) > 0;
+    auto dims = first.dims();
+    if (dims.empty()) {
+      continue;
+    }
+
+    int64_t total = 0;
+    for (const auto& graph : graphs) {
+      const auto iter = graph.find(name);
+      if (iter == graph.end() || iter->second.type() != first.type() ||
+          iter->second.num_dims() != dims.size()) {
+        std::stringstream ss;
+        ss << "input '" << name << "' is missing or inconsistent across graphs";
+        throw std::invalid_argument(ss.str());
+      }
+
+      total += is_edge ? iter->second.cols() : iter->second.rows();
+    }
+
+    dims[is_edge ? 1 : 0] = total;
+    auto& packed = getBuffer(name, dims, first.type());
+    if (is_edge) {
+      if (dims.size() != 2 || dims[0] != 2) {
+        std::stringstream ss;
+        ss << "edge input '" << name << "' must have shape 2 x E";
+        throw std::invalid_argument(ss.str());
+      }
+
+      int64_t col = 0;
+      for (size_t i = 0; i < graphs.size(); ++i) {
+        const auto& edges = graphs[i].at(name);
+        switch (edges.type()) {
+          case Tensor::Type::INT64:
+            copyEdges<int64_t>(edges, node_offsets_[i], col, packed);
+            break;
+          case Tensor::Type::INT32:
+            copyEdges<int32_t>(edges, node_offsets_[i], col, packed);
+            break;
+          default:
+            throw std::invalid_argument("edge indices must be int32 or int64");
+        }
+
+        col += edges.cols();
+      }
+
+      continue;
+    }
+
+    char* dest = packed.data<char>(false);
+    for (const auto& graph : graphs) {
+      const auto& tensor = graph.at(name);
+      std::memcpy(dest, tensor.data<char>(false), tensor.num_bytes());
+      dest += tensor.num_bytes();
+    }
+  }
+
+  if (batch_field_.empty()) {
+    return;
+  }
+
+  auto& batch = getBuffer(batch_field_, {numNodes()}, Tensor::Type::INT64);
+  int64_t* batch_data = batch.data<int64_t>();
+  for (size_t i = 0; i < graphs.size(); ++i) {
+    std::fill(batch_data + node_offsets_[i],
+              batch_data + node_offsets_[i + 1],
+              static_cast<int64_t>(i));
+  }
+}
+
+std::vector<TensorMap> GraphBatch::unpack(const TensorMap& outputs) const {
+  std::vector<TensorMap> results(size());
+  for (const auto& [name, output] : outputs) {
+    const auto num_rows = output.rows();
+    if (num_rows == numNodes() && output.num_dims()) {
+      for (size_t i = 0; i < results.size(); ++i) {
+        const auto start = node_offsets_[i];
+        results[i][name] = sliceRows(output, start, node_offsets_[i + 1] - start);
+      }
+    } else if (num_rows == static_cast<int64_t>(size()) && output.num_dims()) {
+      for (size_t i = 0; i < results.size(); ++i) {
+        results[i][name] = sliceRows(output, i, 1);
+      }
+    } else {
+      for (auto& result : results) {
+        result[name] = output;
+      }
+    }
+  }
+
+  return results;
+}
+
+}  // namespace hydra::gnn
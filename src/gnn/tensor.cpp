@@ -112,6 +112,8 @@ int64_t Tensor::cols() const {
   return dims_[1];
 }
 
+bool Tensor::shared() const { return memory_.use_count() > 1; }
+
 std::string getTensorTypeStr(Tensor::Type type) {
   switch (type) {
     case Tensor::Type::FLOAT32:
@@ -197,6 +197,27 @@ bool Camera::pointIsInViewFrustum(const Eigen::Vector3f& point_C,
   return true;
 }
 
+bool Camera::projectBoundsToImagePlane(const Eigen::Matrix3Xf& points_C,
+                                       float& u_min,
+                                       float& u_max,
+                                       float& v_min,
+                                       float& v_max) const {
+  // the projection of the convex hull is the convex hull of the projected points as
+  // long as every point is in front of the camera
+  if (points_C.cols() == 0 || (points_C.row(2).array() <= 0.0f).any()) {
+    return false;
+  }
+
+  const Eigen::ArrayXf inv_z = points_C.row(2).array().inverse();
+  const Eigen::ArrayXf u = points_C.row(0).array() * inv_z * config_.fx + config_.cx;
+  const Eigen::ArrayXf v = points_C.row(1).array() * inv_z * config_.fy + config_.cy;
+  u_min = u.minCoeff();
+  u_max = u.maxCoeff();
+  v_min = v.minCoeff();
+  v_max = v.maxCoeff();
+  return true;
+}
+
 cv::Mat Camera::computeVertexMap(const cv::Mat& depth_image,
                                  const Eigen::Isometry3f* T_W_C) const {
   // Compute the 3D pointcloud from a depth image.
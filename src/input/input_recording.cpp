@@ -0,0 +1,319 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/input/input_recording.h"
+
+#include <glog/logging.h>
+
+#include <array>
+#include <type_traits>
+
+namespace hydra {
+namespace {
+
+inline constexpr std::array<char, 8> kMagic{'H', 'Y', 'D', 'R', 'A', 'I', 'N', '\0'};
+inline constexpr uint32_t kVersion = 1;
+
+enum class PacketType : uint8_t { IMAGE = 0, CLOUD = 1 };
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::istream& in, T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeString(std::ostream& out, const std::string& str) {
+  writeValue<uint64_t>(out, str.size());
+  out.write(str.data(), str.size());
+}
+
+// Number of unread bytes in the stream, used to reject sizes from corrupt recordings
+// before allocating anything
+uint64_t remainingBytes(std::istream& in) {
+  const auto current = in.tellg();
+  if (current < 0) {
+    return 0;
+  }
+
+  in.seekg(0, std::ios::end);
+  const auto end = in.tellg();
+  in.seekg(current);
+  return end > current ? static_cast<uint64_t>(end - current) : 0;
+}
+
+bool readString(std::istream& in, std::string& str) {
+  uint64_t size;
+  if (!readValue(in, size) || size > remainingBytes(in)) {
+    return false;
+  }
+
+  str.resize(size);
+  return static_cast<bool>(in.read(str.data(), size));
+}
+
+void writeFeature(std::ostream& out, const FeatureVector& feature) {
+  writeValue<uint64_t>(out, feature.size());
+  out.write(reinterpret_cast<const char*>(feature.data()),
+            feature.size() * sizeof(FeatureVector::Scalar));
+}
+
+bool readFeature(std::istream& in, FeatureVector& feature) {
+  uint64_t size;
+  if (!readValue(in, size) ||
+      size > remainingBytes(in) / sizeof(FeatureVector::Scalar)) {
+    return false;
+  }
+
+  feature.resize(size);
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(feature.data()),
+                                   size * sizeof(FeatureVector::Scalar)));
+}
+
+void writeMat(std::ostream& out, const cv::Mat& mat) {
+  writeValue<int32_t>(out, mat.rows);
+  writeValue<int32_t>(out, mat.cols);
+  writeValue<int32_t>(out, mat.type());
+  if (mat.empty()) {
+    return;
+  }
+
+  const cv::Mat contiguous = mat.isContinuous() ? mat : mat.clone();
+  out.write(reinterpret_cast<const char*>(contiguous.data),
+            contiguous.total() * contiguous.elemSize());
+}
+
+bool readMat(std::istream& in, cv::Mat& mat) {
+  int32_t rows, cols, type;
+  if (!readValue(in, rows) || !readValue(in, cols) || !readValue(in, type)) {
+    return false;
+  }
+
+  if (rows <= 0 || cols <= 0) {
+    mat = cv::Mat();
+    return true;
+  }
+
+  if (type != CV_MAT_TYPE(type)) {
+    return false;
+  }
+
+  const uint64_t num_elements = static_cast<uint64_t>(rows) * cols;
+  if (num_elements > remainingBytes(in) / CV_ELEM_SIZE(type)) {
+    return false;
+  }
+
+  mat.create(rows, cols, type);
+  return static_cast<bool>(
+      in.read(reinterpret_cast<char*>(mat.data), mat.total() * mat.elemSize()));
+}
+
+}  // namespace
+
+InputPacketWriter::InputPacketWriter(const std::filesystem::path& filepath)
+    : out_(filepath, std::ios::binary | std::ios::trunc) {
+  if (!out_) {
+    LOG(ERROR) << "Unable to open recording " << filepath << " for writing";
+    return;
+  }
+
+  out_.write(kMagic.data(), kMagic.size());
+  writeValue(out_, kVersion);
+}
+
+bool InputPacketWriter::write(const InputPacket& packet) {
+  if (!out_ || !packet.sensor_input) {
+    return false;
+  }
+
+  const auto& sensor_input = *packet.sensor_input;
+  const auto image = dynamic_cast<const ImageInputPacket*>(&sensor_input);
+  const auto cloud = dynamic_cast<const CloudInputPacket*>(&sensor_input);
+  if (!image && !cloud) {
+    LOG(ERROR) << "Unable to record unknown input type for sensor '"
+               << sensor_input.sensor_name << "'";
+    return false;
+  }
+
+  writeValue(out_, image ? PacketType::IMAGE : PacketType::CLOUD);
+  writeValue(out_, packet.timestamp_ns);
+  writeValue(out_, packet.world_t_body.x());
+  writeValue(out_, packet.world_t_body.y());
+  writeValue(out_, packet.world_t_body.z());
+  writeValue(out_, packet.world_R_body.w());
+  writeValue(out_, packet.world_R_body.x());
+  writeValue(out_, packet.world_R_body.y());
+  writeValue(out_, packet.world_R_body.z());
+
+  writeValue(out_, sensor_input.timestamp_ns);
+  writeString(out_, sensor_input.sensor_name);
+  writeString(out_, sensor_input.sensor_frame);
+  writeFeature(out_, sensor_input.input_feature);
+  if (image) {
+    writeValue<uint8_t>(out_, image->color_is_bgr);
+    writeMat(out_, image->color);
+    writeMat(out_, image->depth);
+    writeMat(out_, image->labels);
+    writeValue<uint64_t>(out_, image->label_features.size());
+    for (const auto& [label, feature] : image->label_features) {
+      writeValue<int32_t>(out_, label);
+      writeFeature(out_, feature);
+    }
+  } else {
+    writeValue<uint8_t>(out_, cloud->in_world_frame);
+    writeMat(out_, cloud->points);
+    writeMat(out_, cloud->colors);
+    writeMat(out_, cloud->labels);
+  }
+
+  if (!out_) {
+    LOG(ERROR) << "Failed to write input @ " << packet.timestamp_ns << " [ns]";
+    return false;
+  }
+
+  ++num_written_;
+  return true;
+}
+
+InputPacketReader::InputPacketReader(const std::filesystem::path& filepath)
+    : in_(filepath, std::ios::binary) {
+  if (!in_) {
+    LOG(ERROR) << "Unable to open recording " << filepath;
+    return;
+  }
+
+  std::array<char, kMagic.size()> magic;
+  uint32_t version;
+  if (!in_.read(magic.data(), magic.size()) || magic != kMagic ||
+      !readValue(in_, version)) {
+    LOG(ERROR) << "Invalid recording " << filepath;
+    return;
+  }
+
+  if (version != kVersion) {
+    LOG(ERROR) << "Unsupported recording version " << version << " (expected "
+               << kVersion << ") for " << filepath;
+    return;
+  }
+
+  data_start_ = in_.tellg();
+  valid_ = true;
+}
+
+InputPacket::Ptr InputPacketReader::next() {
+  if (!valid_) {
+    return nullptr;
+  }
+
+  PacketType type;
+  if (!readValue(in_, type)) {
+    return nullptr;  // end of recording
+  }
+
+  auto packet = std::make_shared<InputPacket>();
+  std::array<double, 7> pose;
+  bool valid = readValue(in_, packet->timestamp_ns);
+  for (auto& value : pose) {
+    valid &= readValue(in_, value);
+  }
+
+  uint64_t sensor_stamp;
+  std::string sensor_name;
+  valid &= readValue(in_, sensor_stamp) && readString(in_, sensor_name);
+  if (!valid) {
+    LOG(ERROR) << "Truncated recording: failed to read packet header";
+    valid_ = false;
+    return nullptr;
+  }
+
+  packet->world_t_body << pose[0], pose[1], pose[2];
+  packet->world_R_body = Eigen::Quaterniond(pose[3], pose[4], pose[5], pose[6]);
+
+  std::shared_ptr<SensorInputPacket> sensor_input;
+  if (type == PacketType::IMAGE) {
+    auto image = std::make_shared<ImageInputPacket>(sensor_stamp, sensor_name);
+    valid = readString(in_, image->sensor_frame) &&
+            readFeature(in_, image->input_feature);
+    uint8_t color_is_bgr = 0;
+    uint64_t num_features = 0;
+    valid = valid && readValue(in_, color_is_bgr) && readMat(in_, image->color) &&
+            readMat(in_, image->depth) && readMat(in_, image->labels) &&
+            readValue(in_, num_features);
+    for (uint64_t i = 0; valid && i < num_features; ++i) {
+      int32_t label;
+      valid = readValue(in_, label) && readFeature(in_, image->label_features[label]);
+    }
+
+    image->color_is_bgr = color_is_bgr;
+    sensor_input = image;
+  } else if (type == PacketType::CLOUD) {
+    auto cloud = std::make_shared<CloudInputPacket>(sensor_stamp, sensor_name);
+    uint8_t in_world_frame = 0;
+    valid = readString(in_, cloud->sensor_frame) &&
+            readFeature(in_, cloud->input_feature) && readValue(in_, in_world_frame) &&
+            readMat(in_, cloud->points) && readMat(in_, cloud->colors) &&
+            readMat(in_, cloud->labels);
+    cloud->in_world_frame = in_world_frame;
+    sensor_input = cloud;
+  } else {
+    valid = false;
+  }
+
+  if (!valid) {
+    LOG(ERROR) << "Corrupt recording: failed to read input @ " << packet->timestamp_ns
+               << " [ns]";
+    valid_ = false;
+    return nullptr;
+  }
+
+  packet->sensor_input = sensor_input;
+  return packet;
+}
+
+void InputPacketReader::rewind() {
+  if (!valid_ && data_start_ == std::streampos()) {
+    return;  // never opened successfully
+  }
+
+  in_.clear();
+  in_.seekg(data_start_);
+  valid_ = static_cast<bool>(in_);
+}
+
+}  // namespace hydra
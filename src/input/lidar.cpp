@@ -312,6 +312,51 @@ bool Lidar::projectPointToImagePlane(const Eigen::Vector3f& p_C, int& u, int& v)
   return true;
 }
 
+bool Lidar::projectBoundsToImagePlane(const Eigen::Matrix3Xf& points_C,
+                                      float& u_min,
+                                      float& u_max,
+                                      float& v_min,
+                                      float& v_max) const {
+  if (points_C.cols() == 0) {
+    return false;
+  }
+
+  const Eigen::Vector3f lower = points_C.rowwise().minCoeff();
+  const Eigen::Vector3f upper = points_C.rowwise().maxCoeff();
+  // azimuth is only bounded by the points if the hull doesn't contain the vertical axis
+  // or cross the discontinuity at theta = +/-pi (checked conservatively with the AABB)
+  if (lower.x() <= 0.0f && lower.y() <= 0.0f && upper.y() >= 0.0f) {
+    return false;
+  }
+
+  float theta_min = std::numeric_limits<float>::max();
+  float theta_max = std::numeric_limits<float>::lowest();
+  float rho_max = 0.0f;
+  for (int i = 0; i < points_C.cols(); ++i) {
+    const auto theta = std::atan2(points_C(1, i), points_C(0, i));
+    theta_min = std::min(theta_min, theta);
+    theta_max = std::max(theta_max, theta);
+    rho_max = std::max(rho_max, points_C.col(i).head<2>().norm());
+  }
+
+  // elevation increases with height and decreases with horizontal distance, which is
+  // bounded below by the distance to the AABB
+  const Eigen::Vector2f closest =
+      Eigen::Vector2f::Zero().cwiseMax(lower.head<2>()).cwiseMin(upper.head<2>());
+  const float rho_min = closest.norm();
+  const float phi_max = std::atan2(upper.z(), upper.z() >= 0.0f ? rho_min : rho_max);
+  const float phi_min = std::atan2(lower.z(), lower.z() >= 0.0f ? rho_max : rho_min);
+
+  // u and v decrease with theta and phi respectively
+  const float v_top = config_.is_asymmetric ? vertical_fov_top_rad_
+                                            : vertical_fov_rad_ / 2.0f;
+  v_min = height_ * (v_top - phi_max) / vertical_fov_rad_;
+  v_max = height_ * (v_top - phi_min) / vertical_fov_rad_;
+  u_min = width_ * (horizontal_fov_rad_ / 2.0f - theta_max) / horizontal_fov_rad_;
+  u_max = width_ * (horizontal_fov_rad_ / 2.0f - theta_min) / horizontal_fov_rad_;
+  return true;
+}
+
 bool Lidar::pointIsInViewFrustum(const Eigen::Vector3f& point_C,
                                  float inflation_distance) const {
   if (point_C.norm() > config_.max_range + inflation_distance) {
@@ -0,0 +1,187 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/input/replay_receiver.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+#include <chrono>
+
+#include "hydra/input/input_recording.h"
+
+namespace hydra {
+
+void declare_config(ReplayReceiver::Config& config) {
+  using namespace config;
+  name("ReplayReceiver::Config");
+  base<DataReceiver::Config>(config);
+  field(config.recording, "recording");
+  field(config.use_recorded_rate, "use_recorded_rate");
+  field(config.rate_scale, "rate_scale");
+  checkCondition(!config.recording.empty(), "recording is required");
+  check(config.rate_scale, GT, 0.0, "rate_scale");
+}
+
+ReplayReceiver::ReplayReceiver(const Config& config, const std::string& sensor_name)
+    : DataReceiver(config, sensor_name), config(config::checkValid(config)) {}
+
+ReplayReceiver::~ReplayReceiver() {
+  should_shutdown_ = true;
+  if (spin_thread_) {
+    spin_thread_->join();
+    spin_thread_.reset();
+  }
+}
+
+bool ReplayReceiver::initImpl() {
+  if (spin_thread_) {
+    return true;
+  }
+
+  spin_thread_ = std::make_unique<std::thread>(&ReplayReceiver::spin, this);
+  return true;
+}
+
+PoseStatus ReplayReceiver::popBodyPose(uint64_t timestamp_ns) {
+  std::lock_guard<std::mutex> lock(pose_mutex_);
+  auto iter = poses_.find(timestamp_ns);
+  if (iter == poses_.end()) {
+    return {};
+  }
+
+  const auto pose = iter->second;
+  poses_.erase(iter);
+  return pose;
+}
+
+void ReplayReceiver::spin() {
+  InputPacketReader reader(config.recording);
+  if (!reader.good()) {
+    LOG(ERROR) << "[Replay Receiver] Unable to replay " << config.recording;
+    finished_ = true;
+    return;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  std::optional<uint64_t> first_stamp;
+  Clock::time_point start_time;
+  size_t num_skipped = 0;
+  while (!should_shutdown_) {
+    const auto packet = reader.next();
+    if (!packet) {
+      break;
+    }
+
+    const auto& input = packet->sensor_input;
+    if (input->sensor_name != sensor_name_) {
+      ++num_skipped;
+      continue;
+    }
+
+    if (!checkInputTimestamp(input->timestamp_ns)) {
+      continue;
+    }
+
+    if (config.use_recorded_rate) {
+      if (!first_stamp) {
+        first_stamp = input->timestamp_ns;
+        start_time = Clock::now();
+      }
+
+      const std::chrono::nanoseconds offset(input->timestamp_ns - *first_stamp);
+      std::this_thread::sleep_until(
+          start_time + std::chrono::duration_cast<Clock::duration>(
+                           offset / config.rate_scale));
+    }
+
+    {  // poses need to be available before the packet can be popped
+      std::lock_guard<std::mutex> lock(pose_mutex_);
+      auto& pose = poses_[input->timestamp_ns];
+      pose.is_valid = true;
+      pose.target_p_source = packet->world_t_body;
+      pose.target_R_source = packet->world_R_body;
+    }
+
+    // bounded queues apply backpressure instead of dropping data
+    while (!should_shutdown_ && !queue.push(input, true, 1000)) {
+    }
+
+    ++num_replayed_;
+  }
+
+  LOG_IF(WARNING, num_skipped > 0)
+      << "[Replay Receiver] Skipped " << num_skipped << " packet(s) for other sensors";
+  VLOG(1) << "[Replay Receiver] Finished replaying " << num_replayed_
+          << " packet(s) for '" << sensor_name_ << "'";
+  finished_ = true;
+}
+
+ReplayInputModule::ReplayInputModule(const Config& config,
+                                     const OutputQueue::Ptr& output_queue)
+    : InputModule(config, output_queue) {
+  for (const auto& receiver : receivers_) {
+    auto replay = dynamic_cast<ReplayReceiver*>(receiver.get());
+    if (!replay) {
+      LOG(WARNING) << "[Replay Input] Ignoring non-replay receiver for poses";
+      continue;
+    }
+
+    replay_receivers_.push_back(replay);
+  }
+}
+
+bool ReplayInputModule::finished() const {
+  for (const auto receiver : replay_receivers_) {
+    if (!receiver->finished() || !receiver->queue.empty()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+PoseStatus ReplayInputModule::getBodyPose(uint64_t timestamp) {
+  for (const auto receiver : replay_receivers_) {
+    const auto pose = receiver->popBodyPose(timestamp);
+    if (pose) {
+      return pose;
+    }
+  }
+
+  return {};
+}
+
+}  // namespace hydra
@@ -69,6 +69,14 @@ Sensor::Sensor(const Config& config, const std::string& name)
           << std::setfill(' ') << sensor_body_pose.matrix().format(fmt);
 }
 
+bool Sensor::projectBoundsToImagePlane(const Eigen::Matrix3Xf&,
+                                       float&,
+                                       float&,
+                                       float&,
+                                       float&) const {
+  return false;
+}
+
 YAML::Node Sensor::dump() const { return config::toYaml(config); }
 
 void declare_config(Sensor::Config& conf) {
@@ -41,8 +41,10 @@
 
 #include <glog/logging.h>
 
+#include <atomic>
 #include <fstream>
 
+#include "hydra/utils/parallel_utilities.h"
 #include "hydra/utils/timing_utilities.h"
 
 namespace hydra::lcd {
@@ -82,6 +84,10 @@ void configureDescriptorFactories(lcd::LcdDetector& detector,
     embeddings = loadLabelEmbeddings(config.gnn_lcd.label_embeddings_file);
   }
 
+  GnnDescriptorOptions options;
+  options.num_threads = config.gnn_lcd.num_threads;
+  options.batch_inference = config.gnn_lcd.batch_inference;
+
   LcdDetector::FactoryMap factories;
   factories.emplace(
       DsgLayers::OBJECTS,
@@ -89,12 +95,14 @@ void configureDescriptorFactories(lcd::LcdDetector& detector,
                                             config.object_extraction,
                                             config.gnn_lcd.object_connection_radius_m,
                                             embeddings,
-                                            config.gnn_lcd.objects_pos_in_feature));
+                                            config.gnn_lcd.objects_pos_in_feature,
+                                            options));
   factories.emplace(
       DsgLayers::PLACES,
       std::make_unique<PlaceGnnDescriptor>(config.gnn_lcd.places_model_path,
                                            config.places_extraction,
-                                           config.gnn_lcd.places_pos_in_feature));
+                                           config.gnn_lcd.places_pos_in_feature,
+                                           options));
   detector.setDescriptorFactories(std::move(factories));
 }
 #else
@@ -107,7 +115,8 @@ using hydra::timing::ScopedTimer;
 using SearchConfigMap = std::map<std::string, DescriptorMatchConfig>;
 using RegConfigMap = std::map<std::string, LayerRegistrationConfig>;
 
-LcdDetector::LcdDetector(const LcdDetectorConfig& config) : config_(config) {
+LcdDetector::LcdDetector(const LcdDetectorConfig& config)
+    : config_(config), subgraph_index_(std::make_shared<SubgraphIndex>()) {
   makeDefaultDescriptorFactories();
   if (config_.use_gnn_descriptors) {
     configureDescriptorFactories(*this, config_);
@@ -225,6 +234,10 @@ void LcdDetector::resetLayerAssignments(const SearchConfigMap& search_configs,
   // TODO(nathan) this is messy
   registration_solvers_.clear();
 
+  for (auto& [layer, factory] : layer_factories_) {
+    factory->subgraph_index = subgraph_index_;
+  }
+
   size_t internal_idx = 1;  // agent is 0
   for (auto&& [layer, layer_config] : search_configs) {
     if (!layer_factories_.count(layer)) {
@@ -279,19 +292,33 @@ bool LcdDetector::addNewDescriptors(const DynamicSceneGraph& graph,
   }
 
   leaf_cache_[*parent][agent_node.id] = agent_factory_->construct(graph, agent_node);
+  return true;
+}
 
-  for (const auto& prefix_func_pair : layer_factories_) {
-    if (cache_map_[prefix_func_pair.first].count(*parent)) {
-      continue;
+void LcdDetector::addLayerDescriptors(
+    const DynamicSceneGraph& graph,
+    const std::vector<const SceneGraphNode*>& agent_nodes) {
+  for (const auto& [layer, factory] : layer_factories_) {
+    auto& cache = cache_map_[layer];
+
+    // the first agent node of every root without a descriptor is used for the root
+    std::set<NodeId> roots;
+    std::vector<const SceneGraphNode*> to_construct;
+    for (const auto agent_node : agent_nodes) {
+      const auto parent = agent_node->getParent();
+      if (!parent || cache.count(*parent) || !roots.insert(*parent).second) {
+        continue;
+      }
+
+      to_construct.push_back(agent_node);
     }
 
     // guaranteed to exist by constructor
-    Descriptor::Ptr layer_descriptor =
-        prefix_func_pair.second->construct(graph, agent_node);
-    cache_map_[prefix_func_pair.first][*parent] = std::move(layer_descriptor);
+    auto descriptors = factory->constructBatch(graph, to_construct);
+    for (size_t i = 0; i < to_construct.size(); ++i) {
+      cache[*to_construct[i]->getParent()] = std::move(descriptors.at(i));
+    }
   }
-
-  return true;
 }
 
 void LcdDetector::updateDescriptorCache(
@@ -299,7 +326,10 @@ void LcdDetector::updateDescriptorCache(
     const std::unordered_set<NodeId>& archived_places,
     uint64_t timestamp) {
   ScopedTimer timer("lcd/update_descriptors", timestamp, true, 2, false);
+  subgraph_index_->update(dsg, archived_places);
+  subgraph_index_->startBatch();
 
+  std::vector<const SceneGraphNode*> agent_nodes;
   for (const auto& place_id : archived_places) {
     if (!dsg.hasNode(place_id)) {
       continue;  // ideally this doesn't happen in practice, but worth building in the
@@ -315,9 +345,14 @@ void LcdDetector::updateDescriptorCache(
       }
 
       // every agent node only has one parent
-      addNewDescriptors(dsg, child);
+      if (addNewDescriptors(dsg, child)) {
+        agent_nodes.push_back(&child);
+      }
     }
   }
+
+  // layer descriptors for all new roots are computed together
+  addLayerDescriptors(dsg, agent_nodes);
 }
 
 std::vector<RegistrationSolution> LcdDetector::registerAndVerify(
@@ -345,6 +380,7 @@ std::vector<RegistrationSolution> LcdDetector::registerAndVerify(
       continue;
     }
 
+    std::vector<size_t> candidates;
     for (size_t i = 0; i < match.match_root.size(); i++) {
       if (match.score[i] < match_config_map_.at(idx).min_registration_score) {
         break;
@@ -354,17 +390,39 @@ std::vector<RegistrationSolution> LcdDetector::registerAndVerify(
       CHECK(dsg.hasNode(root)) << "Invalid match root: " << NodeSymbol(root).str();
       CHECK(dsg.hasNode(match.query_root))
           << "Invalid query root: " << NodeSymbol(match.query_root).str();
+      candidates.push_back(i);
+    }
 
-      DsgRegistrationInput registration_input = {match.query_nodes,
-                                                 match.match_nodes[i],
-                                                 match.query_root,
-                                                 match.match_root[i]};
-      registration_result =
-          registration_solvers_.at(idx)->solve(dsg, registration_input, agent_id);
+    // register candidates with a bounded pool of workers. Candidates after the first
+    // valid registration are skipped, so results match sequential registration
+    const auto& solver = *registration_solvers_.at(idx);
+    std::vector<RegistrationSolution> results(candidates.size());
+    std::atomic<size_t> first_valid(candidates.size());
+    processInParallel(
+        candidates.size(), config_.num_registration_threads, [&](size_t c) {
+          if (c > first_valid) {
+            return;
+          }
+
+          const auto i = candidates[c];
+          const DsgRegistrationInput registration_input = {match.query_nodes,
+                                                           match.match_nodes[i],
+                                                           match.query_root,
+                                                           match.match_root[i]};
+          results[c] = solver.solve(dsg, registration_input, agent_id);
+          if (!results[c].valid) {
+            return;
+          }
+
+          size_t current = first_valid;
+          while (c < current && !first_valid.compare_exchange_weak(current, c)) {
+            // current holds the latest value after a failed exchange
+          }
+        });
+
+    if (first_valid < candidates.size()) {
+      registration_result = results[first_valid];
       registration_result.level = static_cast<int64_t>(idx);
-      if (registration_result.valid) {
-        break;
-      }
     }
 
     if (registration_result.valid) {
@@ -401,6 +459,7 @@ std::vector<RegistrationSolution> LcdDetector::detect(const DynamicSceneGraph& d
                                                       NodeId agent_id,
                                                       uint64_t timestamp) {
   ScopedTimer timer("lcd/detect", timestamp, true, 2, false);
+  subgraph_index_->startBatch();
   std::set<NodeId> prev_valid_roots;
   for (const auto& id_desc_pair : cache_map_[root_layer_]) {
     prev_valid_roots.insert(id_desc_pair.first);
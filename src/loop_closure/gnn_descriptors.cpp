@@ -35,21 +35,139 @@
 #include "hydra/loop_closure/gnn_descriptors.h"
 
 #include <glog/logging.h>
+#include <spatial_hash/hash.h>
 #include <yaml-cpp/yaml.h>
 
-#include <deque>
+#include <algorithm>
+#include <functional>
+
+#include "hydra/utils/parallel_utilities.h"
 
 namespace hydra::lcd {
 
 using Dsg = DynamicSceneGraph;
-using DsgNode = DynamicSceneGraphNode;
+
+namespace {
+
+using InputFunc = std::function<gnn::TensorMap(const std::set<NodeId>&)>;
+
+std::unique_ptr<gnn::GnnInterface> makeModel(const std::string& model_path,
+                                             bool batch_inference) {
+  if (!batch_inference) {
+    return std::make_unique<gnn::GnnInterface>(model_path);
+  }
+
+  gnn::GnnInterface::Config config;
+  config.model_path = model_path;
+  // the dynamic output axis is the number of graphs in the batch
+  return std::make_unique<gnn::GnnInterface>(config,
+                                             gnn::DynamicIndexMap{{"output", {1}}});
+}
+
+inline void logInput(const gnn::TensorMap& input) {
+  VLOG(20) << "Inputs:";
+  VLOG(20) << "  - x: " << std::endl << input.at("x").map<float>();
+  VLOG(20) << "  - edge_index: " << std::endl << input.at("edge_index").map<int64_t>();
+  const auto pos = input.find("pos");
+  if (pos != input.end()) {
+    VLOG(20) << "  - pos: " << std::endl << pos->second.map<float>();
+  }
+}
+
+inline void setOutput(gnn::Tensor output, Descriptor& descriptor) {
+  VLOG(20) << "--------------------------------------";
+  VLOG(20) << "Output type: " << output;
+  VLOG(20) << "Output:" << std::endl << output.map<float>();
+  descriptor.values = output.map<float>().transpose();
+}
+
+gnn::Tensor makeEdgeIndex(const std::vector<std::pair<int64_t, int64_t>>& edges) {
+  // note that edges is built in an undirected manner, so edges.size() = 2 * |E|
+  gnn::Tensor edge_index(2, edges.size(), gnn::Tensor::Type::INT64);
+  auto edge_map = edge_index.map<int64_t>();
+  size_t edge_idx = 0;
+  for (const auto& edge : edges) {
+    edge_map(0, edge_idx) = edge.first;
+    edge_map(1, edge_idx) = edge.second;
+    ++edge_idx;
+  }
+
+  return edge_index;
+}
+
+// Subgraphs are extracted serially (the subgraph index caches are not thread-safe),
+// while input tensors (and unbatched inference) are computed in parallel
+std::vector<Descriptor::Ptr> constructDescriptors(
+    const Dsg& graph,
+    const std::vector<const SceneGraphNode*>& agent_nodes,
+    const SubgraphConfig& config,
+    bool is_places,
+    const SubgraphIndex* subgraph_index,
+    const GnnDescriptorOptions& options,
+    const gnn::GnnInterface& model,
+    const InputFunc& make_input) {
+  std::vector<Descriptor::Ptr> descriptors(agent_nodes.size());
+  std::vector<size_t> to_infer;
+  for (size_t i = 0; i < agent_nodes.size(); ++i) {
+    const auto& agent_node = *agent_nodes[i];
+    auto parent = agent_node.getParent();
+    if (!parent) {
+      continue;
+    }
+
+    auto& descriptor = descriptors[i];
+    descriptor = std::make_unique<Descriptor>();
+    descriptor->normalized = false;
+    descriptor->nodes =
+        getSubgraphNodes(config, graph, *parent, is_places, subgraph_index);
+    descriptor->root_node = *parent;
+    descriptor->root_position = graph.getPosition(*parent);
+    descriptor->timestamp = agent_node.attributes<AgentNodeAttributes>().timestamp;
+
+    if (descriptor->nodes.empty()) {
+      // empty place subgraphs produce no descriptor, empty object subgraphs are kept
+      if (is_places) {
+        descriptor.reset();
+      } else {
+        descriptor->is_null = true;
+      }
+
+      continue;
+    }
+
+    to_infer.push_back(i);
+  }
+
+  std::vector<gnn::TensorMap> inputs(to_infer.size());
+  processInParallel(to_infer.size(), options.num_threads, [&](size_t i) {
+    auto& descriptor = *descriptors[to_infer[i]];
+    inputs[i] = make_input(descriptor.nodes);
+    logInput(inputs[i]);
+    if (!options.batch_inference) {
+      setOutput(model(inputs[i]).at("output"), descriptor);
+    }
+  });
+
+  if (options.batch_inference && !inputs.empty()) {
+    const auto outputs = model.batch(inputs);
+    for (size_t i = 0; i < to_infer.size(); ++i) {
+      setOutput(outputs.at(i).at("output"), *descriptors[to_infer[i]]);
+    }
+  }
+
+  return descriptors;
+}
+
+}  // namespace
 
 ObjectGnnDescriptor::ObjectGnnDescriptor(const std::string& model_path,
                                          const SubgraphConfig& config,
                                          double max_edge_distance_m,
                                          const LabelEmbeddings& label_embeddings,
-                                         bool use_pos_in_feature)
+                                         bool use_pos_in_feature,
+                                         const GnnDescriptorOptions& options)
     : config_(config),
+      options_(options),
       max_edge_distance_m_(max_edge_distance_m),
       label_embeddings_(label_embeddings),
       use_pos_in_feature_(use_pos_in_feature) {
@@ -69,7 +187,7 @@ ObjectGnnDescriptor::ObjectGnnDescriptor(const std::string& model_path,
     }
   }
 
-  model_.reset(new gnn::GnnInterface(model_path));
+  model_ = makeModel(model_path, options_.batch_inference);
 }
 
 gnn::TensorMap ObjectGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
@@ -85,9 +203,11 @@ gnn::TensorMap ObjectGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
   auto pos_map = pos.map<float>();
 
   size_t index = 0;
-  std::map<NodeId, size_t> index_mapping;
+  std::vector<Eigen::Vector3d> positions;
+  positions.reserve(nodes.size());
   for (const auto node : nodes) {
-    const auto& attrs = graph.getNode(node)->get().attributes<SemanticNodeAttributes>();
+    const auto& attrs = graph.getNode(node).attributes<SemanticNodeAttributes>();
+    positions.push_back(attrs.position);
 
     size_t start_idx = 0;
     if (use_pos_in_feature_) {
@@ -107,37 +227,52 @@ gnn::TensorMap ObjectGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
       x_map.block(index, start_idx + 3, 1, label_embedding_size_).setZero();
     }
 
-    index_mapping[node] = index;
     ++index;
   }
 
-  std::list<std::pair<int64_t, int64_t>> edges;
-  for (const auto& source : nodes) {
-    const auto source_position = graph.getPosition(source);
-    for (const auto& target : nodes) {
-      if (source == target) {
-        continue;
-      }
-
-      const auto target_position = graph.getPosition(target);
-      if ((source_position - target_position).norm() > max_edge_distance_m_) {
-        continue;
-      }
+  // bucket nodes into cells at least as large as the connection radius so that only
+  // neighboring cells need to be checked for every node
+  const double cell_size = std::max(max_edge_distance_m_, 1.0e-3);
+  const auto to_cell = [cell_size](const Eigen::Vector3d& p) -> spatial_hash::Index {
+    return (p / cell_size).array().floor().cast<int>();
+  };
 
-      edges.push_back({index_mapping[source], index_mapping[target]});
-    }
+  spatial_hash::IndexHashMap<std::vector<int64_t>> cells;
+  for (size_t i = 0; i < positions.size(); ++i) {
+    cells[to_cell(positions[i])].push_back(i);
   }
 
-  // note that edges is built in an undirected manner, so edges.size() = 2 * |E|
-  gnn::Tensor edge_index(2, edges.size(), gnn::Tensor::Type::INT64);
-  auto edge_map = edge_index.map<int64_t>();
-  size_t edge_idx = 0;
-  for (const auto& edge : edges) {
-    edge_map(0, edge_idx) = edge.first;
-    edge_map(1, edge_idx) = edge.second;
-    ++edge_idx;
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (size_t source = 0; source < positions.size(); ++source) {
+    const auto center = to_cell(positions[source]);
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dz = -1; dz <= 1; ++dz) {
+          const auto iter = cells.find(center + spatial_hash::Index(dx, dy, dz));
+          if (iter == cells.end()) {
+            continue;
+          }
+
+          for (const auto target : iter->second) {
+            if (static_cast<size_t>(target) == source) {
+              continue;
+            }
+
+            const auto dist = (positions[source] - positions[target]).norm();
+            if (dist > max_edge_distance_m_) {
+              continue;
+            }
+
+            edges.push_back({static_cast<int64_t>(source), target});
+          }
+        }
+      }
+    }
   }
 
+  // keep edges ordered by source and then target node
+  std::sort(edges.begin(), edges.end());
+  const auto edge_index = makeEdgeIndex(edges);
   if (use_pos_in_feature_) {
     return {{"x", x}, {"edge_index", edge_index}};
   } else {
@@ -146,45 +281,29 @@ gnn::TensorMap ObjectGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
 }
 
 Descriptor::Ptr ObjectGnnDescriptor::construct(const Dsg& graph,
-                                               const DsgNode& agent_node) const {
-  auto parent = agent_node.getParent();
-  if (!parent) {
-    return nullptr;
-  }
-
-  auto descriptor = std::make_unique<Descriptor>();
-  descriptor->normalized = false;
-  descriptor->nodes = getSubgraphNodes(config_, graph, *parent, false);
-  descriptor->root_node = *parent;
-  descriptor->root_position = graph.getPosition(*parent);
-  descriptor->timestamp = agent_node.timestamp;
-
-  if (descriptor->nodes.empty()) {
-    descriptor->is_null = true;
-    return descriptor;
-  }
-
-  auto input = makeInput(graph, descriptor->nodes);
-  VLOG(20) << "Inputs:";
-  VLOG(20) << "  - x: " << std::endl << input.at("x").map<float>();
-  VLOG(20) << "  - edge_index: " << std::endl << input.at("edge_index").map<int64_t>();
-  if (!use_pos_in_feature_) {
-    VLOG(20) << "  - pos: " << std::endl << input.at("pos").map<float>();
-  }
+                                               const SceneGraphNode& agent_node) const {
+  return std::move(constructBatch(graph, {&agent_node}).front());
+}
 
-  auto output = (*model_)(input).at("output");
-  VLOG(20) << "--------------------------------------";
-  VLOG(20) << "Output type: " << output;
-  VLOG(20) << "Output:" << std::endl << output.map<float>();
-  descriptor->values = output.map<float>().transpose();
-  return descriptor;
+std::vector<Descriptor::Ptr> ObjectGnnDescriptor::constructBatch(
+    const Dsg& graph, const std::vector<const SceneGraphNode*>& agent_nodes) const {
+  return constructDescriptors(
+      graph,
+      agent_nodes,
+      config_,
+      false,
+      subgraph_index.get(),
+      options_,
+      *model_,
+      [&](const std::set<NodeId>& nodes) { return makeInput(graph, nodes); });
 }
 
 PlaceGnnDescriptor::PlaceGnnDescriptor(const std::string& model_path,
                                        const SubgraphConfig& config,
-                                       bool use_pos_in_feature)
-    : config_(config), use_pos_in_feature_(use_pos_in_feature) {
-  model_.reset(new gnn::GnnInterface(model_path));
+                                       bool use_pos_in_feature,
+                                       const GnnDescriptorOptions& options)
+    : config_(config), use_pos_in_feature_(use_pos_in_feature), options_(options) {
+  model_ = makeModel(model_path, options_.batch_inference);
 }
 
 gnn::TensorMap PlaceGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
@@ -201,7 +320,7 @@ gnn::TensorMap PlaceGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
   size_t index = 0;
   std::map<NodeId, size_t> index_mapping;
   for (const auto node : nodes) {
-    const auto& attrs = graph.getNode(node)->get().attributes<PlaceNodeAttributes>();
+    const auto& attrs = graph.getNode(node).attributes<PlaceNodeAttributes>();
     if (use_pos_in_feature_) {
       x_map.block(index, 0, 1, 3) = attrs.position.cast<float>().transpose();
       x_map(index, 3) = attrs.distance;
@@ -215,9 +334,9 @@ gnn::TensorMap PlaceGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
     ++index;
   }
 
-  std::list<std::pair<int64_t, int64_t>> edges;
+  std::vector<std::pair<int64_t, int64_t>> edges;
   for (const auto source : nodes) {
-    const SceneGraphNode& node = *graph.getNode(source);
+    const SceneGraphNode& node = graph.getNode(source);
     for (const auto sibling : node.siblings()) {
       if (!nodes.count(sibling)) {
         continue;
@@ -227,16 +346,7 @@ gnn::TensorMap PlaceGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
     }
   }
 
-  // note that edges is built in an undirected manner, so edges.size() = 2 * |E|
-  gnn::Tensor edge_index(2, edges.size(), gnn::Tensor::Type::INT64);
-  auto edge_map = edge_index.map<int64_t>();
-  size_t edge_idx = 0;
-  for (const auto& edge : edges) {
-    edge_map(0, edge_idx) = edge.first;
-    edge_map(1, edge_idx) = edge.second;
-    ++edge_idx;
-  }
-
+  const auto edge_index = makeEdgeIndex(edges);
   if (use_pos_in_feature_) {
     return {{"x", x}, {"edge_index", edge_index}};
   } else {
@@ -245,37 +355,21 @@ gnn::TensorMap PlaceGnnDescriptor::makeInput(const DynamicSceneGraph& graph,
 }
 
 Descriptor::Ptr PlaceGnnDescriptor::construct(const Dsg& graph,
-                                              const DsgNode& agent_node) const {
-  auto parent = agent_node.getParent();
-  if (!parent) {
-    return nullptr;
-  }
-
-  auto descriptor = std::make_unique<Descriptor>();
-  descriptor->normalized = false;
-  descriptor->nodes = getSubgraphNodes(config_, graph, *parent, true);
-  descriptor->root_node = *parent;
-  descriptor->root_position = graph.getPosition(*parent);
-  descriptor->timestamp = agent_node.timestamp;
-
-  if (descriptor->nodes.empty()) {
-    return nullptr;
-  }
-
-  auto input = makeInput(graph, descriptor->nodes);
-  VLOG(20) << "Inputs:";
-  VLOG(20) << "  - x: " << std::endl << input.at("x").map<float>();
-  VLOG(20) << "  - edge_index: " << std::endl << input.at("edge_index").map<int64_t>();
-  if (!use_pos_in_feature_) {
-    VLOG(20) << "  - pos: " << std::endl << input.at("pos").map<float>();
-  }
+                                              const SceneGraphNode& agent_node) const {
+  return std::move(constructBatch(graph, {&agent_node}).front());
+}
 
-  auto output = (*model_)(input).at("output");
-  VLOG(20) << "--------------------------------------";
-  VLOG(20) << "Output type: " << output;
-  VLOG(20) << "Output:" << std::endl << output.map<float>();
-  descriptor->values = output.map<float>().transpose();
-  return descriptor;
+std::vector<Descriptor::Ptr> PlaceGnnDescriptor::constructBatch(
+    const Dsg& graph, const std::vector<const SceneGraphNode*>& agent_nodes) const {
+  return constructDescriptors(
+      graph,
+      agent_nodes,
+      config_,
+      true,
+      subgraph_index.get(),
+      options_,
+      *model_,
+      [&](const std::set<NodeId>& nodes) { return makeInput(graph, nodes); });
 }
 
 ObjectGnnDescriptor::LabelEmbeddings loadLabelEmbeddings(const std::string& filename) {
@@ -35,6 +35,7 @@
 #include "hydra/loop_closure/loop_closure_config.h"
 
 #include <config_utilities/config.h>
+#include <config_utilities/types/conversions.h>
 #include <config_utilities/types/eigen_matrix.h>
 #include <config_utilities/types/enum.h>
 
@@ -84,6 +85,7 @@ void declare_config(LayerRegistrationConfig& conf) {
   if (conf.recreate_subgraph) {
     field(conf.subgraph_extraction, "subgraph_extraction");
   }
+  field(conf.max_correspondences_per_node, "max_correspondences_per_node");
 }
 
 void declare_config(DescriptorMatchConfig& conf) {
@@ -114,6 +116,9 @@ void declare_config(GnnLcdConfig& conf) {
   field(conf.places_model_path, "places_model_path");
   field(conf.objects_pos_in_feature, "objects_pos_in_feature");
   field(conf.places_pos_in_feature, "places_pos_in_feature");
+  field<ThreadNumConversion>(conf.num_threads, "num_threads");
+  field(conf.batch_inference, "batch_inference");
+  check(conf.num_threads, GT, 0, "num_threads");
 }
 
 void declare_config(LayerLcdConfig& conf) {
@@ -141,6 +146,9 @@ void declare_config(LcdDetectorConfig& conf) {
   if (conf.use_gnn_descriptors) {
     field(conf.gnn_lcd, "gnn_lcd");
   }
+
+  field(conf.num_registration_threads, "num_registration_threads");
+  check(conf.num_registration_threads, GT, 0, "num_registration_threads");
 }
 
 }  // namespace lcd
@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #include "hydra/loop_closure/registration.h"
 
+#include <atomic>
 #include <fstream>
 #include <iomanip>
 
@@ -134,10 +135,10 @@ void logRegistrationProblem(const std::string& path_prefix,
                             const LayerRegistrationSolution& solution,
                             const DsgRegistrationInput& match,
                             NodeId query_agent_id) {
-  static size_t registration_index = 0;
+  // registrations may run concurrently
+  static std::atomic<size_t> registration_index = 0;
   std::stringstream ss;
-  ss << path_prefix << registration_index << ".json";
-  ++registration_index;
+  ss << path_prefix << registration_index++ << ".json";
 
   std::ofstream outfile(ss.str());
   outfile << "query_id: " << query_agent_id << std::endl;
@@ -162,10 +163,55 @@ void logRegistrationProblem(const std::string& path_prefix,
   // TODO(nathan) output position data
 }
 
+double getSemanticFeatureDistance(const SceneGraphNode& src_node,
+                                  const SceneGraphNode& dest_node) {
+  const auto& src_feature = src_node.attributes<SemanticNodeAttributes>().semantic_feature;
+  const auto& dest_feature =
+      dest_node.attributes<SemanticNodeAttributes>().semantic_feature;
+  if (src_feature.size() == 0 || src_feature.rows() != dest_feature.rows() ||
+      src_feature.cols() != dest_feature.cols()) {
+    return 0.0;
+  }
+
+  return (src_feature - dest_feature).norm();
+}
+
+TeaserSolverPool::Lease::~Lease() {
+  if (!solver_) {
+    return;  // moved-from lease
+  }
+
+  std::lock_guard<std::mutex> lock(pool_->mutex_);
+  pool_->idle_.push_back(std::move(solver_));
+}
+
+TeaserSolverPool::TeaserSolverPool(const TeaserParams& params)
+    : params(params), num_solvers_(0) {}
+
+TeaserSolverPool::Lease TeaserSolverPool::acquire() const {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_.empty()) {
+      auto solver = std::move(idle_.back());
+      idle_.pop_back();
+      return Lease(*this, std::move(solver));
+    }
+
+    ++num_solvers_;
+  }  // end critical section
+
+  return Lease(*this, std::make_unique<Solver>(params));
+}
+
+size_t TeaserSolverPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_solvers_;
+}
+
 DsgTeaserSolver::DsgTeaserSolver(const std::string& layer,
                                  const LayerRegistrationConfig& config,
                                  const TeaserParams& params)
-    : layer_id(layer), config(config), solver(params) {
+    : layer_id(layer), config(config), solvers(params) {
   timer_prefix = "lcd/" + layer_id + "_registration";
   log_prefix = config.registration_output_path + "/" + layer_id + "_registration_";
 }
@@ -214,11 +260,12 @@ RegistrationSolution DsgTeaserSolver::solve(const DynamicSceneGraph& dsg,
   }
 
   const auto& layer = dsg.getLayer(layer_id);
+  auto solver = solvers.acquire();
   LayerRegistrationSolution solution;
   if (config.use_pairwise_registration) {
-    solution = registerDsgLayerPairwise(config, solver, problem, layer);
+    solution = registerDsgLayerPairwise(config, *solver, problem, layer);
   } else {
-    solution = registerDsgLayerSemantic(config, solver, problem, layer);
+    solution = registerDsgLayerSemantic(config, *solver, problem, layer);
   }
 
   if (config.log_registration_problem) {
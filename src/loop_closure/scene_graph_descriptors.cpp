@@ -40,6 +40,17 @@ namespace hydra::lcd {
 
 using Dsg = DynamicSceneGraph;
 
+std::vector<Descriptor::Ptr> DescriptorFactory::constructBatch(
+    const Dsg& graph, const std::vector<const SceneGraphNode*>& agent_nodes) const {
+  std::vector<Descriptor::Ptr> descriptors;
+  descriptors.reserve(agent_nodes.size());
+  for (const auto agent_node : agent_nodes) {
+    descriptors.push_back(construct(graph, *agent_node));
+  }
+
+  return descriptors;
+}
+
 Descriptor::Ptr AgentDescriptorFactory::construct(
     const Dsg& graph, const SceneGraphNode& agent_node) const {
   auto parent = agent_node.getParent();
@@ -78,7 +89,8 @@ Descriptor::Ptr ObjectDescriptorFactory::construct(
   descriptor->root_node = *parent;
   descriptor->timestamp = agent_node.attributes<AgentNodeAttributes>().timestamp;
   descriptor->root_position = root_position;
-  descriptor->nodes = getSubgraphNodes(config, graph, *parent, false);
+  descriptor->nodes =
+      getSubgraphNodes(config, graph, *parent, false, subgraph_index.get());
 
   for (const auto node : descriptor->nodes) {
     const auto attrs = graph.getNode(node).attributes<SemanticNodeAttributes>();
@@ -115,7 +127,8 @@ Descriptor::Ptr PlaceDescriptorFactory::construct(
   descriptor->root_node = *parent;
   descriptor->timestamp = agent_node.attributes<AgentNodeAttributes>().timestamp;
   descriptor->root_position = root_position;
-  descriptor->nodes = getSubgraphNodes(config, graph, *parent, true);
+  descriptor->nodes =
+      getSubgraphNodes(config, graph, *parent, true, subgraph_index.get());
 
   const auto& places = graph.getLayer(DsgLayers::PLACES);
   for (const auto node : descriptor->nodes) {
@@ -35,7 +35,9 @@
 #include "hydra/loop_closure/subgraph_extraction.h"
 
 #include <glog/logging.h>
-#include <spark_dsg/graph_utilities.h>
+
+#include <algorithm>
+#include <deque>
 
 namespace hydra {
 
@@ -44,113 +46,229 @@ SubgraphConfig::SubgraphConfig(double radius_m)
 
 SubgraphConfig::SubgraphConfig() = default;
 
-void getObjectsWithinRadius(const DynamicSceneGraph& graph,
-                            const Eigen::Vector3d& origin,
-                            NodeId parent,
-                            double radius_m,
-                            std::set<NodeId>& found) {
-  std::deque<NodeId> frontier{parent};
-  std::unordered_set<NodeId> visited{parent};
-  graph_utilities::breadthFirstSearch(
-      graph.getLayer(DsgLayers::PLACES),
-      frontier,
-      visited,
-      [&](const auto& node) {
-        for (const auto& child_id : node.children()) {
-          const auto& child = graph.getNode(child_id);
-          if (child.layer.partition) {
-            // object nodes are in the primary partition
-            continue;
-          }
-
-          if ((origin - child.attributes().position).norm() < radius_m) {
-            return true;
-          }
-        }
+namespace {
 
-        return (origin - node.attributes().position).norm() < radius_m;
-      },
-      [](const auto&) { return true; },
-      [&](const SceneGraphLayer&, NodeId node) {
-        for (const auto& child_id : graph.getNode(node).children()) {
-          const auto& child = graph.getNode(child_id);
-          if (child.layer.partition) {
-            // object nodes are in the primary partition
-            continue;
-          }
-
-          if ((origin - child.attributes().position).norm() < radius_m) {
-            found.insert(child_id);
-          }
-        }
-      });
+inline SubgraphIndex::PlaceRecord makeRecord(const SceneGraphNode& node) {
+  SubgraphIndex::PlaceRecord record;
+  record.position = node.attributes().position;
+  const auto& siblings = node.siblings();
+  record.siblings.assign(siblings.begin(), siblings.end());
+  return record;
 }
 
-void getPlacesWithinRadius(const DynamicSceneGraph& graph,
-                           const Eigen::Vector3d& origin,
-                           NodeId parent,
-                           double radius_m,
-                           std::set<NodeId>& found) {
-  std::deque<NodeId> frontier{parent};
-  std::unordered_set<NodeId> visited{parent};
-  graph_utilities::breadthFirstSearch(
-      graph.getLayer(DsgLayers::PLACES),
-      frontier,
-      visited,
-      [&](const auto& node) {
-        return (origin - node.attributes().position).norm() < radius_m;
-      },
-      [](const auto&) { return true; },
-      [&](const SceneGraphLayer&, NodeId node) { found.insert(node); });
+inline bool hasObjectWithinRadius(const SubgraphIndex::ObjectList& objects,
+                                  const Eigen::Vector3d& origin,
+                                  double radius_m) {
+  for (const auto& [object_id, position] : objects) {
+    if ((origin - position).norm() < radius_m) {
+      return true;
+    }
+  }
+
+  return false;
 }
 
-std::set<NodeId> getFilteredNodeSet(const SubgraphConfig& config,
-                                    const DynamicSceneGraph& graph,
-                                    const Eigen::Vector3d& origin,
-                                    const std::set<NodeId>& found) {
-  std::vector<std::pair<double, NodeId>> candidates;
-  for (const auto node : found) {
-    const double distance_m = (graph.getPosition(node) - origin).norm();
-    candidates.push_back({distance_m, node});
+}  // namespace
+
+void SubgraphIndex::update(const DynamicSceneGraph& graph,
+                           const std::unordered_set<NodeId>& places) {
+  for (const auto place_id : places) {
+    batch_places_.erase(place_id);
+    const auto node = graph.findNode(place_id);
+    if (!node) {
+      places_.erase(place_id);
+      continue;
+    }
+
+    places_[place_id] = makeRecord(*node);
+  }
+}
+
+void SubgraphIndex::startBatch() const {
+  batch_places_.clear();
+  batch_objects_.clear();
+  batch_subgraphs_.clear();
+}
+
+void SubgraphIndex::clear() {
+  places_.clear();
+  startBatch();
+}
+
+const SubgraphIndex::PlaceRecord* SubgraphIndex::getPlace(
+    const DynamicSceneGraph& graph, NodeId place) const {
+  auto iter = places_.find(place);
+  if (iter != places_.end()) {
+    // archived places can still be removed from the graph by merges
+    return graph.hasNode(place) ? &iter->second : nullptr;
+  }
+
+  auto batch_iter = batch_places_.find(place);
+  if (batch_iter != batch_places_.end()) {
+    return &batch_iter->second;
+  }
+
+  const auto node = graph.findNode(place);
+  if (!node) {
+    return nullptr;
   }
-  std::sort(candidates.begin(), candidates.end());
 
-  std::set<NodeId> valid;
-  std::optional<double> last_distance;
-  for (const auto& candidate : candidates) {
-    if (candidate.first < config.min_radius_m) {
-      // we take as many nodes as possible within the min radius
-      valid.insert(candidate.second);
-      last_distance = candidate.first;
+  return &batch_places_.emplace(place, makeRecord(*node)).first->second;
+}
+
+const SubgraphIndex::ObjectList& SubgraphIndex::getObjects(
+    const DynamicSceneGraph& graph, NodeId place) const {
+  auto iter = batch_objects_.find(place);
+  if (iter != batch_objects_.end()) {
+    return iter->second;
+  }
+
+  auto& objects = batch_objects_[place];
+  const auto node = graph.findNode(place);
+  if (!node) {
+    return objects;
+  }
+
+  for (const auto& child_id : node->children()) {
+    const auto& child = graph.getNode(child_id);
+    if (child.layer.partition) {
+      // object nodes are in the primary partition
       continue;
     }
 
-    if (candidate.first >= config.max_radius_m) {
-      break;  // we've hit candidates that are outside the radius we want
+    objects.emplace_back(child_id, child.attributes().position);
+  }
+
+  return objects;
+}
+
+const std::vector<NodeId>* SubgraphIndex::getCachedSubgraph(NodeId root,
+                                                            bool is_places,
+                                                            double radius_m) const {
+  auto iter = batch_subgraphs_.find({root, is_places, radius_m});
+  return iter == batch_subgraphs_.end() ? nullptr : &iter->second;
+}
+
+void SubgraphIndex::cacheSubgraph(NodeId root,
+                                  bool is_places,
+                                  double radius_m,
+                                  const std::vector<NodeId>& nodes) const {
+  batch_subgraphs_[{root, is_places, radius_m}] = nodes;
+}
+
+std::vector<NodeId> getNodesWithinRadius(const DynamicSceneGraph& graph,
+                                         const SubgraphIndex& index,
+                                         const Eigen::Vector3d& origin,
+                                         NodeId parent,
+                                         double radius_m,
+                                         bool is_places) {
+  const auto cached = index.getCachedSubgraph(parent, is_places, radius_m);
+  if (cached) {
+    return *cached;
+  }
+
+  // places are valid if they are within the radius or (when searching for objects)
+  // have an object within the radius
+  const auto is_valid = [&](NodeId place, const SubgraphIndex::PlaceRecord& record) {
+    if ((origin - record.position).norm() < radius_m) {
+      return true;
     }
 
-    if (last_distance && candidate.first == last_distance) {
-      // make sure we don't exit early if we have equidistant nodes (unlikely)
-      valid.insert(candidate.second);
+    return !is_places &&
+           hasObjectWithinRadius(index.getObjects(graph, place), origin, radius_m);
+  };
+
+  std::vector<NodeId> found;
+  std::deque<NodeId> frontier{parent};
+  std::unordered_set<NodeId> visited{parent};
+  while (!frontier.empty()) {
+    const auto place = frontier.front();
+    frontier.pop_front();
+
+    const auto record = index.getPlace(graph, place);
+    if (!record) {
       continue;
     }
 
-    last_distance = candidate.first;
-    if (valid.size() >= config.min_nodes) {
-      break;  // if we hit this point, we have all the nodes within the min radius, so
-              // okay to exit
+    if (is_places) {
+      found.push_back(place);
+    } else {
+      for (const auto& [object_id, position] : index.getObjects(graph, place)) {
+        if ((origin - position).norm() < radius_m) {
+          found.push_back(object_id);
+        }
+      }
     }
 
-    valid.insert(candidate.second);
+    for (const auto sibling : record->siblings) {
+      if (visited.count(sibling)) {
+        continue;
+      }
+
+      const auto sibling_record = index.getPlace(graph, sibling);
+      if (!sibling_record || !is_valid(sibling, *sibling_record)) {
+        continue;
+      }
+
+      visited.insert(sibling);
+      frontier.push_back(sibling);
+    }
   }
 
+  std::sort(found.begin(), found.end());
+  index.cacheSubgraph(parent, is_places, radius_m, found);
+  return found;
+}
+
+std::vector<NodeId> getFilteredNodes(const SubgraphConfig& config,
+                                     const DynamicSceneGraph& graph,
+                                     const Eigen::Vector3d& origin,
+                                     const std::vector<NodeId>& found) {
+  std::vector<std::pair<double, NodeId>> candidates;
+  candidates.reserve(found.size());
+  for (const auto node : found) {
+    const double distance_m = (graph.getPosition(node) - origin).norm();
+    candidates.push_back({distance_m, node});
+  }
+
+  // we take as many nodes as possible within the min radius
+  const auto mid = std::partition(candidates.begin(), candidates.end(), [&](auto& c) {
+    return c.first < config.min_radius_m;
+  });
+
+  // we never take candidates that are outside the radius we want
+  const auto end = std::partition(mid, candidates.end(), [&](auto& c) {
+    return c.first < config.max_radius_m;
+  });
+
+  auto last = mid;
+  const size_t num_within_min = std::distance(candidates.begin(), mid);
+  const size_t num_remaining = std::distance(mid, end);
+  if (num_within_min < config.min_nodes && num_remaining) {
+    // take the closest nodes until we have enough, including any nodes equidistant to
+    // the last node we take
+    const size_t num_needed =
+        std::min(config.min_nodes - num_within_min, num_remaining);
+    std::nth_element(mid, mid + num_needed - 1, end);
+    const auto max_distance = (mid + num_needed - 1)->first;
+    last = std::partition(mid, end, [&](auto& c) { return c.first <= max_distance; });
+  }
+
+  std::vector<NodeId> valid;
+  valid.reserve(std::distance(candidates.begin(), last));
+  for (auto iter = candidates.begin(); iter != last; ++iter) {
+    valid.push_back(iter->second);
+  }
+
+  std::sort(valid.begin(), valid.end());
   return valid;
 }
 
-std::set<NodeId> getSubgraphNodes(const SubgraphConfig& config,
-                                  const DynamicSceneGraph& graph,
-                                  NodeId root_node,
-                                  bool is_places) {
+std::vector<NodeId> getSubgraphNodeList(const SubgraphConfig& config,
+                                        const DynamicSceneGraph& graph,
+                                        NodeId root_node,
+                                        bool is_places,
+                                        const SubgraphIndex* index) {
   Eigen::Vector3d origin;
   try {
     origin = graph.getPosition(root_node);
@@ -160,18 +278,31 @@ std::set<NodeId> getSubgraphNodes(const SubgraphConfig& config,
     return {};
   }
 
-  std::set<NodeId> found;
-  if (is_places) {
-    getPlacesWithinRadius(graph, origin, root_node, config.max_radius_m, found);
+  std::vector<NodeId> found;
+  if (index) {
+    found = getNodesWithinRadius(
+        graph, *index, origin, root_node, config.max_radius_m, is_places);
   } else {
-    getObjectsWithinRadius(graph, origin, root_node, config.max_radius_m, found);
+    SubgraphIndex local_index;
+    found = getNodesWithinRadius(
+        graph, local_index, origin, root_node, config.max_radius_m, is_places);
   }
 
   if (config.fixed_radius) {
     return found;
   }
 
-  return getFilteredNodeSet(config, graph, origin, found);
+  return getFilteredNodes(config, graph, origin, found);
+}
+
+std::set<NodeId> getSubgraphNodes(const SubgraphConfig& config,
+                                  const DynamicSceneGraph& graph,
+                                  NodeId root_node,
+                                  bool is_places,
+                                  const SubgraphIndex* index) {
+  const auto nodes = getSubgraphNodeList(config, graph, root_node, is_places, index);
+  // nodes are sorted, so constructing the set is linear
+  return std::set<NodeId>(nodes.begin(), nodes.end());
 }
 
 }  // namespace hydra
@@ -4,6 +4,37 @@
 
 namespace hydra {
 
+namespace {
+
+// cosine scores between normalized queries (rows) and normalized embeddings (columns)
+Eigen::MatrixXf cosineScores(const FeatureGroup& queries,
+                             const Eigen::VectorXf& query_norms,
+                             const FeatureGroup& embeddings,
+                             const Eigen::VectorXf& embedding_norms,
+                             float tolerance) {
+  Eigen::MatrixXf scores = queries.transpose() * embeddings;
+  // match the tolerance CosineDistance::score applies to the product of the norms
+  const Eigen::ArrayXXf products =
+      (query_norms * embedding_norms.transpose()).array() / tolerance;
+  scores.array() *= products.min(1.0f);
+  return scores;
+}
+
+}  // namespace
+
+Eigen::MatrixXf EmbeddingDistance::scoreGroup(const EmbeddingGroup& group,
+                                              const FeatureGroup& queries) const {
+  Eigen::MatrixXf scores(queries.cols(), group.size());
+  for (int m = 0; m < queries.cols(); ++m) {
+    const FeatureVector query = queries.col(m);
+    for (size_t n = 0; n < group.size(); ++n) {
+      scores(m, n) = score(group.embeddings[n], query);
+    }
+  }
+
+  return scores;
+}
+
 float CosineDistance::dist(const FeatureVector& lhs, const FeatureVector& rhs) const {
   // map [-1, 1] to [0, 2]
   return 1.0f - score(lhs, rhs);
@@ -14,6 +45,14 @@ float CosineDistance::score(const FeatureVector& lhs, const FeatureVector& rhs)
   return lhs.dot(rhs) / divisor;
 }
 
+Eigen::MatrixXf CosineDistance::scoreGroup(const EmbeddingGroup& group,
+                                           const FeatureGroup& queries) const {
+  FeatureGroup normalized = queries;
+  const auto norms = normalizeColumns(normalized);
+  return cosineScores(
+      normalized, norms, group.normalized(), group.norms(), config.tolerance);
+}
+
 float L2Norm::dist(const FeatureVector& lhs, const FeatureVector& rhs) const {
   return (lhs.normalized() - rhs.normalized()).norm();
 }
@@ -32,7 +71,8 @@ float L1Norm::score(const FeatureVector& lhs, const FeatureVector& rhs) const {
   return 1.0f - 0.5f * dist(lhs, rhs);
 }
 
-LerfScore::LerfScore(const Config& config) : config(config::checkValid(config)) {
+LerfScore::LerfScore(const Config& config)
+    : config(config::checkValid(config)), dot_prod_({config.tolerance}) {
   cannonical_ = config.cannonical_features.create();
 }
 
@@ -41,15 +81,45 @@ float LerfScore::dist(const FeatureVector& lhs, const FeatureVector& rhs) const
   return 1.0f - score(lhs, rhs);
 }
 
+Eigen::VectorXf LerfScore::getCannonicalTerm(const FeatureGroup& normalized,
+                                             const Eigen::VectorXf& norms) const {
+  const auto scores = cosineScores(normalized,
+                                   norms,
+                                   cannonical_->normalized(),
+                                   cannonical_->norms(),
+                                   config.tolerance);
+  return scores.rowwise().maxCoeff();
+}
+
 float LerfScore::score(const FeatureVector& lhs, const FeatureVector& rhs) const {
-  CosineDistance::Config dot_config;
-  dot_config.tolerance = config.tolerance;
-  const CosineDistance dot_prod(dot_config);
+  CHECK(cannonical_ && !cannonical_->empty()) << "LERF requires cannonical features";
   // score maps to cosine similiarity (for CosineDistance norm)
-  const auto l_dot_r = std::exp(dot_prod.score(lhs, rhs));
-  const auto scores = cannonical_->getScores(dot_prod, lhs);
-  const auto divisor = (scores.array().exp() + l_dot_r);
-  return (l_dot_r / divisor).minCoeff();
+  const auto l_dot_r = std::exp(dot_prod_.score(lhs, rhs));
+
+  // the softmax against the canonical features is smallest for the most similar
+  // canonical feature
+  FeatureGroup normalized = lhs;
+  const auto norms = normalizeColumns(normalized);
+  const auto cannonical_term = std::exp(getCannonicalTerm(normalized, norms)(0));
+  return l_dot_r / (cannonical_term + l_dot_r);
+}
+
+Eigen::MatrixXf LerfScore::scoreGroup(const EmbeddingGroup& group,
+                                      const FeatureGroup& queries) const {
+  CHECK(cannonical_ && !cannonical_->empty()) << "LERF requires cannonical features";
+  FeatureGroup normalized = queries;
+  const auto norms = normalizeColumns(normalized);
+  const Eigen::ArrayXXf l_dot_r =
+      cosineScores(
+          normalized, norms, group.normalized(), group.norms(), config.tolerance)
+          .array()
+          .exp();
+
+  // canonical term only depends on the group embeddings
+  const Eigen::ArrayXf cannonical_term =
+      getCannonicalTerm(group.normalized(), group.norms()).array().exp();
+  const Eigen::ArrayXXf divisor = l_dot_r.rowwise() + cannonical_term.transpose();
+  return (l_dot_r / divisor).matrix();
 }
 
 void declare_config(LerfScore::Config& config) {
@@ -40,16 +40,97 @@ Eigen::VectorXf EmbeddingGroup::getScores(const EmbeddingDistance& dist,
 
 ScoreResult EmbeddingGroup::getBestScore(const EmbeddingDistance& dist,
                                          const FeatureVector& embedding) const {
-  ScoreResult result;
+  if (embeddings.empty()) {
+    return {};
+  }
+
+  return getBestScores(dist, embedding).front();
+}
+
+Eigen::MatrixXf EmbeddingGroup::getScoreMatrix(const EmbeddingDistance& dist,
+                                               const FeatureGroup& queries) const {
+  if (embeddings.empty() || queries.cols() == 0) {
+    return Eigen::MatrixXf(queries.cols(), embeddings.size());
+  }
+
+  return dist.scoreGroup(*this, queries);
+}
+
+std::vector<ScoreResult> EmbeddingGroup::getBestScores(
+    const EmbeddingDistance& dist, const FeatureGroup& queries) const {
+  if (embeddings.empty()) {
+    return std::vector<ScoreResult>(queries.cols());
+  }
+
+  return getRowwiseMax(getScoreMatrix(dist, queries));
+}
+
+const FeatureGroup& EmbeddingGroup::normalized() const {
+  updateCache();
+  return normalized_;
+}
+
+const Eigen::VectorXf& EmbeddingGroup::norms() const {
+  updateCache();
+  return norms_;
+}
+
+bool EmbeddingGroup::cacheValid() const {
+  if (static_cast<size_t>(cached_.cols()) != embeddings.size()) {
+    return false;
+  }
+
+  // comparing is linear in the embeddings, while scoring is linear per query
   for (size_t i = 0; i < embeddings.size(); ++i) {
-    const auto score = dist.score(embeddings[i], embedding);
-    if (score > result.score) {
-      result.score = score;
-      result.index = i;
+    if (embeddings[i].size() != cached_.rows() || embeddings[i] != cached_.col(i)) {
+      return false;
     }
   }
 
-  return result;
+  return true;
+}
+
+void EmbeddingGroup::updateCache() const {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  if (cacheValid()) {
+    return;
+  }
+
+  const auto dims = embeddings.empty() ? 0 : embeddings.front().size();
+  cached_.resize(dims, embeddings.size());
+  for (size_t i = 0; i < embeddings.size(); ++i) {
+    CHECK_EQ(embeddings[i].size(), dims) << "embeddings must have the same size";
+    cached_.col(i) = embeddings[i];
+  }
+
+  normalized_ = cached_;
+  norms_ = normalizeColumns(normalized_);
+}
+
+Eigen::VectorXf normalizeColumns(FeatureGroup& features) {
+  Eigen::VectorXf norms = features.colwise().norm().transpose();
+  for (int i = 0; i < features.cols(); ++i) {
+    if (norms(i) > 0.0f) {
+      features.col(i) /= norms(i);
+    }
+  }
+
+  return norms;
+}
+
+std::vector<ScoreResult> getRowwiseMax(const Eigen::MatrixXf& scores) {
+  std::vector<ScoreResult> results(scores.rows());
+  if (scores.cols() == 0) {
+    return results;
+  }
+
+  for (int r = 0; r < scores.rows(); ++r) {
+    Eigen::Index index;
+    results[r].score = scores.row(r).maxCoeff(&index);
+    results[r].index = index;
+  }
+
+  return results;
 }
 
 }  // namespace hydra
@@ -36,11 +36,18 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <opencv2/core.hpp>
+#include <vector>
 
 namespace hydra {
 namespace {
 
+// images at least this large (e.g., lidar range images) are split across threads
+constexpr size_t kMinParallelPixels = 1 << 17;
+// larger label spans fall back to searching the sorted labels
+constexpr int64_t kMaxTableSize = 1 << 20;
+
 inline std::string showImageDim(const cv::Mat& mat) {
   std::stringstream ss;
   ss << "[rows=" << mat.rows << ", cols=" << mat.cols << "]";
@@ -70,10 +77,37 @@ inline bool initMask(const cv::Mat& input, cv::Mat& mask) {
   return true;
 }
 
+//! Apply a row kernel to every row of the input and mask
+template <typename Kernel>
+void applyRows(const cv::Mat& input, cv::Mat& mask, const Kernel& kernel) {
+  const auto body = [&](const cv::Range& range) {
+    for (int r = range.start; r < range.end; ++r) {
+      kernel(input.ptr(r), mask.ptr<int32_t>(r), input.cols);
+    }
+  };
+
+  if (input.total() < kMinParallelPixels) {
+    body(cv::Range(0, input.rows));
+  } else {
+    cv::parallel_for_(cv::Range(0, input.rows), body);
+  }
+}
+
+template <typename T>
+bool maskNonZeroImpl(const cv::Mat& input, cv::Mat& mask) {
+  applyRows(input, mask, [](const uchar* row, int32_t* mask_row, int cols) {
+    const auto values = reinterpret_cast<const T*>(row);
+    for (int c = 0; c < cols; ++c) {
+      mask_row[c] |= values[c] != 0;
+    }
+  });
+  return true;
+}
+
 }  // namespace
 
 bool maskInvalidSemantics(const cv::Mat& labels,
-                          const std::set<int32_t> to_mask,
+                          const std::set<int32_t>& to_mask,
                           cv::Mat& mask) {
   if (labels.empty() || to_mask.empty()) {
     return true;  // more efficient to not init mask if it is going to be empty
@@ -88,17 +122,40 @@ bool maskInvalidSemantics(const cv::Mat& labels,
     return false;
   }
 
-  for (int r = 0; r < labels.rows; ++r) {
-    for (int c = 0; c < labels.cols; ++c) {
-      const auto label = labels.at<int32_t>(r, c);
-      mask.at<int32_t>(r, c) |= to_mask.count(label);
-    }
+  const auto min_label = *to_mask.begin();
+  const auto span = static_cast<int64_t>(*to_mask.rbegin()) - min_label + 1;
+  if (span > kMaxTableSize) {
+    const std::vector<int32_t> sorted(to_mask.begin(), to_mask.end());
+    applyRows(labels, mask, [&sorted](const uchar* row, int32_t* mask_row, int cols) {
+      const auto values = reinterpret_cast<const int32_t*>(row);
+      for (int c = 0; c < cols; ++c) {
+        mask_row[c] |= std::binary_search(sorted.begin(), sorted.end(), values[c]);
+      }
+    });
+    return true;
   }
 
+  std::vector<uint8_t> table(span, 0);
+  for (const auto label : to_mask) {
+    table[static_cast<int64_t>(label) - min_label] = 1;
+  }
+
+  // labels below the minimum wrap around to large offsets and fail the bounds check
+  const auto offset = static_cast<uint32_t>(min_label);
+  const auto size = static_cast<uint32_t>(span);
+  const auto lut = table.data();
+  applyRows(labels, mask, [=](const uchar* row, int32_t* mask_row, int cols) {
+    const auto values = reinterpret_cast<const int32_t*>(row);
+    for (int c = 0; c < cols; ++c) {
+      const uint32_t index = static_cast<uint32_t>(values[c]) - offset;
+      mask_row[c] |= index < size ? lut[index] : 0;
+    }
+  });
+
   return true;
 }
 
-bool maskNonZero(const cv::Mat input, cv::Mat& mask) {
+bool maskNonZero(const cv::Mat& input, cv::Mat& mask) {
   if (input.empty()) {
     return true;  // more efficient to not init mask if it is going to be empty
   }
@@ -106,49 +163,29 @@ bool maskNonZero(const cv::Mat input, cv::Mat& mask) {
   // if opencv implemented bitwise_or across integer types, we could just use that, but
   // this is likely more efficient than converting the entire input
   // TODO(nathan) port to label remapper as well
-  std::function<bool(const cv::Mat&, int, int)> input_getter;
-  switch (input.depth()) {
-    case CV_8U:
-      input_getter = [](const cv::Mat& mat, int r, int c) -> bool {
-        return mat.at<int8_t>(r, c);
-      };
-      break;
-    case CV_8S:
-      input_getter = [](const cv::Mat& mat, int r, int c) -> bool {
-        return mat.at<uint8_t>(r, c);
-      };
-      break;
-    case CV_16U:
-      input_getter = [](const cv::Mat& mat, int r, int c) -> bool {
-        return mat.at<uint16_t>(r, c);
-      };
-      break;
-    case CV_16S:
-      input_getter = [](const cv::Mat& mat, int r, int c) -> bool {
-        return mat.at<int16_t>(r, c);
-      };
-      break;
-    case CV_32S:
-      input_getter = [](const cv::Mat& mat, int r, int c) -> bool {
-        return mat.at<int32_t>(r, c);
-      };
-      break;
-    default:
-      LOG(ERROR) << "Unhandled depth: " << input.depth();
-      return false;
+  const auto depth = input.depth();
+  if (depth != CV_8U && depth != CV_8S && depth != CV_16U && depth != CV_16S &&
+      depth != CV_32S) {
+    LOG(ERROR) << "Unhandled depth: " << depth;
+    return false;
   }
 
   if (!initMask(input, mask)) {
     return false;
   }
 
-  for (int r = 0; r < input.rows; ++r) {
-    for (int c = 0; c < input.cols; ++c) {
-      mask.at<int32_t>(r, c) |= input_getter(input, r, c);
-    }
+  switch (depth) {
+    case CV_8U:
+      return maskNonZeroImpl<uint8_t>(input, mask);
+    case CV_8S:
+      return maskNonZeroImpl<int8_t>(input, mask);
+    case CV_16U:
+      return maskNonZeroImpl<uint16_t>(input, mask);
+    case CV_16S:
+      return maskNonZeroImpl<int16_t>(input, mask);
+    default:
+      return maskNonZeroImpl<int32_t>(input, mask);
   }
-
-  return true;
 }
 
 }  // namespace hydra
@@ -53,10 +53,12 @@
 
 #include <algorithm>
 #include <future>
+#include <limits>
 #include <vector>
 
 #include "hydra/input/sensor_utilities.h"
 #include "hydra/reconstruction/index_getter.h"
+#include "hydra/reconstruction/range_image_pyramid.h"
 #include "hydra/utils/printing.h"
 
 namespace hydra {
@@ -100,6 +102,7 @@ void declare_config(ProjectiveIntegrator::Config& config) {
   field(config.interpolation_method, "interpolation_method");
   config.semantic_integrator.setOptional();
   field(config.semantic_integrator, "semantic_integrator");
+  field(config.use_range_pyramid, "use_range_pyramid");
 
   const auto labels_ok = !config.extra_integration_distance_labels.empty() ||
                          !config.skip_extra_colors_and_labels;
@@ -144,6 +147,133 @@ void ProjectiveIntegrator::updateMap(const InputData& data,
   }
 }
 
+// Conservative test for whether a box of voxel centers can produce any valid
+// measurement. Voxels in front of the surface are still integrated as free space, so
+// only voxels that are out of range or entirely behind the (max) observed range plus
+// the integration band are skipped.
+struct ProjectiveIntegrator::RangeCuller {
+  //! Voxels of a block grouped into small boxes to cull individually
+  struct SubBlock {
+    size_t min_index = 0;
+    size_t max_index = 0;
+    std::vector<size_t> voxels;
+  };
+
+  RangeCuller(const MapConfig& map_config,
+              const ProjectiveIntegrator::Config& config,
+              const InputData& data);
+
+  bool canSkip(const Point& p_min, const Point& p_max) const;
+
+  const Sensor& sensor;
+  const Eigen::Isometry3f sensor_T_body;
+  const RangeImagePyramid pyramid;
+  float min_range;
+  float max_range;
+  float max_behind_surface;
+  float margin;
+  size_t block_min_index = 0;
+  size_t block_max_index = 0;
+  std::vector<SubBlock> sub_blocks;
+
+  inline static constexpr int kSubBlockSize = 4;
+};
+
+ProjectiveIntegrator::RangeCuller::RangeCuller(
+    const MapConfig& map_config,
+    const ProjectiveIntegrator::Config& config,
+    const InputData& data)
+    : sensor(data.getSensor()),
+      sensor_T_body(data.getSensorPose().cast<float>().inverse()),
+      pyramid(data.range_image) {
+  // small tolerance to absorb the difference in rounding between the bounds and the
+  // per-voxel computations
+  margin = 0.01f * map_config.voxel_size;
+  min_range = sensor.min_range() - margin;
+  max_range = std::min(sensor.max_range(), data.max_range) + margin;
+
+  // matches the thresholds applied in computeSDF and getVoxelMeasurement
+  float extra_distance = 0.0f;
+  if (config.extra_integration_distance) {
+    extra_distance = config.extra_integration_distance < 0.0f
+                         ? -config.extra_integration_distance * map_config.voxel_size
+                         : config.extra_integration_distance;
+  }
+  max_behind_surface = map_config.truncation_distance + extra_distance + margin;
+
+  // voxel layout is identical for all blocks, so use a reference block to group voxels
+  const auto vps = map_config.voxels_per_side;
+  const TsdfBlock block(map_config.voxel_size, vps, BlockIndex::Zero());
+  const int sub_per_side = (vps + kSubBlockSize - 1) / kSubBlockSize;
+  sub_blocks.resize(sub_per_side * sub_per_side * sub_per_side);
+  std::vector<int> min_sums(sub_blocks.size(), std::numeric_limits<int>::max());
+  std::vector<int> max_sums(sub_blocks.size(), std::numeric_limits<int>::lowest());
+  for (size_t i = 0; i < block.numVoxels(); ++i) {
+    const Eigen::Vector3i index = block.getVoxelIndex(i).cast<int>();
+    const Eigen::Vector3i sub_index = index / kSubBlockSize;
+    const auto sub =
+        sub_index.x() + sub_per_side * (sub_index.y() + sub_per_side * sub_index.z());
+    auto& sub_block = sub_blocks.at(sub);
+    sub_block.voxels.push_back(i);
+    // within an axis-aligned box of voxels the corners minimize / maximize the sum of
+    // the voxel coordinates
+    const int sum = index.sum();
+    if (sum < min_sums[sub]) {
+      min_sums[sub] = sum;
+      sub_block.min_index = i;
+    }
+    if (sum > max_sums[sub]) {
+      max_sums[sub] = sum;
+      sub_block.max_index = i;
+    }
+
+    if (sum == 0) {
+      block_min_index = i;
+    }
+    if (sum == 3 * (static_cast<int>(vps) - 1)) {
+      block_max_index = i;
+    }
+  }
+}
+
+bool ProjectiveIntegrator::RangeCuller::canSkip(const Point& p_min,
+                                                const Point& p_max) const {
+  const Point center = sensor_T_body * (0.5f * (p_min + p_max));
+  const float radius = 0.5f * (p_max - p_min).norm();
+  const float center_dist = center.norm();
+  const float r_min = std::max(center_dist - radius, 0.0f);
+  const float r_max = center_dist + radius;
+  if (r_max < min_range || r_min > max_range) {
+    return true;
+  }
+
+  Eigen::Matrix3Xf corners(3, 8);
+  for (int i = 0; i < 8; ++i) {
+    const Point corner((i & 1) ? p_max.x() : p_min.x(),
+                       (i & 2) ? p_max.y() : p_min.y(),
+                       (i & 4) ? p_max.z() : p_min.z());
+    corners.col(i) = sensor_T_body * corner;
+  }
+
+  float u_min, u_max, v_min, v_max;
+  if (!sensor.projectBoundsToImagePlane(corners, u_min, u_max, v_min, v_max)) {
+    return false;
+  }
+
+  // interpolation reads at most the pixel after floor(u) (or rounds to nearest), so pad
+  // the footprint by a pixel on both sides. Clamping first keeps the casts in range
+  const auto& base = pyramid.level(0);
+  const auto to_pixel = [](float value, int size) {
+    return static_cast<int>(std::floor(std::clamp(value, -4.0f, size + 4.0f)));
+  };
+  const float d_max = pyramid.maxRange(to_pixel(u_min, base.cols) - 1,
+                                       to_pixel(u_max, base.cols) + 2,
+                                       to_pixel(v_min, base.rows) - 1,
+                                       to_pixel(v_max, base.rows) + 2);
+  // no valid pixels results in lowest float, which always passes this check
+  return d_max < r_min - max_behind_surface;
+}
+
 void ProjectiveIntegrator::updateBlocks(const BlockIndices& block_indices,
                                         const InputData& data,
                                         const cv::Mat& integration_mask,
@@ -151,6 +281,12 @@ void ProjectiveIntegrator::updateBlocks(const BlockIndices& block_indices,
   LOG_IF(INFO, config.verbosity >= 3)
       << "Updating " << block_indices.size() << " blocks.";
 
+  num_projected_voxels_ = 0;
+  std::unique_ptr<RangeCuller> culler;
+  if (config.use_range_pyramid && !data.range_image.empty()) {
+    culler = std::make_unique<RangeCuller>(map.config, config, data);
+  }
+
   // Update all blocks in parallel.
   IndexGetter<BlockIndex> index_getter(block_indices);
 
@@ -160,7 +296,7 @@ void ProjectiveIntegrator::updateBlocks(const BlockIndices& block_indices,
     threads.emplace_back(std::async(std::launch::async, [&]() {
       BlockIndex block_index;
       while (index_getter.getNextIndex(block_index)) {
-        updateBlock(block_index, data, integration_mask, map);
+        updateBlockImpl(block_index, data, integration_mask, map, culler.get());
       }
     }));
   }
@@ -168,35 +304,68 @@ void ProjectiveIntegrator::updateBlocks(const BlockIndices& block_indices,
   for (auto& thread : threads) {
     thread.get();
   }
+
+  LOG_IF(INFO, config.verbosity >= 3)
+      << "Projected " << num_projected_voxels_ << " voxels.";
 }
 
 void ProjectiveIntegrator::updateBlock(const BlockIndex& block_index,
                                        const InputData& data,
                                        const cv::Mat& integration_mask,
                                        VolumetricMap& map) const {
+  updateBlockImpl(block_index, data, integration_mask, map, nullptr);
+}
+
+void ProjectiveIntegrator::updateBlockImpl(const BlockIndex& block_index,
+                                           const InputData& data,
+                                           const cv::Mat& integration_mask,
+                                           VolumetricMap& map,
+                                           const RangeCuller* culler) const {
   // Get the requested blocks.
   BlockTuple blocks = map.getBlock(block_index);
   if (!blocks.tsdf) {
     // Skip unallocated blocks.
     return;
   }
+  const auto& tsdf = *blocks.tsdf;
   const auto sensor_T_body = data.getSensorPose().cast<float>().inverse();
 
   // Update all voxels.
   bool was_updated = false;
-  for (size_t i = 0; i < blocks.tsdf->numVoxels(); ++i) {
-    const auto p_sensor = sensor_T_body * blocks.tsdf->getVoxelPosition(i);
+  size_t num_projected = 0;
+  const auto update_voxel = [&](size_t i) {
+    ++num_projected;
+    const auto p_sensor = sensor_T_body * tsdf.getVoxelPosition(i);
     const auto measurement =
         getVoxelMeasurement(map.config, data, integration_mask, p_sensor);
     if (!measurement.valid) {
-      continue;
+      return;
     }
 
     auto voxels = blocks.getVoxels(i);
     updateVoxel(map.config, data, measurement, voxels);
     was_updated = true;
+  };
+
+  if (!culler) {
+    for (size_t i = 0; i < tsdf.numVoxels(); ++i) {
+      update_voxel(i);
+    }
+  } else if (!culler->canSkip(tsdf.getVoxelPosition(culler->block_min_index),
+                              tsdf.getVoxelPosition(culler->block_max_index))) {
+    for (const auto& sub_block : culler->sub_blocks) {
+      if (culler->canSkip(tsdf.getVoxelPosition(sub_block.min_index),
+                          tsdf.getVoxelPosition(sub_block.max_index))) {
+        continue;
+      }
+
+      for (const auto i : sub_block.voxels) {
+        update_voxel(i);
+      }
+    }
   }
 
+  num_projected_voxels_ += num_projected;
   if (was_updated) {
     LOG_IF(INFO, config.verbosity >= 10)
         << "integrator updated block " << showIndex(block_index);
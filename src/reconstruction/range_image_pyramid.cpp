@@ -0,0 +1,115 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/reconstruction/range_image_pyramid.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hydra {
+
+RangeImagePyramid::RangeImagePyramid(const cv::Mat& range_image) {
+  if (range_image.empty()) {
+    return;
+  }
+
+  CHECK_EQ(range_image.type(), CV_32FC1) << "range image must be float";
+  constexpr float lowest = std::numeric_limits<float>::lowest();
+  cv::Mat base(range_image.size(), CV_32FC1);
+  for (int r = 0; r < range_image.rows; ++r) {
+    const auto src = range_image.ptr<float>(r);
+    auto dest = base.ptr<float>(r);
+    for (int c = 0; c < range_image.cols; ++c) {
+      dest[c] = std::isnan(src[c]) ? lowest : src[c];
+    }
+  }
+
+  levels_.push_back(base);
+  while (levels_.back().rows > 1 || levels_.back().cols > 1) {
+    const auto& prev = levels_.back();
+    cv::Mat next((prev.rows + 1) / 2, (prev.cols + 1) / 2, CV_32FC1);
+    for (int r = 0; r < next.rows; ++r) {
+      const auto top = prev.ptr<float>(2 * r);
+      const auto bottom = prev.ptr<float>(std::min(2 * r + 1, prev.rows - 1));
+      auto dest = next.ptr<float>(r);
+      for (int c = 0; c < next.cols; ++c) {
+        const auto c0 = 2 * c;
+        const auto c1 = std::min(c0 + 1, prev.cols - 1);
+        dest[c] = std::max(std::max(top[c0], top[c1]), std::max(bottom[c0], bottom[c1]));
+      }
+    }
+
+    levels_.push_back(next);
+  }
+}
+
+float RangeImagePyramid::maxRange(int u_min, int u_max, int v_min, int v_max) const {
+  constexpr float lowest = std::numeric_limits<float>::lowest();
+  if (levels_.empty()) {
+    return lowest;
+  }
+
+  const auto& base = levels_.front();
+  u_min = std::max(u_min, 0);
+  v_min = std::max(v_min, 0);
+  u_max = std::min(u_max, base.cols - 1);
+  v_max = std::min(v_max, base.rows - 1);
+  if (u_min > u_max || v_min > v_max) {
+    return lowest;
+  }
+
+  // find the first level where the rectangle spans at most 2x2 pixels
+  size_t level = 0;
+  while (level + 1 < levels_.size() &&
+         ((u_max >> level) - (u_min >> level) > 1 ||
+          (v_max >> level) - (v_min >> level) > 1)) {
+    ++level;
+  }
+
+  const auto& img = levels_[level];
+  float max_range = lowest;
+  for (int v = v_min >> level; v <= (v_max >> level); ++v) {
+    const auto row = img.ptr<float>(v);
+    for (int u = u_min >> level; u <= (u_max >> level); ++u) {
+      max_range = std::max(max_range, row[u]);
+    }
+  }
+
+  return max_range;
+}
+
+}  // namespace hydra
@@ -76,11 +76,17 @@ MLESemanticIntegrator::MLESemanticIntegrator(const Config& config) : config(conf
   total_labels_ = GlobalInfo::instance().getTotalLabels();
   init_likelihood_ = std::log(1.0f / static_cast<float>(total_labels_));
 
-  const auto match_likelihood = std::log(config.label_confidence);
-  const auto nonmatch_likelihood = std::log(1.0f - config.label_confidence);
-  observation_likelihoods_ =
-      Eigen::MatrixXf::Constant(total_labels_, total_labels_, nonmatch_likelihood);
-  observation_likelihoods_.diagonal().setConstant(match_likelihood);
+  match_likelihood_ = std::log(config.label_confidence);
+  nonmatch_likelihood_ = std::log(1.0f - config.label_confidence);
+  match_increment_ = match_likelihood_ - nonmatch_likelihood_;
+  // a certain measurement (non-match likelihood of -inf) can't be split into an
+  // offset and an increment, so fall back to the dense update
+  use_offset_ = std::isfinite(nonmatch_likelihood_);
+  if (!use_offset_) {
+    observation_likelihoods_ =
+        Eigen::MatrixXf::Constant(total_labels_, total_labels_, nonmatch_likelihood_);
+    observation_likelihoods_.diagonal().setConstant(match_likelihood_);
+  }
 }
 
 void MLESemanticIntegrator::updateLikelihoods(uint32_t label,
@@ -97,11 +103,41 @@ void MLESemanticIntegrator::updateLikelihoods(uint32_t label,
 
   if (voxel.empty) {
     voxel.empty = false;
+    voxel.likelihood_offset = 0.0f;
     voxel.semantic_likelihoods.setConstant(total_labels_, init_likelihood_);
+    voxel.semantic_label = 0;
+  }
+
+  if (!use_offset_) {
+    voxel.semantic_likelihoods += observation_likelihoods_.col(label);
+    voxel.semantic_likelihoods.maxCoeff(&voxel.semantic_label);
+    return;
+  }
+
+  voxel.likelihood_offset += nonmatch_likelihood_;
+  auto& likelihood = voxel.semantic_likelihoods(label);
+  likelihood += match_increment_;
+
+  const auto best = voxel.semantic_label;
+  if (best >= total_labels_) {
+    voxel.semantic_likelihoods.maxCoeff(&voxel.semantic_label);
+    return;
   }
 
-  voxel.semantic_likelihoods += observation_likelihoods_.col(label);
-  voxel.semantic_likelihoods.maxCoeff(&voxel.semantic_label);
+  if (label == best) {
+    if (match_increment_ < 0.0f) {
+      // the current best got worse (label confidence below 0.5)
+      voxel.semantic_likelihoods.maxCoeff(&voxel.semantic_label);
+    }
+
+    return;
+  }
+
+  // ties resolve to the lowest label to match Eigen's maxCoeff
+  const auto best_likelihood = voxel.semantic_likelihoods(best);
+  if (likelihood > best_likelihood || (likelihood == best_likelihood && label < best)) {
+    voxel.semantic_label = label;
+  }
 }
 
 void declare_config(MLESemanticIntegrator::Config& config) {
@@ -35,8 +35,11 @@
 #include "hydra/reconstruction/tsdf_interpolators.h"
 
 #include <config_utilities/config.h>
+#include <config_utilities/types/conversions.h>
 #include <config_utilities/validation.h>
 
+#include "hydra/utils/parallel_utilities.h"
+
 namespace hydra {
 
 Eigen::Matrix<int, 3, 8> getCubeOffsets() {
@@ -54,8 +57,12 @@ void declare_config(DownsampleTsdfInterpolator::Config& config) {
   name("DownsampleTsdfInterpolator::Config");
   field(config.ratio, "ratio");
   field(config.tolerance, "tolerance");
+  field<ThreadNumConversion>(config.num_threads, "num_threads");
+  field(config.num_levels, "num_levels");
   checkCondition((config.ratio % 2 == 0), "Downsample ratio must be even");
   check(config.ratio, GT, 1, "ratio");
+  check(config.num_threads, GT, 0, "num_threads");
+  check(config.num_levels, GT, 0, "num_levels");
 }
 
 DownsampleTsdfInterpolator::DownsampleTsdfInterpolator(const Config& config)
@@ -69,51 +76,130 @@ TsdfLayer::Ptr DownsampleTsdfInterpolator::interpolate(
     LOG(ERROR) << "ratio invalid for current number of voxels";
     return nullptr;
   }
+
   auto new_layer = std::make_shared<TsdfLayer>(new_vs, new_vps);
+  const auto& blocks = to_use ? *to_use : input.allocatedBlockIndices();
+  interpolateBlocks(input, blocks, *new_layer);
+  return new_layer;
+}
+
+void DownsampleTsdfInterpolator::interpolateBlocks(const TsdfLayer& input,
+                                                   const BlockIndices& blocks,
+                                                   TsdfLayer& output) const {
+  // allocation isn't thread-safe, so all output blocks are allocated up front
+  for (const auto& idx : blocks) {
+    output.allocateBlock(idx);
+  }
+
+  processInParallel(blocks.size(), config.num_threads, [&](size_t i) {
+    interpolateBlock(input.getBlock(blocks[i]), output.getBlock(blocks[i]));
+  });
+}
+
+void DownsampleTsdfInterpolator::interpolateBlock(const TsdfBlock& old_block,
+                                                  TsdfBlock& new_block) const {
+  static const auto offsets = getCubeOffsets();
+  const VoxelIndex center_offset = VoxelIndex::Constant(config.ratio / 2);
+  for (size_t i = 0; i < new_block.numVoxels(); ++i) {
+    auto& new_voxel = new_block.getVoxel(i);
+    new_voxel = TsdfVoxel();
+
+    // get top-level corner of 2x2x2 cube
+    const auto new_idx = new_block.getVoxelIndex(i);
+    const VoxelIndex old_idx = config.ratio * new_idx + center_offset;
+
+    // float required to avoid overflow
+    Eigen::Vector4f new_color = Eigen::Vector4f::Zero();
+    for (size_t i = 0; i < 8; ++i) {
+      const auto& voxel = old_block.getVoxel(old_idx - offsets.col(i));
+
+      new_voxel.weight += voxel.weight;
+      new_voxel.distance += voxel.weight * voxel.distance;
+      new_color(0, 0) += voxel.weight * voxel.color.r;
+      new_color(1, 0) += voxel.weight * voxel.color.g;
+      new_color(2, 0) += voxel.weight * voxel.color.b;
+      new_color(3, 0) += voxel.weight * voxel.color.a;
+    }
+
+    if (new_voxel.weight < config.tolerance) {
+      continue;  // all voxels are unobserved, skip distance and color computation
+    }
+
+    // finalize the weight average
+    new_voxel.color.r = std::round(new_color(0) / new_voxel.weight);
+    new_voxel.color.g = std::round(new_color(1) / new_voxel.weight);
+    new_voxel.color.b = std::round(new_color(2) / new_voxel.weight);
+    new_voxel.color.a = std::round(new_color(3) / new_voxel.weight);
+    new_voxel.distance /= new_voxel.weight;
+    new_voxel.weight /= 8;
+  }
+}
+
+namespace {
+
+inline DownsampleTsdfInterpolator::Config levelConfig(
+    const DownsampleTsdfInterpolator::Config& config) {
+  auto level_config = config;
+  level_config.ratio = 2;
+  return level_config;
+}
+
+}  // namespace
+
+TsdfPyramid::TsdfPyramid(const Config& config)
+    : base_interpolator_(config), level_interpolator_(levelConfig(config)) {}
+
+bool TsdfPyramid::update(const TsdfLayer& input, const BlockIndices* to_use) {
+  if (levels_.empty()) {
+    auto voxel_size = input.voxel_size * base_interpolator_.config.ratio;
+    auto vps = input.voxels_per_side / base_interpolator_.config.ratio;
+    if (vps <= 1) {
+      LOG(ERROR) << "ratio invalid for current number of voxels";
+      return false;
+    }
+
+    levels_.push_back(std::make_shared<TsdfLayer>(voxel_size, vps));
+    while (levels_.size() < base_interpolator_.config.num_levels && vps / 2 > 1) {
+      voxel_size *= 2;
+      vps /= 2;
+      levels_.push_back(std::make_shared<TsdfLayer>(voxel_size, vps));
+    }
+
+    LOG_IF(WARNING, levels_.size() < base_interpolator_.config.num_levels)
+        << "Only using " << levels_.size() << " of "
+        << base_interpolator_.config.num_levels
+        << " requested level(s) for TSDF pyramid: not enough voxels per side";
+  }
 
-  const auto offsets = getCubeOffsets();
-  VoxelIndex center_offset = VoxelIndex::Constant(config.ratio / 2);
   const BlockIndices blocks = to_use ? *to_use : input.allocatedBlockIndices();
+  base_interpolator_.interpolateBlocks(input, blocks, *levels_.front());
+  for (size_t i = 1; i < levels_.size(); ++i) {
+    level_interpolator_.interpolateBlocks(*levels_[i - 1], blocks, *levels_[i]);
+  }
 
-  for (const auto& idx : blocks) {
-    auto& new_block = new_layer->allocateBlock(idx);
-    const auto& old_block = input.getBlock(idx);
-
-    for (size_t i = 0; i < new_block.numVoxels(); ++i) {
-      auto& new_voxel = new_block.getVoxel(i);
-
-      // get top-level corner of 2x2x2 cube
-      const auto new_idx = new_block.getVoxelIndex(i);
-      const VoxelIndex old_idx = config.ratio * new_idx + center_offset;
-
-      // float required to avoid overflow
-      Eigen::Vector4f new_color = Eigen::Vector4f::Zero();
-      for (size_t i = 0; i < 8; ++i) {
-        const auto& voxel = old_block.getVoxel(old_idx - offsets.col(i));
-
-        new_voxel.weight += voxel.weight;
-        new_voxel.distance += voxel.weight * voxel.distance;
-        new_color(0, 0) += voxel.weight * voxel.color.r;
-        new_color(1, 0) += voxel.weight * voxel.color.g;
-        new_color(2, 0) += voxel.weight * voxel.color.b;
-        new_color(3, 0) += voxel.weight * voxel.color.a;
-      }
-
-      if (new_voxel.weight < config.tolerance) {
-        continue;  // all voxels are unobserved, skip distance and color computation
-      }
-
-      // finalize the weight average
-      new_voxel.color.r = std::round(new_color(0) / new_voxel.weight);
-      new_voxel.color.g = std::round(new_color(1) / new_voxel.weight);
-      new_voxel.color.b = std::round(new_color(2) / new_voxel.weight);
-      new_voxel.color.a = std::round(new_color(3) / new_voxel.weight);
-      new_voxel.distance /= new_voxel.weight;
-      new_voxel.weight /= 8;
+  for (const auto& layer : levels_) {
+    for (const auto& idx : blocks) {
+      layer->getBlock(idx).setUpdated();
     }
   }
 
-  return new_layer;
+  return true;
+}
+
+void TsdfPyramid::removeBlocks(const BlockIndices& blocks) {
+  for (const auto& layer : levels_) {
+    for (const auto& idx : blocks) {
+      layer->removeBlock(idx);
+    }
+  }
+}
+
+const TsdfLayer* TsdfPyramid::level(size_t index) const {
+  return index < levels_.size() ? levels_[index].get() : nullptr;
+}
+
+TsdfLayer* TsdfPyramid::level(size_t index) {
+  return index < levels_.size() ? levels_[index].get() : nullptr;
 }
 
 }  // namespace hydra
@@ -244,10 +244,19 @@ std::unique_ptr<VolumetricMap> VolumetricMap::clone() const {
 }
 
 std::unique_ptr<VolumetricMap> VolumetricMap::cloneUpdated() const {
-  auto map = std::make_unique<VolumetricMap>(config);
   const auto blocks = tsdf_layer_.blockIndicesWithCondition(
       [](const auto& block) { return block.updated; });
+  return cloneBlocks(blocks);
+}
+
+std::unique_ptr<VolumetricMap> VolumetricMap::cloneBlocks(
+    const BlockIndices& blocks) const {
+  auto map = std::make_unique<VolumetricMap>(config);
   for (const auto& idx : blocks) {
+    if (!tsdf_layer_.hasBlock(idx)) {
+      continue;
+    }
+
     map->tsdf_layer_.allocateBlock(idx) = tsdf_layer_.getBlock(idx);
     if (mesh_layer_.hasBlock(idx)) {
       map->mesh_layer_.allocateBlock(idx) = mesh_layer_.getBlock(idx);
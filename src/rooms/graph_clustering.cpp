@@ -34,7 +34,12 @@
  * -------------------------------------------------------------------------- */
 #include "hydra/rooms/graph_clustering.h"
 
+#include <algorithm>
+#include <limits>
 #include <queue>
+#include <unordered_map>
+
+#include "hydra/utils/parallel_utilities.h"
 
 namespace hydra {
 
@@ -60,10 +65,185 @@ void ClusterResults::fillFromInitialClusters(const InitialClusters& initial_clus
   }
 }
 
+namespace {
+
+inline constexpr size_t kUnlabeled = std::numeric_limits<size_t>::max();
+
+// Layer adjacency in compressed sparse row format with nodes indexed in ID order
+struct CsrGraph {
+  CsrGraph(const SceneGraphLayer& layer, const EdgeWeightFunc& edge_weight_func) {
+    ids.reserve(layer.numNodes());
+    for (const auto& id_node_pair : layer.nodes()) {
+      index.emplace(id_node_pair.first, ids.size());
+      ids.push_back(id_node_pair.first);
+    }
+
+    offsets.reserve(ids.size() + 1);
+    offsets.push_back(0);
+    degrees.reserve(ids.size());
+    std::vector<std::pair<size_t, double>> row;
+    for (const auto& id_node_pair : layer.nodes()) {
+      row.clear();
+      double degree = 0.0;
+      for (const auto& sibling : id_node_pair.second->siblings()) {
+        double edge_weight = edge_weight_func(layer, id_node_pair.first, sibling);
+        // we should probably assert that this isn't happening, but it should be pretty
+        // feasbile to not return negative weights
+        edge_weight = edge_weight < 0.0 ? 0.0 : edge_weight;
+        degree += edge_weight;
+        row.emplace_back(index.at(sibling), edge_weight);
+      }
+
+      // neighbors are visited in ID order when accumulating community weights
+      std::sort(row.begin(), row.end());
+      for (const auto& [neighbor, weight] : row) {
+        neighbors.push_back(neighbor);
+        weights.push_back(weight);
+      }
+
+      offsets.push_back(neighbors.size());
+      degrees.push_back(degree);
+    }
+  }
+
+  size_t size() const { return ids.size(); }
+
+  std::vector<NodeId> ids;
+  std::unordered_map<NodeId, size_t> index;
+  std::vector<size_t> offsets;
+  std::vector<size_t> neighbors;
+  std::vector<double> weights;
+  std::vector<double> degrees;
+};
+
+// Dense per-community weights that only resets the communities it touched
+struct CommunityAccumulator {
+  explicit CommunityAccumulator(size_t num_communities)
+      : weights(num_communities, 0.0), seen(num_communities, false) {}
+
+  void add(size_t community, double weight) {
+    if (!seen[community]) {
+      seen[community] = true;
+      touched.push_back(community);
+    }
+
+    weights[community] += weight;
+  }
+
+  void clear() {
+    for (const auto community : touched) {
+      weights[community] = 0.0;
+      seen[community] = false;
+    }
+
+    touched.clear();
+  }
+
+  std::vector<double> weights;
+  std::vector<bool> seen;
+  std::vector<size_t> touched;
+};
+
+struct ModularityState {
+  const CsrGraph& graph;
+  const size_t num_communities;
+  const double m;
+  const double gamma;
+  std::vector<size_t> labels;
+  std::vector<double> community_degrees;
+
+  // Find the community with the best (positive) modularity gain for a node, using the
+  // community degrees without the contribution of the node itself
+  size_t findBest(size_t node, CommunityAccumulator& accumulator) const {
+    accumulator.clear();
+    for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+      const auto community = labels[graph.neighbors[i]];
+      if (community == kUnlabeled) {
+        continue;
+      }
+
+      accumulator.add(community, graph.weights[i]);
+    }
+
+    // communities are compared in increasing order to break ties consistently
+    std::sort(accumulator.touched.begin(), accumulator.touched.end());
+
+    const double node_degree = graph.degrees[node];
+    const auto current = labels[node];
+    double best_gain = 0.0;
+    size_t best_community = num_communities;
+    for (const auto community : accumulator.touched) {
+      double community_degree = community_degrees[community];
+      if (community == current) {
+        community_degree -= node_degree;
+      }
+
+      const double gain = 2 * accumulator.weights[community] -
+                          gamma * (community_degree * node_degree) / m;
+      if (gain > best_gain) {
+        best_gain = gain;
+        best_community = community;
+      }
+    }
+
+    return best_community;
+  }
+
+  // Move a node to the best community, returning true if the label changed
+  bool apply(size_t node, size_t best_community) {
+    const double node_degree = graph.degrees[node];
+    if (labels[node] != kUnlabeled) {
+      community_degrees[labels[node]] -= node_degree;
+    }
+
+    if (best_community == num_communities) {
+      return false;  // we couldn't pick a community
+    }
+
+    community_degrees[best_community] += node_degree;
+    if (labels[node] == best_community) {
+      return false;
+    }
+
+    labels[node] = best_community;
+    return true;
+  }
+};
+
+// Greedy coloring of the unlabeled nodes so that no two adjacent nodes share a color
+std::vector<std::vector<size_t>> colorNodes(const CsrGraph& graph,
+                                            const std::vector<size_t>& nodes) {
+  std::vector<size_t> colors(graph.size(), kUnlabeled);
+  std::vector<std::vector<size_t>> color_classes;
+  std::vector<bool> used;
+  for (const auto node : nodes) {
+    used.assign(color_classes.size() + 1, false);
+    for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+      const auto color = colors[graph.neighbors[i]];
+      if (color != kUnlabeled) {
+        used[color] = true;
+      }
+    }
+
+    const auto color = std::find(used.begin(), used.end(), false) - used.begin();
+    if (static_cast<size_t>(color) == color_classes.size()) {
+      color_classes.emplace_back();
+    }
+
+    colors[node] = color;
+    color_classes[color].push_back(node);
+  }
+
+  return color_classes;
+}
+
+}  // namespace
+
 ClusterResults clusterGraphByModularity(const SceneGraphLayer& layer,
                                         const InitialClusters& initial_clusters,
                                         size_t max_iters,
-                                        double gamma) {
+                                        double gamma,
+                                        size_t num_threads) {
   return clusterGraphByModularity(
       layer,
       initial_clusters,
@@ -71,100 +251,71 @@ ClusterResults clusterGraphByModularity(const SceneGraphLayer& layer,
         return G.getEdge(n1, n2).info->weight;
       },
       max_iters,
-      gamma);
+      gamma,
+      num_threads);
 }
 
 ClusterResults clusterGraphByModularity(const SceneGraphLayer& layer,
                                         const InitialClusters& initial_clusters,
                                         const EdgeWeightFunc& edge_weight_func,
                                         size_t max_iters,
-                                        double gamma) {
-  std::map<NodeId, double> degrees;
-  std::map<NodeId, std::map<NodeId, double>> neighbors;
-  for (const auto& id_node_pair : layer.nodes()) {
-    double degree = 0.0;
-    neighbors[id_node_pair.first] = std::map<NodeId, double>();
-    for (const auto& sibling : id_node_pair.second->siblings()) {
-      double edge_weight = edge_weight_func(layer, id_node_pair.first, sibling);
-      // we should probably assert that this isn't happening, but it should be pretty
-      // feasbile to not return negative weights
-      edge_weight = edge_weight < 0.0 ? 0.0 : edge_weight;
-      degree += edge_weight;
-      neighbors[id_node_pair.first][sibling] = edge_weight;
-    }
-    degrees[id_node_pair.first] = degree;
-  }
-
-  const double m = layer.numEdges();
-
-  std::map<size_t, double> community_degrees;
-  std::map<NodeId, size_t> labels;
+                                        double gamma,
+                                        size_t num_threads) {
+  const CsrGraph graph(layer, edge_weight_func);
+  const size_t num_communities = initial_clusters.size();
+  ModularityState state{graph,
+                        num_communities,
+                        static_cast<double>(layer.numEdges()),
+                        gamma,
+                        std::vector<size_t>(graph.size(), kUnlabeled),
+                        std::vector<double>(num_communities, 0.0)};
   for (size_t i = 0; i < initial_clusters.size(); ++i) {
     const auto& component = initial_clusters[i];
     double total_degree = 0.0;
     for (const auto& node_id : component) {
-      labels[node_id] = i;
-      total_degree += degrees.at(node_id);
+      const auto node = graph.index.at(node_id);
+      state.labels[node] = i;
+      total_degree += graph.degrees[node];
     }
-    community_degrees[i] = total_degree;
+    state.community_degrees[i] = total_degree;
   }
 
-  std::set<NodeId> unlabeled_nodes;
-  for (const auto& id_node_pair : layer.nodes()) {
-    if (labels.count(id_node_pair.first)) {
-      continue;
+  std::vector<size_t> unlabeled_nodes;
+  for (size_t node = 0; node < graph.size(); ++node) {
+    if (state.labels[node] == kUnlabeled) {
+      unlabeled_nodes.push_back(node);
     }
-
-    unlabeled_nodes.insert(id_node_pair.first);
   }
 
+  // nodes of the same color are not adjacent, so their community weights can be
+  // computed concurrently (against the community degrees from before the color)
+  const bool parallel = num_threads > 1;
+  const auto color_classes = parallel ? colorNodes(graph, unlabeled_nodes)
+                                      : std::vector<std::vector<size_t>>();
+
+  CommunityAccumulator accumulator(num_communities);
+  std::vector<CommunityAccumulator> accumulators(
+      parallel ? num_threads : 0, CommunityAccumulator(num_communities));
+  std::vector<size_t> best_communities;
   size_t iter;
   for (iter = 0; iter < max_iters; ++iter) {
     size_t num_changes = 0;
-    for (const auto& node : unlabeled_nodes) {
-      std::map<size_t, double> community_weights;
-      for (const auto id_weight_pair : neighbors.at(node)) {
-        if (!labels.count(id_weight_pair.first)) {
-          continue;
-        }
-
-        const size_t community = labels.at(id_weight_pair.first);
-        if (!community_weights.count(community)) {
-          community_weights[community] = 0.0;
-        }
-
-        community_weights[community] += id_weight_pair.second;
-      }
-
-      const double node_degree = degrees.at(node);
-      if (labels.count(node)) {
-        community_degrees[labels.at(node)] -= node_degree;
-      }
-
-      double best_gain = 0.0;
-      size_t best_community = initial_clusters.size();
-      for (const auto& id_weight_pair : community_weights) {
-        const double gain =
-            2 * id_weight_pair.second -
-            gamma * (community_degrees.at(id_weight_pair.first) * node_degree) / m;
-        if (gain > best_gain) {
-          best_gain = gain;
-          best_community = id_weight_pair.first;
-        }
-      }
-
-      if (best_community == initial_clusters.size()) {
-        continue;  // we couldn't pick a community
+    if (!parallel) {
+      for (const auto node : unlabeled_nodes) {
+        num_changes += state.apply(node, state.findBest(node, accumulator));
       }
+    }
 
-      community_degrees[best_community] += node_degree;
+    for (const auto& nodes : color_classes) {
+      best_communities.resize(nodes.size());
+      const auto num_workers = std::min(num_threads, nodes.size());
+      processInParallel(nodes.size(), num_workers, [&](size_t worker, size_t i) {
+        best_communities[i] = state.findBest(nodes[i], accumulators[worker]);
+      });
 
-      if (labels.count(node) && labels.at(node) == best_community) {
-        continue;
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        num_changes += state.apply(nodes[i], best_communities[i]);
       }
-
-      ++num_changes;
-      labels[node] = best_community;
     }
 
     if (!num_changes) {
@@ -172,13 +323,17 @@ ClusterResults clusterGraphByModularity(const SceneGraphLayer& layer,
     }
   }
 
+  std::map<NodeId, size_t> labels;
   std::map<size_t, std::unordered_set<NodeId>> clusters;
-  for (const auto& node_cluster_pair : labels) {
-    if (!clusters.count(node_cluster_pair.second)) {
-      clusters[node_cluster_pair.second] = std::unordered_set<NodeId>();
+  for (size_t node = 0; node < graph.size(); ++node) {
+    const auto label = state.labels[node];
+    if (label == kUnlabeled) {
+      continue;
     }
 
-    clusters[node_cluster_pair.second].insert(node_cluster_pair.first);
+    const auto node_id = graph.ids[node];
+    labels[node_id] = label;
+    clusters[label].insert(node_id);
   }
 
   return {clusters, labels, iter, true};
@@ -277,8 +277,11 @@ SceneGraphLayer::Ptr RoomFinder::findRooms(const SceneGraphLayer& places) {
   last_results_.clear();
   switch (config_.clustering_mode) {
     case RoomClusterMode::MODULARITY:
-      last_results_ = clusterGraphByModularity(
-          places, components, config_.max_modularity_iters, config_.modularity_gamma);
+      last_results_ = clusterGraphByModularity(places,
+                                               components,
+                                               config_.max_modularity_iters,
+                                               config_.modularity_gamma,
+                                               config_.num_modularity_threads);
       break;
     case RoomClusterMode::MODULARITY_DISTANCE:
       last_results_ = clusterGraphByModularity(
@@ -289,7 +292,8 @@ SceneGraphLayer::Ptr RoomFinder::findRooms(const SceneGraphLayer& places) {
             return 1.0 / (getNodePosition(G, n1) - getNodePosition(G, n2)).norm();
           },
           config_.max_modularity_iters,
-          config_.modularity_gamma);
+          config_.modularity_gamma,
+          config_.num_modularity_threads);
       break;
     case RoomClusterMode::NEIGHBORS:
       last_results_ = clusterGraphByNeighbors(places, components);
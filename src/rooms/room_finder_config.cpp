@@ -60,6 +60,7 @@ void declare_config(RoomFinderConfig& conf) {
   field(conf.plateau_ratio, "plateau_ratio");
   field(conf.max_modularity_iters, "max_modularity_iters");
   field(conf.modularity_gamma, "modularity_gamma");
+  field(conf.num_modularity_threads, "num_modularity_threads");
   enum_field(conf.clustering_mode,
              "clustering_mode",
              {{RoomClusterMode::MODULARITY, "MODULARITY"},
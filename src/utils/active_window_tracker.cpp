@@ -39,8 +39,13 @@
 #include <spark_dsg/scene_graph_layer.h>
 #include <spark_dsg/scene_graph_node.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace hydra {
 
+using spark_dsg::LayerView;
+using spark_dsg::NodeId;
 using spark_dsg::SceneGraphLayer;
 using spark_dsg::SceneGraphNode;
 
@@ -54,10 +59,61 @@ void ActiveWindowTracker::clear() {
 void ActiveWindowTracker::reset() {
   to_clear_.clear();
   prev_active_.clear();
+  last_sequence_.reset();
+}
+
+NodeSubsetView ActiveWindowTracker::view(const SceneGraphLayer& layer,
+                                         bool freeze,
+                                         const GraphChangeLog* changes) const {
+  if (!changes || !last_sequence_ || !changes->covers(*last_sequence_)) {
+    // grab the sequence before scanning so that nothing gets missed
+    const auto sequence = changes ? std::optional<uint64_t>(changes->sequence())
+                                  : std::nullopt;
+    auto view = scanLayer(layer, freeze);
+    if (!freeze) {
+      last_sequence_ = sequence;
+    }
+
+    return view;
+  }
+
+  const auto sequence = changes->sequence();
+  const auto dirty = changes->dirtySince(*last_sequence_, layer.id);
+  // both are sorted, so the candidates stay in the same order as the layer nodes
+  std::vector<NodeId> candidates;
+  candidates.reserve(prev_active_.size() + dirty.size());
+  std::set_union(prev_active_.begin(),
+                 prev_active_.end(),
+                 dirty.begin(),
+                 dirty.end(),
+                 std::back_inserter(candidates));
+
+  NodeSubsetView::Nodes nodes;
+  for (const auto node_id : candidates) {
+    const auto node = layer.findNode(node_id);
+    if (!node) {
+      if (!freeze) {
+        to_clear_.erase(node_id);
+        prev_active_.erase(node_id);
+      }
+
+      continue;
+    }
+
+    if (isActive(*node, freeze)) {
+      nodes.push_back(node);
+    }
+  }
+
+  if (!freeze) {
+    last_sequence_ = sequence;
+  }
+
+  return NodeSubsetView(std::move(nodes));
 }
 
-spark_dsg::LayerView ActiveWindowTracker::view(const SceneGraphLayer& layer,
-                                               bool freeze) const {
+NodeSubsetView ActiveWindowTracker::scanLayer(const SceneGraphLayer& layer,
+                                              bool freeze) const {
   if (!freeze) {
     // prune all removed nodes
     auto iter = prev_active_.begin();
@@ -71,8 +127,9 @@ spark_dsg::LayerView ActiveWindowTracker::view(const SceneGraphLayer& layer,
     }
   }
 
-  return {layer,
-          [this, freeze](const auto& node) -> bool { return isActive(node, freeze); }};
+  return NodeSubsetView(LayerView(layer, [this, freeze](const auto& node) -> bool {
+    return isActive(node, freeze);
+  }));
 }
 
 bool ActiveWindowTracker::isActive(const SceneGraphNode& node, bool freeze) const {
@@ -36,6 +36,9 @@
 
 #include <glog/logging.h>
 
+#include <stdexcept>
+#include <string>
+
 namespace hydra {
 
 DisjointSet::DisjointSet() {}
@@ -59,15 +62,32 @@ bool DisjointSet::addSet(NodeId node) {
 }
 
 NodeId DisjointSet::findSet(NodeId node) const {
-  NodeId parent = node;
+  auto iter = parents.find(node);
+  if (iter == parents.end()) {
+    throw std::out_of_range("node " + std::to_string(node) + " not in disjoint set");
+  }
 
-  NodeId curr_node;
-  do {
-    curr_node = parent;
-    parent = parents.at(curr_node);
-  } while (parent != curr_node);
+  while (iter->second != iter->first) {
+    iter = parents.find(iter->second);
+  }
+
+  return iter->first;
+}
+
+NodeId DisjointSet::findSet(NodeId node) {
+  // path halving: point every other node on the path to its grandparent
+  auto iter = parents.find(node);
+  if (iter == parents.end()) {
+    throw std::out_of_range("node " + std::to_string(node) + " not in disjoint set");
+  }
+
+  while (iter->second != iter->first) {
+    auto parent = parents.find(iter->second);
+    iter->second = parent->second;
+    iter = parents.find(iter->second);
+  }
 
-  return parent;
+  return iter->first;
 }
 
 bool DisjointSet::hasSet(NodeId node) const { return parents.count(node); }
@@ -0,0 +1,167 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/utils/graph_change_log.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace hydra {
+
+using spark_dsg::DynamicSceneGraph;
+using spark_dsg::LayerId;
+using spark_dsg::NodeId;
+
+uint64_t GraphChangeLog::observe(DynamicSceneGraph& graph) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto next = sequence_ + 1;
+  for (const auto node_id : graph.getRemovedNodes(true)) {
+    const auto iter = active_.find(node_id);
+    std::optional<LayerId> layer;
+    if (iter != active_.end()) {
+      layer = iter->second;
+      active_.erase(iter);
+    }
+
+    entries_.push_back({next, node_id, layer, Change::REMOVED});
+  }
+
+  for (const auto node_id : graph.getNewNodes(true)) {
+    const auto node = graph.findNode(node_id);
+    if (!node) {
+      continue;  // added and removed before we got to see it
+    }
+
+    const auto layer = node->layer.layer;
+    entries_.push_back({next, node_id, layer, Change::ADDED});
+    if (node->attributes().is_active) {
+      active_[node_id] = layer;
+    }
+  }
+
+  // only the active window can change state, so there's no need to visit the rest
+  auto iter = active_.begin();
+  while (iter != active_.end()) {
+    const auto node = graph.findNode(iter->first);
+    if (node && node->attributes().is_active) {
+      ++iter;
+      continue;
+    }
+
+    const auto change = node ? Change::DEACTIVATED : Change::REMOVED;
+    entries_.push_back({next, iter->first, iter->second, change});
+    iter = active_.erase(iter);
+  }
+
+  sequence_ = next;
+  VLOG(5) << "[Graph Change Log] sequence " << sequence_ << ": " << entries_.size()
+          << " entries, " << active_.size() << " active node(s)";
+  return sequence_;
+}
+
+void GraphChangeLog::record(NodeId node,
+                            std::optional<LayerId> layer,
+                            Change change) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.push_back({sequence_ + 1, node, layer, change});
+}
+
+uint64_t GraphChangeLog::sequence() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sequence_;
+}
+
+bool GraphChangeLog::covers(uint64_t sequence) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sequence >= trimmed_;
+}
+
+std::vector<GraphChangeLog::Entry> GraphChangeLog::changesSince(
+    uint64_t sequence) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // entries are appended in sequence order
+  const auto first = std::upper_bound(
+      entries_.begin(), entries_.end(), sequence, [](uint64_t seq, const Entry& entry) {
+        return seq < entry.sequence;
+      });
+  return {first, entries_.end()};
+}
+
+template <typename Filter>
+std::vector<NodeId> GraphChangeLog::collect(uint64_t sequence,
+                                            const Filter& filter) const {
+  std::vector<NodeId> nodes;
+  for (const auto& entry : changesSince(sequence)) {
+    if (filter(entry)) {
+      nodes.push_back(entry.node);
+    }
+  }
+
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  return nodes;
+}
+
+std::vector<NodeId> GraphChangeLog::dirtySince(uint64_t sequence) const {
+  return collect(sequence, [](const Entry&) { return true; });
+}
+
+std::vector<NodeId> GraphChangeLog::dirtySince(uint64_t sequence,
+                                               LayerId layer) const {
+  return collect(sequence, [layer](const Entry& entry) {
+    return !entry.layer || *entry.layer == layer;
+  });
+}
+
+void GraphChangeLog::trim(uint64_t sequence) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // never drop changes that belong to the pending sequence
+  sequence = std::min(sequence, sequence_);
+  while (!entries_.empty() && entries_.front().sequence <= sequence) {
+    entries_.pop_front();
+  }
+
+  trimmed_ = std::max(trimmed_, sequence);
+}
+
+void GraphChangeLog::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  active_.clear();
+  // keep counting so that consumers can tell that they missed changes
+  trimmed_ = sequence_;
+}
+
+}  // namespace hydra
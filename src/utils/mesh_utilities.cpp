@@ -41,6 +41,8 @@
 #undef PCL_NO_PRECOMPILE
 #include <spark_dsg/bounding_box_extraction.h>
 
+#include <algorithm>
+
 namespace hydra {
 
 using spark_dsg::NodeAttributes;
@@ -88,6 +90,137 @@ bool updateObjectGeometry(const spark_dsg::Mesh& mesh,
   }
 }
 
+namespace {
+
+inline bool isValid(const Eigen::Vector3f& pos) { return pos.array().isFinite().all(); }
+
+inline bool onBoundary(const Eigen::Vector3f& pos,
+                       const Eigen::Vector3f& min,
+                       const Eigen::Vector3f& max) {
+  return (pos.array() <= min.array()).any() || (pos.array() >= max.array()).any();
+}
+
+}  // namespace
+
+size_t ObjectGeometry::update(const spark_dsg::Mesh& mesh,
+                              const std::vector<size_t>& connections) {
+  const std::vector<size_t>* sorted = &connections;
+  std::vector<size_t> sorted_connections;
+  if (!std::is_sorted(connections.begin(), connections.end())) {
+    sorted_connections = connections;
+    std::sort(sorted_connections.begin(), sorted_connections.end());
+    sorted = &sorted_connections;
+  }
+
+  // merge walk over the cached and current indices: shared vertices only contribute
+  // their displacement, added and removed vertices contribute their position
+  std::vector<size_t> new_indices;
+  std::vector<Eigen::Vector3f> new_positions;
+  new_indices.reserve(sorted->size());
+  new_positions.reserve(sorted->size());
+
+  size_t num_changed = 0;
+  auto old_iter = indices_.begin();
+  auto new_iter = sorted->begin();
+  while (old_iter != indices_.end() || new_iter != sorted->end()) {
+    if (new_iter != sorted->end() && !new_indices.empty() &&
+        *new_iter == new_indices.back()) {
+      ++new_iter;  // skip duplicate connections
+      continue;
+    }
+
+    const auto offset = old_iter - indices_.begin();
+    if (new_iter == sorted->end() ||
+        (old_iter != indices_.end() && *old_iter < *new_iter)) {
+      remove(positions_[offset]);
+      ++num_changed;
+      ++old_iter;
+      continue;
+    }
+
+    const Eigen::Vector3f pos = mesh.pos(*new_iter);
+    if (old_iter == indices_.end() || *new_iter < *old_iter) {
+      add(pos);
+      ++num_changed;
+    } else {
+      const auto& prev = positions_[offset];
+      // NaN positions always compare as changed, which only costs a redundant update
+      if ((prev.array() != pos.array()).any()) {
+        remove(prev);
+        add(pos);
+        ++num_changed;
+      }
+
+      ++old_iter;
+    }
+
+    new_indices.push_back(*new_iter);
+    new_positions.push_back(pos);
+    ++new_iter;
+  }
+
+  indices_ = std::move(new_indices);
+  positions_ = std::move(new_positions);
+  if (needs_recompute_) {
+    recompute();
+  }
+
+  return num_changed;
+}
+
+bool ObjectGeometry::apply(const spark_dsg::Mesh& mesh,
+                           ObjectNodeAttributes& attrs) const {
+  if (!num_valid_) {
+    return false;
+  }
+
+  attrs.position = sum_ / num_valid_;
+  if (attrs.bounding_box.type == BoundingBox::Type::AABB) {
+    attrs.bounding_box = BoundingBox(max_ - min_, (max_ + min_) / 2.0f);
+  } else {
+    const BoundingBox::MeshAdaptor adaptor(mesh, &indices_);
+    attrs.bounding_box = BoundingBox(adaptor, attrs.bounding_box.type);
+  }
+
+  return true;
+}
+
+void ObjectGeometry::add(const Eigen::Vector3f& pos) {
+  if (!isValid(pos)) {
+    return;
+  }
+
+  sum_ += pos.cast<double>();
+  ++num_valid_;
+  if (!needs_recompute_) {
+    min_ = min_.cwiseMin(pos);
+    max_ = max_.cwiseMax(pos);
+  }
+}
+
+void ObjectGeometry::remove(const Eigen::Vector3f& pos) {
+  if (!isValid(pos)) {
+    return;
+  }
+
+  sum_ -= pos.cast<double>();
+  --num_valid_;
+  // interior vertices can't shrink the extents
+  needs_recompute_ |= onBoundary(pos, min_, max_);
+}
+
+void ObjectGeometry::recompute() {
+  // also resets the running sum to avoid accumulating round-off from the updates
+  num_valid_ = 0;
+  sum_ = Eigen::Vector3d::Zero();
+  min_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  max_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  needs_recompute_ = false;
+  for (const auto& pos : positions_) {
+    add(pos);
+  }
+}
+
 MeshLayer::Ptr getActiveMesh(const MeshLayer& mesh_layer,
                              const BlockIndices& archived_blocks) {
   auto active_mesh = std::make_shared<MeshLayer>(mesh_layer.blockSize());
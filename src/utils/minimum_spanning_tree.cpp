@@ -36,7 +36,10 @@
 
 #include <glog/logging.h>
 
-#include "hydra/utils/disjoint_set.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <optional>
 
 namespace hydra {
 
@@ -48,6 +51,15 @@ MinimumSpanningTreeInfo getMinimumSpanningEdges(const SceneGraphLayer& layer) {
 // implementation mainly from: https://en.wikipedia.org/wiki/Kruskal%27s_algorithm
 MinimumSpanningTreeInfo getMinimumSpanningEdges(const SceneGraphLayer& layer,
                                                 const EdgeFilter& filter) {
+  MinimumSpanningTreeInfo info;
+  // dense node indices to avoid hashing in the union-find
+  std::unordered_map<NodeId, size_t> indices;
+  indices.reserve(layer.numNodes());
+  for (const auto& id_node_pair : layer.nodes()) {
+    indices.emplace(id_node_pair.first, indices.size());
+    info.counts[id_node_pair.first] = 0;
+  }
+
   std::vector<MinimalEdge> sorted_edges;
   sorted_edges.reserve(layer.edges().size());
   for (const auto& id_edge_pair : layer.edges()) {
@@ -62,28 +74,39 @@ MinimumSpanningTreeInfo getMinimumSpanningEdges(const SceneGraphLayer& layer,
         (getNodePosition(layer, edge.source) - getNodePosition(layer, edge.target))
             .norm());
   }
-  std::make_heap(sorted_edges.begin(), sorted_edges.end(), std::greater<>{});
 
-  MinimumSpanningTreeInfo info;
-  info.edges.reserve(sorted_edges.size());
-  for (const auto& id_node_pair : layer.nodes()) {
-    info.counts[id_node_pair.first] = 0;
-  }
+  std::stable_sort(sorted_edges.begin(),
+                   sorted_edges.end(),
+                   [](const auto& lhs, const auto& rhs) { return lhs.distance < rhs.distance; });
 
-  DisjointSet subtrees(layer);
-  while (!sorted_edges.empty()) {
-    std::pop_heap(sorted_edges.begin(), sorted_edges.end(), std::greater<>{});
-    auto min_edge = sorted_edges.back();
-    sorted_edges.pop_back();
+  std::vector<size_t> parents(indices.size());
+  std::iota(parents.begin(), parents.end(), 0);
+  std::vector<size_t> sizes(indices.size(), 1);
+  const auto find_set = [&parents](size_t node) {
+    while (parents[node] != node) {
+      parents[node] = parents[parents[node]];
+      node = parents[node];
+    }
+    return node;
+  };
 
-    NodeId lhs_set = subtrees.findSet(min_edge.source);
-    NodeId rhs_set = subtrees.findSet(min_edge.target);
-    if (lhs_set != rhs_set) {
-      subtrees.doUnion(lhs_set, rhs_set);
-      info.edges.push_back(min_edge);
-      info.counts[min_edge.source]++;
-      info.counts[min_edge.target]++;
+  info.edges.reserve(indices.size());
+  for (const auto& min_edge : sorted_edges) {
+    auto lhs_set = find_set(indices.at(min_edge.source));
+    auto rhs_set = find_set(indices.at(min_edge.target));
+    if (lhs_set == rhs_set) {
+      continue;
     }
+
+    if (sizes[lhs_set] < sizes[rhs_set]) {
+      std::swap(lhs_set, rhs_set);
+    }
+
+    parents[rhs_set] = lhs_set;
+    sizes[lhs_set] += sizes[rhs_set];
+    info.edges.push_back(min_edge);
+    info.counts[min_edge.source]++;
+    info.counts[min_edge.target]++;
   }
 
   for (const auto& id_count_pair : info.counts) {
@@ -95,4 +118,649 @@ MinimumSpanningTreeInfo getMinimumSpanningEdges(const SceneGraphLayer& layer,
   return info;
 }
 
+namespace {
+
+using EdgeKey = DynamicMinimumSpanningTree::EdgeKey;
+
+inline EdgeKey makeKey(NodeId source, NodeId target) {
+  return source < target ? EdgeKey(source, target) : EdgeKey(target, source);
+}
+
+// threshold on the number of changed edge distances before rebuilding the forest
+inline constexpr size_t kMaxIncrementalReweights = 32;
+
+struct EdgeKeyHash {
+  size_t operator()(const EdgeKey& key) const {
+    return std::hash<NodeId>()(key.first) * 31 + std::hash<NodeId>()(key.second);
+  }
+};
+
+/**
+ * @brief Link-cut tree maintaining path maximums.
+ *
+ * Implementation follows Sleator and Tarjan with splay trees over preferred paths.
+ * Graph edges are represented as nodes so that path maximums are over edge weights.
+ */
+class LinkCutForest {
+ public:
+  static constexpr size_t NIL = std::numeric_limits<size_t>::max();
+
+  size_t addNode(double weight) {
+    size_t index;
+    if (free_.empty()) {
+      index = nodes_.size();
+      nodes_.emplace_back();
+    } else {
+      index = free_.back();
+      free_.pop_back();
+    }
+
+    nodes_[index] = Node{{NIL, NIL}, NIL, false, weight, index};
+    return index;
+  }
+
+  //! Node must not be linked to any other node
+  void removeNode(size_t index) { free_.push_back(index); }
+
+  double weight(size_t index) const { return nodes_[index].weight; }
+
+  void setWeight(size_t index, double weight) {
+    // after access the node is the root of its splay tree, so only it needs a pull
+    access(index);
+    nodes_[index].weight = weight;
+    pull(index);
+  }
+
+  void link(size_t child, size_t parent) {
+    makeRoot(child);
+    nodes_[child].parent = parent;
+  }
+
+  void cut(size_t lhs, size_t rhs) {
+    makeRoot(lhs);
+    access(rhs);
+    // lhs is the only node on the path above rhs
+    nodes_[rhs].children[0] = NIL;
+    nodes_[lhs].parent = NIL;
+    pull(rhs);
+  }
+
+  bool connected(size_t lhs, size_t rhs) {
+    return lhs == rhs || findRoot(lhs) == findRoot(rhs);
+  }
+
+  //! Node with the largest weight on the path between lhs and rhs
+  size_t pathMax(size_t lhs, size_t rhs) {
+    makeRoot(lhs);
+    access(rhs);
+    return nodes_[rhs].max;
+  }
+
+ private:
+  struct Node {
+    size_t children[2];
+    size_t parent;
+    bool reversed;
+    double weight;
+    size_t max;
+  };
+
+  bool isRoot(size_t x) const {
+    const auto parent = nodes_[x].parent;
+    return parent == NIL ||
+           (nodes_[parent].children[0] != x && nodes_[parent].children[1] != x);
+  }
+
+  void push(size_t x) {
+    auto& node = nodes_[x];
+    if (!node.reversed) {
+      return;
+    }
+
+    std::swap(node.children[0], node.children[1]);
+    for (const auto child : node.children) {
+      if (child != NIL) {
+        nodes_[child].reversed = !nodes_[child].reversed;
+      }
+    }
+
+    node.reversed = false;
+  }
+
+  void pull(size_t x) {
+    auto& node = nodes_[x];
+    node.max = x;
+    for (const auto child : node.children) {
+      if (child != NIL && nodes_[nodes_[child].max].weight > nodes_[node.max].weight) {
+        node.max = nodes_[child].max;
+      }
+    }
+  }
+
+  void rotate(size_t x) {
+    const size_t parent = nodes_[x].parent;
+    const size_t grandparent = nodes_[parent].parent;
+    const int dir = nodes_[parent].children[1] == x ? 1 : 0;
+    if (!isRoot(parent)) {
+      auto& siblings = nodes_[grandparent].children;
+      siblings[siblings[1] == parent ? 1 : 0] = x;
+    }
+
+    nodes_[x].parent = grandparent;
+    const size_t inner = nodes_[x].children[1 - dir];
+    nodes_[parent].children[dir] = inner;
+    if (inner != NIL) {
+      nodes_[inner].parent = parent;
+    }
+
+    nodes_[x].children[1 - dir] = parent;
+    nodes_[parent].parent = x;
+    pull(parent);
+    pull(x);
+  }
+
+  void splay(size_t x) {
+    // push pending reversals from the top of the splay tree down to x
+    stack_.clear();
+    for (size_t y = x;; y = nodes_[y].parent) {
+      stack_.push_back(y);
+      if (isRoot(y)) {
+        break;
+      }
+    }
+
+    for (auto iter = stack_.rbegin(); iter != stack_.rend(); ++iter) {
+      push(*iter);
+    }
+
+    while (!isRoot(x)) {
+      const size_t parent = nodes_[x].parent;
+      if (!isRoot(parent)) {
+        const size_t grandparent = nodes_[parent].parent;
+        const bool zigzig = (nodes_[grandparent].children[0] == parent) ==
+                            (nodes_[parent].children[0] == x);
+        rotate(zigzig ? parent : x);
+      }
+
+      rotate(x);
+    }
+  }
+
+  void access(size_t x) {
+    size_t last = NIL;
+    for (size_t y = x; y != NIL; y = nodes_[y].parent) {
+      splay(y);
+      nodes_[y].children[1] = last;
+      pull(y);
+      last = y;
+    }
+
+    splay(x);
+  }
+
+  void makeRoot(size_t x) {
+    access(x);
+    nodes_[x].reversed = !nodes_[x].reversed;
+    push(x);
+  }
+
+  size_t findRoot(size_t x) {
+    access(x);
+    while (true) {
+      push(x);
+      if (nodes_[x].children[0] == NIL) {
+        break;
+      }
+
+      x = nodes_[x].children[0];
+    }
+
+    splay(x);
+    return x;
+  }
+
+  std::vector<Node> nodes_;
+  std::vector<size_t> free_;
+  std::vector<size_t> stack_;
+};
+
+}  // namespace
+
+struct DynamicMstImpl {
+  struct EdgeState {
+    double distance;
+    //! Link-cut node representing the edge if the edge is in the tree
+    std::optional<size_t> tree_node;
+  };
+
+  struct NodeState {
+    size_t tree_node;
+    std::unordered_set<NodeId> neighbors;
+    std::unordered_set<NodeId> tree_neighbors;
+  };
+
+  LinkCutForest forest;
+  std::unordered_map<NodeId, NodeState> nodes;
+  std::unordered_map<EdgeKey, EdgeState, EdgeKeyHash> edges;
+  //! Maps link-cut nodes for tree edges back to the edge
+  std::unordered_map<size_t, EdgeKey> tree_edges;
+  std::unordered_set<EdgeKey, EdgeKeyHash> added;
+  std::unordered_set<EdgeKey, EdgeKeyHash> removed;
+  std::unordered_set<NodeId> changed_nodes;
+
+  void link(const EdgeKey& key, EdgeState& edge) {
+    auto& source = nodes.at(key.first);
+    auto& target = nodes.at(key.second);
+    const auto edge_node = forest.addNode(edge.distance);
+    forest.link(source.tree_node, edge_node);
+    forest.link(edge_node, target.tree_node);
+    edge.tree_node = edge_node;
+    tree_edges.emplace(edge_node, key);
+    source.tree_neighbors.insert(key.second);
+    target.tree_neighbors.insert(key.first);
+    changed_nodes.insert(key.first);
+    changed_nodes.insert(key.second);
+    if (!removed.erase(key)) {
+      added.insert(key);
+    }
+  }
+
+  void cut(const EdgeKey& key, EdgeState& edge) {
+    auto& source = nodes.at(key.first);
+    auto& target = nodes.at(key.second);
+    const auto edge_node = *edge.tree_node;
+    forest.cut(source.tree_node, edge_node);
+    forest.cut(edge_node, target.tree_node);
+    forest.removeNode(edge_node);
+    tree_edges.erase(edge_node);
+    edge.tree_node.reset();
+    source.tree_neighbors.erase(key.second);
+    target.tree_neighbors.erase(key.first);
+    changed_nodes.insert(key.first);
+    changed_nodes.insert(key.second);
+    if (!added.erase(key)) {
+      removed.insert(key);
+    }
+  }
+
+  //! Add a non-tree edge to the tree if it is cheaper than the path it short-circuits
+  void insert(const EdgeKey& key, EdgeState& edge) {
+    const auto source = nodes.at(key.first).tree_node;
+    const auto target = nodes.at(key.second).tree_node;
+    if (!forest.connected(source, target)) {
+      link(key, edge);
+      return;
+    }
+
+    // replace the heaviest edge on the tree path if the new edge is cheaper
+    const auto heaviest = forest.pathMax(source, target);
+    if (forest.weight(heaviest) <= edge.distance) {
+      return;
+    }
+
+    const auto prev_key = tree_edges.at(heaviest);
+    cut(prev_key, edges.at(prev_key));
+    link(key, edge);
+  }
+
+  void reweight(const EdgeKey& key, EdgeState& edge, double distance) {
+    const auto prev_distance = edge.distance;
+    edge.distance = distance;
+    if (!edge.tree_node) {
+      if (distance < prev_distance) {
+        insert(key, edge);
+      }
+
+      return;
+    }
+
+    forest.setWeight(*edge.tree_node, distance);
+    if (distance > prev_distance) {
+      // a cheaper edge may cross the cut now (which might be this edge again)
+      cut(key, edge);
+      reconnect(key.first, key.second);
+    }
+  }
+
+  //! Recompute the forest from scratch by adding all edges in order of distance
+  void rebuild() {
+    std::vector<EdgeKey> keys;
+    keys.reserve(edges.size());
+    for (auto& [key, edge] : edges) {
+      if (edge.tree_node) {
+        cut(key, edge);
+      }
+
+      keys.push_back(key);
+    }
+
+    std::sort(keys.begin(), keys.end(), [this](const auto& lhs, const auto& rhs) {
+      return edges.at(lhs).distance < edges.at(rhs).distance;
+    });
+
+    for (const auto& key : keys) {
+      auto& edge = edges.at(key);
+      if (!forest.connected(nodes.at(key.first).tree_node,
+                            nodes.at(key.second).tree_node)) {
+        link(key, edge);
+      }
+    }
+  }
+
+  //! Find the cheapest non-tree edge reconnecting the components of lhs and rhs
+  void reconnect(NodeId lhs, NodeId rhs) {
+    // alternate BFS on both sides until the smaller component is exhausted
+    std::unordered_set<NodeId> visited[2] = {{lhs}, {rhs}};
+    std::vector<NodeId> frontier[2] = {{lhs}, {rhs}};
+    size_t heads[2] = {0, 0};
+    int done = -1;
+    while (done < 0) {
+      for (int side = 0; side < 2; ++side) {
+        if (heads[side] == frontier[side].size()) {
+          done = side;
+          break;
+        }
+
+        const auto curr = frontier[side][heads[side]++];
+        for (const auto neighbor : nodes.at(curr).tree_neighbors) {
+          if (visited[side].insert(neighbor).second) {
+            frontier[side].push_back(neighbor);
+          }
+        }
+      }
+    }
+
+    const auto& component = visited[done];
+    std::optional<EdgeKey> best;
+    double best_distance = std::numeric_limits<double>::infinity();
+    for (const auto node : component) {
+      for (const auto neighbor : nodes.at(node).neighbors) {
+        if (component.count(neighbor)) {
+          continue;
+        }
+
+        const auto key = makeKey(node, neighbor);
+        const auto distance = edges.at(key).distance;
+        if (distance < best_distance) {
+          best_distance = distance;
+          best = key;
+        }
+      }
+    }
+
+    if (best) {
+      link(*best, edges.at(*best));
+    }
+  }
+};
+
+DynamicMinimumSpanningTree::DynamicMinimumSpanningTree()
+    : impl_(std::make_unique<DynamicMstImpl>()) {}
+
+DynamicMinimumSpanningTree::~DynamicMinimumSpanningTree() = default;
+
+bool DynamicMinimumSpanningTree::addNode(NodeId node) {
+  if (impl_->nodes.count(node)) {
+    return false;
+  }
+
+  const auto tree_node = impl_->forest.addNode(-std::numeric_limits<double>::infinity());
+  impl_->nodes.emplace(node, DynamicMstImpl::NodeState{tree_node, {}, {}});
+  impl_->changed_nodes.insert(node);
+  return true;
+}
+
+bool DynamicMinimumSpanningTree::removeNode(NodeId node) {
+  auto iter = impl_->nodes.find(node);
+  if (iter == impl_->nodes.end()) {
+    return false;
+  }
+
+  // remove non-tree edges first to avoid searching for replacements through them
+  const auto neighbors = iter->second.neighbors;
+  for (const auto neighbor : neighbors) {
+    if (!isTreeEdge(node, neighbor)) {
+      removeEdge(node, neighbor);
+    }
+  }
+
+  for (const auto neighbor : neighbors) {
+    removeEdge(node, neighbor);
+  }
+
+  impl_->forest.removeNode(iter->second.tree_node);
+  impl_->nodes.erase(iter);
+  impl_->changed_nodes.erase(node);
+  return true;
+}
+
+bool DynamicMinimumSpanningTree::addEdge(NodeId source, NodeId target, double distance) {
+  if (source == target) {
+    return false;
+  }
+
+  const auto key = makeKey(source, target);
+  if (impl_->edges.count(key)) {
+    return false;
+  }
+
+  addNode(source);
+  addNode(target);
+  auto& edge = impl_->edges.emplace(key, DynamicMstImpl::EdgeState{distance, {}})
+                   .first->second;
+  impl_->nodes.at(source).neighbors.insert(target);
+  impl_->nodes.at(target).neighbors.insert(source);
+  impl_->insert(key, edge);
+  return true;
+}
+
+bool DynamicMinimumSpanningTree::setEdgeDistance(NodeId source,
+                                                 NodeId target,
+                                                 double distance) {
+  const auto key = makeKey(source, target);
+  auto iter = impl_->edges.find(key);
+  if (iter == impl_->edges.end()) {
+    return false;
+  }
+
+  if (iter->second.distance != distance) {
+    impl_->reweight(key, iter->second, distance);
+  }
+
+  return true;
+}
+
+bool DynamicMinimumSpanningTree::removeEdge(NodeId source, NodeId target) {
+  const auto key = makeKey(source, target);
+  auto iter = impl_->edges.find(key);
+  if (iter == impl_->edges.end()) {
+    return false;
+  }
+
+  const bool in_tree = iter->second.tree_node.has_value();
+  if (in_tree) {
+    impl_->cut(key, iter->second);
+  }
+
+  impl_->nodes.at(source).neighbors.erase(target);
+  impl_->nodes.at(target).neighbors.erase(source);
+  impl_->edges.erase(iter);
+  if (in_tree) {
+    impl_->reconnect(source, target);
+  }
+
+  return true;
+}
+
+void DynamicMinimumSpanningTree::update(const SceneGraphLayer& layer,
+                                        const EdgeFilter& filter) {
+  std::vector<NodeId> nodes;
+  nodes.reserve(impl_->nodes.size() + layer.numNodes());
+  for (const auto& [node_id, state] : impl_->nodes) {
+    if (!layer.hasNode(node_id)) {
+      nodes.push_back(node_id);
+    }
+  }
+
+  for (const auto& id_node_pair : layer.nodes()) {
+    nodes.push_back(id_node_pair.first);
+  }
+
+  update(layer, nodes, filter);
+}
+
+void DynamicMinimumSpanningTree::update(const SceneGraphLayer& layer,
+                                        const std::vector<NodeId>& nodes,
+                                        const EdgeFilter& filter) {
+  std::vector<NodeId> present;
+  present.reserve(nodes.size());
+  for (const auto node_id : nodes) {
+    if (layer.hasNode(node_id)) {
+      present.push_back(node_id);
+    } else {
+      removeNode(node_id);
+    }
+  }
+
+  std::vector<EdgeKey> to_remove;
+  std::vector<std::pair<EdgeKey, double>> to_add;
+  std::vector<std::pair<EdgeKey, double>> to_reweight;
+  for (const auto node_id : present) {
+    addNode(node_id);
+    const auto& node = layer.getNode(node_id);
+    for (const auto neighbor : impl_->nodes.at(node_id).neighbors) {
+      const auto edge = layer.findEdge(node_id, neighbor);
+      if (!edge || (filter && !filter(layer, *edge))) {
+        to_remove.push_back(makeKey(node_id, neighbor));
+      }
+    }
+
+    for (const auto sibling : node.siblings()) {
+      const auto key = makeKey(node_id, sibling);
+      const auto edge = layer.findEdge(node_id, sibling);
+      if (!edge || (filter && !filter(layer, *edge))) {
+        continue;
+      }
+
+      const auto distance =
+          (getNodePosition(layer, key.first) - getNodePosition(layer, key.second))
+              .norm();
+      const auto iter = impl_->edges.find(key);
+      if (iter == impl_->edges.end()) {
+        to_add.emplace_back(key, distance);
+      } else if (iter->second.distance != distance) {
+        to_reweight.emplace_back(key, distance);
+      }
+    }
+  }
+
+  for (const auto& key : to_remove) {
+    removeEdge(key.first, key.second);
+  }
+
+  // re-weighting tree edges may search a whole component for a replacement, so many
+  // changed distances (e.g., after a loop closure) are cheaper to handle by rebuilding
+  const bool rebuild = to_reweight.size() > kMaxIncrementalReweights &&
+                       2 * to_reweight.size() > impl_->tree_edges.size();
+  for (const auto& [key, distance] : to_reweight) {
+    if (rebuild) {
+      impl_->edges.at(key).distance = distance;
+    } else {
+      setEdgeDistance(key.first, key.second, distance);
+    }
+  }
+
+  if (rebuild) {
+    impl_->rebuild();
+  }
+
+  // edges between two updated nodes are found twice, but only added once
+  for (const auto& [key, distance] : to_add) {
+    addEdge(key.first, key.second, distance);
+  }
+}
+
+bool DynamicMinimumSpanningTree::hasNode(NodeId node) const {
+  return impl_->nodes.count(node);
+}
+
+bool DynamicMinimumSpanningTree::hasEdge(NodeId source, NodeId target) const {
+  return impl_->edges.count(makeKey(source, target));
+}
+
+std::optional<double> DynamicMinimumSpanningTree::edgeDistance(NodeId source,
+                                                               NodeId target) const {
+  auto iter = impl_->edges.find(makeKey(source, target));
+  if (iter == impl_->edges.end()) {
+    return std::nullopt;
+  }
+
+  return iter->second.distance;
+}
+
+bool DynamicMinimumSpanningTree::isTreeEdge(NodeId source, NodeId target) const {
+  auto iter = impl_->edges.find(makeKey(source, target));
+  return iter != impl_->edges.end() && iter->second.tree_node;
+}
+
+size_t DynamicMinimumSpanningTree::numNodes() const { return impl_->nodes.size(); }
+
+size_t DynamicMinimumSpanningTree::numEdges() const { return impl_->edges.size(); }
+
+size_t DynamicMinimumSpanningTree::numTreeEdges() const {
+  return impl_->tree_edges.size();
+}
+
+size_t DynamicMinimumSpanningTree::degree(NodeId node) const {
+  auto iter = impl_->nodes.find(node);
+  return iter == impl_->nodes.end() ? 0 : iter->second.tree_neighbors.size();
+}
+
+std::vector<NodeId> DynamicMinimumSpanningTree::treeNeighbors(NodeId node) const {
+  auto iter = impl_->nodes.find(node);
+  if (iter == impl_->nodes.end()) {
+    return {};
+  }
+
+  const auto& neighbors = iter->second.tree_neighbors;
+  return std::vector<NodeId>(neighbors.begin(), neighbors.end());
+}
+
+double DynamicMinimumSpanningTree::totalDistance() const {
+  double total = 0.0;
+  for (const auto& [tree_node, key] : impl_->tree_edges) {
+    total += impl_->edges.at(key).distance;
+  }
+
+  return total;
+}
+
+MinimumSpanningTreeInfo DynamicMinimumSpanningTree::info() const {
+  MinimumSpanningTreeInfo info;
+  info.edges.reserve(impl_->tree_edges.size());
+  for (const auto& [tree_node, key] : impl_->tree_edges) {
+    info.edges.emplace_back(key.first, key.second, impl_->edges.at(key).distance);
+  }
+
+  for (const auto& [node_id, state] : impl_->nodes) {
+    info.counts[node_id] = state.tree_neighbors.size();
+    if (state.tree_neighbors.size() == 1) {
+      info.leaves.insert(node_id);
+    }
+  }
+
+  return info;
+}
+
+DynamicMinimumSpanningTree::Changes DynamicMinimumSpanningTree::takeChanges() {
+  Changes changes;
+  changes.added.assign(impl_->added.begin(), impl_->added.end());
+  changes.removed.assign(impl_->removed.begin(), impl_->removed.end());
+  changes.nodes = std::move(impl_->changed_nodes);
+  impl_->added.clear();
+  impl_->removed.clear();
+  impl_->changed_nodes.clear();
+  return changes;
+}
+
 }  // namespace hydra
@@ -177,6 +177,128 @@ size_t makeSemanticNodeFinders(const SceneGraphLayer& layer,
   return total;
 }
 
+struct DynamicNodeFinder::Detail {
+  struct Dataset {
+    inline size_t kdtree_get_point_count() const { return points.size(); }
+
+    inline double kdtree_get_pt(const size_t idx, const size_t dim) const {
+      return points[idx](dim);
+    }
+
+    template <class T>
+    bool kdtree_get_bbox(T&) const {
+      return false;
+    }
+
+    std::vector<Eigen::Vector3d> points;
+  };
+
+  using Dist = L2_Simple_Adaptor<double, Dataset>;
+  using KDTree = KDTreeSingleIndexDynamicAdaptor<Dist, Dataset, 3, size_t>;
+
+  Detail() { rebuild(); }
+
+  void add(NodeId node, const Eigen::Vector3d& position) {
+    const auto idx = dataset.points.size();
+    dataset.points.push_back(position);
+    ids.push_back(node);
+    indices[node] = idx;
+    kdtree->addPoints(idx, idx);
+  }
+
+  void remove(size_t idx) {
+    kdtree->removePoint(idx);
+    ++num_removed;
+  }
+
+  // removed points stay in the dataset, so compact once they make up half of it
+  void compact() {
+    if (2 * num_removed <= dataset.points.size()) {
+      return;
+    }
+
+    Dataset live;
+    std::vector<NodeId> live_ids;
+    live.points.reserve(indices.size());
+    live_ids.reserve(indices.size());
+    for (auto& [node, idx] : indices) {
+      live.points.push_back(dataset.points[idx]);
+      live_ids.push_back(node);
+      idx = live_ids.size() - 1;
+    }
+
+    dataset = std::move(live);
+    ids = std::move(live_ids);
+    rebuild();
+  }
+
+  void rebuild() {
+    num_removed = 0;
+    // the tree adds any points already in the dataset on construction
+    kdtree.reset(new KDTree(3, dataset));
+  }
+
+  Dataset dataset;
+  std::vector<NodeId> ids;
+  std::unordered_map<NodeId, size_t> indices;
+  size_t num_removed = 0;
+  std::unique_ptr<KDTree> kdtree;
+};
+
+DynamicNodeFinder::DynamicNodeFinder() : internals_(new Detail()) {}
+
+DynamicNodeFinder::~DynamicNodeFinder() = default;
+
+void DynamicNodeFinder::insert(NodeId node, const Eigen::Vector3d& position) {
+  auto iter = internals_->indices.find(node);
+  if (iter != internals_->indices.end()) {
+    if (internals_->dataset.points[iter->second] == position) {
+      return;
+    }
+
+    internals_->remove(iter->second);
+  }
+
+  internals_->add(node, position);
+  internals_->compact();
+}
+
+bool DynamicNodeFinder::erase(NodeId node) {
+  auto iter = internals_->indices.find(node);
+  if (iter == internals_->indices.end()) {
+    return false;
+  }
+
+  internals_->remove(iter->second);
+  internals_->indices.erase(iter);
+  internals_->compact();
+  return true;
+}
+
+bool DynamicNodeFinder::contains(NodeId node) const {
+  return internals_->indices.count(node);
+}
+
+size_t DynamicNodeFinder::size() const { return internals_->indices.size(); }
+
+void DynamicNodeFinder::find(const Eigen::Vector3d& position,
+                             size_t num_to_find,
+                             const Callback& callback) const {
+  if (!num_to_find || internals_->indices.empty()) {
+    return;
+  }
+
+  std::vector<size_t> nn_indices(num_to_find);
+  std::vector<double> distances(num_to_find);
+  nanoflann::KNNResultSet<double, size_t, size_t> result(num_to_find);
+  result.init(nn_indices.data(), distances.data());
+  internals_->kdtree->findNeighbors(result, position.data());
+
+  for (size_t i = 0; i < result.size(); ++i) {
+    callback(internals_->ids[nn_indices[i]], i, distances[i]);
+  }
+}
+
 struct PointNeighborSearch::Detail {
   // Nanoflann interface.
   explicit Detail(const std::vector<Eigen::Vector3f>& points)
@@ -0,0 +1,200 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra/utils/place_2d_grid_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hydra {
+
+namespace {
+
+// padding to absorb rounding in the ellipse overlap computation
+constexpr double kBoundsPadding = 1.0e-6;
+// limit on cell coordinates so that the int casts (and iterating to upper + 1) can't
+// overflow for places far from the origin
+constexpr double kMaxCellCoordinate = 1 << 30;
+
+inline int cellCoordinate(double value, double cell_size) {
+  // clamping is monotonic, so clamped bounds still cover every overlapping cell
+  const double coord = std::floor(value / cell_size);
+  if (!(coord > -kMaxCellCoordinate)) {
+    return -static_cast<int>(kMaxCellCoordinate);
+  }
+
+  return static_cast<int>(std::min(coord, kMaxCellCoordinate));
+}
+
+inline spatial_hash::Index cellIndex(const Eigen::Vector2d& pos, double cell_size) {
+  return spatial_hash::Index(
+      cellCoordinate(pos.x(), cell_size), cellCoordinate(pos.y(), cell_size), 0);
+}
+
+inline double numCells(const spatial_hash::Index& lower,
+                       const spatial_hash::Index& upper) {
+  const Eigen::Vector2d extent = upper.head<2>().cast<double>() -
+                                 lower.head<2>().cast<double>() +
+                                 Eigen::Vector2d::Ones();
+  return extent.x() * extent.y();
+}
+
+}  // namespace
+
+bool PlaceBounds2d::overlaps(const PlaceBounds2d& other) const {
+  if (!bounded || !other.bounded) {
+    return true;
+  }
+
+  return (min.array() <= other.max.array()).all() &&
+         (other.min.array() <= max.array()).all();
+}
+
+PlaceBounds2d PlaceBounds2d::fromEllipse(const Eigen::Matrix2d& A,
+                                         const Eigen::Vector2d& c) {
+  PlaceBounds2d bounds;
+  if (!A.allFinite() || !c.allFinite()) {
+    return bounds;
+  }
+
+  // the quadratic form only depends on the symmetric part of A
+  const Eigen::Matrix2d S = 0.5 * (A + A.transpose());
+  Eigen::LLT<Eigen::Matrix2d> llt(S);
+  if (llt.info() != Eigen::Success) {
+    return bounds;
+  }
+
+  // extent of ellipse along each axis is sqrt(e_i^T S^-1 e_i)
+  const Eigen::Vector2d extent =
+      llt.solve(Eigen::Matrix2d::Identity()).diagonal().cwiseSqrt();
+  if (!extent.allFinite()) {
+    return bounds;
+  }
+
+  const Eigen::Vector2d padding = Eigen::Vector2d::Constant(kBoundsPadding);
+  bounds.min = c - extent - padding;
+  bounds.max = c + extent + padding;
+  bounds.bounded = true;
+  return bounds;
+}
+
+Place2dGridIndex::Place2dGridIndex(const std::vector<PlaceBounds2d>& bounds)
+    : bounds_(bounds), cell_size_(1.0) {
+  double total_extent = 0.0;
+  size_t num_bounded = 0;
+  for (const auto& b : bounds_) {
+    if (b.bounded) {
+      total_extent += (b.max - b.min).maxCoeff();
+      ++num_bounded;
+    }
+  }
+
+  if (num_bounded && total_extent > 0.0) {
+    cell_size_ = std::max(total_extent / num_bounded, 1.0e-3);
+  }
+
+  for (size_t i = 0; i < bounds_.size(); ++i) {
+    const auto& b = bounds_[i];
+    if (!b.bounded) {
+      large_.push_back(i);
+      continue;
+    }
+
+    const auto lower = cellIndex(b.min, cell_size_);
+    const auto upper = cellIndex(b.max, cell_size_);
+    if (numCells(lower, upper) > kMaxCellsPerPlace) {
+      large_.push_back(i);
+      continue;
+    }
+
+    for (int x = lower.x(); x <= upper.x(); ++x) {
+      for (int y = lower.y(); y <= upper.y(); ++y) {
+        cells_[spatial_hash::Index(x, y, 0)].push_back(i);
+      }
+    }
+  }
+}
+
+std::vector<size_t> Place2dGridIndex::getCandidates(size_t index) const {
+  const auto& query = bounds_.at(index);
+  std::vector<size_t> candidates;
+  if (!query.bounded) {
+    candidates.resize(bounds_.size());
+    for (size_t i = 0; i < bounds_.size(); ++i) {
+      candidates[i] = i;
+    }
+
+    return candidates;
+  }
+
+  const auto lower = cellIndex(query.min, cell_size_);
+  const auto upper = cellIndex(query.max, cell_size_);
+  if (numCells(lower, upper) > kMaxCellsPerPlace) {
+    // visiting every cell of a large query is slower than checking every place
+    for (size_t i = 0; i < bounds_.size(); ++i) {
+      if (query.overlaps(bounds_[i])) {
+        candidates.push_back(i);
+      }
+    }
+
+    return candidates;
+  }
+
+  for (const auto i : large_) {
+    if (query.overlaps(bounds_[i])) {
+      candidates.push_back(i);
+    }
+  }
+
+  for (int x = lower.x(); x <= upper.x(); ++x) {
+    for (int y = lower.y(); y <= upper.y(); ++y) {
+      const auto iter = cells_.find(spatial_hash::Index(x, y, 0));
+      if (iter == cells_.end()) {
+        continue;
+      }
+
+      for (const auto i : iter->second) {
+        if (query.overlaps(bounds_[i])) {
+          candidates.push_back(i);
+        }
+      }
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  return candidates;
+}
+
+}  // namespace hydra
@@ -38,53 +38,26 @@
 #include <glog/stl_logging.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <fstream>
 #include <iostream>
-#include <numeric>
+#include <limits>
 #include <sstream>
 
 namespace hydra::timing {
 
-bool operator<(const ElapsedTimeRecorder::Entry& lhs,
-               const ElapsedTimeRecorder::Entry& rhs) {
-  return lhs.elapsed < rhs.elapsed;
-}
-
 namespace {
 
 using Entries = std::vector<ElapsedTimeRecorder::Entry>;
+using Clock = std::chrono::high_resolution_clock;
 
-ElapsedStatistics computeStats(const Entries& entries) {
-  if (entries.empty()) {
-    return {};
-  }
-
-  const auto last_elapsed = entries.back().elapsed_seconds();
-  if (entries.size() == 1) {
-    return {last_elapsed, last_elapsed, last_elapsed, last_elapsed, 0.0, 1};
-  }
-
-  const size_t N = entries.size();
-  const double mean = std::accumulate(
-      entries.begin(), entries.end(), 0.0, [&](double total, const auto& entry) {
-        return total + (entry.elapsed_seconds() / N);
-      });
-
-  const double variance = std::accumulate(
-      entries.begin(), entries.end(), 0.0, [&](double total, const auto& entry) {
-        const double mean_diff = entry.elapsed_seconds() - mean;
-        return total + (mean_diff * mean_diff / N);
-      });
+inline double toSeconds(std::chrono::nanoseconds elapsed) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+}
 
-  const auto min_entry = std::min_element(entries.begin(), entries.end());
-  const auto max_entry = std::max_element(entries.begin(), entries.end());
-  return {last_elapsed,
-          mean,
-          min_entry == entries.end() ? 0.0 : min_entry->elapsed_seconds(),
-          max_entry == entries.end() ? 0.0 : max_entry->elapsed_seconds(),
-          std::sqrt(variance),
-          N};
+inline int64_t orderKey(const Clock::time_point& now) {
+  return now.time_since_epoch().count();
 }
 
 void writeEntries(const std::filesystem::path& output_csv, const Entries& entries) {
@@ -117,8 +90,89 @@ std::filesystem::path getTimerPath(const std::filesystem::path& output,
       .lexically_normal();
 }
 
+std::atomic<uint64_t> next_generation{1};
+
 }  // namespace
 
+struct ElapsedTimeRecorder::TimerState {
+  ElapsedHistogram histogram;
+  size_t count = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = 0.0;
+  double last = 0.0;
+  int64_t last_order = std::numeric_limits<int64_t>::min();
+  //! Raw measurements ordered by the time they were recorded
+  std::vector<std::pair<int64_t, Entry>> measurements;
+
+  void add(uint64_t timestamp,
+           std::chrono::nanoseconds elapsed,
+           int64_t order,
+           bool keep_measurement) {
+    const double elapsed_s = toSeconds(elapsed);
+    histogram.add(elapsed);
+    ++count;
+    // welford update to avoid keeping every measurement around
+    const double delta = elapsed_s - mean;
+    mean += delta / count;
+    m2 += delta * (elapsed_s - mean);
+    min = std::min(min, elapsed_s);
+    max = std::max(max, elapsed_s);
+    if (order >= last_order) {
+      last = elapsed_s;
+      last_order = order;
+    }
+
+    if (keep_measurement) {
+      measurements.emplace_back(order, Entry{timestamp, elapsed});
+    }
+  }
+
+  void merge(const TimerState& other, bool with_measurements) {
+    if (!other.count) {
+      return;
+    }
+
+    histogram.merge(other.histogram);
+    const size_t total = count + other.count;
+    const double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * count * other.count / total;
+    count = total;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    if (other.last_order >= last_order) {
+      last = other.last;
+      last_order = other.last_order;
+    }
+
+    if (with_measurements) {
+      measurements.insert(
+          measurements.end(), other.measurements.begin(), other.measurements.end());
+    }
+  }
+
+  ElapsedStatistics stats() const {
+    if (!count) {
+      return {};
+    }
+
+    return {last, mean, min, max, std::sqrt(m2 / count), count};
+  }
+};
+
+struct ElapsedTimeRecorder::ThreadState {
+  using TimePoint = std::pair<uint64_t, Clock::time_point>;
+
+  //! Guards timers: only contended while another thread collects measurements
+  std::mutex mutex;
+  std::vector<TimerState> timers;
+  // only accessed by the owning thread
+  std::vector<std::optional<TimePoint>> starts;
+  std::unordered_map<std::string, TimerId> id_cache;
+};
+
 decltype(ElapsedTimeRecorder::instance_) ElapsedTimeRecorder::instance_;
 
 std::ostream& operator<<(std::ostream& out, const ElapsedStatistics& stats) {
@@ -138,12 +192,89 @@ std::ostream& operator<<(std::ostream& out, const ElapsedStatistics& stats) {
   return out;
 }
 
+size_t ElapsedHistogram::bucketIndex(uint64_t elapsed_ns) {
+  if (elapsed_ns < kSubBuckets) {
+    return elapsed_ns;
+  }
+
+  size_t exponent = 63 - __builtin_clzll(elapsed_ns);
+  if (exponent > kMaxExponent) {
+    return kNumBuckets - 1;
+  }
+
+  const size_t shift = exponent - kSubBucketBits;
+  const size_t sub_bucket = (elapsed_ns >> shift) - kSubBuckets;
+  return kSubBuckets + shift * kSubBuckets + sub_bucket;
+}
+
+uint64_t ElapsedHistogram::bucketLowerBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+
+  const size_t shift = (index - kSubBuckets) / kSubBuckets;
+  const size_t sub_bucket = (index - kSubBuckets) % kSubBuckets;
+  return static_cast<uint64_t>(kSubBuckets + sub_bucket) << shift;
+}
+
+void ElapsedHistogram::add(std::chrono::nanoseconds elapsed) {
+  if (counts_.empty()) {
+    counts_.resize(kNumBuckets, 0);
+  }
+
+  ++counts_[bucketIndex(std::max<int64_t>(elapsed.count(), 0))];
+  ++count_;
+}
+
+void ElapsedHistogram::merge(const ElapsedHistogram& other) {
+  if (!other.count_) {
+    return;
+  }
+
+  if (counts_.empty()) {
+    counts_.resize(kNumBuckets, 0);
+  }
+
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+
+  count_ += other.count_;
+}
+
+double ElapsedHistogram::quantile(double q) const {
+  if (!count_) {
+    return 0.0;
+  }
+
+  const auto rank = std::clamp<size_t>(std::ceil(q * count_), 1, count_);
+  size_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts_[i];
+    if (seen < rank) {
+      continue;
+    }
+
+    // report the midpoint of the bucket
+    const double lower = bucketLowerBound(i);
+    const double upper = i + 1 < kNumBuckets ? bucketLowerBound(i + 1) : 2.0 * lower;
+    const double value_ns = i < kSubBuckets ? lower : 0.5 * (lower + upper);
+    return value_ns * 1.0e-9;
+  }
+
+  return bucketLowerBound(kNumBuckets - 1) * 1.0e-9;
+}
+
 double ElapsedTimeRecorder::Entry::elapsed_seconds() const {
-  return std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+  return toSeconds(elapsed);
 }
 
 ElapsedTimeRecorder::ElapsedTimeRecorder()
-    : timing_disabled(false), disable_output(true) {}
+    : timing_disabled(false),
+      disable_output(true),
+      keep_raw_measurements(false),
+      generation_(next_generation++),
+      retired_(std::make_shared<ThreadState>()) {}
 
 ElapsedTimeRecorder& ElapsedTimeRecorder::instance() {
   if (!instance_) {
@@ -155,88 +286,256 @@ ElapsedTimeRecorder& ElapsedTimeRecorder::instance() {
 
 void ElapsedTimeRecorder::reset() { instance_.reset(new ElapsedTimeRecorder()); }
 
-void ElapsedTimeRecorder::start(const std::string& name, const uint64_t timestamp) {
+ElapsedTimeRecorder::ThreadState& ElapsedTimeRecorder::localState() {
+  // the recorder is a singleton, so a single thread-local slot suffices
+  thread_local uint64_t generation = 0;
+  thread_local std::shared_ptr<ThreadState> state;
+  if (!state || generation != generation_) {
+    state = std::make_shared<ThreadState>();
+    generation = generation_;
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    threads_.push_back(state);
+  }
+
+  return *state;
+}
+
+ElapsedTimeRecorder::TimerId ElapsedTimeRecorder::getTimerId(const std::string& name) {
+  auto& state = localState();
+  auto cached = state.id_cache.find(name);
+  if (cached != state.id_cache.end()) {
+    return cached->second;
+  }
+
+  TimerId id;
   {  // start critical section
-    std::unique_lock<std::mutex> lock(mutex_);
-    auto iter = starts_.find(name);
-    if (iter == starts_.end()) {
-      starts_.emplace(name,
-                      TimePoint{timestamp, std::chrono::high_resolution_clock::now()});
-      return;  // break to avoid error statement
+    std::unique_lock<std::shared_mutex> lock(names_mutex_);
+    auto iter = ids_.find(name);
+    if (iter == ids_.end()) {
+      iter = ids_.emplace(name, names_.size()).first;
+      names_.push_back(name);
     }
+
+    id = iter->second;
   }  // end critical section
 
-  LOG(ERROR) << "Timer '" << name << "' was already started. Discarding time point!";
+  state.id_cache.emplace(name, id);
+  return id;
+}
+
+std::optional<ElapsedTimeRecorder::TimerId> ElapsedTimeRecorder::findTimerId(
+    const std::string& name) const {
+  std::shared_lock<std::shared_mutex> lock(names_mutex_);
+  auto iter = ids_.find(name);
+  if (iter == ids_.end()) {
+    return std::nullopt;
+  }
+
+  return iter->second;
+}
+
+std::string ElapsedTimeRecorder::getTimerName(TimerId timer) const {
+  std::shared_lock<std::shared_mutex> lock(names_mutex_);
+  return timer < names_.size() ? names_[timer] : "<invalid>";
+}
+
+void ElapsedTimeRecorder::start(const std::string& name, const uint64_t timestamp) {
+  start(getTimerId(name), timestamp);
+}
+
+void ElapsedTimeRecorder::start(TimerId timer, const uint64_t timestamp) {
+  auto& state = localState();
+  if (state.starts.size() <= timer) {
+    state.starts.resize(timer + 1);
+  }
+
+  auto& start_point = state.starts[timer];
+  if (!start_point) {
+    start_point = ThreadState::TimePoint{timestamp, Clock::now()};
+    return;
+  }
+
+  LOG(ERROR) << "Timer '" << getTimerName(timer)
+             << "' was already started. Discarding time point!";
 }
 
-void ElapsedTimeRecorder::stop(const std::string& name) {
+void ElapsedTimeRecorder::stop(const std::string& name) { stop(getTimerId(name)); }
+
+void ElapsedTimeRecorder::stop(TimerId timer) {
   // we grab the time point first (to not mess up timing with later processing)
-  const auto stop_point = std::chrono::high_resolution_clock::now();
-  {  // start critical section
-    std::unique_lock<std::mutex> lock(mutex_);
-    auto iter = starts_.find(name);
-    if (iter != starts_.end()) {
-      add(name, iter->second.timestamp, stop_point - iter->second.now);
-      starts_.erase(iter);
-      return;  // break to avoid error statement
-    }
-  }  // end critical section
+  const auto stop_point = Clock::now();
+  auto& state = localState();
+  if (state.starts.size() <= timer || !state.starts[timer]) {
+    LOG(ERROR) << "Timer '" << getTimerName(timer)
+               << "' was not started. Discarding time point!";
+    return;
+  }
 
-  LOG(ERROR) << "Timer '" << name << "' was not started. Discarding time point!";
+  const auto [timestamp, start_point] = *state.starts[timer];
+  state.starts[timer].reset();
+  add(state, timer, timestamp, stop_point - start_point, orderKey(stop_point));
 }
 
 void ElapsedTimeRecorder::record(const std::string& name,
                                  const uint64_t timestamp,
                                  const std::chrono::nanoseconds elapsed) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  add(name, timestamp, elapsed);
+  record(getTimerId(name), timestamp, elapsed);
+}
+
+void ElapsedTimeRecorder::record(TimerId timer,
+                                 const uint64_t timestamp,
+                                 const std::chrono::nanoseconds elapsed) {
+  add(localState(), timer, timestamp, elapsed, orderKey(Clock::now()));
+}
+
+void ElapsedTimeRecorder::add(ThreadState& state,
+                              TimerId timer,
+                              const uint64_t timestamp,
+                              const std::chrono::nanoseconds elapsed,
+                              int64_t order) {
+  // only contended if another thread is collecting measurements
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.timers.size() <= timer) {
+    state.timers.resize(timer + 1);
+  }
+
+  state.timers[timer].add(timestamp, elapsed, order, keep_raw_measurements);
+}
+
+std::map<ElapsedTimeRecorder::TimerId, ElapsedTimeRecorder::TimerState>
+ElapsedTimeRecorder::collect(std::optional<TimerId> timer,
+                             bool with_measurements) const {
+  std::map<TimerId, TimerState> merged;
+  const auto merge_from = [&](ThreadState& state) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (size_t i = 0; i < state.timers.size(); ++i) {
+      if ((timer && *timer != i) || !state.timers[i].count) {
+        continue;
+      }
+
+      merged[i].merge(state.timers[i], with_measurements);
+    }
+  };
+
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  auto iter = threads_.begin();
+  while (iter != threads_.end()) {
+    if (iter->use_count() > 1) {
+      ++iter;
+      continue;
+    }
+
+    // the owning thread exited: fold its measurements into the retired state
+    auto& retired_timers = retired_->timers;
+    const auto& timers = (*iter)->timers;
+    if (retired_timers.size() < timers.size()) {
+      retired_timers.resize(timers.size());
+    }
+
+    for (size_t i = 0; i < timers.size(); ++i) {
+      retired_timers[i].merge(timers[i], true);
+    }
+
+    iter = threads_.erase(iter);
+  }
+
+  merge_from(*retired_);
+  for (const auto& state : threads_) {
+    merge_from(*state);
+  }
+
+  return merged;
 }
 
 std::vector<std::string> ElapsedTimeRecorder::timerNames() const {
+  const auto merged = collect();
   std::vector<std::string> names;
   {  // start critical section
-    std::unique_lock<std::mutex> lock(mutex_);
-    std::transform(elapsed_.begin(),
-                   elapsed_.end(),
-                   std::back_inserter(names),
-                   [](const auto& entry) { return entry.first; });
-  }
+    std::shared_lock<std::shared_mutex> lock(names_mutex_);
+    for (const auto& [id, state] : merged) {
+      names.push_back(names_.at(id));
+    }
+  }  // end critical section
 
+  std::sort(names.begin(), names.end());
   return names;
 }
 
 std::optional<double> ElapsedTimeRecorder::getLastElapsed(const std::string& n) const {
-  {  // start critical section
-    std::unique_lock<std::mutex> lock(mutex_);
-    auto iter = elapsed_.find(n);
-    if (iter != elapsed_.end()) {
-      // NOTE(nathan) invariant that every timer has at least one sample
-      return iter->second.back().elapsed_seconds();
-    }
-  }  // end critical section
+  const auto id = findTimerId(n);
+  if (!id) {
+    return std::nullopt;
+  }
 
-  return std::nullopt;
+  const auto merged = collect(*id);
+  auto iter = merged.find(*id);
+  if (iter == merged.end()) {
+    return std::nullopt;
+  }
+
+  return iter->second.last;
 }
 
 ElapsedStatistics ElapsedTimeRecorder::getStats(const std::string& name) const {
-  std::vector<Entry> durations;
-  {  // start critical section
-    std::unique_lock<std::mutex> lock(mutex_);
-    auto iter = elapsed_.find(name);
-    if (iter != elapsed_.end()) {
-      durations = iter->second;
+  const auto id = findTimerId(name);
+  if (!id) {
+    return {};
+  }
+
+  const auto merged = collect(*id);
+  auto iter = merged.find(*id);
+  return iter == merged.end() ? ElapsedStatistics{} : iter->second.stats();
+}
+
+std::vector<ElapsedTimeRecorder::Snapshot> ElapsedTimeRecorder::snapshot() const {
+  std::map<std::string, TimerState> by_name;
+  {
+    auto merged = collect();
+    std::shared_lock<std::shared_mutex> lock(names_mutex_);
+    for (auto& [id, state] : merged) {
+      by_name.emplace(names_.at(id), std::move(state));
     }
-  }  // end critical section
+  }
+
+  std::vector<Snapshot> snapshots;
+  for (const auto& [name, state] : by_name) {
+    snapshots.push_back({name,
+                         state.stats(),
+                         state.histogram,
+                         state.histogram.quantile(0.5),
+                         state.histogram.quantile(0.9),
+                         state.histogram.quantile(0.99)});
+  }
+
+  return snapshots;
+}
+
+std::optional<ElapsedTimeRecorder::Snapshot> ElapsedTimeRecorder::snapshot(
+    const std::string& name) const {
+  const auto id = findTimerId(name);
+  if (!id) {
+    return std::nullopt;
+  }
+
+  const auto merged = collect(*id);
+  auto iter = merged.find(*id);
+  if (iter == merged.end()) {
+    return std::nullopt;
+  }
 
-  return computeStats(durations);
+  const auto& state = iter->second;
+  return Snapshot{name,
+                  state.stats(),
+                  state.histogram,
+                  state.histogram.quantile(0.5),
+                  state.histogram.quantile(0.9),
+                  state.histogram.quantile(0.99)};
 }
 
 std::string ElapsedTimeRecorder::printAllStats() const {
   std::stringstream ss;
-  const auto timers = timerNames();
-  for (const auto& name : timers) {
-    const auto stats = getStats(name);
-    ss << name << ": " << stats << std::endl;
+  for (const auto& timer : snapshot()) {
+    ss << timer.name << ": " << timer.stats << std::endl;
   }
 
   return ss.str();
@@ -253,25 +552,34 @@ bool log_raw_timers_to_single_dir = false;
 void ElapsedTimeRecorder::logTimers(const std::filesystem::path& output,
                                     const std::string& name_prefix,
                                     const std::string& name_suffix) const {
-  const auto all_timers = timerNames();
-  VLOG(5) << "Saving timers: [" << all_timers << "]";
-  for (const auto& name : all_timers) {
-    VLOG(5) << "Saving timer '" << name << "'";
+  auto merged = collect(std::nullopt, true);
+  std::vector<std::string> names;
+  {  // start critical section
+    std::shared_lock<std::shared_mutex> lock(names_mutex_);
+    names = names_;
+  }  // end critical section
 
-    std::vector<Entry> entries;
-    {  // start critical section
-      std::unique_lock<std::mutex> lock(mutex_);
-      auto iter = elapsed_.find(name);
-      if (iter != elapsed_.end()) {
-        entries = iter->second;
-      }
-    }  // end critical section
+  for (auto& [id, state] : merged) {
+    const auto& name = names.at(id);
+    VLOG(5) << "Saving timer '" << name << "'";
 
-    if (entries.empty()) {
-      LOG(ERROR) << "Invalid timer encountered while saving '" << name << "'";
+    auto& measurements = state.measurements;
+    if (measurements.empty()) {
+      LOG_IF(ERROR, keep_raw_measurements)
+          << "Invalid timer encountered while saving '" << name << "'";
       continue;
     }
 
+    // measurements are ordered per thread; restore global order
+    std::stable_sort(measurements.begin(),
+                     measurements.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    Entries entries;
+    entries.reserve(measurements.size());
+    for (const auto& measurement : measurements) {
+      entries.push_back(measurement.second);
+    }
+
     const auto output_csv = getTimerPath(output, name, name_prefix, name_suffix);
     VLOG(2) << "Writing " << entries.size() << " measurements for timer '" << name
             << "' to '" << output_csv << "'";
@@ -287,28 +595,15 @@ void ElapsedTimeRecorder::logStats(const std::filesystem::path& filename) const
   // file format
   std::stringstream ss;
   ss << "name,mean[s],min[s],max[s],std-dev[s]\n";
-  for (const auto& str_timer_pair : elapsed_) {
-    const ElapsedStatistics& stats = getStats(str_timer_pair.first);
-    ss << str_timer_pair.first << "," << stats.mean_s << "," << stats.min_s << ","
-       << stats.max_s << "," << stats.stddev_s << "\n";
+  for (const auto& timer : snapshot()) {
+    const auto& stats = timer.stats;
+    ss << timer.name << "," << stats.mean_s << "," << stats.min_s << "," << stats.max_s
+       << "," << stats.stddev_s << "\n";
   }
   output_file << ss.str();
   output_file.close();
 }
 
-// NOTE(nathan) this is intentionally NOT threadsafe, the callee is responsible
-// for locking the mutex
-void ElapsedTimeRecorder::add(const std::string& name,
-                              const uint64_t timestamp,
-                              const std::chrono::nanoseconds elapsed) {
-  auto iter = elapsed_.find(name);
-  if (iter == elapsed_.end()) {
-    iter = elapsed_.emplace(name, std::vector<Entry>()).first;
-  }
-
-  iter->second.emplace_back(Entry{timestamp, elapsed});
-}
-
 ScopedTimer::ScopedTimer(const std::string& name,
                          uint64_t timestamp,
                          bool verbose,
@@ -342,7 +637,12 @@ void ScopedTimer::start() {
     return;
   }
 
-  ElapsedTimeRecorder::instance().start(name_, timestamp_);
+  auto& recorder = ElapsedTimeRecorder::instance();
+  if (!id_) {
+    id_ = recorder.getTimerId(name_);
+  }
+
+  recorder.start(*id_, timestamp_);
   is_running_ = true;
 }
 
@@ -360,7 +660,7 @@ void ScopedTimer::stop() {
   }
 
   is_running_ = false;
-  ElapsedTimeRecorder::instance().stop(name_);
+  ElapsedTimeRecorder::instance().stop(*id_);
   if (!verbose_) {
     return;
   }
@@ -386,12 +686,14 @@ void ScopedTimer::stop() {
 void ScopedTimer::reset(const std::string& name) {
   stop();
   name_ = name;
+  id_.reset();
   start();
 }
 
 void ScopedTimer::reset(const std::string& name, uint64_t timestamp) {
   stop();
   name_ = name;
+  id_.reset();
   timestamp_ = timestamp;
   start();
 }
@@ -53,6 +53,8 @@ inline NodeAttributes::Ptr makeAttrs(std::chrono::nanoseconds stamp) {
   return attrs;
 }
 
+inline uint64_t toNs(std::chrono::nanoseconds stamp) { return stamp.count(); }
+
 inline void addToQueue(ExternalLoopClosureReceiver::Queue& queue,
                        int from_robot,
                        std::chrono::nanoseconds from_ns,
@@ -185,4 +187,160 @@ TEST(ExternalLoopClosureReceiver, QueueCorrect) {
   }
 }
 
+TEST(ExternalLoopClosureReceiver, FindClosestOutOfOrder) {
+  ExternalLoopClosureReceiver::Config config;
+  config.layer = "AGENTS";
+  ExternalLoopClosureReceiver receiver(config, nullptr);
+
+  const auto prefix = kimera_pgmo::GetRobotPrefix(0);
+  DynamicSceneGraph graph;
+  graph.addLayer(2, prefix);
+  graph.emplaceNode(2, "a5"_id, makeAttrs(50s), prefix);
+  graph.emplaceNode(2, "a6"_id, makeAttrs(60s), prefix);
+  {  // index built from scratch
+    const auto result = receiver.findClosest(graph, toNs(54s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a5"_id);
+  }
+
+  // nodes with lower IDs added after the index was built
+  graph.emplaceNode(2, "a1"_id, makeAttrs(10s), prefix);
+  graph.emplaceNode(2, "a2"_id, makeAttrs(20s), prefix);
+  {
+    const auto result = receiver.findClosest(graph, toNs(16s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a2"_id);
+  }
+
+  // stamps that are not monotonic in node ID
+  graph.emplaceNode(2, "a7"_id, makeAttrs(30s), prefix);
+  graph.emplaceNode(2, "a8"_id, makeAttrs(70s), prefix);
+  {
+    const auto result = receiver.findClosest(graph, toNs(31s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a7"_id);
+  }
+  {  // halfway between two nodes picks the earlier one
+    const auto result = receiver.findClosest(graph, toNs(65s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a6"_id);
+  }
+  {
+    const auto result = receiver.findClosest(graph, toNs(71s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::UNKNOWN);
+  }
+}
+
+TEST(ExternalLoopClosureReceiver, PendingRetriedInOrder) {
+  ExternalLoopClosureReceiver::Config config;
+  config.max_time_difference = 2.0;
+  config.layer = "AGENTS";
+  ExternalLoopClosureReceiver::Queue queue;
+  ExternalLoopClosureReceiver receiver(config, &queue);
+
+  const auto prefix0 = kimera_pgmo::GetRobotPrefix(0);
+  const auto prefix1 = kimera_pgmo::GetRobotPrefix(1);
+  DynamicSceneGraph graph;
+  graph.addLayer(2, prefix0);
+  graph.emplaceNode(2, "a0"_id, makeAttrs(10s), prefix0);
+  graph.emplaceNode(2, "a1"_id, makeAttrs(20s), prefix0);
+
+  addToQueue(queue, 0, 10s, 0, 30s);  // waits on robot 0
+  addToQueue(queue, 0, 10s, 1, 21s);  // waits on robot 1 (missing layer)
+  addToQueue(queue, 0, 29s, 0, 10s);  // waits on robot 0
+  addToQueue(queue, 0, 100s, 0, 10s);  // waits on robot 0 until later
+
+  std::vector<std::pair<NodeId, NodeId>> results;
+  const auto callback = [&results](NodeId to, NodeId from, const gtsam::Pose3) {
+    results.push_back({to, from});
+  };
+
+  receiver.update(graph, callback);
+  EXPECT_TRUE(results.empty());
+  EXPECT_EQ(receiver.numPending(), 4u);
+
+  graph.emplaceNode(2, "b0"_id, makeAttrs(21s), prefix1);
+  graph.emplaceNode(2, "a2"_id, makeAttrs(30s), prefix0);
+  receiver.update(graph, callback);
+  std::vector<std::pair<NodeId, NodeId>> expected{
+      {"a2"_id, "a0"_id}, {"b0"_id, "a0"_id}, {"a0"_id, "a2"_id}};
+  EXPECT_EQ(results, expected);
+  EXPECT_EQ(receiver.numPending(), 1u);
+
+  // closest node is too far away in time
+  results.clear();
+  graph.emplaceNode(2, "a3"_id, makeAttrs(110s), prefix0);
+  receiver.update(graph, callback);
+  EXPECT_TRUE(results.empty());
+  EXPECT_EQ(receiver.numPending(), 0u);
+}
+
+TEST(ExternalLoopClosureReceiver, ReplacedNodesReindexed) {
+  ExternalLoopClosureReceiver::Config config;
+  config.layer = "AGENTS";
+  ExternalLoopClosureReceiver receiver(config, nullptr);
+
+  const auto prefix = kimera_pgmo::GetRobotPrefix(0);
+  DynamicSceneGraph graph;
+  graph.addLayer(2, prefix);
+  graph.emplaceNode(2, "a1"_id, makeAttrs(10s), prefix);
+  graph.emplaceNode(2, "a2"_id, makeAttrs(20s), prefix);
+  graph.emplaceNode(2, "a3"_id, makeAttrs(30s), prefix);
+  EXPECT_EQ(receiver.findClosest(graph, toNs(19s), 0, 0.0).id, "a2"_id);
+
+  // same number of nodes as before, but one was replaced
+  graph.removeNode("a2"_id);
+  graph.emplaceNode(2, "a4"_id, makeAttrs(40s), prefix);
+  {
+    const auto result = receiver.findClosest(graph, toNs(19s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a1"_id);
+  }
+  {
+    const auto result = receiver.findClosest(graph, toNs(39s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a4"_id);
+  }
+}
+
+TEST(ExternalLoopClosureReceiver, ChangeLogTracksRemovedNodes) {
+  ExternalLoopClosureReceiver::Config config;
+  config.layer = "AGENTS";
+  GraphChangeLog changes;
+  ExternalLoopClosureReceiver receiver(config, nullptr, &changes);
+
+  const auto prefix = kimera_pgmo::GetRobotPrefix(0);
+  DynamicSceneGraph graph;
+  graph.addLayer(2, prefix);
+  graph.emplaceNode(2, "a1"_id, makeAttrs(10s), prefix);
+  graph.emplaceNode(2, "a2"_id, makeAttrs(20s), prefix);
+  graph.emplaceNode(2, "a3"_id, makeAttrs(30s), prefix);
+  changes.observe(graph);
+  EXPECT_EQ(receiver.findClosest(graph, toNs(19s), 0, 0.0).id, "a2"_id);
+
+  // nothing changed: the index is reused
+  changes.observe(graph);
+  EXPECT_EQ(receiver.findClosest(graph, toNs(19s), 0, 0.0).id, "a2"_id);
+
+  // replace a node with one that has a lower ID, which keeps both the number of nodes
+  // and the largest ID the same
+  graph.removeNode("a3"_id);
+  graph.emplaceNode(2, "a0"_id, makeAttrs(25s), prefix);
+  changes.observe(graph);
+  {
+    const auto result = receiver.findClosest(graph, toNs(24s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a0"_id);
+  }
+
+  // new nodes are still picked up incrementally
+  graph.emplaceNode(2, "a5"_id, makeAttrs(50s), prefix);
+  changes.observe(graph);
+  {
+    const auto result = receiver.findClosest(graph, toNs(49s), 0, 0.0);
+    EXPECT_EQ(result.status, LookupResult::Status::VALID);
+    EXPECT_EQ(result.id, "a5"_id);
+  }
+}
+
 }  // namespace hydra
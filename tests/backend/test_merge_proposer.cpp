@@ -0,0 +1,215 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/backend/association_strategies.h>
+#include <hydra/backend/merge_proposer.h>
+#include <hydra/utils/graph_change_log.h>
+
+#include <random>
+#include <set>
+
+namespace hydra {
+
+using association::NearestNode;
+using association::Pairwise;
+using association::SemanticNearestNode;
+using association::SemanticPairwise;
+
+namespace {
+
+template <typename StrategyConfig>
+MergeProposer::Config makeConfig(const StrategyConfig& strategy_config) {
+  MergeProposer::Config config;
+  config.strategy = config::VirtualConfig<AssociationStrategy>(strategy_config);
+  config.num_threads = 2;
+  return config;
+}
+
+bool isClose(const SceneGraphNode& lhs, const SceneGraphNode& rhs) {
+  return (lhs.attributes().position - rhs.attributes().position).norm() < 1.5;
+}
+
+struct MergeSimulation {
+  explicit MergeSimulation(uint32_t seed) : gen(seed) {}
+
+  Eigen::Vector3d randomPosition() {
+    std::uniform_real_distribution<double> dist(0.0, 6.0);
+    return Eigen::Vector3d(dist(gen), dist(gen), dist(gen));
+  }
+
+  uint32_t randomLabel() { return std::uniform_int_distribution<uint32_t>(0, 2)(gen); }
+
+  void addNode() {
+    auto attrs = std::make_unique<SemanticNodeAttributes>();
+    attrs->position = randomPosition();
+    attrs->is_active = true;
+    attrs->semantic_label = randomLabel();
+    graph.emplaceNode(DsgLayers::OBJECTS, next_id, std::move(attrs));
+    active.push_back(next_id);
+    ++next_id;
+  }
+
+  SemanticNodeAttributes& attributes(NodeId node_id) {
+    return graph.getNode(node_id).attributes<SemanticNodeAttributes>();
+  }
+
+  void step() {
+    for (size_t i = 0; i < 4; ++i) {
+      addNode();
+    }
+
+    // labels of active nodes can change until they are archived
+    attributes(active.back()).semantic_label = randomLabel();
+
+    while (active.size() > 8) {
+      attributes(active.front()).is_active = false;
+      active.erase(active.begin());
+    }
+
+    // occasionally drop an archived node
+    std::uniform_int_distribution<NodeId> dist(0, next_id - 1);
+    const auto to_remove = dist(gen);
+    if (std::find(active.begin(), active.end(), to_remove) == active.end()) {
+      graph.removeNode(to_remove);
+    }
+  }
+
+  // mimic merges in the backend: the source node is dropped and the target changes
+  void applyMerges(const MergeList& merges) {
+    for (const auto& merge : merges) {
+      if (!graph.hasNode(merge.from) || !graph.hasNode(merge.to)) {
+        continue;
+      }
+
+      auto& target = attributes(merge.to);
+      target.position = attributes(merge.from).position;
+      target.semantic_label = randomLabel();
+      active.erase(std::remove(active.begin(), active.end(), merge.from), active.end());
+      graph.removeNode(merge.from);
+    }
+  }
+
+  std::mt19937 gen;
+  DynamicSceneGraph graph;
+  std::vector<NodeId> active;
+  NodeId next_id = 0;
+};
+
+template <typename StrategyConfig>
+void checkMatchesFresh(const StrategyConfig& strategy_config) {
+  const auto config = makeConfig(strategy_config);
+  const MergeProposer proposer(config);
+  GraphChangeLog changes;
+  MergeSimulation sim(12345);
+
+  size_t num_merges = 0;
+  for (size_t iter = 0; iter < 40; ++iter) {
+    SCOPED_TRACE("iteration " + std::to_string(iter));
+    sim.step();
+    changes.observe(sim.graph);
+
+    const auto& layer = sim.graph.getLayer(DsgLayers::OBJECTS);
+    const NodeSubsetView view(layer, sim.active);
+    MergeList merges;
+    proposer.findMerges(layer, view, isClose, merges, &changes);
+
+    const MergeProposer fresh(config);
+    MergeList expected;
+    fresh.findMerges(layer, view, isClose, expected);
+    EXPECT_EQ(merges, expected);
+
+    std::set<std::pair<NodeId, NodeId>> pairs;
+    for (const auto& merge : merges) {
+      EXPECT_TRUE(pairs.insert(std::minmax(merge.from, merge.to)).second) << merge;
+    }
+
+    num_merges += merges.size();
+    sim.applyMerges(merges);
+  }
+
+  // make sure the merge invalidation actually got exercised
+  EXPECT_GT(num_merges, 0u);
+}
+
+}  // namespace
+
+TEST(MergeProposer, PairwiseMatchesFresh) { checkMatchesFresh(Pairwise::Config{}); }
+
+TEST(MergeProposer, SemanticPairwiseMatchesFresh) {
+  checkMatchesFresh(SemanticPairwise::Config{});
+}
+
+TEST(MergeProposer, NearestNodeMatchesFresh) {
+  NearestNode::Config config;
+  config.num_merges_to_consider = 3;
+  checkMatchesFresh(config);
+}
+
+TEST(MergeProposer, SemanticNearestNodeMatchesFresh) {
+  SemanticNearestNode::Config config;
+  config.num_merges_to_consider = 2;
+  checkMatchesFresh(config);
+}
+
+TEST(MergeProposer, ChecksPairsOnce) {
+  DynamicSceneGraph graph;
+  for (NodeId i = 0; i < 3; ++i) {
+    auto attrs = std::make_unique<SemanticNodeAttributes>();
+    attrs->position = Eigen::Vector3d(0.1 * i, 0.0, 0.0);
+    graph.emplaceNode(DsgLayers::OBJECTS, i, std::move(attrs));
+  }
+
+  // every node is archived, so every node is a candidate for every other node
+  const MergeProposer proposer(makeConfig(Pairwise::Config{}));
+  const auto& layer = graph.getLayer(DsgLayers::OBJECTS);
+  std::set<std::pair<NodeId, NodeId>> checked;
+  size_t num_checks = 0;
+  MergeList merges;
+  proposer.findMerges(
+      layer,
+      NodeSubsetView(layer),
+      [&](const SceneGraphNode& lhs, const SceneGraphNode& rhs) {
+        ++num_checks;
+        EXPECT_TRUE(checked.insert(std::minmax(lhs.id, rhs.id)).second);
+        return true;
+      },
+      merges);
+
+  EXPECT_EQ(num_checks, 3u);
+  const MergeList expected{{0, 1}, {0, 2}, {1, 2}};
+  EXPECT_EQ(merges, expected);
+}
+
+}  // namespace hydra
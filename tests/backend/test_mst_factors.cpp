@@ -0,0 +1,230 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/backend/mst_factors.h>
+#include <hydra/utils/graph_change_log.h>
+#include <kimera_pgmo/deformation_graph.h>
+
+#include <limits>
+#include <random>
+
+#include "hydra_test/shared_dsg_fixture.h"
+
+namespace hydra {
+
+namespace {
+
+struct PlaceMstFactorsTest : public ::testing::Test {
+  void SetUp() override {
+    dsg = test::makeSharedDsg();
+    for (size_t i = 0; i < 30; ++i) {
+      addPlace();
+    }
+
+    for (size_t i = 0; i < 60; ++i) {
+      addEdge();
+    }
+  }
+
+  Eigen::Vector3d randomPosition() {
+    return Eigen::Vector3d(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+  }
+
+  NodeId randomPlace(bool active) {
+    std::vector<NodeId> candidates;
+    for (const auto& [node_id, node] : places().nodes()) {
+      if (node->attributes().is_active == active) {
+        candidates.push_back(node_id);
+      }
+    }
+
+    if (candidates.empty()) {
+      return next_id;  // never a valid place
+    }
+
+    std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
+    return candidates.at(dist(gen));
+  }
+
+  void addPlace() {
+    auto attrs = std::make_unique<PlaceNodeAttributes>(0.0, 0.0);
+    attrs->position = randomPosition();
+    attrs->is_active = true;
+    // invalid connections keep the deformation graph from needing a mesh
+    attrs->deformation_connections = {std::numeric_limits<size_t>::max()};
+    dsg->graph->emplaceNode(DsgLayers::PLACES, next_id, std::move(attrs));
+    ++next_id;
+  }
+
+  void addEdge() {
+    // like the frontend, only connect places to the active window
+    std::uniform_int_distribution<NodeId> dist(0, next_id - 1);
+    const auto source = randomPlace(true);
+    const auto target = dist(gen);
+    if (source != target && places().hasNode(source) && places().hasNode(target)) {
+      dsg->graph->insertEdge(source, target);
+    }
+  }
+
+  void update(bool full_update = false) {
+    changes.observe(*dsg->graph);
+    factors.update(*dsg->graph,
+                   0,
+                   dgraph,
+                   1.0,
+                   1.0,
+                   [](NodeId) { return 'v'; },
+                   &changes,
+                   full_update);
+  }
+
+  void checkMatchesFresh() const {
+    kimera_pgmo::DeformationGraph fresh_dgraph;
+    PlaceMstFactors expected;
+    expected.update(
+        *dsg->graph, 0, fresh_dgraph, 1.0, 1.0, [](NodeId) { return 'v'; });
+
+    EXPECT_EQ(factors.mst().info().leaves, expected.mst().info().leaves);
+    EXPECT_NEAR(factors.mst().totalDistance(), expected.mst().totalDistance(), 1.0e-9);
+
+    ASSERT_EQ(factors.numFactors(), expected.numFactors());
+    for (const auto& [node_id, factor] : expected.factors()) {
+      const auto iter = factors.factors().find(node_id);
+      ASSERT_TRUE(iter != factors.factors().end()) << "missing factor " << node_id;
+      EXPECT_EQ(iter->second.key, factor.key);
+      EXPECT_EQ(iter->second.valence_prefix, factor.valence_prefix);
+      EXPECT_EQ(iter->second.valence, factor.valence);
+      EXPECT_TRUE(iter->second.pose.equals(factor.pose, 1.0e-9));
+    }
+
+    ASSERT_EQ(factors.numBetweenFactors(), expected.numBetweenFactors());
+    for (const auto& [key, edge] : expected.betweenFactors()) {
+      const auto iter = factors.betweenFactors().find(key);
+      ASSERT_TRUE(iter != factors.betweenFactors().end())
+          << "missing edge " << key.first << " -> " << key.second;
+      EXPECT_EQ(iter->second.key_from, edge.key_from);
+      EXPECT_EQ(iter->second.key_to, edge.key_to);
+      const auto diff = iter->second.pose.matrix() - edge.pose.matrix();
+      EXPECT_NEAR(diff.norm(), 0.0, 1.0e-9);
+    }
+  }
+
+  const SceneGraphLayer& places() const {
+    return dsg->graph->getLayer(DsgLayers::PLACES);
+  }
+
+  SharedDsgInfo::Ptr dsg;
+  GraphChangeLog changes;
+  kimera_pgmo::DeformationGraph dgraph;
+  PlaceMstFactors factors;
+  NodeId next_id = 0;
+  std::mt19937 gen{4321};
+  std::uniform_real_distribution<double> pos_dist{0.0, 10.0};
+};
+
+}  // namespace
+
+TEST_F(PlaceMstFactorsTest, MatchesFreshUpdate) {
+  update();
+  checkMatchesFresh();
+
+  for (size_t iter = 0; iter < 20; ++iter) {
+    SCOPED_TRACE("iteration " + std::to_string(iter));
+    for (size_t i = 0; i < 3; ++i) {
+      addPlace();
+    }
+
+    for (size_t i = 0; i < 8; ++i) {
+      addEdge();
+    }
+
+    // active places move and lose edges
+    for (size_t i = 0; i < 3; ++i) {
+      const auto node_id = randomPlace(true);
+      if (!places().hasNode(node_id)) {
+        continue;
+      }
+
+      dsg->graph->getNode(node_id).attributes().position = randomPosition();
+      const auto& siblings = dsg->graph->getNode(node_id).siblings();
+      if (i == 0 && !siblings.empty()) {
+        dsg->graph->removeEdge(node_id, *siblings.begin());
+      }
+    }
+
+    for (size_t i = 0; i < 4; ++i) {
+      const auto node_id = randomPlace(true);
+      if (places().hasNode(node_id)) {
+        dsg->graph->getNode(node_id).attributes().is_active = false;
+      }
+    }
+
+    if (iter % 3 == 2) {
+      dsg->graph->removeNode(randomPlace(false));
+    }
+
+    // archived places only move with a full update (e.g., after a loop closure)
+    const bool full_update = iter % 5 == 4;
+    if (full_update) {
+      const auto node_id = randomPlace(false);
+      if (places().hasNode(node_id)) {
+        dsg->graph->getNode(node_id).attributes().position = randomPosition();
+      }
+    }
+
+    update(full_update);
+    checkMatchesFresh();
+  }
+}
+
+TEST_F(PlaceMstFactorsTest, RemovedPlacesDropFactors) {
+  update();
+  const auto num_factors = factors.numFactors();
+  ASSERT_GT(num_factors, 0u);
+
+  // drop all edges of a place with factors so that it no longer has siblings
+  const auto node_id = factors.factors().begin()->first;
+  const auto siblings = dsg->graph->getNode(node_id).siblings();
+  for (const auto sibling : siblings) {
+    dsg->graph->removeEdge(node_id, sibling);
+  }
+
+  update();
+  EXPECT_EQ(factors.factors().count(node_id), 0u);
+  EXPECT_FALSE(factors.mst().hasEdge(node_id, *siblings.begin()));
+  checkMatchesFresh();
+}
+
+}  // namespace hydra
@@ -0,0 +1,117 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/backend/surface_place_utilities.h>
+
+#include <random>
+
+namespace hydra {
+
+namespace {
+
+using EdgeMap = std::map<std::tuple<size_t, size_t, size_t, size_t>, double>;
+using SplitPlaces = std::vector<std::pair<NodeId, std::vector<Place2d>>>;
+
+Place2d makeRandomPlace(std::mt19937& gen) {
+  std::uniform_real_distribution<double> pos_dist(-10.0, 10.0);
+  std::uniform_real_distribution<double> z_dist(0.0, 0.6);
+  std::uniform_real_distribution<double> side_dist(0.3, 3.0);
+  std::uniform_real_distribution<double> angle_dist(-M_PI / 4, M_PI / 4);
+
+  Place2d place;
+  const Eigen::Rotation2Dd rot(angle_dist(gen));
+  const Eigen::Vector2d e1 = rot * Eigen::Vector2d(side_dist(gen), 0.0);
+  const Eigen::Vector2d e2 = rot * Eigen::Vector2d(0.0, side_dist(gen));
+  place.ellipse_matrix_expand.col(0) = std::sqrt(2) * e1 / 2;
+  place.ellipse_matrix_expand.col(1) = std::sqrt(2) * e2 / 2;
+  const Eigen::Matrix2d m_inv = place.ellipse_matrix_expand.inverse();
+  place.ellipse_matrix_compress = m_inv.transpose() * m_inv;
+  place.ellipse_centroid << pos_dist(gen), pos_dist(gen);
+  place.centroid.add(pcl::PointXYZ(
+      place.ellipse_centroid.x(), place.ellipse_centroid.y(), z_dist(gen)));
+  return place;
+}
+
+// Reference implementation checking every pair of split places
+EdgeMap buildEdgeMapBruteForce(const SplitPlaces& nodes_to_add,
+                               double overlap_threshold,
+                               double z_diff) {
+  EdgeMap edge_map;
+  for (size_t og_ix = 0; og_ix < nodes_to_add.size(); ++og_ix) {
+    const auto& places_i = nodes_to_add[og_ix].second;
+    for (size_t split_ix = 0; split_ix < places_i.size(); ++split_ix) {
+      for (size_t og_jx = 0; og_jx <= og_ix; ++og_jx) {
+        const auto& places_j = nodes_to_add[og_jx].second;
+        for (size_t split_jx = 0; split_jx < places_j.size(); ++split_jx) {
+          double weight;
+          const bool connected = shouldAddPlaceConnection(
+              places_i[split_ix], places_j[split_jx], overlap_threshold, z_diff, weight);
+          if (connected && weight > 0) {
+            edge_map[{og_ix, split_ix, og_jx, split_jx}] = weight;
+          }
+        }
+      }
+    }
+  }
+
+  return edge_map;
+}
+
+}  // namespace
+
+TEST(SurfacePlaceUtilities, EdgeMapMatchesBruteForce) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> split_dist(1, 4);
+  for (size_t trial = 0; trial < 5; ++trial) {
+    SplitPlaces nodes_to_add;
+    for (size_t i = 0; i < 40; ++i) {
+      auto& [node_id, places] = nodes_to_add.emplace_back();
+      node_id = i;
+      const auto num_splits = split_dist(gen);
+      for (size_t j = 0; j < num_splits; ++j) {
+        places.push_back(makeRandomPlace(gen));
+      }
+    }
+
+    for (const double threshold : {-1.0, 0.0, 0.5}) {
+      const auto expected = buildEdgeMapBruteForce(nodes_to_add, threshold, 0.3);
+      const auto result = utils::buildEdgeMap(nodes_to_add, threshold, 0.3);
+      EXPECT_FALSE(expected.empty());
+      EXPECT_EQ(result, expected);
+    }
+  }
+}
+
+}  // namespace hydra
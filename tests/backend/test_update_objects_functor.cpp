@@ -111,6 +111,107 @@ TEST(UpdateObjectsFunctor, ObjectUpdate) {
   }
 }
 
+TEST(UpdateObjectsFunctor, ObjectUpdateMovedVertices) {
+  auto dsg = test::makeSharedDsg();
+  auto& graph = *dsg->graph;
+
+  auto attrs = std::make_unique<ObjectNodeAttributes>();
+  attrs->bounding_box.type = BoundingBox::Type::AABB;
+  attrs->is_active = true;
+  attrs->mesh_connections = {0, 1};
+  graph.emplaceNode(DsgLayers::OBJECTS, 0, std::move(attrs));
+
+  auto mesh = std::make_shared<Mesh>();
+  mesh->resizeVertices(3);
+  mesh->setPos(0, Mesh::Pos(-1.0, -2.0, -3.0));
+  mesh->setPos(1, Mesh::Pos(1.0, 2.0, 3.0));
+  mesh->setPos(2, Mesh::Pos(3.0, 2.0, 1.0));
+  graph.setMesh(mesh);
+
+  UpdateInfo::ConstPtr info(new UpdateInfo{0, nullptr, nullptr, false, {}});
+  UpdateObjectsFunctor functor(UpdateObjectsFunctor::Config{});
+  callWithUnmerged(functor, *dsg, info, false);
+
+  // move a vertex on the boundary inwards and add a new connection
+  mesh->setPos(0, Mesh::Pos(0.0, 0.0, 0.0));
+  graph.getNode(0).attributes<ObjectNodeAttributes>().mesh_connections = {0, 1, 2};
+  callWithUnmerged(functor, *dsg, info, false);
+
+  {
+    const Eigen::Vector3d expected_pos(4.0 / 3.0, 4.0 / 3.0, 4.0 / 3.0);
+    const Eigen::Vector3f expected_center(1.5, 1.0, 1.5);
+    const Eigen::Vector3f expected_dims(3.0, 2.0, 3.0);
+    const auto& result = graph.getNode(0).attributes<ObjectNodeAttributes>();
+    EXPECT_NEAR(0.0, (expected_pos - result.position).norm(), 1.0e-7);
+    EXPECT_NEAR(
+        0.0, (expected_center - result.bounding_box.world_P_center).norm(), 1.0e-7);
+    EXPECT_NEAR(0.0, (expected_dims - result.bounding_box.dimensions).norm(), 1.0e-7);
+  }
+
+  // remove the vertex that defines the upper x bound
+  graph.getNode(0).attributes<ObjectNodeAttributes>().mesh_connections = {0, 1};
+  callWithUnmerged(functor, *dsg, info, false);
+
+  {
+    const Eigen::Vector3d expected_pos(0.5, 1.0, 1.5);
+    const Eigen::Vector3f expected_dims(1.0, 2.0, 3.0);
+    const auto& result = graph.getNode(0).attributes<ObjectNodeAttributes>();
+    EXPECT_NEAR(0.0, (expected_pos - result.position).norm(), 1.0e-7);
+    EXPECT_NEAR(0.0, (expected_dims - result.bounding_box.dimensions).norm(), 1.0e-7);
+  }
+}
+
+TEST(UpdateObjectsFunctor, IncrementalGeometryMatchesRefit) {
+  Mesh mesh;
+  mesh.resizeVertices(50);
+  for (size_t i = 0; i < 50; ++i) {
+    mesh.setPos(i, Mesh::Pos(std::sin(i), std::cos(2.0 * i), 0.1 * i));
+  }
+
+  std::vector<size_t> connections;
+  for (size_t i = 0; i < 50; i += 2) {
+    connections.push_back(i);
+  }
+
+  ObjectGeometry geometry;
+  EXPECT_EQ(geometry.update(mesh, connections), connections.size());
+  EXPECT_EQ(geometry.update(mesh, connections), 0u);
+
+  for (size_t iter = 0; iter < 10; ++iter) {
+    // deform part of the mesh and swap some connections
+    for (size_t i = iter; i < 50; i += 7) {
+      mesh.setPos(i, mesh.pos(i) * 1.1f + Mesh::Pos(0.2, -0.1, 0.3));
+    }
+
+    connections.erase(connections.begin());
+    connections.push_back(49 - iter);
+    std::sort(connections.begin(), connections.end());
+    connections.erase(std::unique(connections.begin(), connections.end()),
+                      connections.end());
+
+    ObjectNodeAttributes incremental;
+    incremental.mesh_connections = connections;
+    geometry.update(mesh, connections);
+    ASSERT_TRUE(geometry.apply(mesh, incremental));
+
+    ObjectNodeAttributes expected;
+    expected.mesh_connections = connections;
+    ASSERT_TRUE(updateObjectGeometry(mesh, expected));
+
+    EXPECT_EQ(geometry.numValid(), connections.size());
+    EXPECT_NEAR(0.0, (expected.position - incremental.position).norm(), 1.0e-6);
+    EXPECT_NEAR(0.0,
+                (expected.bounding_box.world_P_center -
+                 incremental.bounding_box.world_P_center)
+                    .norm(),
+                1.0e-6);
+    EXPECT_NEAR(
+        0.0,
+        (expected.bounding_box.dimensions - incremental.bounding_box.dimensions).norm(),
+        1.0e-6);
+  }
+}
+
 TEST(UpdateObjectsFunctor, ObjectUpdateMergeLC) {
   auto dsg = test::makeSharedDsg();
   auto& graph = *dsg->graph;
@@ -0,0 +1,377 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/backend/graph_delta.h>
+#include <hydra/backend/zmq_graph_delta.h>
+#include <hydra/backend/zmq_interfaces.h>
+#include <kimera_pgmo/deformation_graph.h>
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#include "hydra_test/shared_dsg_fixture.h"
+
+namespace hydra {
+
+namespace {
+
+using namespace spark_dsg;
+
+void expectGraphsEqual(const DynamicSceneGraph& expected,
+                       const DynamicSceneGraph& result) {
+  EXPECT_EQ(expected.numNodes(), result.numNodes());
+  EXPECT_EQ(expected.numEdges(), result.numEdges());
+  for (const auto& [layer_id, layer] : expected.layers()) {
+    for (const auto& [node_id, node] : layer->nodes()) {
+      const auto other = result.findNode(node_id);
+      ASSERT_TRUE(other) << "missing node " << NodeSymbol(node_id).str();
+      EXPECT_EQ(node->layer.layer, other->layer.layer);
+      EXPECT_TRUE(node->attributes() == other->attributes())
+          << "attributes differ for " << NodeSymbol(node_id).str();
+    }
+
+    for (const auto& [key, edge] : layer->edges()) {
+      const auto other = result.findEdge(edge.source, edge.target);
+      ASSERT_TRUE(other);
+      EXPECT_TRUE(*edge.info == *other->info);
+    }
+  }
+
+  for (const auto& [key, edge] : expected.interlayer_edges()) {
+    EXPECT_TRUE(result.hasEdge(edge.source, edge.target));
+  }
+}
+
+std::unique_ptr<NodeAttributes> makeAttrs(double x, const std::string& name = "") {
+  auto attrs = std::make_unique<SemanticNodeAttributes>();
+  attrs->position = Eigen::Vector3d(x, 0.0, 0.0);
+  attrs->name = name;
+  return attrs;
+}
+
+// applies a fixed sequence of changes to the graph, returning false when done
+bool stepGraph(size_t step, DynamicSceneGraph& graph) {
+  switch (step) {
+    case 0:
+      graph.emplaceNode(DsgLayers::OBJECTS, "O0"_id, makeAttrs(0.0));
+      graph.emplaceNode(DsgLayers::OBJECTS, "O1"_id, makeAttrs(1.0));
+      graph.emplaceNode(DsgLayers::ROOMS, "R0"_id, makeAttrs(0.5));
+      graph.insertEdge("R0"_id, "O0"_id);
+      return true;
+    case 1:
+      graph.emplaceNode(DsgLayers::PLACES, "p0"_id, makeAttrs(2.0));
+      graph.emplaceNode(DsgLayers::PLACES, "p1"_id, makeAttrs(3.0));
+      graph.insertEdge("p0"_id, "p1"_id, std::make_unique<EdgeAttributes>(0.5));
+      graph.insertEdge("R0"_id, "O1"_id);
+      return true;
+    case 2:
+      // attribute changes only
+      graph.getNode("O0"_id).attributes().position.x() = 5.0;
+      graph.getNode("R0"_id).attributes<SemanticNodeAttributes>().name = "kitchen";
+      return true;
+    case 3:
+      graph.removeNode("O1"_id);
+      graph.getEdge("p0"_id, "p1"_id).info->weight = 2.0;
+      return true;
+    case 4:
+      graph.removeEdge("R0"_id, "O0"_id);
+      graph.emplaceNode(DsgLayers::ROOMS, "R1"_id, makeAttrs(-1.0));
+      graph.insertEdge("R1"_id, "O0"_id);
+      return true;
+    case 5:
+      // no changes
+      return true;
+    case 6:
+      graph.removeEdge("p0"_id, "p1"_id);
+      graph.emplaceNode(DsgLayers::PLACES, "p2"_id, makeAttrs(4.0));
+      graph.insertEdge("p1"_id, "p2"_id);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// applies a fixed sequence of changes to the mesh, returning false when done
+bool stepMesh(size_t step, Mesh& mesh) {
+  const auto add_vertices = [&mesh](size_t num) {
+    const auto offset = mesh.numVertices();
+    mesh.resizeVertices(offset + num);
+    for (size_t i = offset; i < mesh.numVertices(); ++i) {
+      mesh.setPos(i, Mesh::Pos(static_cast<float>(i), 2.0f * i, 0.0f));
+      mesh.setLabel(i, i);
+    }
+  };
+
+  const auto add_face = [&mesh](size_t v0, size_t v1, size_t v2) {
+    mesh.resizeFaces(mesh.numFaces() + 1);
+    mesh.face(mesh.numFaces() - 1) = {v0, v1, v2};
+  };
+
+  switch (step) {
+    case 0:
+      add_vertices(4);
+      add_face(0, 1, 2);
+      return true;
+    case 1:
+      // appended vertices and faces only
+      add_vertices(3);
+      add_face(2, 3, 4);
+      add_face(4, 5, 6);
+      return true;
+    case 2:
+      // no changes
+      return true;
+    case 3:
+      // change in the middle of the mesh
+      mesh.setPos(3, Mesh::Pos(-1.0, -1.0, -1.0));
+      mesh.setLabel(5, 10);
+      return true;
+    case 4:
+      // shrink the mesh
+      mesh.resizeVertices(5);
+      mesh.resizeFaces(2);
+      return true;
+    case 5:
+      mesh.face(0) = {1, 0, 2};
+      add_vertices(1);
+      return true;
+    default:
+      return false;
+  }
+}
+
+void expectMeshesEqual(const Mesh& expected, const Mesh& result) {
+  ASSERT_EQ(expected.numVertices(), result.numVertices());
+  ASSERT_EQ(expected.numFaces(), result.numFaces());
+  for (size_t i = 0; i < expected.numVertices(); ++i) {
+    EXPECT_EQ(expected.pos(i), result.pos(i)) << "vertex " << i;
+    EXPECT_EQ(expected.label(i), result.label(i)) << "vertex " << i;
+  }
+
+  for (size_t i = 0; i < expected.numFaces(); ++i) {
+    EXPECT_EQ(expected.face(i), result.face(i)) << "face " << i;
+  }
+}
+
+}  // namespace
+
+TEST(GraphDelta, EncodeDecodeRoundTrip) {
+  auto graph = test::makeSharedDsg()->graph;
+  stepGraph(0, *graph);
+  stepGraph(1, *graph);
+
+  GraphDeltaTracker tracker;
+  tracker.update(10, *graph);
+  graph->removeNode("O1"_id);
+  const auto delta = tracker.update(20, *graph);
+  EXPECT_FALSE(delta.keyframe);
+  ASSERT_EQ(delta.removed_nodes.size(), 1u);
+  EXPECT_EQ(delta.removed_nodes[0], "O1"_id);
+
+  const auto buffer = delta.encode(false);
+  const auto result = GraphDelta::decode(buffer.data(), buffer.size());
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->sequence, delta.sequence);
+  EXPECT_EQ(result->timestamp_ns, 20u);
+  EXPECT_FALSE(result->keyframe);
+  EXPECT_EQ(result->removed_nodes, delta.removed_nodes);
+  EXPECT_EQ(result->removed_edges, delta.removed_edges);
+  ASSERT_TRUE(result->graph);
+
+  // truncated buffers are rejected
+  EXPECT_FALSE(GraphDelta::decode(buffer.data(), buffer.size() / 2));
+}
+
+TEST(GraphDelta, DeltasOnlyContainChanges) {
+  auto graph = test::makeSharedDsg()->graph;
+  GraphDeltaTracker tracker;
+  stepGraph(0, *graph);
+  stepGraph(1, *graph);
+  EXPECT_TRUE(tracker.update(0, *graph).keyframe);
+
+  stepGraph(2, *graph);
+  const auto delta = tracker.update(1, *graph);
+  EXPECT_FALSE(delta.keyframe);
+  EXPECT_EQ(delta.graph->numNodes(), 2u);
+  EXPECT_TRUE(delta.graph->hasNode("O0"_id));
+  EXPECT_TRUE(delta.graph->hasNode("R0"_id));
+
+  const auto empty = tracker.update(2, *graph);
+  EXPECT_EQ(empty.graph->numNodes(), 0u);
+  EXPECT_TRUE(empty.removed_nodes.empty());
+  EXPECT_TRUE(empty.removed_edges.empty());
+}
+
+TEST(GraphDelta, ApplierDropsUntilKeyframe) {
+  auto graph = test::makeSharedDsg()->graph;
+  GraphDeltaTracker tracker(2);
+  GraphDeltaApplier applier;
+  for (size_t step = 0; stepGraph(step, *graph); ++step) {
+    const auto delta = tracker.update(step, *graph);
+    // simulate a receiver that joins late
+    if (step == 0) {
+      continue;
+    }
+
+    EXPECT_EQ(applier.apply(delta), step >= 3) << "step " << step;
+    if (step >= 3) {
+      expectGraphsEqual(*graph, *applier.graph());
+    }
+  }
+}
+
+TEST(GraphDelta, CompressedRoundTrip) {
+  for (const auto compression : {DeltaCompression::LZ4, DeltaCompression::ZSTD}) {
+    if (!compressionAvailable(compression)) {
+      continue;
+    }
+
+    auto graph = test::makeSharedDsg()->graph;
+    GraphDeltaTracker tracker(2);
+    GraphDeltaApplier applier;
+    for (size_t step = 0; stepGraph(step, *graph); ++step) {
+      const auto delta = tracker.update(step, *graph);
+      const auto buffer = delta.encode(false, compression);
+      EXPECT_EQ(buffer[6], static_cast<uint8_t>(compression));
+      const auto result = GraphDelta::decode(buffer.data(), buffer.size());
+      ASSERT_TRUE(result) << "step " << step;
+      EXPECT_EQ(result->sequence, delta.sequence);
+      EXPECT_EQ(result->keyframe, delta.keyframe);
+      EXPECT_EQ(result->removed_nodes, delta.removed_nodes);
+      EXPECT_EQ(result->removed_edges, delta.removed_edges);
+      ASSERT_TRUE(applier.apply(*result));
+      expectGraphsEqual(*graph, *applier.graph());
+
+      // corrupted compressed payloads are rejected
+      auto corrupted = buffer;
+      corrupted.resize(corrupted.size() - 1);
+      EXPECT_FALSE(GraphDelta::decode(corrupted.data(), corrupted.size()));
+    }
+  }
+}
+
+TEST(GraphDelta, RejectsInvalidPayloadSize) {
+  auto graph = test::makeSharedDsg()->graph;
+  stepGraph(0, *graph);
+  GraphDeltaTracker tracker;
+  const auto buffer = tracker.update(0, *graph).encode(false);
+  ASSERT_TRUE(GraphDelta::decode(buffer.data(), buffer.size()));
+
+  // payload size is the last field of the header
+  constexpr size_t size_offset = 8 + 2 * sizeof(uint64_t);
+  for (const uint64_t payload_size :
+       {std::numeric_limits<uint64_t>::max(), uint64_t(1) << 40, uint64_t(0)}) {
+    auto corrupted = buffer;
+    std::memcpy(corrupted.data() + size_offset, &payload_size, sizeof(uint64_t));
+    EXPECT_FALSE(GraphDelta::decode(corrupted.data(), corrupted.size()))
+        << "payload size " << payload_size;
+  }
+}
+
+TEST(GraphDelta, DeltasOnlySendMeshChanges) {
+  auto graph = test::makeSharedDsg()->graph;
+  auto mesh = std::make_shared<Mesh>(false, false, true, false);
+  graph->setMesh(mesh);
+
+  GraphDeltaTracker tracker;
+  GraphDeltaApplier applier;
+  for (size_t step = 0; stepMesh(step, *mesh); ++step) {
+    const auto delta = tracker.update(step, *graph);
+    const auto buffer = delta.encode(true);
+    const auto result = GraphDelta::decode(buffer.data(), buffer.size());
+    ASSERT_TRUE(result) << "step " << step;
+    ASSERT_TRUE(applier.apply(*result)) << "step " << step;
+    ASSERT_TRUE(applier.graph()->mesh()) << "step " << step;
+    expectMeshesEqual(*mesh, *applier.graph()->mesh());
+    if (step == 0) {
+      EXPECT_TRUE(delta.keyframe);
+      continue;
+    }
+
+    if (step == 2) {
+      EXPECT_FALSE(delta.mesh_update);
+      continue;
+    }
+
+    ASSERT_TRUE(delta.mesh_update) << "step " << step;
+    const auto& update = *delta.mesh_update;
+    const auto tail = delta.graph->mesh();
+    ASSERT_TRUE(tail);
+    EXPECT_EQ(tail->numVertices(), update.num_vertices - update.vertex_offset);
+    EXPECT_EQ(tail->numFaces(), update.num_faces - update.face_offset);
+    if (step == 1) {
+      EXPECT_EQ(update.vertex_offset, 4u);
+      EXPECT_EQ(update.face_offset, 1u);
+    } else if (step == 3) {
+      EXPECT_EQ(update.vertex_offset, 3u);
+      EXPECT_EQ(update.face_offset, 3u);
+    } else if (step == 4) {
+      EXPECT_EQ(update.vertex_offset, 5u);
+      EXPECT_EQ(update.face_offset, 2u);
+      EXPECT_EQ(tail->numVertices(), 0u);
+    } else if (step == 5) {
+      EXPECT_EQ(update.vertex_offset, 5u);
+      EXPECT_EQ(update.face_offset, 0u);
+    }
+  }
+
+  // the receiver's mesh is not shared with the sender
+  EXPECT_NE(applier.graph()->mesh(), mesh);
+}
+
+TEST(ZmqSink, DeltaStreamReconstructsGraph) {
+  ZmqSink::Config config;
+  config.url = "inproc://hydra_test_graph_deltas";
+  config.send_mesh = false;
+  config.send_deltas = true;
+  config.keyframe_interval = 3;
+  ZmqSink sink(config);
+  ZmqGraphDeltaReceiver receiver(config.url);
+  // give the subscription time to reach the publisher
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  auto graph = test::makeSharedDsg()->graph;
+  kimera_pgmo::DeformationGraph dgraph;
+  for (size_t step = 0; stepGraph(step, *graph); ++step) {
+    sink.call(step, *graph, dgraph);
+    ASSERT_TRUE(receiver.recv(1000)) << "step " << step;
+    ASSERT_TRUE(receiver.graph());
+    expectGraphsEqual(*graph, *receiver.graph());
+  }
+}
+
+}  // namespace hydra
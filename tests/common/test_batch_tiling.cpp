@@ -0,0 +1,154 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/common/batch_tiling.h>
+
+namespace hydra {
+
+namespace {
+
+void addPlace(DynamicSceneGraph& graph, NodeId node_id, const Eigen::Vector3d& pos) {
+  auto attrs = std::make_unique<PlaceNodeAttributes>(1.0, 0);
+  attrs->position = pos;
+  graph.emplaceNode(DsgLayers::PLACES, node_id, std::move(attrs));
+}
+
+void addVertices(spark_dsg::Mesh& mesh, const std::vector<Eigen::Vector3f>& points) {
+  const auto offset = mesh.numVertices();
+  mesh.resizeVertices(offset + points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    mesh.setPos(offset + i, points[i]);
+  }
+}
+
+}  // namespace
+
+TEST(BatchTiling, PartitionCoversMap) {
+  VolumetricMap::Config map_config;
+  map_config.voxel_size = 0.1;
+  map_config.voxels_per_side = 10;
+  VolumetricMap map(map_config);
+  for (int x = -4; x < 2; ++x) {
+    for (int y = -2; y < 2; ++y) {
+      map.allocateBlock(BlockIndex(x, y, 0));
+    }
+  }
+
+  BatchTilingConfig tiling;
+  tiling.tile_size_m = 2.0;
+  tiling.overlap_m = 1.0;
+  const MapTiler tiler(tiling, map.blockSize());
+  const auto tiles = tiler.partition(map);
+  ASSERT_EQ(tiles.size(), 6u);
+
+  size_t num_core = 0;
+  for (const auto& tile : tiles) {
+    num_core += tile.core.size();
+    EXPECT_EQ(tile.core.size(), 4u);
+    for (const auto& block : tile.core) {
+      const Eigen::Vector3d center = (block.cast<double>().array() + 0.5).matrix();
+      EXPECT_EQ(tiler.tileIndex(center), tile.index);
+    }
+
+    // every block within one block of the tile is included
+    for (const auto& block : tile.blocks) {
+      EXPECT_GE(block.x(), 2 * tile.index.x() - 1);
+      EXPECT_LE(block.x(), 2 * tile.index.x() + 2);
+      EXPECT_GE(block.y(), 2 * tile.index.y() - 1);
+      EXPECT_LE(block.y(), 2 * tile.index.y() + 2);
+    }
+  }
+
+  EXPECT_EQ(num_core, 24u);
+  // corner tile with overlap into two neighbors and the shared diagonal block
+  EXPECT_EQ(tiles.front().index, BlockIndex(-2, -1, 0));
+  EXPECT_EQ(tiles.front().blocks.size(), 9u);
+}
+
+TEST(BatchTiling, StitchAcrossSeam) {
+  BatchTilingConfig tiling;
+  tiling.tile_size_m = 1.0;
+  tiling.overlap_m = 1.0;
+  const MapTiler tiler(tiling, 1.0);
+  const std::vector<MapTile> tiles{{BlockIndex(0, 0, 0), {}, {}},
+                                   {BlockIndex(1, 0, 0), {}, {}}};
+
+  // both tiles see the place on the other side of the seam
+  auto first = std::make_shared<DynamicSceneGraph>();
+  addPlace(*first, "p0"_id, {0.5, 0.5, 0.0});
+  addPlace(*first, "p1"_id, {1.2, 0.5, 0.0});
+  first->insertEdge("p0"_id, "p1"_id);
+
+  auto second = std::make_shared<DynamicSceneGraph>();
+  addPlace(*second, "p0"_id, {1.2, 0.5, 0.0});
+  addPlace(*second, "p1"_id, {0.5, 0.5, 0.0});
+  addPlace(*second, "p2"_id, {1.8, 0.5, 0.0});
+  second->insertEdge("p0"_id, "p1"_id);
+  second->insertEdge("p0"_id, "p2"_id);
+
+  // one face per tile and one face split by the seam that both tiles produce
+  first->setMesh(std::make_shared<spark_dsg::Mesh>());
+  addVertices(*first->mesh(), {{0.1, 0.1, 0.0}, {0.2, 0.1, 0.0}, {0.1, 0.2, 0.0}});
+  addVertices(*first->mesh(), {{0.9, 0.1, 0.0}, {1.3, 0.1, 0.0}, {1.3, 0.2, 0.0}});
+  first->mesh()->resizeFaces(2);
+  first->mesh()->face(0) = {0, 1, 2};
+  first->mesh()->face(1) = {3, 4, 5};
+
+  second->setMesh(std::make_shared<spark_dsg::Mesh>());
+  addVertices(*second->mesh(), {{0.9, 0.1, 0.0}, {1.3, 0.1, 0.0}, {1.3, 0.2, 0.0}});
+  addVertices(*second->mesh(), {{1.5, 0.1, 0.0}, {1.6, 0.1, 0.0}});
+  second->mesh()->resizeFaces(2);
+  second->mesh()->face(0) = {0, 1, 2};
+  second->mesh()->face(1) = {3, 4, 2};
+
+  DynamicSceneGraph output;
+  output.setMesh(std::make_shared<spark_dsg::Mesh>());
+  tiler.stitch(tiles, {first, second}, output);
+
+  const auto& places = output.getLayer(DsgLayers::PLACES);
+  EXPECT_EQ(places.numNodes(), 3u);
+  EXPECT_NEAR(output.getNode("p0"_id).attributes().position.x(), 0.5, 1.0e-9);
+  EXPECT_NEAR(output.getNode("p1"_id).attributes().position.x(), 1.2, 1.0e-9);
+  EXPECT_NEAR(output.getNode("p2"_id).attributes().position.x(), 1.8, 1.0e-9);
+  EXPECT_EQ(places.numEdges(), 2u);
+  EXPECT_TRUE(output.hasEdge("p0"_id, "p1"_id));
+  EXPECT_TRUE(output.hasEdge("p1"_id, "p2"_id));
+
+  const auto mesh = output.mesh();
+  EXPECT_EQ(mesh->numFaces(), 3u);
+  EXPECT_EQ(mesh->numVertices(), 8u);
+}
+
+}  // namespace hydra
@@ -0,0 +1,161 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/active_window/active_window_output.h>
+#include <hydra/frontend/frontier_extractor.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+#include <spark_dsg/node_attributes.h>
+#include <spark_dsg/node_symbol.h>
+
+namespace hydra {
+
+using namespace spark_dsg;
+
+namespace {
+
+struct FrontierPoint {
+  double x;
+  double y;
+  double z;
+  bool operator<(const FrontierPoint& other) const {
+    return std::tie(x, y, z) < std::tie(other.x, other.y, other.z);
+  }
+  bool operator==(const FrontierPoint& other) const {
+    return x == other.x && y == other.y && z == other.z;
+  }
+};
+
+std::shared_ptr<VolumetricMap> makeMap() {
+  VolumetricMap::Config config;
+  config.voxel_size = 0.1f;
+  config.voxels_per_side = 8;
+  config.truncation_distance = 0.3f;
+  auto map = std::make_shared<VolumetricMap>(config);
+
+  // observe everything below x = 0.6 in two neighboring blocks
+  auto& tsdf = map->getTsdfLayer();
+  for (const auto& index : {BlockIndex(0, 0, 0), BlockIndex(1, 0, 0)}) {
+    auto& block = tsdf.allocateBlock(index);
+    for (size_t i = 0; i < block.numVoxels(); ++i) {
+      if (block.getVoxelPosition(i).x() < 0.6f) {
+        block.getVoxel(i).weight = 1.0f;
+      }
+    }
+  }
+
+  return map;
+}
+
+void addPlaces(DynamicSceneGraph& graph, NodeIdSet& active) {
+  for (size_t i = 0; i < 2; ++i) {
+    auto attrs = std::make_unique<PlaceNodeAttributes>(0.5 + 0.2 * i, 0);
+    attrs->position << 0.3 + 0.5 * i, 0.4, 0.4;
+    attrs->is_active = true;
+    graph.emplaceNode(DsgLayers::PLACES, NodeSymbol('p', i), std::move(attrs));
+    active.insert(NodeSymbol('p', i));
+  }
+}
+
+std::vector<FrontierPoint> getFrontiers(const DynamicSceneGraph& graph) {
+  std::vector<FrontierPoint> points;
+  for (const auto& [node_id, node] : graph.getLayer(DsgLayers::PLACES).nodes()) {
+    const auto& attrs = node->attributes<PlaceNodeAttributes>();
+    if (attrs.real_place) {
+      continue;
+    }
+
+    points.push_back({attrs.position.x(), attrs.position.y(), attrs.position.z()});
+  }
+
+  std::sort(points.begin(), points.end());
+  return points;
+}
+
+std::vector<FrontierPoint> runExtractor(int num_threads, size_t num_updates) {
+  FrontierExtractor::Config config;
+  config.dense_frontiers = true;
+  config.num_threads = num_threads;
+  FrontierExtractor extractor(config);
+
+  DynamicSceneGraph graph;
+  NodeIdSet active;
+  addPlaces(graph, active);
+
+  ActiveWindowOutput msg;
+  msg.world_t_body << 0.0, 0.0, 0.3;
+  msg.world_R_body = Eigen::Quaterniond::Identity();
+  msg.setMap(makeMap());
+  extractor.detectFrontiers(msg, graph, active);
+
+  // later updates without any changed blocks reuse the cached blocks
+  for (size_t i = 1; i < num_updates; ++i) {
+    const auto config = msg.map().config;
+    msg.setMap(std::make_shared<VolumetricMap>(config));
+    extractor.detectFrontiers(msg, graph, active);
+  }
+
+  extractor.addFrontiers(0, graph);
+  return getFrontiers(graph);
+}
+
+}  // namespace
+
+TEST(FrontierExtractor, DenseFrontiersCorrect) {
+  const auto frontiers = runExtractor(1, 1);
+  ASSERT_FALSE(frontiers.empty());
+
+  DynamicSceneGraph graph;
+  NodeIdSet active;
+  addPlaces(graph, active);
+  for (const auto& point : frontiers) {
+    // frontiers are inside the z band around the robot and outside of all places
+    EXPECT_GE(point.z, 0.1);
+    EXPECT_LE(point.z, 1.3);
+    const Eigen::Vector3d pos(point.x, point.y, point.z);
+    for (const auto node_id : active) {
+      const auto& attrs = graph.getNode(node_id).attributes<PlaceNodeAttributes>();
+      EXPECT_GT((pos - attrs.position).norm(), attrs.distance - 1.0e-6);
+    }
+  }
+}
+
+TEST(FrontierExtractor, ParallelMatchesSequential) {
+  const auto expected = runExtractor(1, 1);
+  EXPECT_EQ(runExtractor(4, 1), expected);
+  EXPECT_EQ(runExtractor(1, 3), expected);
+  EXPECT_EQ(runExtractor(4, 3), expected);
+}
+
+}  // namespace hydra
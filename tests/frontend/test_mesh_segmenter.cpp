@@ -38,6 +38,8 @@
 #include <hydra/utils/pgmo_mesh_traits.h>
 #include <kimera_pgmo/mesh_delta.h>
 
+#include <random>
+
 namespace hydra {
 
 using kimera_pgmo::MeshDelta;
@@ -101,8 +103,81 @@ void addPoints(MeshDelta& delta,
   }
 }
 
+// reference euclidean clustering via exhaustive search
+Clusters bruteForceClusters(const clustering::ClusteringConfig& config,
+                            const std::vector<Eigen::Vector3f>& points) {
+  std::vector<int> labels(points.size(), -1);
+  Clusters components;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (labels[i] >= 0) {
+      continue;
+    }
+
+    auto& component = components.emplace_back(std::vector<size_t>{i});
+    labels[i] = components.size() - 1;
+    for (size_t k = 0; k < component.size(); ++k) {
+      const auto& curr = points[component[k]];
+      for (size_t j = 0; j < points.size(); ++j) {
+        if (labels[j] < 0 && (curr - points[j]).norm() <= config.cluster_tolerance) {
+          labels[j] = labels[i];
+          component.push_back(j);
+        }
+      }
+    }
+  }
+
+  Clusters clusters;
+  for (auto& component : components) {
+    if (component.size() >= config.min_cluster_size &&
+        component.size() <= config.max_cluster_size) {
+      std::sort(component.begin(), component.end());
+      clusters.push_back(component);
+    }
+  }
+
+  std::sort(clusters.begin(), clusters.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.size() == rhs.size() ? lhs.front() < rhs.front()
+                                    : lhs.size() > rhs.size();
+  });
+  return clusters;
+}
+
 }  // namespace
 
+TEST(MeshSegmenter, IncrementalClustersMatchBruteForce) {
+  clustering::ClusteringConfig config;
+  config.cluster_tolerance = 0.3;
+  config.min_cluster_size = 3;
+  config.max_cluster_size = 200;
+  clustering::IncrementalClusters clusters(config);
+
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<float> dist(0.0f, 5.0f);
+  std::vector<Eigen::Vector3f> points;
+  for (size_t i = 0; i < 300; ++i) {
+    points.emplace_back(dist(gen), dist(gen), 0.2f * dist(gen));
+  }
+
+  for (size_t step = 0; step < 20; ++step) {
+    // vertex order changes between mesh updates, and vertices are added and removed
+    std::shuffle(points.begin(), points.end(), gen);
+    points.resize(points.size() - 20);
+    for (size_t i = 0; i < 25; ++i) {
+      points.emplace_back(dist(gen), dist(gen), 0.2f * dist(gen));
+    }
+
+    // duplicated vertices are tracked as one point
+    points.push_back(points.front());
+
+    const auto result = clusters.update(points);
+    EXPECT_EQ(result, bruteForceClusters(config, points)) << "step: " << step;
+    if (step > 0) {
+      // only new points and points from clusters that lost points get linked
+      EXPECT_LT(clusters.numLinked(), clusters.size()) << "step: " << step;
+    }
+  }
+}
+
 TEST(MeshSegmenter, TestClustering) {
   MeshSegmenter::Config config;
   config.clustering.min_cluster_size = 4;
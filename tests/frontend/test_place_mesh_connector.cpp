@@ -0,0 +1,263 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * all rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/frontend/place_mesh_connector.h>
+#include <kimera_pgmo/mesh_delta.h>
+
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace hydra {
+
+using kimera_pgmo::MeshDelta;
+
+namespace {
+
+struct TestConnector : public PlaceMeshConnector {
+  explicit TestConnector(const Config& config) : PlaceMeshConnector(config) {}
+
+  void corruptMatches() {
+    for (auto& [node_id, cache] : cache_) {
+      for (auto& entry : cache) {
+        if (entry.match) {
+          entry.match->slot = std::numeric_limits<size_t>::max();
+        }
+      }
+    }
+  }
+};
+
+void addVertices(MeshDelta& delta, const std::vector<Eigen::Vector3f>& points) {
+  for (const auto& point : points) {
+    kimera_pgmo::traits::VertexTraits traits;
+    traits.properties.has_label = true;
+    traits.label = 1;
+    delta.addVertex(point, traits, false);
+  }
+}
+
+std::vector<Eigen::Vector3f> randomPoints(std::mt19937& gen,
+                                          size_t num_points,
+                                          const Eigen::Vector3f& min,
+                                          const Eigen::Vector3f& max) {
+  std::vector<Eigen::Vector3f> points;
+  for (size_t i = 0; i < num_points; ++i) {
+    Eigen::Vector3f point;
+    for (int j = 0; j < 3; ++j) {
+      point(j) = std::uniform_real_distribution<float>(min(j), max(j))(gen);
+    }
+    points.push_back(point);
+  }
+  return points;
+}
+
+void addPlace(SceneGraphLayer& places,
+              NodeId node_id,
+              const std::vector<Eigen::Vector3d>& connections) {
+  auto attrs = std::make_unique<PlaceNodeAttributes>(0.0, 0.0);
+  attrs->is_active = true;
+  for (const auto& pos : connections) {
+    auto& info = attrs->voxblox_mesh_connections.emplace_back();
+    info.voxel_pos[0] = pos.x();
+    info.voxel_pos[1] = pos.y();
+    info.voxel_pos[2] = pos.z();
+  }
+
+  places.emplaceNode(node_id, std::move(attrs));
+}
+
+// check every connection against the nearest vertex by exhaustive search
+void checkConnections(const MeshDelta& delta,
+                      const SceneGraphLayer& places,
+                      const PlaceMeshConnector::DeformationMapping& mapping) {
+  for (const auto& [node_id, node] : places.nodes()) {
+    const auto& attrs = node->attributes<PlaceNodeAttributes>();
+    const auto& connections = attrs.voxblox_mesh_connections;
+    ASSERT_EQ(attrs.pcl_mesh_connections.size(), connections.size());
+    ASSERT_EQ(attrs.deformation_connections.size(), connections.size());
+    for (size_t i = 0; i < connections.size(); ++i) {
+      const Eigen::Vector3d pos =
+          Eigen::Map<const Eigen::Vector3d>(connections[i].voxel_pos);
+      double expected = std::numeric_limits<double>::infinity();
+      for (size_t j = 0; j < delta.getNumVertices(); ++j) {
+        const auto& vertex = delta.getVertex(j).pos;
+        expected = std::min(expected, (vertex.cast<double>() - pos).norm());
+      }
+
+      const auto index = attrs.pcl_mesh_connections.at(i);
+      ASSERT_LT(index, delta.getNumVertices());
+      EXPECT_EQ(connections[i].vertex, index);
+      EXPECT_EQ(attrs.deformation_connections.at(i), mapping.at(index));
+      const auto result = (delta.getVertex(index).pos.cast<double>() - pos).norm();
+      EXPECT_NEAR(result, expected, 1.0e-6)
+          << "place " << node_id << ", connection " << i;
+    }
+  }
+}
+
+PlaceMeshConnector::DeformationMapping makeMapping(const MeshDelta& delta) {
+  PlaceMeshConnector::DeformationMapping mapping(delta.getNumVertices());
+  std::iota(mapping.begin(), mapping.end(), 100);
+  return mapping;
+}
+
+}  // namespace
+
+TEST(PlaceMeshConnector, MatchesNearestVertex) {
+  PlaceMeshConnector::Config config;
+  config.cell_size = 0.1;
+  config.max_search_rings = 1;
+  config.num_threads = 4;
+  PlaceMeshConnector connector(config);
+
+  std::mt19937 gen(1234);
+  const auto points = randomPoints(gen, 500, {0, 0, 0}, {2, 2, 2});
+  MeshDelta delta({0, 0, 0});
+  addVertices(delta, points);
+  const auto mapping = makeMapping(delta);
+
+  // connections far from the mesh need to fall back to checking every cell
+  SceneGraphLayer places(DsgLayers::PLACES);
+  for (NodeId i = 0; i < 50; ++i) {
+    const auto connections = randomPoints(gen, 3, {-1, -1, -1}, {3, 3, 3});
+    std::vector<Eigen::Vector3d> positions;
+    for (const auto& pos : connections) {
+      positions.push_back(pos.cast<double>());
+    }
+    addPlace(places, i, positions);
+  }
+
+  connector.addConnections(delta, places, mapping);
+  EXPECT_EQ(connector.numSearched(), 50u);
+  checkConnections(delta, places, mapping);
+}
+
+TEST(PlaceMeshConnector, ReusesUnchangedPlaces) {
+  PlaceMeshConnector::Config config;
+  config.cell_size = 0.1;
+  config.block_ratio = 4;
+  config.max_search_rings = 2;
+  config.num_threads = 2;
+  PlaceMeshConnector connector(config);
+
+  std::mt19937 gen(4321);
+  const auto near_points = randomPoints(gen, 200, {0, 0, 0}, {1, 1, 1});
+  const auto far_points = randomPoints(gen, 200, {5, 5, 5}, {6, 6, 6});
+
+  SceneGraphLayer places(DsgLayers::PLACES);
+  const Eigen::Vector3d offset = Eigen::Vector3d::Constant(0.01);
+  for (NodeId i = 0; i < 10; ++i) {
+    addPlace(places, i, {near_points[i].cast<double>() + offset});
+    addPlace(places, 10 + i, {far_points[i].cast<double>() + offset});
+  }
+
+  {  // initial delta: everything is searched
+    MeshDelta delta({0, 0, 0});
+    addVertices(delta, near_points);
+    addVertices(delta, far_points);
+    const auto mapping = makeMapping(delta);
+    connector.addConnections(delta, places, mapping);
+    EXPECT_EQ(connector.numSearched(), 20u);
+    checkConnections(delta, places, mapping);
+  }
+
+  {  // new vertices far away shift all indices, but no place needs to be searched
+    MeshDelta delta({0, 0, 0});
+    addVertices(delta, randomPoints(gen, 50, {20, 20, 20}, {21, 21, 21}));
+    addVertices(delta, near_points);
+    addVertices(delta, far_points);
+    const auto mapping = makeMapping(delta);
+    connector.addConnections(delta, places, mapping);
+    EXPECT_EQ(connector.numSearched(), 0u);
+    checkConnections(delta, places, mapping);
+  }
+
+  {  // vertices changing near the far places invalidate only those places
+    auto moved_points = far_points;
+    for (auto& point : moved_points) {
+      point += Eigen::Vector3f::Constant(0.005);
+    }
+
+    MeshDelta delta({0, 0, 0});
+    addVertices(delta, near_points);
+    addVertices(delta, moved_points);
+    const auto mapping = makeMapping(delta);
+    connector.addConnections(delta, places, mapping);
+    EXPECT_EQ(connector.numSearched(), 10u);
+    checkConnections(delta, places, mapping);
+  }
+
+  {  // moving a voxel connection invalidates the place
+    auto& attrs = places.getNode(0).attributes<PlaceNodeAttributes>();
+    attrs.voxblox_mesh_connections[0].voxel_pos[0] += 0.3;
+
+    MeshDelta delta({0, 0, 0});
+    addVertices(delta, near_points);
+    addVertices(delta, far_points);
+    addVertices(delta, {Eigen::Vector3f(20, 20, 20)});
+    const auto mapping = makeMapping(delta);
+    connector.addConnections(delta, places, mapping);
+    checkConnections(delta, places, mapping);
+  }
+}
+
+TEST(PlaceMeshConnector, InvalidCacheIsSearchedAgain) {
+  PlaceMeshConnector::Config config;
+  config.num_threads = 2;
+  TestConnector connector(config);
+
+  std::mt19937 gen(5678);
+  const auto points = randomPoints(gen, 100, {0, 0, 0}, {1, 1, 1});
+  MeshDelta delta({0, 0, 0});
+  addVertices(delta, points);
+  const auto mapping = makeMapping(delta);
+
+  SceneGraphLayer places(DsgLayers::PLACES);
+  for (NodeId i = 0; i < 5; ++i) {
+    addPlace(places, i, {points[i].cast<double>()});
+  }
+
+  connector.addConnections(delta, places, mapping);
+  checkConnections(delta, places, mapping);
+
+  // stale matches should be searched again instead of throwing
+  connector.corruptMatches();
+  connector.addConnections(delta, places, mapping);
+  EXPECT_EQ(connector.numSearched(), 5u);
+  checkConnections(delta, places, mapping);
+}
+
+}  // namespace hydra
@@ -0,0 +1,279 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * all rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <config_utilities/factory.h>
+#include <gtest/gtest.h>
+#include <hydra/common/pipeline_queues.h>
+#include <hydra/frontend/view_database.h>
+#include <hydra/input/camera.h>
+#include <hydra/input/lidar.h>
+
+#include <random>
+
+#include "hydra_test/shared_dsg_fixture.h"
+
+namespace hydra {
+
+namespace {
+
+std::unique_ptr<Camera> makeTestCamera(double max_range) {
+  Camera::Config config;
+  config.min_range = 0.1;
+  config.max_range = max_range;
+  config.width = 640;
+  config.height = 480;
+  config.cx = config.width / 2.0f;
+  config.cy = config.height / 2.0f;
+  config.fx = config.width / 2.0;
+  config.fy = config.height / 2.0;
+  config.extrinsics = ParamSensorExtrinsics::Config();
+  return std::make_unique<Camera>(config, "");
+}
+
+std::vector<FeatureView::Ptr> makeRandomViews(const Sensor& sensor,
+                                              size_t num_views,
+                                              std::mt19937& gen) {
+  std::uniform_real_distribution<double> pos_dist(-10.0, 10.0);
+  std::uniform_real_distribution<double> feature_dist(0.0, 1.0);
+  std::vector<FeatureView::Ptr> views;
+  for (size_t i = 0; i < num_views; ++i) {
+    Eigen::Isometry3d world_T_sensor = Eigen::Isometry3d::Identity();
+    world_T_sensor.translation() << pos_dist(gen), pos_dist(gen), pos_dist(gen);
+    const Eigen::Vector3d axis(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+    world_T_sensor.linear() =
+        Eigen::AngleAxisd(feature_dist(gen) * M_PI, axis.normalized()).matrix();
+    FeatureVector feature(3);
+    feature << feature_dist(gen), feature_dist(gen), feature_dist(gen);
+    views.push_back(std::make_unique<FeatureView>(
+        i, world_T_sensor.inverse(), feature, &sensor));
+  }
+
+  return views;
+}
+
+std::unique_ptr<Lidar> makeTestLidar(double max_range) {
+  Lidar::Config config;
+  config.min_range = 0.1;
+  config.max_range = max_range;
+  config.horizontal_fov = 360.0;
+  config.horizontal_resolution = 360.0 / 640.0;
+  config.vertical_fov = 30.0;
+  config.vertical_resolution = 30.0 / 32.0;
+  config.extrinsics = ParamSensorExtrinsics::Config();
+  return std::make_unique<Lidar>(config, "");
+}
+
+FeatureView::Ptr copyView(const FeatureView& view) {
+  return std::make_unique<FeatureView>(
+      view.timestamp_ns, view.sensor_T_world, view.feature, &view.sensor());
+}
+
+struct TestViewDatabase : public ViewDatabase {
+  explicit TestViewDatabase(const Config& config) : ViewDatabase(config) {}
+
+  size_t numIndexedCells() const { return view_index_.size(); }
+  size_t numUnboundedViews() const { return unbounded_views_.size(); }
+};
+
+}  // namespace
+
+TEST(ViewDatabase, CandidatesContainVisibleViews) {
+  std::mt19937 gen(12345);
+  const auto camera = makeTestCamera(3.0);
+  const auto views = makeRandomViews(*camera, 50, gen);
+
+  auto& queue = PipelineQueues::instance().input_features_queue;
+  for (const auto& view : views) {
+    queue.push(copyView(*view));
+  }
+
+  ViewDatabase::Config config;
+  config.layers = {DsgLayers::PLACES};
+  config.index_cell_size = 1.5;
+  config.inflation_distance = 0.2;
+  ViewDatabase database(config);
+
+  auto dsg = test::makeSharedDsg();
+  database.updateAssignments(*dsg->graph, [](const auto&, uint64_t) { return false; });
+
+  std::uniform_real_distribution<double> pos_dist(-12.0, 12.0);
+  size_t num_visible = 0;
+  for (size_t i = 0; i < 500; ++i) {
+    const Eigen::Vector3d pos(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+    const auto candidates = database.getCandidates(pos);
+    EXPECT_LE(candidates.size(), views.size());
+
+    std::vector<uint64_t> candidate_stamps;
+    for (const auto view : candidates) {
+      candidate_stamps.push_back(view->timestamp_ns);
+    }
+
+    // candidates are always in the order the views were received
+    EXPECT_TRUE(std::is_sorted(candidate_stamps.begin(), candidate_stamps.end()));
+
+    for (const auto& view : views) {
+      if (!view->pointInView(pos, config.inflation_distance)) {
+        continue;
+      }
+
+      ++num_visible;
+      EXPECT_TRUE(std::count(
+          candidate_stamps.begin(), candidate_stamps.end(), view->timestamp_ns))
+          << "view " << view->timestamp_ns << " missing for point "
+          << pos.transpose();
+    }
+  }
+
+  // make sure the test isn't vacuous
+  EXPECT_GT(num_visible, 0u);
+}
+
+TEST(ViewDatabase, AssignmentsMatchBruteForce) {
+  std::mt19937 gen(54321);
+  const auto camera = makeTestCamera(4.0);
+  const auto views = makeRandomViews(*camera, 40, gen);
+
+  auto& queue = PipelineQueues::instance().input_features_queue;
+  ViewSelector::FeatureList all_views;
+  for (const auto& view : views) {
+    queue.push(copyView(*view));
+    all_views.push_back(copyView(*view));
+  }
+
+  ViewDatabase::Config config;
+  config.view_selection_method = "closest";
+  config.layers = {DsgLayers::PLACES};
+  ViewDatabase database(config);
+
+  auto dsg = test::makeSharedDsg();
+  auto& graph = *dsg->graph;
+  std::uniform_real_distribution<double> pos_dist(-10.0, 10.0);
+  for (size_t i = 0; i < 200; ++i) {
+    auto attrs = std::make_unique<PlaceNodeAttributes>(1.0, 2);
+    attrs->position << pos_dist(gen), pos_dist(gen), pos_dist(gen);
+    attrs->is_active = true;
+    graph.emplaceNode(DsgLayers::PLACES, NodeSymbol('p', i), std::move(attrs));
+  }
+
+  // archive the first few views to exercise removing views from the index
+  const auto should_archive = [](const auto&, uint64_t stamp) { return stamp < 5; };
+  database.updateAssignments(graph, should_archive);
+  all_views.erase(all_views.begin(), std::next(all_views.begin(), 5));
+
+  const auto selector = config::create<ViewSelector>("closest");
+  size_t num_assigned = 0;
+  for (const auto& [node_id, node] : graph.findLayer(DsgLayers::PLACES)->nodes()) {
+    const auto& result = node->attributes<PlaceNodeAttributes>();
+    PlaceNodeAttributes expected(1.0, 2);
+    expected.position = result.position;
+    selector->selectFeature(all_views, config.inflation_distance, expected);
+    ASSERT_EQ(expected.semantic_feature.size(), result.semantic_feature.size())
+        << "node: " << NodeSymbol(node_id).str();
+    if (expected.semantic_feature.size()) {
+      ++num_assigned;
+      EXPECT_TRUE(expected.semantic_feature.isApprox(result.semantic_feature));
+    }
+  }
+
+  EXPECT_GT(num_assigned, 0u);
+}
+
+TEST(ViewDatabase, IndexSkipsCellsOutsideFrustum) {
+  const auto camera = makeTestCamera(10.0);
+  auto& queue = PipelineQueues::instance().input_features_queue;
+  queue.push(std::make_unique<FeatureView>(
+      0, Eigen::Isometry3d::Identity(), FeatureVector::Zero(3), camera.get()));
+
+  ViewDatabase::Config config;
+  config.layers = {DsgLayers::PLACES};
+  TestViewDatabase database(config);
+  auto dsg = test::makeSharedDsg();
+  database.updateAssignments(*dsg->graph, [](const auto&, uint64_t) { return false; });
+
+  EXPECT_EQ(database.numUnboundedViews(), 0u);
+  EXPECT_EQ(database.getCandidates(Eigen::Vector3d(0.0, 0.0, 8.0)).size(), 1u);
+  // points behind the camera are inside the range sphere but never visible
+  EXPECT_TRUE(database.getCandidates(Eigen::Vector3d(0.0, 0.0, -8.0)).empty());
+  EXPECT_TRUE(database.getCandidates(Eigen::Vector3d(8.0, 0.0, 0.0)).empty());
+}
+
+TEST(ViewDatabase, LongRangeViewsStayBounded) {
+  std::mt19937 gen(6789);
+  const auto lidar = makeTestLidar(100.0);
+  const auto views = makeRandomViews(*lidar, 10, gen);
+
+  auto& queue = PipelineQueues::instance().input_features_queue;
+  for (const auto& view : views) {
+    queue.push(copyView(*view));
+  }
+
+  ViewDatabase::Config config;
+  config.layers = {DsgLayers::PLACES};
+  config.inflation_distance = 0.5;
+  TestViewDatabase database(config);
+  auto dsg = test::makeSharedDsg();
+  database.updateAssignments(*dsg->graph, [](const auto&, uint64_t) { return false; });
+
+  // views spanning too many cells are checked for every query instead of indexed
+  EXPECT_EQ(database.numIndexedCells(), 0u);
+  EXPECT_EQ(database.numUnboundedViews(), views.size());
+
+  std::uniform_real_distribution<double> pos_dist(-100.0, 100.0);
+  size_t num_visible = 0;
+  for (size_t i = 0; i < 200; ++i) {
+    const Eigen::Vector3d pos(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+    const auto candidates = database.getCandidates(pos);
+    for (const auto& view : views) {
+      if (!view->pointInView(pos, config.inflation_distance)) {
+        continue;
+      }
+
+      ++num_visible;
+      const auto iter = std::find_if(
+          candidates.begin(), candidates.end(), [&](const FeatureView* candidate) {
+            return candidate->timestamp_ns == view->timestamp_ns;
+          });
+      EXPECT_TRUE(iter != candidates.end())
+          << "view " << view->timestamp_ns << " missing for point "
+          << pos.transpose();
+    }
+  }
+
+  EXPECT_GT(num_visible, 0u);
+
+  database.updateAssignments(*dsg->graph, [](const auto&, uint64_t) { return true; });
+  EXPECT_EQ(database.numUnboundedViews(), 0u);
+}
+
+}  // namespace hydra
@@ -34,16 +34,33 @@
  * -------------------------------------------------------------------------- */
 #include <glog/logging.h>
 #include <gtest/gtest.h>
-#include <ros/package.h>
 
 #include "hydra/gnn/gnn_interface.h"
+#include "hydra/gnn/graph_batch.h"
+#include "hydra_test/resources.h"
 
 namespace hydra::gnn {
 
-TEST(GnnInterfaceTests, TestSimpleNetwork) {
-  std::string package_path = ros::package::getPath("hydra");
-  std::string model_path = package_path + "/src/gnn/tests/resources/simple_model.onnx";
+TensorMap makeChainGraph(int64_t num_nodes, float offset) {
+  Tensor x(num_nodes, 2);
+  auto x_map = x.map<float>();
+  for (int i = 0; i < x.rows(); ++i) {
+    x_map(i, 0) = i + offset;
+    x_map(i, 1) = 2.0f * i + offset;
+  }
 
+  Tensor edge_index(2, num_nodes - 1, Tensor::Type::INT64);
+  auto index_map = edge_index.map<int64_t>();
+  for (int i = 0; i < edge_index.cols(); ++i) {
+    index_map(0, i) = i;
+    index_map(1, i) = i + 1;
+  }
+
+  return {{"x", x}, {"edge_index", edge_index}};
+}
+
+TEST(GnnInterfaceTests, TestSimpleNetwork) {
+  const auto model_path = test::get_resource_path("gnn/simple_model.onnx");
   GnnInterface model(model_path, {{"output", {0}}});
 
   Tensor x(5, 2);
@@ -83,4 +100,74 @@ TEST(GnnInterfaceTests, TestSimpleNetwork) {
   EXPECT_NEAR(diff, 0.0, 1.0e-9);
 }
 
+TEST(GnnInterfaceTests, TestGraphBatchPacking) {
+  GraphBatch batch;
+  batch.pack({makeChainGraph(3, 0.0f), makeChainGraph(2, 5.0f)});
+  EXPECT_EQ(batch.size(), 2u);
+  EXPECT_EQ(batch.numNodes(), 5);
+  EXPECT_EQ(batch.numEdges(), 3);
+
+  auto x = batch.input().at("x");
+  ASSERT_EQ(x.rows(), 5);
+  EXPECT_NEAR(x.map<float>()(3, 0), 5.0f, 1.0e-9);
+  EXPECT_NEAR(x.map<float>()(4, 1), 7.0f, 1.0e-9);
+
+  auto edges = batch.input().at("edge_index");
+  Eigen::MatrixXi expected_edges(2, 3);
+  expected_edges << 0, 1, 3, 1, 2, 4;
+  EXPECT_EQ(Eigen::MatrixXi(edges.map<int64_t>().cast<int>()), expected_edges);
+
+  auto batch_vec = batch.input().at("batch");
+  const std::vector<int64_t> expected_batch{0, 0, 0, 1, 1};
+  const std::vector<int64_t> result(batch_vec.data<int64_t>(),
+                                    batch_vec.data<int64_t>() + batch_vec.size());
+  EXPECT_EQ(result, expected_batch);
+
+  // repacking the same shapes reuses the same buffers
+  const auto* prev_data = batch.input().at("x").data<float>();
+  x = Tensor();
+  edges = Tensor();
+  batch_vec = Tensor();
+  batch.pack({makeChainGraph(3, 1.0f), makeChainGraph(2, 2.0f)});
+  EXPECT_EQ(batch.input().at("x").data<float>(), prev_data);
+
+  Tensor node_output(5, 1);
+  node_output.map<float>() << 0.0f, 1.0f, 2.0f, 3.0f, 4.0f;
+  Tensor graph_output(2, 1);
+  graph_output.map<float>() << 10.0f, 20.0f;
+  const auto split = batch.unpack({{"nodes", node_output}, {"graphs", graph_output}});
+  ASSERT_EQ(split.size(), 2u);
+  EXPECT_EQ(split[0].at("nodes").rows(), 3);
+  EXPECT_EQ(split[1].at("nodes").rows(), 2);
+  auto second_nodes = split[1].at("nodes");
+  EXPECT_NEAR(second_nodes.map<float>()(1, 0), 4.0f, 1.0e-9);
+  auto second_graph = split[1].at("graphs");
+  EXPECT_NEAR(second_graph.map<float>()(0, 0), 20.0f, 1.0e-9);
+}
+
+TEST(GnnInterfaceTests, TestBatchedInference) {
+  GnnInterface::Config config;
+  config.model_path = test::get_resource_path("gnn/simple_model.onnx");
+  config.intra_op_threads = 2;
+  config.optimization_level = GnnInterface::OptimizationLevel::BASIC;
+  GnnInterface model(config, {{"output", {0}}});
+
+  const std::vector<TensorMap> graphs{
+      makeChainGraph(5, 1.0f), makeChainGraph(3, 2.0f), makeChainGraph(4, 0.5f)};
+
+  // run twice to exercise reusing input and output buffers
+  for (size_t iter = 0; iter < 2; ++iter) {
+    const auto results = model.batch(graphs);
+    ASSERT_EQ(results.size(), graphs.size());
+    for (size_t i = 0; i < graphs.size(); ++i) {
+      const auto num_nodes = graphs[i].at("x").rows();
+      auto expected = model(graphs[i], {num_nodes}).at("output");
+      auto result = results[i].at("output");
+      ASSERT_EQ(result.dims(), expected.dims());
+      const double diff = (expected.map<float>() - result.map<float>()).norm();
+      EXPECT_NEAR(diff, 0.0, 1.0e-6) << "graph " << i << ", iteration " << iter;
+    }
+  }
+}
+
 }  // namespace hydra::gnn
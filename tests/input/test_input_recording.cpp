@@ -0,0 +1,196 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/input/input_recording.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace hydra {
+
+namespace {
+
+bool matsEqual(const cv::Mat& lhs, const cv::Mat& rhs) {
+  if (lhs.empty() || rhs.empty()) {
+    return lhs.empty() && rhs.empty();
+  }
+
+  if (lhs.size() != rhs.size() || lhs.type() != rhs.type()) {
+    return false;
+  }
+
+  const size_t num_bytes = lhs.total() * lhs.elemSize();
+  return std::memcmp(lhs.data, rhs.data, num_bytes) == 0;
+}
+
+InputPacket makeImagePacket(uint64_t stamp) {
+  auto image = std::make_shared<ImageInputPacket>(stamp, "camera");
+  image->sensor_frame = "camera_frame";
+  image->depth = cv::Mat(3, 4, CV_32FC1);
+  image->labels = cv::Mat(3, 4, CV_32SC1);
+  image->color = cv::Mat(3, 4, CV_8UC3, cv::Scalar(1, 2, 3));
+  cv::randu(image->depth, 0.0f, 5.0f);
+  cv::randu(image->labels, 0, 10);
+  image->color_is_bgr = true;
+  image->input_feature = FeatureVector::Constant(4, 0.5f);
+  image->label_features[3] = FeatureVector::Constant(2, 1.0f);
+
+  InputPacket packet;
+  packet.timestamp_ns = stamp;
+  packet.sensor_input = image;
+  packet.world_t_body << 1.0, 2.0, 3.0;
+  packet.world_R_body = Eigen::Quaterniond(0.5, 0.5, -0.5, 0.5);
+  return packet;
+}
+
+}  // namespace
+
+TEST(InputRecording, RoundTrip) {
+  const auto filepath = std::filesystem::temp_directory_path() / "test_recording.bin";
+  const auto image_packet = makeImagePacket(10);
+
+  auto cloud = std::make_shared<CloudInputPacket>(20, "lidar");
+  cloud->in_world_frame = true;
+  cloud->points = cv::Mat(1, 5, CV_32FC3, cv::Scalar(1.0f, 2.0f, 3.0f));
+  cloud->labels = cv::Mat(1, 5, CV_32SC1, cv::Scalar(2));
+  InputPacket cloud_packet;
+  cloud_packet.timestamp_ns = 20;
+  cloud_packet.sensor_input = cloud;
+  cloud_packet.world_t_body << -1.0, 0.0, 1.0;
+  cloud_packet.world_R_body = Eigen::Quaterniond::Identity();
+
+  {  // scope to flush writer
+    InputPacketWriter writer(filepath);
+    ASSERT_TRUE(writer.good());
+    EXPECT_TRUE(writer.write(image_packet));
+    EXPECT_TRUE(writer.write(cloud_packet));
+    EXPECT_EQ(writer.numWritten(), 2u);
+  }
+
+  InputPacketReader reader(filepath);
+  ASSERT_TRUE(reader.good());
+  for (size_t pass = 0; pass < 2; ++pass) {
+    const auto first = reader.next();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first->timestamp_ns, 10u);
+    EXPECT_TRUE(first->world_t_body.isApprox(image_packet.world_t_body));
+    EXPECT_TRUE(first->world_R_body.isApprox(image_packet.world_R_body));
+    const auto image = std::dynamic_pointer_cast<ImageInputPacket>(first->sensor_input);
+    ASSERT_TRUE(image);
+    const auto& expected =
+        dynamic_cast<const ImageInputPacket&>(*image_packet.sensor_input);
+    EXPECT_EQ(image->timestamp_ns, 10u);
+    EXPECT_EQ(image->sensor_name, "camera");
+    EXPECT_EQ(image->sensor_frame, "camera_frame");
+    EXPECT_TRUE(image->color_is_bgr);
+    EXPECT_TRUE(matsEqual(image->depth, expected.depth));
+    EXPECT_TRUE(matsEqual(image->labels, expected.labels));
+    EXPECT_TRUE(matsEqual(image->color, expected.color));
+    EXPECT_TRUE(image->input_feature.isApprox(expected.input_feature));
+    ASSERT_EQ(image->label_features.size(), 1u);
+    EXPECT_TRUE(image->label_features.at(3).isApprox(expected.label_features.at(3)));
+
+    const auto second = reader.next();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second->timestamp_ns, 20u);
+    const auto result =
+        std::dynamic_pointer_cast<CloudInputPacket>(second->sensor_input);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->sensor_name, "lidar");
+    EXPECT_TRUE(result->in_world_frame);
+    EXPECT_TRUE(matsEqual(result->points, cloud->points));
+    EXPECT_TRUE(matsEqual(result->labels, cloud->labels));
+    EXPECT_TRUE(result->colors.empty());
+
+    EXPECT_FALSE(reader.next());
+    reader.rewind();
+  }
+
+  std::filesystem::remove(filepath);
+}
+
+TEST(InputRecording, InvalidRecording) {
+  const auto filepath = std::filesystem::temp_directory_path() / "test_invalid.bin";
+  {
+    std::ofstream out(filepath, std::ios::binary);
+    out << "not a recording";
+  }
+
+  InputPacketReader reader(filepath);
+  EXPECT_FALSE(reader.good());
+  EXPECT_FALSE(reader.next());
+
+  {  // truncate a valid recording in the middle of a packet
+    InputPacketWriter writer(filepath);
+    writer.write(makeImagePacket(10));
+  }
+
+  std::filesystem::resize_file(filepath, std::filesystem::file_size(filepath) - 8);
+  InputPacketReader truncated(filepath);
+  EXPECT_TRUE(truncated.good());
+  EXPECT_FALSE(truncated.next());
+  EXPECT_FALSE(truncated.good());
+  std::filesystem::remove(filepath);
+}
+
+TEST(InputRecording, CorruptSizes) {
+  const auto filepath = std::filesystem::temp_directory_path() / "test_corrupt.bin";
+  // offsets of the sensor name, input feature and color image sizes in the first packet
+  // (after the 12 byte file header and the 81 byte packet header)
+  const std::vector<std::streamoff> offsets{85, 119, 144};
+  for (const auto offset : offsets) {
+    {
+      InputPacketWriter writer(filepath);
+      ASSERT_TRUE(writer.write(makeImagePacket(10)));
+    }
+
+    {  // overwrite the size (or rows and columns) with values much larger than the file
+      std::fstream file(filepath, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(offset);
+      const uint64_t size = 0x7fffffff7fffffff;
+      file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+
+    InputPacketReader reader(filepath);
+    EXPECT_TRUE(reader.good());
+    EXPECT_FALSE(reader.next()) << "offset " << offset;
+    EXPECT_FALSE(reader.good());
+  }
+
+  std::filesystem::remove(filepath);
+}
+
+}  // namespace hydra
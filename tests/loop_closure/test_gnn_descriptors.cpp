@@ -36,18 +36,28 @@
 #include <gtest/gtest.h>
 #include <hydra/loop_closure/gnn_descriptors.h>
 
+#include <chrono>
+
 #include "hydra_test/resources.h"
 
 namespace hydra::lcd {
 
 namespace {
 
-inline const DynamicSceneGraphNode& makeDefaultAgentNode(DynamicSceneGraph& graph) {
+inline const SceneGraphNode& makeAgentNode(DynamicSceneGraph& graph, size_t index) {
   using namespace std::chrono_literals;
   Eigen::Quaterniond q = Eigen::Quaterniond::Identity();
   Eigen::Vector3d t = Eigen::Vector3d::Zero();
-  graph.emplaceNode(2, 'a', 10ns, std::make_unique<AgentNodeAttributes>(q, t, 0));
-  return graph.getDynamicNode(NodeSymbol('a', 0)).value();
+  const NodeSymbol agent_id('a', index);
+  graph.emplaceNode(2,
+                    agent_id,
+                    std::make_unique<AgentNodeAttributes>(10ns * (index + 1), q, t, 0),
+                    'a');
+  return graph.getNode(agent_id);
+}
+
+inline const SceneGraphNode& makeDefaultAgentNode(DynamicSceneGraph& graph) {
+  return makeAgentNode(graph, 0);
 }
 
 inline void emplacePlaceNode(DynamicSceneGraph& graph,
@@ -179,6 +189,102 @@ TEST(GnnLcdTests, testObjectTensors) {
       << tensors.at("edge_index").map<int64_t>();
 }
 
+TEST(GnnLcdTests, testObjectRadiusEdges) {
+  SubgraphConfig config;
+  Eigen::VectorXf fake_embedding(2);
+  fake_embedding << 1.0, 2.0;
+
+  const double radius = 1.0;
+  ObjectGnnDescriptor factory(test::get_resource_path("loop_closure/objects.onnx"),
+                              config,
+                              radius,
+                              {{0, fake_embedding}});
+
+  size_t node_idx = 0;
+  std::set<NodeId> nodes;
+  std::vector<Eigen::Vector3d> positions;
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 40; ++i) {
+    // spread objects over several grid cells (including negative coordinates)
+    const Eigen::Vector3d pos(0.37 * (i % 7) - 1.0, 0.61 * (i / 7) - 1.5, 0.1 * i);
+    positions.push_back(pos);
+    nodes.insert(NodeSymbol('o', node_idx));
+    emplaceObjectNode(graph, pos, Eigen::Vector3f::Ones(), node_idx);
+  }
+
+  std::vector<int64_t> expected_sources;
+  std::vector<int64_t> expected_targets;
+  for (size_t i = 0; i < positions.size(); ++i) {
+    for (size_t j = 0; j < positions.size(); ++j) {
+      if (i != j && (positions[i] - positions[j]).norm() <= radius) {
+        expected_sources.push_back(i);
+        expected_targets.push_back(j);
+      }
+    }
+  }
+
+  const auto tensors = factory.makeInput(graph, nodes);
+  auto edges = tensors.at("edge_index").map<int64_t>();
+  ASSERT_EQ(edges.cols(), static_cast<int>(expected_sources.size()));
+  for (int i = 0; i < edges.cols(); ++i) {
+    EXPECT_EQ(edges(0, i), expected_sources[i]) << "edge " << i;
+    EXPECT_EQ(edges(1, i), expected_targets[i]) << "edge " << i;
+  }
+}
+
+TEST(GnnLcdTests, testBatchedDescriptorsMatchSingle) {
+  SubgraphConfig config;
+  config.max_radius_m = 5.0;
+  config.min_radius_m = 2.0;
+  config.min_nodes = 5;
+
+  GnnDescriptorOptions options;
+  options.num_threads = 4;
+  PlaceGnnDescriptor factory(
+      test::get_resource_path("loop_closure/places.onnx"), config, true, options);
+
+  size_t node_idx = 0;
+  DynamicSceneGraph graph;
+  std::vector<const SceneGraphNode*> agent_nodes;
+  for (size_t i = 0; i < 30; ++i) {
+    emplacePlaceNode(
+        graph, Eigen::Vector3d(0.5 * i, 0.0, 1.0), 1.0 + 0.1 * i, i % 4, node_idx);
+    if (i > 0) {
+      graph.insertEdge(NodeSymbol('p', i - 1), NodeSymbol('p', i));
+    }
+
+    const auto& agent = makeAgentNode(graph, i);
+    graph.insertEdge(agent.id, NodeSymbol('p', i));
+    agent_nodes.push_back(&agent);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto batched = factory.constructBatch(graph, agent_nodes);
+  const auto batch_time = std::chrono::steady_clock::now() - start;
+
+  std::vector<Descriptor::Ptr> single;
+  const auto single_start = std::chrono::steady_clock::now();
+  for (const auto agent : agent_nodes) {
+    single.push_back(factory.construct(graph, *agent));
+  }
+  const auto single_time = std::chrono::steady_clock::now() - single_start;
+
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  RecordProperty("batch_us", duration_cast<microseconds>(batch_time).count());
+  RecordProperty("single_us", duration_cast<microseconds>(single_time).count());
+
+  ASSERT_EQ(batched.size(), agent_nodes.size());
+  for (size_t i = 0; i < agent_nodes.size(); ++i) {
+    ASSERT_TRUE(batched[i] != nullptr);
+    ASSERT_TRUE(single[i] != nullptr);
+    EXPECT_EQ(batched[i]->root_node, single[i]->root_node);
+    EXPECT_EQ(batched[i]->nodes, single[i]->nodes);
+    ASSERT_EQ(batched[i]->values.size(), single[i]->values.size());
+    EXPECT_NEAR((batched[i]->values - single[i]->values).norm(), 0.0, 1.0e-6);
+  }
+}
+
 TEST(GnnLcdTests, testLoadEmbeddings) {
   const auto embeddings =
       loadLabelEmbeddings(test::get_resource_path("loop_closure/test_embeddings.yaml"));
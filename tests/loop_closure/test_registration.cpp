@@ -35,6 +35,8 @@
 #include <gtest/gtest.h>
 #include <hydra/loop_closure/registration.h>
 
+#include <future>
+
 namespace hydra::lcd {
 
 double getPoseDistance(const gtsam::Pose3& expected,
@@ -386,4 +388,122 @@ TEST_F(LayerRegistrationTests, TestRepeatedRegistration) {
   ASSERT_TRUE(solution.valid);
 }
 
+TEST_F(LayerRegistrationTests, KeyedCorrespondencesMatchAllPairs) {
+  for (const auto& [node_id, node] : src_layer->nodes()) {
+    node->attributes<SemanticNodeAttributes>().semantic_label = node_id % 3;
+    dest_layer->getNode(node_id).attributes<SemanticNodeAttributes>().semantic_label =
+        (node_id / 2) % 3;
+  }
+
+  const auto get_label = [](const SceneGraphNode& node) -> uint64_t {
+    return node.attributes<SemanticNodeAttributes>().semantic_label;
+  };
+
+  const auto expected = getAllCorrespondences(
+      *src_layer,
+      *dest_layer,
+      node_ids,
+      node_ids,
+      [&](const SceneGraphNode& src, const SceneGraphNode& dest) {
+        return get_label(src) == get_label(dest);
+      });
+  const auto result =
+      getKeyedCorrespondences(*src_layer, *dest_layer, node_ids, node_ids, get_label);
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, result);
+}
+
+TEST_F(LayerRegistrationTests, KeyedCorrespondencesRespectCap) {
+  // all nodes share a label and are ranked by feature distance
+  for (const auto& [node_id, node] : src_layer->nodes()) {
+    node->attributes<SemanticNodeAttributes>().semantic_feature =
+        Eigen::MatrixXd::Constant(1, 1, node_id);
+    dest_layer->getNode(node_id).attributes<SemanticNodeAttributes>().semantic_feature =
+        Eigen::MatrixXd::Constant(1, 1, node_id);
+  }
+
+  const auto result = getKeyedCorrespondences(
+      *src_layer,
+      *dest_layer,
+      node_ids,
+      node_ids,
+      [](const SceneGraphNode&) -> uint64_t { return 0; },
+      getSemanticFeatureDistance,
+      3);
+
+  ASSERT_EQ(result.size(), 3 * node_ids.size());
+  std::map<NodeId, std::set<NodeId>> matches;
+  for (const auto& [src_id, dest_id] : result) {
+    matches[src_id].insert(dest_id);
+  }
+
+  for (const auto& [src_id, dest_ids] : matches) {
+    EXPECT_EQ(dest_ids.size(), 3u);
+    EXPECT_TRUE(dest_ids.count(src_id));
+    for (const auto dest_id : dest_ids) {
+      const auto diff = static_cast<int64_t>(src_id) - static_cast<int64_t>(dest_id);
+      EXPECT_LE(std::abs(diff), 2);
+    }
+  }
+
+  // registration still succeeds with capped correspondences
+  reg_config.max_correspondences_per_node = 3;
+  teaser::RobustRegistrationSolver::Params params;
+  params.estimate_scaling = false;
+  teaser::RobustRegistrationSolver solver(params);
+
+  LayerRegistrationProblem problem;
+  problem.src_nodes = node_ids;
+  problem.dest_nodes = node_ids;
+  problem.dest_layer = dest_layer.get();
+  auto solution = registerDsgLayerSemantic(reg_config, solver, problem, *src_layer);
+  ASSERT_TRUE(solution.valid);
+  EXPECT_NEAR(dest_t_src.x(), solution.dest_T_src.translation().x(), 1.0e-4);
+  EXPECT_NEAR(dest_t_src.y(), solution.dest_T_src.translation().y(), 1.0e-4);
+  EXPECT_NEAR(dest_t_src.z(), solution.dest_T_src.translation().z(), 1.0e-4);
+}
+
+TEST(TeaserSolverPool, ReusesIdleSolvers) {
+  TeaserSolverPool pool(TeaserParams{});
+  {
+    auto first = pool.acquire();
+    auto second = pool.acquire();
+    EXPECT_NE(&*first, &*second);
+    EXPECT_EQ(pool.size(), 2u);
+  }
+
+  auto third = pool.acquire();
+  EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST_F(GraphRegistrationTests, TestConcurrentObjectRegistration) {
+  DsgRegistrationInput match;
+  for (int i = 0; i < src_points.cols(); ++i) {
+    match.query_nodes.insert(NodeSymbol('O', i + src_points.cols()));
+    match.match_nodes.insert(NodeSymbol('O', i));
+  }
+
+  match.query_root = NodeSymbol('p', src_points.cols());
+  match.match_root = NodeSymbol('p', 0);
+
+  teaser::RobustRegistrationSolver::Params params;
+  reg_config.use_pairwise_registration = false;
+  DsgTeaserSolver solver(DsgLayers::OBJECTS, reg_config, params);
+
+  std::vector<std::future<RegistrationSolution>> futures;
+  for (size_t i = 0; i < 4; ++i) {
+    futures.push_back(std::async(std::launch::async, [&]() {
+      return solver.solve(*dsg, match, NodeSymbol('a', 1));
+    }));
+  }
+
+  for (auto& future : futures) {
+    const auto result = future.get();
+    EXPECT_TRUE(result.valid);
+    EXPECT_NEAR(0.0, getPoseDistance(to_T_from, result), 1.0e-3);
+  }
+
+  EXPECT_LE(solver.solvers.size(), 4u);
+}
+
 }  // namespace hydra::lcd
@@ -35,6 +35,8 @@
 #include <gtest/gtest.h>
 #include <hydra/loop_closure/subgraph_extraction.h>
 
+#include <random>
+
 namespace hydra {
 
 namespace {
@@ -208,4 +210,110 @@ TEST(GnnLcdTests, testGetSubgraphObjects) {
   }
 }
 
+class SubgraphIndexFixture : public ::testing::Test {
+ public:
+  SubgraphIndexFixture() = default;
+  virtual ~SubgraphIndexFixture() = default;
+
+  void SetUp() override {
+    // grid of places with a random subset of edges and objects around each place
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> offset(-0.4, 0.4);
+    std::uniform_int_distribution<int> num_objects(0, 3);
+    std::bernoulli_distribution keep_edge(0.8);
+
+    size_t place_idx = 0;
+    size_t object_idx = 0;
+    for (size_t x = 0; x < grid_size; ++x) {
+      for (size_t y = 0; y < grid_size; ++y) {
+        const NodeId place_id = NodeSymbol('p', place_idx);
+        const Eigen::Vector3d pos(x + offset(gen), y + offset(gen), 0.0);
+        emplacePlaceNode(graph, pos, 0.5 + offset(gen), 2, place_idx);
+        places.insert(place_id);
+        if (x > 0 && keep_edge(gen)) {
+          graph.insertEdge(place_id, NodeSymbol('p', place_idx - 1 - grid_size));
+        }
+        if (y > 0 && keep_edge(gen)) {
+          graph.insertEdge(place_id, NodeSymbol('p', place_idx - 2));
+        }
+
+        const auto to_add = num_objects(gen);
+        for (int i = 0; i < to_add; ++i) {
+          const NodeId object_id = NodeSymbol('o', object_idx);
+          const Eigen::Vector3d obj_pos =
+              pos + Eigen::Vector3d(2.0 * offset(gen), 2.0 * offset(gen), 1.0);
+          emplaceObjectNode(graph, obj_pos, Eigen::Vector3f::Zero(), object_idx);
+          graph.insertEdge(place_id, object_id);
+        }
+      }
+    }
+  }
+
+  const size_t grid_size = 30;
+  DynamicSceneGraph graph;
+  std::unordered_set<NodeId> places;
+};
+
+TEST_F(SubgraphIndexFixture, IndexMatchesGraph) {
+  SubgraphConfig fixed(3.0);
+
+  SubgraphConfig filtered;
+  filtered.fixed_radius = false;
+  filtered.max_radius_m = 4.0;
+  filtered.min_radius_m = 1.5;
+  filtered.min_nodes = 15;
+
+  // only index half of the places to mix archived and active lookups
+  std::unordered_set<NodeId> archived;
+  for (const auto place : places) {
+    if (NodeSymbol(place).categoryId() % 2 == 0) {
+      archived.insert(place);
+    }
+  }
+
+  SubgraphIndex index;
+  index.update(graph, archived);
+  EXPECT_EQ(index.numPlaces(), archived.size());
+
+  for (const auto& config : {fixed, filtered}) {
+    for (const bool is_places : {true, false}) {
+      index.startBatch();
+      for (const auto root : places) {
+        const auto expected = getSubgraphNodeList(config, graph, root, is_places);
+        const auto result = getSubgraphNodeList(config, graph, root, is_places, &index);
+        EXPECT_EQ(result, expected) << "root: " << NodeSymbol(root).str();
+        EXPECT_TRUE(std::is_sorted(result.begin(), result.end()));
+
+        // cached subgraphs should give the same result
+        const auto cached = getSubgraphNodeList(config, graph, root, is_places, &index);
+        EXPECT_EQ(cached, expected) << "root: " << NodeSymbol(root).str();
+      }
+    }
+  }
+}
+
+TEST_F(SubgraphIndexFixture, IndexCoversAllRoots) {
+  SubgraphConfig config(3.0);
+
+  std::vector<NodeId> roots(places.begin(), places.end());
+  std::sort(roots.begin(), roots.end());
+
+  size_t num_expected = 0;
+  for (const auto root : roots) {
+    num_expected += getSubgraphNodeList(config, graph, root, true).size();
+    num_expected += getSubgraphNodeList(config, graph, root, false).size();
+  }
+
+  SubgraphIndex index;
+  index.update(graph, places);
+  index.startBatch();
+  size_t num_found = 0;
+  for (const auto root : roots) {
+    num_found += getSubgraphNodeList(config, graph, root, true, &index).size();
+    num_found += getSubgraphNodeList(config, graph, root, false, &index).size();
+  }
+
+  EXPECT_EQ(num_found, num_expected);
+}
+
 }  // namespace hydra
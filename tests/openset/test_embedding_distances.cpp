@@ -1,8 +1,89 @@
 #include <gtest/gtest.h>
 #include <hydra/openset/embedding_distances.h>
 
+#include <random>
+
 namespace hydra {
 
+namespace {
+
+struct TestEmbeddingGroup : EmbeddingGroup {
+  struct Config {
+    size_t num_embeddings = 5;
+    size_t dims = 10;
+    int seed = 0;
+  };
+
+  explicit TestEmbeddingGroup(const Config& config) {
+    std::mt19937 gen(config.seed);
+    std::normal_distribution<float> dist;
+    for (size_t i = 0; i < config.num_embeddings; ++i) {
+      auto& embedding = embeddings.emplace_back(config.dims);
+      for (size_t d = 0; d < config.dims; ++d) {
+        embedding(d) = dist(gen);
+      }
+
+      names.push_back("embedding_" + std::to_string(i));
+    }
+  }
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<EmbeddingGroup, TestEmbeddingGroup, Config>(
+          "TestEmbeddingGroup");
+};
+
+void declare_config(TestEmbeddingGroup::Config& config) {
+  config::name("TestEmbeddingGroup::Config");
+  config::field(config.num_embeddings, "num_embeddings");
+  config::field(config.dims, "dims");
+  config::field(config.seed, "seed");
+}
+
+FeatureGroup makeQueries(size_t num_queries, size_t dims, int seed) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<float> dist;
+  FeatureGroup queries(dims, num_queries);
+  for (size_t i = 0; i < num_queries; ++i) {
+    for (size_t d = 0; d < dims; ++d) {
+      queries(d, i) = dist(gen);
+    }
+  }
+
+  // make sure zero queries use the same tolerance as the pairwise scores
+  queries.col(0).setZero();
+  return queries;
+}
+
+void checkScoreMatrix(const EmbeddingDistance& dist,
+                      const EmbeddingGroup& group,
+                      const FeatureGroup& queries) {
+  const auto scores = group.getScoreMatrix(dist, queries);
+  ASSERT_EQ(scores.rows(), queries.cols());
+  ASSERT_EQ(scores.cols(), static_cast<int>(group.size()));
+  for (int m = 0; m < queries.cols(); ++m) {
+    const FeatureVector query = queries.col(m);
+    for (size_t n = 0; n < group.size(); ++n) {
+      EXPECT_NEAR(scores(m, n), dist.score(group.embeddings[n], query), 1.0e-5f)
+          << "query " << m << ", embedding " << n;
+    }
+  }
+
+  const auto best = group.getBestScores(dist, queries);
+  ASSERT_EQ(best.size(), static_cast<size_t>(queries.cols()));
+  for (int m = 0; m < queries.cols(); ++m) {
+    const FeatureVector query = queries.col(m);
+    Eigen::Index expected_index;
+    const auto expected = group.getScores(dist, query).maxCoeff(&expected_index);
+    EXPECT_NEAR(best[m].score, expected, 1.0e-5f);
+    if (m > 0) {
+      // all scores are equal for the zero query
+      EXPECT_EQ(best[m].index, static_cast<size_t>(expected_index));
+    }
+  }
+}
+
+}  // namespace
+
 TEST(EmbeddingDistances, TestCosineCorrect) {
   FeatureVector a = FeatureVector::Zero(10);
   FeatureVector b = FeatureVector::Zero(10);
@@ -99,4 +180,56 @@ TEST(EmbeddingDistances, TestLerf) {
 }
 */
 
+TEST(EmbeddingDistances, TestCosineBatch) {
+  TestEmbeddingGroup group({20, 16, 1});
+  const auto queries = makeQueries(8, 16, 2);
+  checkScoreMatrix(CosineDistance(), group, queries);
+}
+
+TEST(EmbeddingDistances, TestDefaultBatch) {
+  TestEmbeddingGroup group({20, 16, 1});
+  const auto queries = makeQueries(8, 16, 2);
+  checkScoreMatrix(L1Norm(), group, queries);
+  checkScoreMatrix(L2Norm(), group, queries);
+}
+
+TEST(EmbeddingDistances, TestLerfBatch) {
+  LerfScore::Config config;
+  config.cannonical_features = TestEmbeddingGroup::Config{4, 16, 3};
+  LerfScore dist(config);
+
+  TestEmbeddingGroup group({20, 16, 1});
+  const auto queries = makeQueries(8, 16, 2);
+  checkScoreMatrix(dist, group, queries);
+}
+
+TEST(EmbeddingDistances, TestModifiedGroupBatch) {
+  TestEmbeddingGroup group({20, 16, 1});
+  const auto queries = makeQueries(8, 16, 2);
+  checkScoreMatrix(CosineDistance(), group, queries);
+
+  // changing embeddings in place (without changing the number of embeddings) should
+  // still invalidate the normalized embeddings
+  group.embeddings[3] *= -1.0f;
+  group.embeddings[7].setZero();
+  checkScoreMatrix(CosineDistance(), group, queries);
+
+  group.embeddings.pop_back();
+  group.embeddings.front()(0) += 1.0f;
+  checkScoreMatrix(CosineDistance(), group, queries);
+}
+
+TEST(EmbeddingDistances, TestEmptyGroupBatch) {
+  TestEmbeddingGroup group({0, 16, 1});
+  const auto queries = makeQueries(3, 16, 2);
+  const auto scores = group.getScoreMatrix(CosineDistance(), queries);
+  EXPECT_EQ(scores.rows(), 3);
+  EXPECT_EQ(scores.cols(), 0);
+
+  const auto best = group.getBestScores(CosineDistance(), queries);
+  ASSERT_EQ(best.size(), 3u);
+  EXPECT_EQ(best[0].index, 0u);
+  EXPECT_EQ(best[0].score, std::numeric_limits<float>::lowest());
+}
+
 }  // namespace hydra
@@ -35,9 +35,54 @@
 #include <gtest/gtest.h>
 #include <hydra/reconstruction/integration_masking.h>
 
+#include <limits>
 #include <opencv2/core.hpp>
+#include <set>
+#include <vector>
 
 namespace hydra {
+namespace {
+
+// per-pixel versions of the masking to check the optimized versions against
+cv::Mat referenceNonZero(const cv::Mat& input, const cv::Mat& mask) {
+  cv::Mat values;
+  input.convertTo(values, CV_64F);
+  cv::Mat expected = mask.clone();
+  for (int r = 0; r < input.rows; ++r) {
+    for (int c = 0; c < input.cols; ++c) {
+      expected.at<int32_t>(r, c) |= values.at<double>(r, c) != 0.0;
+    }
+  }
+
+  return expected;
+}
+
+cv::Mat referenceSemantics(const cv::Mat& labels,
+                           const std::set<int32_t>& to_mask,
+                           const cv::Mat& mask) {
+  cv::Mat expected = mask.clone();
+  for (int r = 0; r < labels.rows; ++r) {
+    for (int c = 0; c < labels.cols; ++c) {
+      expected.at<int32_t>(r, c) |= to_mask.count(labels.at<int32_t>(r, c));
+    }
+  }
+
+  return expected;
+}
+
+inline bool identical(const cv::Mat& lhs, const cv::Mat& rhs) {
+  return lhs.size() == rhs.size() && lhs.type() == rhs.type() &&
+         cv::countNonZero(lhs != rhs) == 0;
+}
+
+// mask with some bits already set to check that they are preserved
+cv::Mat makeMask(int rows, int cols) {
+  cv::Mat mask(rows, cols, CV_32SC1);
+  cv::randu(mask, 0, 4);
+  return mask;
+}
+
+}  // namespace
 
 TEST(IntegrationMasking, InitCorrect) {
   {  // empty mask and input means empty output
@@ -142,4 +187,70 @@ TEST(IntegrationMasking, NonZeroCorrect) {
   }
 }
 
+TEST(IntegrationMasking, NonZeroMatchesReference) {
+  cv::RNG rng(12345);
+  // small images and a lidar-sized image that takes the parallel path
+  const std::vector<cv::Size> sizes{{7, 5}, {1024, 128}};
+  for (const auto depth : {CV_8U, CV_8S, CV_16U, CV_16S, CV_32S}) {
+    for (const auto& size : sizes) {
+      cv::Mat input(size, CV_MAKETYPE(depth, 1));
+      rng.fill(input, cv::RNG::UNIFORM, -2, 3);
+
+      const auto mask_before = makeMask(size.height, size.width);
+      cv::Mat mask = mask_before.clone();
+      EXPECT_TRUE(maskNonZero(input, mask));
+      EXPECT_TRUE(identical(mask, referenceNonZero(input, mask_before)))
+          << "depth: " << depth << ", size: " << size;
+    }
+  }
+
+  {  // non-continuous input and mask
+    cv::Mat input_full(20, 30, CV_16UC1);
+    rng.fill(input_full, cv::RNG::UNIFORM, 0, 2);
+    const cv::Mat input = input_full(cv::Rect(3, 2, 17, 11));
+    cv::Mat mask_full = makeMask(20, 30);
+    cv::Mat mask = mask_full(cv::Rect(5, 4, 17, 11));
+    const cv::Mat mask_before = mask.clone();
+    EXPECT_TRUE(maskNonZero(input, mask));
+    EXPECT_TRUE(identical(mask, referenceNonZero(input, mask_before)));
+  }
+}
+
+TEST(IntegrationMasking, SemanticsMatchReference) {
+  cv::RNG rng(12345);
+  const std::vector<std::set<int32_t>> label_sets{
+      {0},
+      {1, 2, 3, 17},
+      {-5, -1, 4},
+      // spans larger than the lookup table
+      {std::numeric_limits<int32_t>::min(), 2, std::numeric_limits<int32_t>::max()},
+  };
+
+  const std::vector<cv::Size> sizes{{7, 5}, {1024, 128}};
+  for (const auto& to_mask : label_sets) {
+    for (const auto& size : sizes) {
+      cv::Mat labels(size, CV_32SC1);
+      rng.fill(labels, cv::RNG::UNIFORM, -8, 20);
+      labels.at<int32_t>(0, 0) = std::numeric_limits<int32_t>::min();
+      labels.at<int32_t>(0, 1) = std::numeric_limits<int32_t>::max();
+
+      const auto mask_before = makeMask(size.height, size.width);
+      cv::Mat mask = mask_before.clone();
+      EXPECT_TRUE(maskInvalidSemantics(labels, to_mask, mask));
+      EXPECT_TRUE(identical(mask, referenceSemantics(labels, to_mask, mask_before)))
+          << "size: " << size;
+    }
+  }
+
+  {  // empty mask gets initialized
+    cv::Mat labels(9, 4, CV_32SC1);
+    rng.fill(labels, cv::RNG::UNIFORM, 0, 5);
+    const std::set<int32_t> to_mask{1, 3};
+    cv::Mat mask;
+    EXPECT_TRUE(maskInvalidSemantics(labels, to_mask, mask));
+    const cv::Mat empty_mask = cv::Mat::zeros(9, 4, CV_32SC1);
+    EXPECT_TRUE(identical(mask, referenceSemantics(labels, to_mask, empty_mask)));
+  }
+}
+
 }  // namespace hydra
@@ -0,0 +1,333 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/input/camera.h>
+#include <hydra/input/lidar.h>
+#include <hydra/reconstruction/projective_integrator.h>
+#include <hydra/reconstruction/range_image_pyramid.h>
+
+#include <limits>
+#include <optional>
+
+namespace hydra {
+
+namespace {
+
+std::shared_ptr<Camera> createCamera(int width, int height) {
+  Camera::Config config;
+  config.min_range = 0.1;
+  config.max_range = 10.0;
+  config.width = width;
+  config.height = height;
+  config.cx = config.width / 2.0f;
+  config.cy = config.height / 2.0f;
+  config.fx = config.width / 2.0f;
+  config.fy = config.height / 2.0f;
+  config.extrinsics = ParamSensorExtrinsics::Config();
+  return std::make_shared<Camera>(config, "");
+}
+
+InputData makeSlantedWall(const Sensor::ConstPtr& sensor, int width, int height) {
+  InputData data(sensor);
+  data.timestamp_ns = 10;
+  data.world_T_body = Eigen::Isometry3d::Identity();
+  data.range_image = cv::Mat(height, width, CV_32FC1);
+  for (int r = 0; r < height; ++r) {
+    for (int c = 0; c < width; ++c) {
+      data.range_image.at<float>(r, c) = 2.0f + 0.01f * c + 0.005f * r;
+    }
+  }
+
+  // a few invalid pixels
+  data.range_image.at<float>(height / 2, width / 2) =
+      std::numeric_limits<float>::quiet_NaN();
+  data.min_range = 0.0f;
+  data.max_range = 5.0f;
+  return data;
+}
+
+constexpr int kLidarWidth = 640;
+constexpr int kLidarHeight = 32;
+
+std::shared_ptr<Lidar> createLidar(
+    double vertical_fov, std::optional<double> vertical_fov_top = std::nullopt) {
+  Lidar::Config config;
+  config.min_range = 0.1;
+  config.max_range = 10.0;
+  config.horizontal_fov = 360.0;
+  config.horizontal_resolution = 360.0 / kLidarWidth;
+  config.vertical_fov = vertical_fov;
+  config.vertical_resolution = vertical_fov / kLidarHeight;
+  config.is_asymmetric = vertical_fov_top.has_value();
+  config.vertical_fov_top = vertical_fov_top.value_or(-1.0);
+  config.extrinsics = ParamSensorExtrinsics::Config();
+  return std::make_shared<Lidar>(config, "");
+}
+
+Eigen::Matrix3Xf makeCorners(const Eigen::Vector3f& p_min,
+                             const Eigen::Vector3f& p_max) {
+  Eigen::Matrix3Xf points(3, 8);
+  for (int i = 0; i < 8; ++i) {
+    points.col(i) << ((i & 1) ? p_max.x() : p_min.x()),
+        ((i & 2) ? p_max.y() : p_min.y()), ((i & 4) ? p_max.z() : p_min.z());
+  }
+
+  return points;
+}
+
+// check that every point of the box that projects into the image is inside the bounds
+void checkBoundsContainBox(const Sensor& sensor,
+                           const Eigen::Vector3f& p_min,
+                           const Eigen::Vector3f& p_max) {
+  float u_min, u_max, v_min, v_max;
+  ASSERT_TRUE(sensor.projectBoundsToImagePlane(
+      makeCorners(p_min, p_max), u_min, u_max, v_min, v_max));
+  constexpr int steps = 8;
+  for (int i = 0; i <= steps; ++i) {
+    for (int j = 0; j <= steps; ++j) {
+      for (int k = 0; k <= steps; ++k) {
+        const Eigen::Vector3f ratio = Eigen::Vector3f(i, j, k) / steps;
+        const Eigen::Vector3f p = p_min + ratio.cwiseProduct(p_max - p_min);
+        float u, v;
+        if (!sensor.projectPointToImagePlane(p, u, v)) {
+          continue;
+        }
+
+        EXPECT_GE(u, u_min - 1.0e-3f) << "point: " << p.transpose();
+        EXPECT_LE(u, u_max + 1.0e-3f) << "point: " << p.transpose();
+        EXPECT_GE(v, v_min - 1.0e-3f) << "point: " << p.transpose();
+        EXPECT_LE(v, v_max + 1.0e-3f) << "point: " << p.transpose();
+      }
+    }
+  }
+}
+
+VolumetricMap::Config mapConfig() {
+  VolumetricMap::Config config;
+  config.voxel_size = 0.1f;
+  config.voxels_per_side = 16;
+  config.truncation_distance = 0.3f;
+  return config;
+}
+
+}  // namespace
+
+TEST(RangeImagePyramid, MaxRangeCorrect) {
+  cv::Mat range(5, 7, CV_32FC1);
+  for (int r = 0; r < range.rows; ++r) {
+    for (int c = 0; c < range.cols; ++c) {
+      range.at<float>(r, c) = r * range.cols + c;
+    }
+  }
+  range.at<float>(4, 6) = std::numeric_limits<float>::quiet_NaN();
+
+  const RangeImagePyramid pyramid(range);
+  EXPECT_EQ(pyramid.numLevels(), 4u);
+  EXPECT_EQ(pyramid.level(1).rows, 3);
+  EXPECT_EQ(pyramid.level(1).cols, 4);
+
+  // results are always an upper bound of the true max
+  for (int v_min = 0; v_min < range.rows; ++v_min) {
+    for (int v_max = v_min; v_max < range.rows; ++v_max) {
+      for (int u_min = 0; u_min < range.cols; ++u_min) {
+        for (int u_max = u_min; u_max < range.cols; ++u_max) {
+          float expected = std::numeric_limits<float>::lowest();
+          for (int v = v_min; v <= v_max; ++v) {
+            for (int u = u_min; u <= u_max; ++u) {
+              const auto value = range.at<float>(v, u);
+              expected = std::isnan(value) ? expected : std::max(expected, value);
+            }
+          }
+
+          EXPECT_GE(pyramid.maxRange(u_min, u_max, v_min, v_max), expected);
+        }
+      }
+    }
+  }
+
+  // single pixels are exact and NaN is ignored
+  EXPECT_EQ(pyramid.maxRange(3, 3, 2, 2), 17.0f);
+  EXPECT_EQ(pyramid.maxRange(6, 6, 4, 4), std::numeric_limits<float>::lowest());
+  // out of bounds or empty rectangles have no valid pixels
+  EXPECT_EQ(pyramid.maxRange(10, 12, 0, 2), std::numeric_limits<float>::lowest());
+  EXPECT_EQ(pyramid.maxRange(3, 2, 0, 2), std::numeric_limits<float>::lowest());
+  // the whole image reduces to the largest valid value
+  EXPECT_EQ(pyramid.maxRange(-5, 20, -5, 20), 33.0f);
+}
+
+TEST(Camera, ProjectBoundsContainsPoints) {
+  const auto camera = createCamera(64, 48);
+  Eigen::Matrix3Xf points(3, 8);
+  for (int i = 0; i < 8; ++i) {
+    points.col(i) << ((i & 1) ? 0.5f : -0.2f), ((i & 2) ? 0.3f : -0.1f),
+        ((i & 4) ? 3.0f : 2.0f);
+  }
+
+  float u_min, u_max, v_min, v_max;
+  ASSERT_TRUE(camera->projectBoundsToImagePlane(points, u_min, u_max, v_min, v_max));
+  for (int i = 0; i < 8; ++i) {
+    float u, v;
+    camera->projectPointToImagePlane(points.col(i), u, v);
+    EXPECT_GE(u, u_min);
+    EXPECT_LE(u, u_max);
+    EXPECT_GE(v, v_min);
+    EXPECT_LE(v, v_max);
+  }
+
+  // points behind the camera can't be bounded
+  points(2, 0) = -1.0f;
+  EXPECT_FALSE(camera->projectBoundsToImagePlane(points, u_min, u_max, v_min, v_max));
+}
+
+TEST(Lidar, ProjectBoundsAcrossSeam) {
+  const auto lidar = createLidar(30.0);
+  float u_min, u_max, v_min, v_max;
+  // azimuth wraps from pi to -pi behind the sensor, so straddling blocks are unbounded
+  EXPECT_FALSE(lidar->projectBoundsToImagePlane(
+      makeCorners({-3.0f, -0.5f, -0.2f}, {-2.0f, 0.5f, 0.2f}),
+      u_min,
+      u_max,
+      v_min,
+      v_max));
+  EXPECT_FALSE(lidar->projectBoundsToImagePlane(
+      makeCorners({-3.0f, -0.01f, -0.2f}, {-2.0f, 0.0f, 0.2f}),
+      u_min,
+      u_max,
+      v_min,
+      v_max));
+  // as are blocks containing the vertical axis
+  EXPECT_FALSE(lidar->projectBoundsToImagePlane(
+      makeCorners({-0.5f, -0.5f, 1.0f}, {0.5f, 0.5f, 2.0f}),
+      u_min,
+      u_max,
+      v_min,
+      v_max));
+
+  // blocks next to the seam on either side map to the edges of the image
+  checkBoundsContainBox(*lidar, {-3.0f, 0.01f, -0.2f}, {-2.0f, 0.5f, 0.2f});
+  checkBoundsContainBox(*lidar, {-3.0f, -0.5f, -0.2f}, {-2.0f, -0.01f, 0.2f});
+  ASSERT_TRUE(lidar->projectBoundsToImagePlane(
+      makeCorners({-3.0f, 0.01f, -0.2f}, {-2.0f, 0.5f, 0.2f}),
+      u_min,
+      u_max,
+      v_min,
+      v_max));
+  EXPECT_GE(u_min, -1.0e-3f);
+  EXPECT_LT(u_max, kLidarWidth / 8.0f);
+  ASSERT_TRUE(lidar->projectBoundsToImagePlane(
+      makeCorners({-3.0f, -0.5f, -0.2f}, {-2.0f, -0.01f, 0.2f}),
+      u_min,
+      u_max,
+      v_min,
+      v_max));
+  EXPECT_GT(u_min, 7.0f * kLidarWidth / 8.0f);
+  EXPECT_LE(u_max, kLidarWidth + 1.0e-3f);
+
+  // blocks in front of the sensor and to the side
+  checkBoundsContainBox(*lidar, {2.0f, -0.5f, -0.2f}, {3.0f, 0.5f, 0.2f});
+  checkBoundsContainBox(*lidar, {-0.5f, 1.0f, -0.3f}, {0.5f, 2.0f, 0.3f});
+}
+
+TEST(Lidar, ProjectBoundsOutsideVerticalFov) {
+  for (const auto& lidar : {createLidar(30.0), createLidar(30.0, 5.0)}) {
+    float u_min, u_max, v_min, v_max;
+    // blocks above the field of view are entirely above the image
+    ASSERT_TRUE(lidar->projectBoundsToImagePlane(
+        makeCorners({2.0f, -0.5f, 5.0f}, {3.0f, 0.5f, 6.0f}),
+        u_min,
+        u_max,
+        v_min,
+        v_max));
+    EXPECT_LE(v_min, v_max);
+    EXPECT_LT(v_max, 0.0f);
+
+    // blocks below the field of view are entirely below the image
+    ASSERT_TRUE(lidar->projectBoundsToImagePlane(
+        makeCorners({2.0f, -0.5f, -6.0f}, {3.0f, 0.5f, -5.0f}),
+        u_min,
+        u_max,
+        v_min,
+        v_max));
+    EXPECT_LE(v_min, v_max);
+    EXPECT_GT(v_min, kLidarHeight);
+
+    // blocks crossing the top or bottom of the field of view are clipped by the image
+    checkBoundsContainBox(*lidar, {1.0f, -0.5f, 0.0f}, {3.0f, 0.5f, 0.6f});
+    checkBoundsContainBox(*lidar, {1.0f, -0.5f, -0.6f}, {3.0f, 0.5f, 0.0f});
+  }
+}
+
+TEST(ProjectiveIntegrator, RangeCullingMatchesFullIntegration) {
+  const int width = 64;
+  const int height = 48;
+  const auto camera = createCamera(width, height);
+  const auto data = makeSlantedWall(camera, width, height);
+
+  ProjectiveIntegrator::Config config;
+  config.num_threads = 2;
+  config.use_range_pyramid = false;
+  const ProjectiveIntegrator full_integrator(config);
+  config.use_range_pyramid = true;
+  const ProjectiveIntegrator culled_integrator(config);
+
+  VolumetricMap full_map(mapConfig());
+  full_integrator.updateMap(data, full_map);
+  VolumetricMap culled_map(mapConfig());
+  culled_integrator.updateMap(data, culled_map);
+
+  // voxels far behind the wall are never projected
+  EXPECT_GT(full_integrator.numProjectedVoxels(), 0u);
+  EXPECT_LT(culled_integrator.numProjectedVoxels(),
+            full_integrator.numProjectedVoxels());
+
+  const auto& full = full_map.getTsdfLayer();
+  const auto& culled = culled_map.getTsdfLayer();
+  const auto indices = full.allocatedBlockIndices();
+  ASSERT_GT(indices.size(), 0u);
+  EXPECT_EQ(indices.size(), culled.allocatedBlockIndices().size());
+  for (const auto& index : indices) {
+    const auto expected = full.getBlockPtr(index);
+    const auto result = culled.getBlockPtr(index);
+    ASSERT_TRUE(result);
+    for (size_t i = 0; i < expected->numVoxels(); ++i) {
+      const auto& lhs = expected->getVoxel(i);
+      const auto& rhs = result->getVoxel(i);
+      EXPECT_EQ(lhs.distance, rhs.distance);
+      EXPECT_EQ(lhs.weight, rhs.weight);
+    }
+  }
+}
+
+}  // namespace hydra
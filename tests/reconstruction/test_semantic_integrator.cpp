@@ -36,6 +36,8 @@
 #include <hydra/common/global_info.h>
 #include <hydra/reconstruction/semantic_integrator.h>
 
+#include <limits>
+
 #include "hydra_test/config_guard.h"
 
 namespace hydra {
@@ -70,10 +72,91 @@ TEST(SemanticIntegrator, MLEIntegrationCorrect) {
   EXPECT_GT(voxel.semantic_likelihoods(2), voxel.semantic_likelihoods(4));
   Eigen::VectorXf expected = Eigen::VectorXf::Zero(5);
   expected << 0.04, 0.04, 0.16, 0.04, 0.04;
-  Eigen::VectorXf result_prob = voxel.semantic_likelihoods.array().exp();
+  Eigen::VectorXf result_prob = voxel.likelihoods().array().exp();
   EXPECT_TRUE(result_prob.isApprox(expected));
 }
 
+// dense reference implementation of the MLE update
+struct DenseMLEReference {
+  DenseMLEReference(size_t num_labels, float label_confidence)
+      : likelihoods(Eigen::VectorXf::Constant(num_labels, std::log(1.0f / num_labels))),
+        observations(Eigen::MatrixXf::Constant(
+            num_labels, num_labels, std::log(1.0f - label_confidence))) {
+    observations.diagonal().setConstant(std::log(label_confidence));
+  }
+
+  void update(uint32_t label) { likelihoods += observations.col(label); }
+
+  Eigen::VectorXf likelihoods;
+  Eigen::MatrixXf observations;
+};
+
+void checkMatchesDense(size_t num_labels,
+                       float label_confidence,
+                       const std::vector<uint32_t>& labels) {
+  const auto integrator = createIntegrator(num_labels, {}, {}, label_confidence);
+  DenseMLEReference reference(num_labels, label_confidence);
+
+  SemanticVoxel voxel;
+  for (size_t i = 0; i < labels.size(); ++i) {
+    integrator->updateLikelihoods(labels[i], 1.0, voxel);
+    reference.update(labels[i]);
+
+    const Eigen::VectorXf result = voxel.likelihoods();
+    ASSERT_EQ(result.size(), reference.likelihoods.size());
+    for (int j = 0; j < result.size(); ++j) {
+      EXPECT_NEAR(result(j), reference.likelihoods(j), 1.0e-3f)
+          << "label " << j << " after " << i + 1 << " observations";
+    }
+
+    // only check argmax when the dense result is unambiguous
+    Eigen::Index expected_label;
+    const auto best = reference.likelihoods.maxCoeff(&expected_label);
+    Eigen::VectorXf others = reference.likelihoods;
+    others(expected_label) = -std::numeric_limits<float>::infinity();
+    if (best - others.maxCoeff() > 1.0e-2f) {
+      EXPECT_EQ(voxel.semantic_label, static_cast<uint32_t>(expected_label))
+          << "after " << i + 1 << " observations";
+    }
+  }
+}
+
+TEST(SemanticIntegrator, MLEMatchesDenseUpdate) {
+  test::ConfigGuard guard(false);
+  const std::vector<uint32_t> labels{3, 3, 1, 4, 1, 1, 0, 2, 2, 2, 2, 4, 3, 1, 1, 1};
+  checkMatchesDense(5, 0.8, labels);
+  checkMatchesDense(5, 0.55, labels);
+}
+
+TEST(SemanticIntegrator, MLEMatchesDenseUpdateLowConfidence) {
+  test::ConfigGuard guard(false);
+  // observing a label with confidence below 0.5 lowers it relative to the others
+  const std::vector<uint32_t> labels{0, 0, 2, 1, 1, 1, 3, 0, 2, 2, 2, 1};
+  checkMatchesDense(4, 0.3, labels);
+}
+
+TEST(SemanticIntegrator, MLEArgmaxTracksSwitches) {
+  test::ConfigGuard guard(false);
+  const auto integrator = createIntegrator(4, {}, {}, 0.8);
+  SemanticVoxel voxel;
+
+  integrator->updateLikelihoods(1, 1.0, voxel);
+  EXPECT_EQ(voxel.semantic_label, 1u);
+  integrator->updateLikelihoods(2, 1.0, voxel);
+  EXPECT_EQ(voxel.semantic_label, 1u);  // ties resolve to the lowest label
+  integrator->updateLikelihoods(2, 1.0, voxel);
+  EXPECT_EQ(voxel.semantic_label, 2u);
+  integrator->updateLikelihoods(0, 1.0, voxel);
+  integrator->updateLikelihoods(0, 1.0, voxel);
+  EXPECT_EQ(voxel.semantic_label, 0u);
+
+  // invalid labels leave the voxel untouched
+  const Eigen::VectorXf before = voxel.likelihoods();
+  integrator->updateLikelihoods(10, 1.0, voxel);
+  EXPECT_EQ(voxel.semantic_label, 0u);
+  EXPECT_TRUE(voxel.likelihoods().isApprox(before));
+}
+
 TEST(SemanticIntegrator, FirstKIntegrationCorrect) {
   FirstKSemanticIntegrator integrator(FirstKSemanticIntegrator::Config{2});
 
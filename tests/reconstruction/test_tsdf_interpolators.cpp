@@ -35,6 +35,7 @@
 #include <gtest/gtest.h>
 #include <hydra/reconstruction/tsdf_interpolators.h>
 
+#include <cmath>
 #include <optional>
 #include <set>
 
@@ -58,6 +59,24 @@ TsdfLayer::Ptr makeLayer(double resolution, int voxels_per_side, double weight)
   return layer;
 }
 
+void fillBlock(TsdfBlock& block, float offset) {
+  for (size_t i = 0; i < block.numVoxels(); ++i) {
+    auto& voxel = block.getVoxel(i);
+    voxel.weight = (i % 3) * 0.5f;
+    voxel.distance = std::sin(offset + i);
+    voxel.color.r = i % 255;
+  }
+}
+
+void expectBlocksEqual(const TsdfBlock& lhs, const TsdfBlock& rhs) {
+  ASSERT_EQ(lhs.numVoxels(), rhs.numVoxels());
+  for (size_t i = 0; i < lhs.numVoxels(); ++i) {
+    EXPECT_EQ(lhs.getVoxel(i).weight, rhs.getVoxel(i).weight) << "voxel " << i;
+    EXPECT_EQ(lhs.getVoxel(i).distance, rhs.getVoxel(i).distance) << "voxel " << i;
+    EXPECT_EQ(lhs.getVoxel(i).color.r, rhs.getVoxel(i).color.r) << "voxel " << i;
+  }
+}
+
 }  // namespace
 
 TEST(TsdfInterpolators, ResampleCorrect) {
@@ -80,4 +99,76 @@ TEST(TsdfInterpolators, ResampleCorrect) {
   }
 }
 
+TEST(TsdfInterpolators, ParallelMatchesSerial) {
+  TsdfLayer tsdf(0.1, 8);
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 3; ++y) {
+      fillBlock(tsdf.allocateBlock(BlockIndex(x, y, 0)), x + 10 * y);
+    }
+  }
+
+  DownsampleTsdfInterpolator::Config config;
+  config.num_threads = 1;
+  const auto serial = DownsampleTsdfInterpolator(config).interpolate(tsdf, nullptr);
+  config.num_threads = 4;
+  const auto parallel = DownsampleTsdfInterpolator(config).interpolate(tsdf, nullptr);
+  ASSERT_TRUE(serial && parallel);
+  for (const auto& idx : tsdf.allocatedBlockIndices()) {
+    const auto lhs = serial->getBlockPtr(idx);
+    const auto rhs = parallel->getBlockPtr(idx);
+    ASSERT_TRUE(lhs && rhs);
+    expectBlocksEqual(*lhs, *rhs);
+  }
+}
+
+TEST(TsdfInterpolators, PyramidUpdatesBlocks) {
+  TsdfLayer tsdf(0.1, 8);
+  fillBlock(tsdf.allocateBlock(BlockIndex(0, 0, 0)), 0.0f);
+  fillBlock(tsdf.allocateBlock(BlockIndex(1, 0, 0)), 1.0f);
+
+  DownsampleTsdfInterpolator::Config config;
+  config.num_threads = 2;
+  config.num_levels = 3;
+  TsdfPyramid pyramid(config);
+  ASSERT_TRUE(pyramid.update(tsdf));
+  ASSERT_EQ(pyramid.numLevels(), 2u);  // 8 -> 4 -> 2 voxels per side
+  EXPECT_NEAR(pyramid.level(0)->voxel_size, 0.2, 1.0e-6);
+  EXPECT_NEAR(pyramid.level(1)->voxel_size, 0.4, 1.0e-6);
+  EXPECT_EQ(pyramid.level(2), nullptr);
+
+  // clear dirty flags and only update one block
+  for (size_t i = 0; i < pyramid.numLevels(); ++i) {
+    for (const auto& idx : pyramid.level(i)->allocatedBlockIndices()) {
+      pyramid.level(i)->getBlock(idx).clearUpdated();
+    }
+  }
+
+  fillBlock(tsdf.getBlock(BlockIndex(1, 0, 0)), 5.0f);
+  const BlockIndices updated{BlockIndex(1, 0, 0)};
+  ASSERT_TRUE(pyramid.update(tsdf, &updated));
+
+  // every level should match interpolating from scratch
+  DownsampleTsdfInterpolator base(config);
+  const auto expected0 = base.interpolate(tsdf, nullptr);
+  config.ratio = 2;
+  const auto expected1 =
+      DownsampleTsdfInterpolator(config).interpolate(*expected0, nullptr);
+  for (const auto& idx : tsdf.allocatedBlockIndices()) {
+    expectBlocksEqual(pyramid.level(0)->getBlock(idx), expected0->getBlock(idx));
+    expectBlocksEqual(pyramid.level(1)->getBlock(idx), expected1->getBlock(idx));
+  }
+
+  for (size_t i = 0; i < pyramid.numLevels(); ++i) {
+    EXPECT_FALSE(pyramid.level(i)->getBlock(BlockIndex(0, 0, 0)).updated);
+    EXPECT_TRUE(pyramid.level(i)->getBlock(BlockIndex(1, 0, 0)).updated);
+    EXPECT_TRUE(pyramid.level(i)->getBlock(BlockIndex(1, 0, 0)).esdf_updated);
+  }
+
+  pyramid.removeBlocks({BlockIndex(0, 0, 0)});
+  for (size_t i = 0; i < pyramid.numLevels(); ++i) {
+    EXPECT_FALSE(pyramid.level(i)->hasBlock(BlockIndex(0, 0, 0)));
+    EXPECT_TRUE(pyramid.level(i)->hasBlock(BlockIndex(1, 0, 0)));
+  }
+}
+
 }  // namespace hydra
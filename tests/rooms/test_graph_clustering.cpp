@@ -124,4 +124,30 @@ TEST(GraphClusteringTests, ModularityClusteringCorrect) {
   EXPECT_EQ(second_cluster, cluster_results.clusters.at(1));
 }
 
+TEST(GraphClusteringTests, ParallelModularityClusteringCorrect) {
+  SceneGraphLayer layer(1);
+  for (size_t i = 0; i < 10; ++i) {
+    layer.emplaceNode(i, std::make_unique<NodeAttributes>());
+  }
+
+  // same graph as above: two cliques joined by a weak bridge
+  layer.insertEdge(0, 1, std::make_unique<EdgeAttributes>(1.0));
+  layer.insertEdge(0, 2, std::make_unique<EdgeAttributes>(1.0));
+  layer.insertEdge(1, 2, std::make_unique<EdgeAttributes>(1.0));
+  layer.insertEdge(2, 3, std::make_unique<EdgeAttributes>(0.1));
+  layer.insertEdge(3, 4, std::make_unique<EdgeAttributes>(0.01));
+  for (size_t i = 4; i < 9; ++i) {
+    for (size_t j = i + 1; j < 9; ++j) {
+      layer.insertEdge(i, j, std::make_unique<EdgeAttributes>(1.0));
+    }
+  }
+  layer.insertEdge(6, 9, std::make_unique<EdgeAttributes>(0.3));
+
+  InitialClusters initial_clusters{{1}, {4, 6, 8}};
+  const auto sequential = clusterGraphByModularity(layer, initial_clusters, 4);
+  const auto parallel = clusterGraphByModularity(layer, initial_clusters, 4, 1.0, 4);
+  EXPECT_EQ(sequential.labels, parallel.labels);
+  EXPECT_EQ(sequential.clusters, parallel.clusters);
+}
+
 }  // namespace hydra
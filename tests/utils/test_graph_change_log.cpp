@@ -0,0 +1,182 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/utils/active_window_tracker.h>
+#include <hydra/utils/graph_change_log.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+#include <spark_dsg/node_attributes.h>
+
+namespace hydra {
+
+using spark_dsg::DynamicSceneGraph;
+using spark_dsg::NodeAttributes;
+using spark_dsg::NodeId;
+
+namespace {
+
+inline void addNode(DynamicSceneGraph& graph,
+                    spark_dsg::LayerId layer,
+                    NodeId node_id,
+                    bool active) {
+  auto attrs = std::make_unique<NodeAttributes>();
+  attrs->is_active = active;
+  graph.emplaceNode(layer, node_id, std::move(attrs));
+}
+
+inline std::vector<NodeId> getNodes(const NodeSubsetView& view) {
+  std::vector<NodeId> nodes;
+  for (const auto& node : view) {
+    nodes.push_back(node.id);
+  }
+
+  return nodes;
+}
+
+}  // namespace
+
+TEST(GraphChangeLog, DirtySinceCorrect) {
+  DynamicSceneGraph graph;
+  GraphChangeLog changes;
+  addNode(graph, 2, 3, true);
+  addNode(graph, 2, 1, false);
+  addNode(graph, 3, 2, true);
+  EXPECT_EQ(changes.observe(graph), 1u);
+
+  {  // everything is new
+    const std::vector<NodeId> expected{1, 2, 3};
+    EXPECT_EQ(changes.dirtySince(0), expected);
+  }
+
+  {  // only nodes from layer 2
+    const std::vector<NodeId> expected{1, 3};
+    EXPECT_EQ(changes.dirtySince(0, 2), expected);
+  }
+
+  // nothing changed after the first update
+  EXPECT_EQ(changes.observe(graph), 2u);
+  EXPECT_TRUE(changes.dirtySince(1).empty());
+
+  // archive one active node and remove the other
+  graph.getNode(3).attributes().is_active = false;
+  graph.removeNode(2);
+  addNode(graph, 3, 4, true);
+  EXPECT_EQ(changes.observe(graph), 3u);
+
+  {
+    const std::vector<NodeId> expected{2, 3, 4};
+    EXPECT_EQ(changes.dirtySince(2), expected);
+  }
+
+  {  // removed node should still be attributed to the right layer
+    const std::vector<NodeId> expected{2, 4};
+    EXPECT_EQ(changes.dirtySince(2, 3), expected);
+  }
+
+  size_t num_deactivated = 0;
+  for (const auto& entry : changes.changesSince(2)) {
+    EXPECT_EQ(entry.sequence, 3u);
+    num_deactivated += entry.change == GraphChangeLog::Change::DEACTIVATED ? 1 : 0;
+  }
+  EXPECT_EQ(num_deactivated, 1u);
+
+  // trimming drops old changes
+  EXPECT_TRUE(changes.covers(0));
+  changes.trim(2);
+  EXPECT_FALSE(changes.covers(1));
+  EXPECT_TRUE(changes.covers(2));
+  EXPECT_EQ(changes.changesSince(0).size(), changes.changesSince(2).size());
+}
+
+TEST(GraphChangeLog, TrackerMatchesFullScan) {
+  DynamicSceneGraph graph;
+  GraphChangeLog changes;
+  ActiveWindowTracker incremental;
+  ActiveWindowTracker full;
+
+  NodeId next_id = 0;
+  for (size_t step = 0; step < 20; ++step) {
+    // add a few active nodes per step
+    for (size_t i = 0; i < 3; ++i) {
+      addNode(graph, 2, next_id++, true);
+    }
+
+    // archive older nodes and remove some of the archived nodes
+    if (step >= 2) {
+      graph.getNode(next_id - 7).attributes().is_active = false;
+      graph.getNode(next_id - 8).attributes().is_active = false;
+    }
+
+    if (step >= 4 && step % 2 == 0) {
+      graph.removeNode(next_id - 13);
+    }
+
+    changes.observe(graph);
+    changes.trim(changes.sequence() > 2 ? changes.sequence() - 2 : 0);
+
+    incremental.clear();
+    full.clear();
+    const auto& layer = graph.getLayer(2);
+    const auto expected = getNodes(full.view(layer));
+    EXPECT_EQ(getNodes(incremental.view(layer, false, &changes)), expected)
+        << "step: " << step;
+    EXPECT_EQ(getNodes(incremental.view(layer, true, &changes)), expected)
+        << "step: " << step;
+  }
+}
+
+TEST(GraphChangeLog, TrackerRescansWhenBehind) {
+  DynamicSceneGraph graph;
+  GraphChangeLog changes;
+  ActiveWindowTracker tracker;
+  addNode(graph, 2, 0, true);
+  changes.observe(graph);
+  {
+    const std::vector<NodeId> expected{0};
+    EXPECT_EQ(getNodes(tracker.view(graph.getLayer(2), false, &changes)), expected);
+  }
+
+  // tracker misses the changes from several updates
+  addNode(graph, 2, 1, true);
+  changes.observe(graph);
+  addNode(graph, 2, 2, true);
+  changes.observe(graph);
+  changes.trim(changes.sequence());
+
+  tracker.clear();
+  const std::vector<NodeId> expected{0, 1, 2};
+  EXPECT_EQ(getNodes(tracker.view(graph.getLayer(2), false, &changes)), expected);
+}
+
+}  // namespace hydra
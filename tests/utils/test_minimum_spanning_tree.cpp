@@ -36,8 +36,27 @@
 #include <hydra/utils/disjoint_set.h>
 #include <hydra/utils/minimum_spanning_tree.h>
 
+#include <random>
+
 namespace hydra {
 
+namespace {
+
+double totalDistance(const SceneGraphLayer& layer, const MinimumSpanningTreeInfo& info) {
+  double total = 0.0;
+  for (const auto& edge : info.edges) {
+    total += (getNodePosition(layer, edge.source) - getNodePosition(layer, edge.target))
+                 .norm();
+  }
+  return total;
+}
+
+void addNode(SceneGraphLayer& layer, NodeId node, const Eigen::Vector3d& pos) {
+  layer.emplaceNode(node, std::make_unique<NodeAttributes>(pos));
+}
+
+}  // namespace
+
 // most for coverage
 TEST(DisjointSet, TestSameCluster) {
   DisjointSet set;
@@ -50,6 +69,34 @@ TEST(DisjointSet, TestSameCluster) {
   EXPECT_FALSE(retry_result);
 }
 
+TEST(DisjointSet, TestPathCompression) {
+  DisjointSet set;
+  for (NodeId i = 0; i < 5; ++i) {
+    set.addSet(i);
+  }
+
+  for (NodeId i = 1; i < 5; ++i) {
+    set.doUnion(i - 1, i);
+  }
+
+  const auto root = set.findSet(0);
+  for (NodeId i = 0; i < 5; ++i) {
+    EXPECT_EQ(set.findSet(i), root);
+  }
+
+  EXPECT_THROW(set.findSet(10), std::out_of_range);
+
+  // lookups through a const reference don't modify the set
+  const auto parents = set.parents;
+  const auto& const_set = set;
+  for (NodeId i = 0; i < 5; ++i) {
+    EXPECT_EQ(const_set.findSet(i), root);
+  }
+
+  EXPECT_EQ(parents, set.parents);
+  EXPECT_THROW(const_set.findSet(10), std::out_of_range);
+}
+
 TEST(MinimumSpanningTreeTests, TestSingleChain) {
   SceneGraphLayer layer(1);
   layer.emplaceNode(0,
@@ -107,4 +154,212 @@ TEST(MinimumSpanningTreeTests, TestCompleteGraph) {
   EXPECT_EQ(3u, info.edges[2].target);
 }
 
+TEST(DynamicMinimumSpanningTreeTests, TestEdgeSwap) {
+  SceneGraphLayer layer(1);
+  addNode(layer, 0, Eigen::Vector3d(0.0, 0.0, 0.0));
+  addNode(layer, 1, Eigen::Vector3d(1.0, 0.0, 0.0));
+  addNode(layer, 2, Eigen::Vector3d(3.0, 0.0, 0.0));
+  layer.insertEdge(0, 1);
+  layer.insertEdge(0, 2);
+
+  DynamicMinimumSpanningTree mst;
+  mst.update(layer);
+  EXPECT_EQ(mst.numTreeEdges(), 2u);
+  EXPECT_TRUE(mst.isTreeEdge(0, 2));
+  EXPECT_TRUE(mst.isLeaf(1));
+  EXPECT_TRUE(mst.isLeaf(2));
+  auto changes = mst.takeChanges();
+  EXPECT_EQ(changes.added.size(), 2u);
+  EXPECT_TRUE(changes.removed.empty());
+
+  // shorter edge should replace the longest edge in the cycle
+  layer.insertEdge(1, 2);
+  mst.update(layer);
+  EXPECT_EQ(mst.numEdges(), 3u);
+  EXPECT_EQ(mst.numTreeEdges(), 2u);
+  EXPECT_FALSE(mst.isTreeEdge(0, 2));
+  EXPECT_TRUE(mst.isTreeEdge(1, 2));
+  EXPECT_TRUE(mst.isLeaf(0));
+  EXPECT_TRUE(mst.isLeaf(2));
+  EXPECT_NEAR(mst.totalDistance(), 3.0, 1.0e-9);
+
+  changes = mst.takeChanges();
+  ASSERT_EQ(changes.added.size(), 1u);
+  EXPECT_EQ(changes.added[0], DynamicMinimumSpanningTree::EdgeKey(1, 2));
+  ASSERT_EQ(changes.removed.size(), 1u);
+  EXPECT_EQ(changes.removed[0], DynamicMinimumSpanningTree::EdgeKey(0, 2));
+  EXPECT_EQ(changes.nodes, std::unordered_set<NodeId>({0, 1, 2}));
+}
+
+TEST(DynamicMinimumSpanningTreeTests, TestRemovalReconnects) {
+  SceneGraphLayer layer(1);
+  addNode(layer, 0, Eigen::Vector3d(0.0, 0.0, 0.0));
+  addNode(layer, 1, Eigen::Vector3d(1.0, 0.0, 0.0));
+  addNode(layer, 2, Eigen::Vector3d(1.0, 1.0, 0.0));
+  addNode(layer, 3, Eigen::Vector3d(0.0, 1.0, 0.0));
+  layer.insertEdge(0, 1);
+  layer.insertEdge(1, 2);
+  layer.insertEdge(2, 3);
+  layer.insertEdge(3, 0);
+
+  DynamicMinimumSpanningTree mst;
+  mst.update(layer);
+  EXPECT_EQ(mst.numTreeEdges(), 3u);
+  mst.takeChanges();
+
+  // removing any tree edge should pull the remaining cycle edge into the tree
+  const NodeId source = mst.isTreeEdge(0, 1) ? 0 : 1;
+  const NodeId target = source == 0 ? 1 : 2;
+  layer.removeEdge(source, target);
+  mst.update(layer);
+  EXPECT_EQ(mst.numEdges(), 3u);
+  EXPECT_EQ(mst.numTreeEdges(), 3u);
+  EXPECT_NEAR(mst.totalDistance(), 3.0, 1.0e-9);
+  auto changes = mst.takeChanges();
+  EXPECT_EQ(changes.added.size(), 1u);
+  EXPECT_EQ(changes.removed.size(), 1u);
+
+  // removing a node splits off nothing else, but drops its edges
+  layer.removeNode(3);
+  mst.update(layer);
+  EXPECT_FALSE(mst.hasNode(3));
+  EXPECT_EQ(mst.numNodes(), 3u);
+  EXPECT_EQ(mst.numTreeEdges(), mst.numEdges());
+}
+
+TEST(DynamicMinimumSpanningTreeTests, TestMatchesStatic) {
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> pos_dist(0.0, 10.0);
+  std::uniform_int_distribution<NodeId> node_dist(0, 39);
+
+  SceneGraphLayer layer(1);
+  for (NodeId i = 0; i < 40; ++i) {
+    addNode(layer, i, Eigen::Vector3d(pos_dist(gen), pos_dist(gen), pos_dist(gen)));
+  }
+
+  DynamicMinimumSpanningTree mst;
+  for (size_t iter = 0; iter < 20; ++iter) {
+    for (size_t i = 0; i < 10; ++i) {
+      const auto source = node_dist(gen);
+      const auto target = node_dist(gen);
+      if (source != target) {
+        layer.insertEdge(source, target);
+      }
+    }
+
+    for (size_t i = 0; i < 4; ++i) {
+      const auto source = node_dist(gen);
+      const auto target = node_dist(gen);
+      if (layer.hasEdge(source, target)) {
+        layer.removeEdge(source, target);
+      }
+    }
+
+    mst.update(layer);
+    const auto expected = getMinimumSpanningEdges(layer);
+    EXPECT_EQ(mst.numEdges(), layer.numEdges());
+    EXPECT_EQ(mst.numTreeEdges(), expected.edges.size());
+    EXPECT_NEAR(mst.totalDistance(), totalDistance(layer, expected), 1.0e-6);
+
+    const auto info = mst.info();
+    EXPECT_EQ(info.leaves, expected.leaves);
+  }
+}
+
+TEST(DynamicMinimumSpanningTreeTests, TestEdgeReweight) {
+  DynamicMinimumSpanningTree mst;
+  for (NodeId i = 0; i < 3; ++i) {
+    mst.addNode(i);
+  }
+
+  mst.addEdge(0, 1, 1.0);
+  mst.addEdge(1, 2, 2.0);
+  mst.addEdge(0, 2, 3.0);
+  EXPECT_FALSE(mst.isTreeEdge(0, 2));
+  EXPECT_FALSE(mst.setEdgeDistance(0, 3, 1.0));
+
+  // a longer tree edge should be replaced by the cheapest edge across the cut
+  EXPECT_TRUE(mst.setEdgeDistance(0, 1, 4.0));
+  EXPECT_FALSE(mst.isTreeEdge(0, 1));
+  EXPECT_TRUE(mst.isTreeEdge(0, 2));
+  EXPECT_NEAR(mst.totalDistance(), 5.0, 1.0e-9);
+  EXPECT_NEAR(mst.edgeDistance(1, 0).value(), 4.0, 1.0e-9);
+
+  // a shorter non-tree edge should replace the longest edge in the cycle
+  EXPECT_TRUE(mst.setEdgeDistance(0, 1, 0.5));
+  EXPECT_TRUE(mst.isTreeEdge(0, 1));
+  EXPECT_FALSE(mst.isTreeEdge(0, 2));
+  EXPECT_NEAR(mst.totalDistance(), 2.5, 1.0e-9);
+
+  // a shorter tree edge stays in the tree
+  EXPECT_TRUE(mst.setEdgeDistance(1, 2, 1.5));
+  EXPECT_TRUE(mst.isTreeEdge(1, 2));
+  EXPECT_NEAR(mst.totalDistance(), 2.0, 1.0e-9);
+}
+
+TEST(DynamicMinimumSpanningTreeTests, TestIncrementalMatchesStatic) {
+  std::mt19937 gen(54321);
+  std::uniform_real_distribution<double> pos_dist(0.0, 10.0);
+  std::uniform_int_distribution<NodeId> node_dist(0, 39);
+
+  SceneGraphLayer layer(1);
+  DynamicMinimumSpanningTree mst;
+  std::vector<NodeId> dirty;
+  for (NodeId i = 0; i < 40; ++i) {
+    addNode(layer, i, Eigen::Vector3d(pos_dist(gen), pos_dist(gen), pos_dist(gen)));
+    dirty.push_back(i);
+  }
+
+  for (size_t iter = 0; iter < 20; ++iter) {
+    for (size_t i = 0; i < 10; ++i) {
+      const auto source = node_dist(gen);
+      const auto target = node_dist(gen);
+      if (source != target && layer.hasNode(source) && layer.hasNode(target)) {
+        layer.insertEdge(source, target);
+        dirty.push_back(source);
+        dirty.push_back(target);
+      }
+    }
+
+    for (size_t i = 0; i < 4; ++i) {
+      const auto source = node_dist(gen);
+      const auto target = node_dist(gen);
+      if (layer.hasEdge(source, target)) {
+        layer.removeEdge(source, target);
+        dirty.push_back(source);
+        dirty.push_back(target);
+      }
+    }
+
+    // move a few nodes most of the time and every node occasionally
+    const size_t num_moves = iter % 5 == 4 ? 40 : 3;
+    for (size_t i = 0; i < num_moves; ++i) {
+      const auto node = iter % 5 == 4 ? i : node_dist(gen);
+      if (!layer.hasNode(node)) {
+        continue;
+      }
+
+      layer.getNode(node).attributes().position =
+          Eigen::Vector3d(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+      dirty.push_back(node);
+    }
+
+    if (iter % 7 == 6) {
+      const auto node = node_dist(gen);
+      layer.removeNode(node);
+      dirty.push_back(node);
+    }
+
+    mst.update(layer, dirty);
+    dirty.clear();
+
+    const auto expected = getMinimumSpanningEdges(layer);
+    EXPECT_EQ(mst.numNodes(), layer.numNodes());
+    EXPECT_EQ(mst.numEdges(), layer.numEdges());
+    EXPECT_EQ(mst.numTreeEdges(), expected.edges.size());
+    EXPECT_NEAR(mst.totalDistance(), totalDistance(layer, expected), 1.0e-6);
+    EXPECT_EQ(mst.info().leaves, expected.leaves);
+  }
+}
+
 }  // namespace hydra
@@ -72,4 +72,50 @@ TEST(NearestNeighborUtilities, TestSkipFirst) {
   }
 }
 
+TEST(NearestNeighborUtilities, DynamicFinderUpdates) {
+  DynamicNodeFinder finder;
+  finder.insert(0, Eigen::Vector3d(0, 0, 3));
+  finder.insert(1, Eigen::Vector3d(0, 0, 0));
+  finder.insert(2, Eigen::Vector3d(3, 0, 0));
+  EXPECT_EQ(finder.size(), 3u);
+
+  const auto nearest = [&finder](const Eigen::Vector3d& pos, size_t num) {
+    std::vector<NodeId> nodes;
+    finder.find(pos, num, [&](NodeId node, size_t, double) { nodes.push_back(node); });
+    return nodes;
+  };
+
+  {  // closest nodes in order
+    const std::vector<NodeId> expected{0, 1};
+    EXPECT_EQ(nearest(Eigen::Vector3d(0, 0, 2), 2), expected);
+  }
+
+  // moving a node updates the index
+  finder.insert(2, Eigen::Vector3d(0, 0, 2.5));
+  EXPECT_EQ(finder.size(), 3u);
+  {
+    const std::vector<NodeId> expected{2, 0};
+    EXPECT_EQ(nearest(Eigen::Vector3d(0, 0, 2), 2), expected);
+  }
+
+  // removed nodes are never returned
+  EXPECT_TRUE(finder.erase(2));
+  EXPECT_FALSE(finder.erase(2));
+  EXPECT_FALSE(finder.contains(2));
+  {
+    const std::vector<NodeId> expected{0, 1};
+    EXPECT_EQ(nearest(Eigen::Vector3d(0, 0, 2), 5), expected);
+  }
+
+  // repeated moves shouldn't change the result
+  for (size_t i = 0; i < 10; ++i) {
+    finder.insert(1, Eigen::Vector3d(0, 0, 0.1 * i));
+  }
+  EXPECT_EQ(finder.size(), 2u);
+  {
+    const std::vector<NodeId> expected{1};
+    EXPECT_EQ(nearest(Eigen::Vector3d(0, 0, 0), 1), expected);
+  }
+}
+
 }  // namespace hydra
@@ -0,0 +1,211 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra/utils/place_2d_ellipsoid_math.h>
+#include <hydra/utils/place_2d_grid_index.h>
+
+#include <random>
+#include <set>
+
+namespace hydra {
+
+namespace {
+
+struct RandomEllipse {
+  Eigen::Matrix2d A;
+  Eigen::Vector2d center;
+};
+
+// Make ellipses the same way as the 2D places: A is either compress matrix (M^-T M^-1)
+// or the (not necessarily symmetric or definite) expand matrix M itself
+std::vector<RandomEllipse> makeEllipses(size_t num_ellipses,
+                                        bool use_expand,
+                                        std::mt19937& gen) {
+  std::uniform_real_distribution<double> pos_dist(-20.0, 20.0);
+  std::uniform_real_distribution<double> side_dist(0.3, 3.0);
+  std::uniform_real_distribution<double> angle_dist(-M_PI, M_PI);
+  std::vector<RandomEllipse> ellipses;
+  for (size_t i = 0; i < num_ellipses; ++i) {
+    const Eigen::Rotation2Dd rot(angle_dist(gen));
+    const Eigen::Vector2d e1 = rot * Eigen::Vector2d(side_dist(gen), 0.0);
+    const Eigen::Vector2d e2 = rot * Eigen::Vector2d(0.0, side_dist(gen));
+    Eigen::Matrix2d M;
+    M << e1.x(), e2.x(), e1.y(), e2.y();
+    M *= std::sqrt(2) / 2;
+
+    auto& ellipse = ellipses.emplace_back();
+    if (use_expand) {
+      ellipse.A = M;
+    } else {
+      const Eigen::Matrix2d m_inv = M.inverse();
+      ellipse.A = m_inv.transpose() * m_inv;
+    }
+
+    ellipse.center << pos_dist(gen), pos_dist(gen);
+  }
+
+  return ellipses;
+}
+
+void checkCandidatesComplete(const std::vector<RandomEllipse>& ellipses,
+                             size_t& num_candidates,
+                             size_t& num_overlapping) {
+  std::vector<PlaceBounds2d> bounds;
+  for (const auto& ellipse : ellipses) {
+    bounds.push_back(PlaceBounds2d::fromEllipse(ellipse.A, ellipse.center));
+  }
+
+  const Place2dGridIndex index(bounds);
+  for (size_t i = 0; i < ellipses.size(); ++i) {
+    const auto candidates = index.getCandidates(i);
+    EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+    const std::set<size_t> candidate_set(candidates.begin(), candidates.end());
+    num_candidates += candidates.size();
+
+    for (size_t j = 0; j < ellipses.size(); ++j) {
+      const auto overlap =
+          ellipse::getEllipsoidTransverseOverlapDistance(ellipses[i].A,
+                                                         ellipses[i].center,
+                                                         ellipses[j].A,
+                                                         ellipses[j].center);
+      if (overlap > 0.0) {
+        ++num_overlapping;
+        EXPECT_TRUE(candidate_set.count(j)) << "missing pair " << i << " -> " << j;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(Place2dGridIndex, EllipseBoundsCorrect) {
+  Eigen::Matrix2d A = Eigen::Matrix2d::Zero();
+  A(0, 0) = 1.0 / 4.0;
+  A(1, 1) = 1.0;
+  const auto bounds = PlaceBounds2d::fromEllipse(A, Eigen::Vector2d(1.0, 2.0));
+  ASSERT_TRUE(bounds.bounded);
+  EXPECT_NEAR(bounds.min.x(), -1.0, 1.0e-5);
+  EXPECT_NEAR(bounds.max.x(), 3.0, 1.0e-5);
+  EXPECT_NEAR(bounds.min.y(), 1.0, 1.0e-5);
+  EXPECT_NEAR(bounds.max.y(), 3.0, 1.0e-5);
+
+  // indefinite forms have unbounded regions
+  A(1, 1) = -1.0;
+  EXPECT_FALSE(PlaceBounds2d::fromEllipse(A, Eigen::Vector2d::Zero()).bounded);
+}
+
+TEST(Place2dGridIndex, UnboundedPlacesAlwaysCandidates) {
+  std::vector<PlaceBounds2d> bounds(3);
+  bounds[0].bounded = true;
+  bounds[0].max << 1.0, 1.0;
+  bounds[1].bounded = true;
+  bounds[1].min << 10.0, 10.0;
+  bounds[1].max << 11.0, 11.0;
+
+  const Place2dGridIndex index(bounds);
+  EXPECT_EQ(index.getCandidates(0), std::vector<size_t>({0, 2}));
+  EXPECT_EQ(index.getCandidates(1), std::vector<size_t>({1, 2}));
+  EXPECT_EQ(index.getCandidates(2), std::vector<size_t>({0, 1, 2}));
+}
+
+TEST(Place2dGridIndex, CandidatesMatchBruteForce) {
+  std::mt19937 gen(12345);
+  for (const bool use_expand : {false, true}) {
+    size_t num_candidates = 0;
+    size_t num_overlapping = 0;
+    const auto ellipses = makeEllipses(300, use_expand, gen);
+    checkCandidatesComplete(ellipses, num_candidates, num_overlapping);
+    EXPECT_GT(num_overlapping, ellipses.size());
+    if (!use_expand) {
+      // the index should prune most of the pairs (expand matrices are often indefinite
+      // and have to be checked against everything)
+      EXPECT_LT(num_candidates, ellipses.size() * ellipses.size() / 4);
+    }
+  }
+}
+
+TEST(Place2dGridIndex, LargeQueriesMatchBruteForce) {
+  std::mt19937 gen(54321);
+  std::uniform_real_distribution<double> pos_dist(-20.0, 20.0);
+  std::uniform_real_distribution<double> side_dist(0.1, 1.0);
+  std::vector<PlaceBounds2d> bounds(200);
+  for (auto& b : bounds) {
+    b.bounded = true;
+    b.min << pos_dist(gen), pos_dist(gen);
+    b.max = b.min + Eigen::Vector2d(side_dist(gen), side_dist(gen));
+  }
+
+  // queries that span far more cells than any single place
+  bounds[0].min << -15.0, -15.0;
+  bounds[0].max << 15.0, 15.0;
+  bounds[1].min << -1.0e3, -1.0;
+  bounds[1].max << 1.0e3, 1.0;
+
+  const Place2dGridIndex index(bounds);
+  for (size_t i = 0; i < bounds.size(); ++i) {
+    std::vector<size_t> expected;
+    for (size_t j = 0; j < bounds.size(); ++j) {
+      if (bounds[i].overlaps(bounds[j])) {
+        expected.push_back(j);
+      }
+    }
+
+    EXPECT_EQ(index.getCandidates(i), expected) << "query " << i;
+  }
+}
+
+TEST(Place2dGridIndex, DistantPlacesHandled) {
+  std::vector<PlaceBounds2d> bounds(4);
+  bounds[0].bounded = true;
+  bounds[0].min << 1.0e12, 1.0e12;
+  bounds[0].max << 1.0e12 + 1.0, 1.0e12 + 1.0;
+  bounds[1].bounded = true;
+  bounds[1].min << 1.0e12 + 0.5, 1.0e12 + 0.5;
+  bounds[1].max << 1.0e12 + 2.0, 1.0e12 + 2.0;
+  bounds[2].bounded = true;
+  bounds[2].min << -1.0e12, -1.0e12;
+  bounds[2].max << -1.0e12 + 1.0, -1.0e12 + 1.0;
+  bounds[3].bounded = true;
+  bounds[3].min << -1.0e15, -1.0e15;
+  bounds[3].max << 1.0e15, 1.0e15;
+
+  const Place2dGridIndex index(bounds);
+  EXPECT_EQ(index.getCandidates(0), std::vector<size_t>({0, 1, 3}));
+  EXPECT_EQ(index.getCandidates(1), std::vector<size_t>({0, 1, 3}));
+  EXPECT_EQ(index.getCandidates(2), std::vector<size_t>({2, 3}));
+  EXPECT_EQ(index.getCandidates(3), std::vector<size_t>({0, 1, 2, 3}));
+}
+
+}  // namespace hydra
@@ -35,6 +35,7 @@
 #include <gtest/gtest.h>
 #include <hydra/utils/timing_utilities.h>
 
+#include <limits>
 #include <thread>
 
 namespace hydra {
@@ -138,5 +139,68 @@ TEST_F(TimingUtilityTests, TestScopedTimers) {
   EXPECT_GT(*elapsed_2, *elapsed_4);
 }
 
+TEST(ElapsedHistogram, BucketsRoundTrip) {
+  for (size_t i = 0; i < ElapsedHistogram::kNumBuckets; ++i) {
+    EXPECT_EQ(i, ElapsedHistogram::bucketIndex(ElapsedHistogram::bucketLowerBound(i)));
+  }
+
+  // values past the last bucket are clamped
+  EXPECT_EQ(ElapsedHistogram::kNumBuckets - 1,
+            ElapsedHistogram::bucketIndex(std::numeric_limits<uint64_t>::max()));
+}
+
+TEST(ElapsedHistogram, QuantilesWithinError) {
+  using namespace std::chrono_literals;
+
+  ElapsedHistogram histogram;
+  EXPECT_EQ(0.0, histogram.quantile(0.5));
+  for (size_t i = 1; i <= 1000; ++i) {
+    histogram.add(i * 1us);
+  }
+
+  EXPECT_EQ(1000u, histogram.count());
+  EXPECT_NEAR(500.0e-6, histogram.quantile(0.5), 500.0e-6 * 0.04);
+  EXPECT_NEAR(900.0e-6, histogram.quantile(0.9), 900.0e-6 * 0.04);
+  EXPECT_NEAR(990.0e-6, histogram.quantile(0.99), 990.0e-6 * 0.04);
+}
+
+TEST_F(TimingUtilityTests, TestSnapshotAcrossThreads) {
+  using namespace std::chrono_literals;
+
+  auto& recorder = ElapsedTimeRecorder::instance();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&recorder]() {
+      const auto timer = recorder.getTimerId("test");
+      for (size_t i = 1; i <= 1000; ++i) {
+        recorder.record(timer, i, i * 1us);
+      }
+    });
+  }
+
+  // snapshots are allowed while threads are still recording
+  const auto partial = recorder.snapshot("test");
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (partial) {
+    EXPECT_LE(partial->stats.num_measurements, 4000u);
+  }
+
+  const auto result = recorder.snapshot("test");
+  ASSERT_TRUE(result);
+  EXPECT_EQ(4000u, result->stats.num_measurements);
+  EXPECT_NEAR(500.5e-6, result->stats.mean_s, 1.0e-9);
+  EXPECT_NEAR(1.0e-6, result->stats.min_s, 1.0e-12);
+  EXPECT_NEAR(1.0e-3, result->stats.max_s, 1.0e-12);
+  EXPECT_NEAR(500.0e-6, result->p50_s, 500.0e-6 * 0.04);
+  EXPECT_NEAR(990.0e-6, result->p99_s, 990.0e-6 * 0.04);
+
+  const auto all = recorder.snapshot();
+  ASSERT_EQ(1u, all.size());
+  EXPECT_EQ("test", all[0].name);
+}
+
 }  // namespace timing
 }  // namespace hydra